@@ -52,6 +52,16 @@
 #define UDP_PORT 8214
 #define SEND_INTERVAL (CLOCK_SECOND)
 
+/* With a varying load, the request rate goes up by LOAD_PEAK_FACTOR
+ * every other LOAD_PHASE_DURATION seconds */
+#ifdef APP_CONF_VARYING_LOAD
+#define VARYING_LOAD APP_CONF_VARYING_LOAD
+#else
+#define VARYING_LOAD 0
+#endif
+#define LOAD_PHASE_DURATION 300
+#define LOAD_PEAK_FACTOR 4
+
 static struct simple_udp_connection udp_conn;
 
 /*---------------------------------------------------------------------------*/
@@ -93,6 +103,17 @@ udp_rx_callback(struct simple_udp_connection *c,
   }
 }
 /*---------------------------------------------------------------------------*/
+static clock_time_t
+send_interval(void)
+{
+#if VARYING_LOAD
+  if((clock_seconds() / LOAD_PHASE_DURATION) % 2) {
+    return SEND_INTERVAL / LOAD_PEAK_FACTOR;
+  }
+#endif /* VARYING_LOAD */
+  return SEND_INTERVAL;
+}
+/*---------------------------------------------------------------------------*/
 PROCESS_THREAD(app_process, ev, data)
 {
   static struct etimer timer;
@@ -129,13 +150,13 @@ PROCESS_THREAD(app_process, ev, data)
     } while(uip_sr_num_nodes() < deployment_node_count());
 
     /* Now start requesting nodes at random */
-    etimer_set(&timer, SEND_INTERVAL);
+    etimer_set(&timer, send_interval());
     while(uip_sr_num_nodes() == deployment_node_count()) {
       static uint32_t count = 0;
       uint16_t dest_id;
 
       PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&timer));
-      etimer_reset(&timer);
+      etimer_reset_with_new_interval(&timer, send_interval());
 
       /* Select a destination at random. Iterate until we do not select ourselve */
       do {
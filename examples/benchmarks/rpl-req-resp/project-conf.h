@@ -43,4 +43,24 @@
 #endif
 #endif
 
+#if CONFIG_ADAPTIVE_TIMING
+/* Shrink the timeslots to the measured processing times after two minutes */
+#define TSCH_CONF_ADAPTIVE_TIMESLOT_TIMING 1
+#define TSCH_CONF_ADAPTIVE_TIMESLOT_TIMING_CALIBRATION (120 * CLOCK_SECOND)
+#endif
+
+#if CONFIG_BURST
+/* Drain queued unicast packets to a neighbor in consecutive timeslots */
+#define TSCH_CONF_BURST_MAX_LEN 8
+#endif
+
+#if CONFIG_MSF
+/* Negotiate dedicated cells with the parent, following the load */
+#define TSCH_CONF_WITH_SIXTOP 1
+#define SIXTOP_CONF_WITH_MSF 1
+#define TSCH_SCHEDULE_CONF_DEFAULT_LENGTH 17
+/* Alternate between low and high load to exercise cell adaptation */
+#define APP_CONF_VARYING_LOAD 1
+#endif
+
 #endif /* PROJECT_CONF_H_ */
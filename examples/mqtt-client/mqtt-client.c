@@ -255,7 +255,10 @@ static const uint8_t mqtt_client_extension_count = 0;
 #if MQTT_5
 static uint8_t PUB_TOPIC_ALIAS;
 
-struct mqtt_prop_list *publish_props;
+/* Publish properties are encoded once, into this buffer */
+static struct mqtt_prop_list publish_prop_list;
+static uint8_t publish_prop_buf[32];
+struct mqtt_prop_list *publish_props = &publish_prop_list;
 
 /* Control whether or not to perform authentication (MQTTv5) */
 #define MQTT_5_AUTH_EN 0
@@ -749,7 +752,8 @@ state_machine(void)
     connect_attempt = 1;
 
 #if MQTT_5
-    mqtt_prop_create_list(&publish_props);
+    mqtt_prop_create_buf_list(publish_props, publish_prop_buf,
+                              sizeof(publish_prop_buf));
 
     /* this will be sent with every publish packet */
     (void)mqtt_prop_register(&publish_props,
@@ -46,12 +46,36 @@
 #include "contiki.h"
 #include "contiki-net.h"
 #include "net/ipv6/multicast/uip-mcast6.h"
+#include "net/ipv6/multicast/uip-mcast6-stats.h"
+
+#include <stdio.h>
 
 #if !NETSTACK_CONF_WITH_IPV6 || !UIP_CONF_ROUTER || !UIP_IPV6_MULTICAST || !UIP_CONF_IPV6_RPL
 #error "This example can not work with the current contiki configuration"
 #error "Check the values of: NETSTACK_CONF_WITH_IPV6, UIP_CONF_ROUTER, UIP_CONF_IPV6_RPL"
 #endif
 /*---------------------------------------------------------------------------*/
+#if UIP_MCAST6_STATS
+#define STATS_INTERVAL (10 * CLOCK_SECOND)
+
+static struct etimer stats_timer;
+/*---------------------------------------------------------------------------*/
+static void
+print_stats(void)
+{
+  uint8_t buf[UIP_MCAST6_STATS_DUMP_LEN];
+  int len;
+  int i;
+
+  len = uip_mcast6_stats_dump(buf, sizeof(buf));
+  printf("Stats: ");
+  for(i = 0; i < len; i++) {
+    printf("%02x", buf[i]);
+  }
+  printf("\n");
+}
+#endif /* UIP_MCAST6_STATS */
+/*---------------------------------------------------------------------------*/
 PROCESS(mcast_intermediate_process, "Intermediate Process");
 AUTOSTART_PROCESSES(&mcast_intermediate_process);
 /*---------------------------------------------------------------------------*/
@@ -59,6 +83,15 @@ PROCESS_THREAD(mcast_intermediate_process, ev, data)
 {
   PROCESS_BEGIN();
 
+#if UIP_MCAST6_STATS
+  etimer_set(&stats_timer, STATS_INTERVAL);
+  while(1) {
+    PROCESS_YIELD_UNTIL(etimer_expired(&stats_timer));
+    print_stats();
+    etimer_reset(&stats_timer);
+  }
+#endif /* UIP_MCAST6_STATS */
+
   PROCESS_END();
 }
 /*---------------------------------------------------------------------------*/
@@ -46,6 +46,9 @@
 #include "sys/ctimer.h"
 #include "sys/cc.h"
 #include "lib/random.h"
+#include "lib/list.h"
+
+#include <string.h>
 /*---------------------------------------------------------------------------*/
 #define DEBUG 0
 
@@ -73,6 +76,13 @@ static clock_time_t loc_clock; /* A local, general-purpose placeholder */
 
 static void fire(void *ptr);
 static void double_interval(void *ptr);
+
+/* The events of a trickle timer: time t, and the interval's end */
+#define EVENT_FIRE            0
+#define EVENT_DOUBLE          1
+/* With the shared scheduler: the interval's end, with the callback of a
+ * suppressed transmission batched in */
+#define EVENT_SUPPRESSED_END  2
 /*---------------------------------------------------------------------------*/
 /* Local utilities and functions to be used as ctimer callbacks */
 /*---------------------------------------------------------------------------*/
@@ -164,6 +174,118 @@ get_t(clock_time_t i_cur)
 
   return i_cur + (tt_rand() % i_cur);
 }
+#if TRICKLE_TIMER_WITH_SCHEDULER
+/*---------------------------------------------------------------------------*/
+/* Shared scheduler: the running timers wait in the queue, sorted by the time
+ * of their next event, and scheduler_ct is set for the head of the queue */
+/*---------------------------------------------------------------------------*/
+LIST(queue);
+static struct ctimer scheduler_ct;
+static uint8_t scheduler_running;
+
+static void run_scheduler(void *ptr);
+
+/* Non-zero if the event of tt is due by time 'when' */
+#define IS_DUE_BY(tt, when) \
+  ((clock_time_t)((when) - (tt)->due) <= (TRICKLE_TIMER_CLOCK_MAX >> 1))
+/*---------------------------------------------------------------------------*/
+static void
+arm_scheduler(void)
+{
+  struct trickle_timer *head = list_head(queue);
+  clock_time_t ticks;
+
+  if(head == NULL) {
+    ctimer_stop(&scheduler_ct);
+    return;
+  }
+
+  ticks = head->due - clock_time();
+  if(ticks > (TRICKLE_TIMER_CLOCK_MAX >> 1)) {
+    ticks = 0; /* Due in the past */
+  }
+  ctimer_set(&scheduler_ct, ticks, run_scheduler, NULL);
+}
+/*---------------------------------------------------------------------------*/
+static void
+run_scheduler(void *ptr)
+{
+  struct trickle_timer *tt;
+  clock_time_t now = clock_time();
+
+  scheduler_running = 1;
+
+  /* Events scheduled from within the callbacks are handled in this same pass
+   * if they are due already */
+  while((tt = list_head(queue)) != NULL &&
+        IS_DUE_BY(tt, now + TRICKLE_TIMER_SCHEDULER_WINDOW)) {
+    list_pop(queue);
+    if(tt->event == EVENT_DOUBLE) {
+      double_interval(tt);
+    } else {
+      /* For a suppressed transmission, the interval has ended already and
+       * fire() schedules the doubling right away */
+      fire(tt);
+    }
+  }
+
+  scheduler_running = 0;
+  arm_scheduler();
+}
+/*---------------------------------------------------------------------------*/
+static void
+schedule_at(struct trickle_timer *tt, clock_time_t due, uint8_t event)
+{
+  struct trickle_timer *prev;
+  struct trickle_timer *t;
+
+  list_remove(queue, tt);
+  tt->due = due;
+  tt->event = event;
+
+  /* After the timers due at the same time, to keep them in FIFO order */
+  prev = NULL;
+  for(t = list_head(queue); t != NULL && IS_DUE_BY(t, tt->due);
+      t = list_item_next(t)) {
+    prev = t;
+  }
+  list_insert(queue, prev, tt);
+
+  if(prev == NULL && !scheduler_running) {
+    arm_scheduler();
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+schedule(struct trickle_timer *tt, clock_time_t ticks, uint8_t event)
+{
+  schedule_at(tt, clock_time() + ticks, event);
+}
+/*---------------------------------------------------------------------------*/
+void
+trickle_timer_unschedule(struct trickle_timer *tt)
+{
+  if(list_head(queue) == tt) {
+    list_pop(queue);
+    if(!scheduler_running) {
+      arm_scheduler();
+    }
+  } else {
+    list_remove(queue, tt);
+  }
+}
+#endif /* TRICKLE_TIMER_WITH_SCHEDULER */
+/*---------------------------------------------------------------------------*/
+/* Schedule the next event of a trickle timer in 'ticks' clock ticks */
+static void
+set_timer(struct trickle_timer *tt, clock_time_t ticks, uint8_t event)
+{
+#if TRICKLE_TIMER_WITH_SCHEDULER
+  schedule(tt, ticks, event);
+#else
+  ctimer_set(&tt->ct, ticks, event == EVENT_FIRE ? fire : double_interval, tt);
+#endif
+}
 /*---------------------------------------------------------------------------*/
 static void
 schedule_for_end(struct trickle_timer *tt)
@@ -183,7 +305,7 @@ schedule_for_end(struct trickle_timer *tt)
     PRINTF("trickle_timer doubling: Was in the past. Compensating\n");
   }
 
-  ctimer_set(&tt->ct, loc_clock, double_interval, tt);
+  set_timer(tt, loc_clock, EVENT_DOUBLE);
 }
 /*---------------------------------------------------------------------------*/
 /* This is used as a ctimer callback, thus its argument must be void *. ptr is
@@ -233,7 +355,7 @@ double_interval(void *ptr)
     loc_clock = 0;
     PRINTF("trickle_timer doubling: Was in the past. Compensating\n");
   }
-  ctimer_set(&loctt->ct, loc_clock, fire, loctt);
+  set_timer(loctt, loc_clock, EVENT_FIRE);
 
   /* Store the actual interval start (absolute time), we need it later.
    * We pretend that it started at the same time when the last one ended */
@@ -241,16 +363,15 @@ double_interval(void *ptr)
 #else
   /* Assumed that the previous interval's end is 'now' and schedule in t ticks
    * after 'now', ignoring potential offsets */
-  ctimer_set(&loctt->ct, loc_clock, fire, loctt);
+  set_timer(loctt, loc_clock, EVENT_FIRE);
   /* Store the actual interval start (absolute time), we need it later */
-  loctt->i_start = loctt->ct.etimer.timer.start;
+  loctt->i_start = TRICKLE_TIMER_NEXT_EVENT(loctt) - loc_clock;
 #endif
 
   PRINTF("trickle_timer doubling: Last end %lu, new end %lu, for %lu, I=%lu\n",
          (unsigned long)last_end,
          (unsigned long)TRICKLE_TIMER_INTERVAL_END(loctt),
-         (unsigned long)(loctt->ct.etimer.timer.start +
-                         loctt->ct.etimer.timer.interval),
+         (unsigned long)TRICKLE_TIMER_NEXT_EVENT(loctt),
          (unsigned long)(loctt->i_cur));
 }
 /*---------------------------------------------------------------------------*/
@@ -264,8 +385,7 @@ fire(void *ptr)
 
   PRINTF("trickle_timer fire: at %lu (was for %lu)\n",
          (unsigned long)clock_time(),
-         (unsigned long)(loctt->ct.etimer.timer.start +
-                         loctt->ct.etimer.timer.interval));
+         (unsigned long)TRICKLE_TIMER_NEXT_EVENT(loctt));
 
   if(loctt->cb) {
     /*
@@ -274,6 +394,13 @@ fire(void *ptr)
      */
     PRINTF("trickle_timer fire: Suppression Status %u (%u < %u)\n",
            TRICKLE_TIMER_PROTO_TX_ALLOW(loctt), loctt->c, loctt->k);
+#if TRICKLE_TIMER_WITH_STATS
+    if(TRICKLE_TIMER_PROTO_TX_ALLOW(loctt)) {
+      loctt->stats.transmissions++;
+    } else {
+      loctt->stats.suppressions++;
+    }
+#endif
     loctt->cb(loctt->cb_arg, TRICKLE_TIMER_PROTO_TX_ALLOW(loctt));
   }
 
@@ -292,10 +419,10 @@ new_interval(struct trickle_timer *tt)
   /* Random t in [I/2, I) */
   loc_clock = get_t(tt->i_cur);
 
-  ctimer_set(&tt->ct, loc_clock, fire, tt);
+  set_timer(tt, loc_clock, EVENT_FIRE);
 
   /* Store the actual interval start (absolute time), we need it later */
-  tt->i_start = tt->ct.etimer.timer.start;
+  tt->i_start = TRICKLE_TIMER_NEXT_EVENT(tt) - loc_clock;
   PRINTF("trickle_timer new interval: at %lu, ends %lu, ",
          (unsigned long)clock_time(),
          (unsigned long)TRICKLE_TIMER_INTERVAL_END(tt));
@@ -314,6 +441,19 @@ trickle_timer_consistency(struct trickle_timer *tt)
     tt->c++;
   }
   PRINTF("trickle_timer consistency: c=%u\n", tt->c);
+
+#if TRICKLE_TIMER_WITH_SCHEDULER
+  /* c only grows until the interval ends: once the transmission at time t
+   * is known to be suppressed, its callback waits for the interval's end */
+  if(tt->event == EVENT_FIRE && TRICKLE_TIMER_PROTO_TX_SUPPRESS(tt)) {
+    loc_clock = clock_time();
+    if((clock_time_t)(TRICKLE_TIMER_INTERVAL_END(tt) - loc_clock) <=
+       (TRICKLE_TIMER_CLOCK_MAX >> 1)) {
+      loc_clock = TRICKLE_TIMER_INTERVAL_END(tt);
+    }
+    schedule_at(tt, loc_clock, EVENT_SUPPRESSED_END);
+  }
+#endif
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -327,6 +467,9 @@ trickle_timer_inconsistency(struct trickle_timer *tt)
   if(tt->i_cur != tt->i_min) {
     PRINTF("trickle_timer inconsistency\n");
     tt->i_cur = tt->i_min;
+#if TRICKLE_TIMER_WITH_STATS
+    tt->stats.resets++;
+#endif
 
     new_interval(tt);
   }
@@ -374,6 +517,9 @@ trickle_timer_config(struct trickle_timer *tt, clock_time_t i_min,
   tt->k = k;
   tt->i_cur = TRICKLE_TIMER_IS_STOPPED;
   tt->cb = NULL;
+#if TRICKLE_TIMER_WITH_STATS
+  memset(&tt->stats, 0, sizeof(tt->stats));
+#endif
 
   PRINTF("trickle_timer config: Imin=%lu, Imax=%u, k=%u\n",
          (unsigned long)tt->i_min, tt->i_max, tt->k);
@@ -409,7 +555,7 @@ trickle_timer_set(struct trickle_timer *tt, trickle_timer_cb_t proto_cb,
   PRINTF("trickle_timer set: at %lu, ends %lu, t=%lu in [%lu , %lu)\n",
          (unsigned long)tt->i_start,
          (unsigned long)TRICKLE_TIMER_INTERVAL_END(tt),
-         (unsigned long)tt->ct.etimer.timer.interval,
+         (unsigned long)(TRICKLE_TIMER_NEXT_EVENT(tt) - tt->i_start),
          (unsigned long)tt->i_cur >> 1, (unsigned long)tt->i_cur);
 
   return TRICKLE_TIMER_SUCCESS;
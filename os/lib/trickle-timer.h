@@ -205,6 +205,42 @@
 #define TRICKLE_TIMER_ERROR_CHECKING 1
 #endif
 /*---------------------------------------------------------------------------*/
+/**
+ * \brief Drive all trickle timers from a single shared scheduler
+ * 1: Enabled. Running timers wait in one queue sorted by the time of their
+ * next event, and a single \ref ctimer is set for the head of that queue.
+ * A transmission known to be suppressed (c >= k before time t) does not get
+ * a wakeup of its own: the protocol's callback is invoked at the end of the
+ * interval, in the same pass as the interval doubling.
+ * 0: Disabled (default). Each trickle timer uses a \ref ctimer of its own.
+ */
+#ifdef TRICKLE_TIMER_CONF_WITH_SCHEDULER
+#define TRICKLE_TIMER_WITH_SCHEDULER TRICKLE_TIMER_CONF_WITH_SCHEDULER
+#else
+#define TRICKLE_TIMER_WITH_SCHEDULER 0
+#endif
+
+/**
+ * \brief With the shared scheduler, events due within this many clock ticks
+ * after the earliest one are handled in the same pass, ahead of time.
+ * 0 (default) only batches events that are due at the same tick.
+ */
+#ifdef TRICKLE_TIMER_CONF_SCHEDULER_WINDOW
+#define TRICKLE_TIMER_SCHEDULER_WINDOW TRICKLE_TIMER_CONF_SCHEDULER_WINDOW
+#else
+#define TRICKLE_TIMER_SCHEDULER_WINDOW 0
+#endif
+
+/**
+ * \brief Keep per-timer statistics, see ::trickle_timer_stats
+ * 1: Enabled. 0: Disabled (default)
+ */
+#ifdef TRICKLE_TIMER_CONF_WITH_STATS
+#define TRICKLE_TIMER_WITH_STATS TRICKLE_TIMER_CONF_WITH_STATS
+#else
+#define TRICKLE_TIMER_WITH_STATS 0
+#endif
+/*---------------------------------------------------------------------------*/
 /* Trickle Timer Library Macros */
 /*---------------------------------------------------------------------------*/
 /**
@@ -281,6 +317,19 @@
  */
 #define TRICKLE_TIMER_INTERVAL_END(tt) ((tt)->i_start + (tt)->i_cur)
 
+/**
+ * \brief Returns the time of the timer's next event (absolute time in ticks)
+ * \param tt A pointer to a ::trickle_timer structure
+ * \return Time t within the current interval, or the interval's end once t
+ *         has passed
+ */
+#if TRICKLE_TIMER_WITH_SCHEDULER
+#define TRICKLE_TIMER_NEXT_EVENT(tt) ((tt)->due)
+#else
+#define TRICKLE_TIMER_NEXT_EVENT(tt) \
+  ((tt)->ct.etimer.timer.start + (tt)->ct.etimer.timer.interval)
+#endif
+
 /**
  * \brief Checks whether an Imin value is suitable considering the various
  * restrictions imposed by our platform's clock as well as by the library itself
@@ -347,6 +396,21 @@
  */
 typedef void (* trickle_timer_cb_t)(void *ptr, uint8_t suppress);
 
+#if TRICKLE_TIMER_WITH_STATS
+/**
+ * \struct trickle_timer_stats
+ *
+ * Statistics of a trickle timer, since it was configured. As each protocol
+ * runs trickle timers of its own, they show the control overhead of each.
+ */
+struct trickle_timer_stats {
+  uint32_t transmissions; /**< Callbacks told to go ahead with TX */
+  uint32_t suppressions;  /**< Callbacks told to suppress */
+  uint32_t resets;        /**< Resets to Imin, on inconsistencies and
+                               external events */
+};
+#endif /* TRICKLE_TIMER_WITH_STATS */
+
 /**
  * \struct trickle_timer
  *
@@ -362,6 +426,9 @@ typedef void (* trickle_timer_cb_t)(void *ptr, uint8_t suppress);
  * boundaries of clock_time_t
  */
 struct trickle_timer {
+#if TRICKLE_TIMER_WITH_SCHEDULER
+  struct trickle_timer *next; /**< Next timer in the scheduler's queue */
+#endif
   clock_time_t i_min;     /**< Imin: Clock ticks */
   clock_time_t i_cur;     /**< I: Current interval in clock_ticks */
   clock_time_t i_start;   /**< Start of this interval (absolute clock_time) */
@@ -370,7 +437,14 @@ struct trickle_timer {
                                Imin << Imax used internally, so that we can
                                have direct access to the maximum interval size
                                without having to calculate it all the time */
+#if TRICKLE_TIMER_WITH_SCHEDULER
+  clock_time_t due;       /**< Time of the next event (absolute clock_time) */
+#else
   struct ctimer ct;       /**< A \ref ctimer used internally */
+#endif
+#if TRICKLE_TIMER_WITH_STATS
+  struct trickle_timer_stats stats; /**< Statistics, read-only */
+#endif
   trickle_timer_cb_t cb;  /**< Protocol's own callback, invoked at time t
                                within the current interval */
   void *cb_arg;           /**< Opaque pointer to be used as the argument of the
@@ -378,6 +452,9 @@ struct trickle_timer {
   uint8_t i_max;          /**< Imax: Max number of doublings */
   uint8_t k;              /**< k: Redundancy Constant */
   uint8_t c;              /**< c: Consistency Counter */
+#if TRICKLE_TIMER_WITH_SCHEDULER
+  uint8_t event;          /**< The next event, used internally */
+#endif
 };
 /** @} */
 /*---------------------------------------------------------------------------*/
@@ -448,10 +525,26 @@ uint8_t trickle_timer_set(struct trickle_timer *tt,
  * to reset a timer manually. Instead, in response to events or inconsistencies,
  * the corresponding functions must be used
  */
+#if TRICKLE_TIMER_WITH_SCHEDULER
+#define trickle_timer_stop(tt) do { \
+  trickle_timer_unschedule(tt); \
+  (tt)->i_cur = TRICKLE_TIMER_IS_STOPPED; \
+} while(0)
+
+/**
+ * \brief      Remove a trickle timer from the shared scheduler's queue
+ * \param tt   A pointer to a ::trickle_timer structure
+ *
+ * Used internally by trickle_timer_stop(). Protocols must not call it
+ * directly.
+ */
+void trickle_timer_unschedule(struct trickle_timer *tt);
+#else
 #define trickle_timer_stop(tt) do { \
   ctimer_stop(&((tt)->ct)); \
   (tt)->i_cur = TRICKLE_TIMER_IS_STOPPED; \
 } while(0)
+#endif
 
 /**
  * \brief      To be called by the protocol when it hears a consistent
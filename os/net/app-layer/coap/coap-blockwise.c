@@ -0,0 +1,511 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         Pipelined block-wise transfers. Up to a window of block requests
+ *         are outstanding, each in its own confirmable transaction. Blocks
+ *         may complete out of order: they are stored at their offsets,
+ *         and a bitmap tracks the completed ones after the first missing
+ *         block.
+ */
+
+/**
+ * \addtogroup coap
+ * @{
+ */
+
+#include "coap-blockwise.h"
+#include "sys/cc.h"
+#include <string.h>
+#include <inttypes.h>
+#if COAP_BLOCKWISE_WITH_CFS
+#include "cfs/cfs.h"
+#endif /* COAP_BLOCKWISE_WITH_CFS */
+
+/* Log configuration */
+#include "coap-log.h"
+#define LOG_MODULE "coap"
+#define LOG_LEVEL  LOG_LEVEL_COAP
+
+#if COAP_BLOCKWISE_WINDOW > 32
+#error "COAP_BLOCKWISE_WINDOW must be at most 32"
+#endif
+
+#define UNKNOWN_BLOCK UINT32_MAX
+
+/* Retry interval when no transaction could be allocated, in msec */
+#define RETRY_INTERVAL 100
+
+#if COAP_BLOCKWISE_WITH_CFS
+static uint8_t block_buffer[COAP_MAX_BLOCK_SIZE];
+#endif /* COAP_BLOCKWISE_WITH_CFS */
+
+static void send_requests(coap_blockwise_state_t *state);
+
+/*---------------------------------------------------------------------------*/
+static uint16_t
+valid_block_size(uint16_t size)
+{
+  uint16_t valid = 16;
+
+  size = MIN(size, COAP_MAX_BLOCK_SIZE);
+  while(valid * 2 <= size) {
+    valid <<= 1;
+  }
+  return valid;
+}
+/*---------------------------------------------------------------------------*/
+static uint32_t
+last_block(const coap_blockwise_state_t *state)
+{
+  return state->length > 0 ? (state->length - 1) / state->block_size : 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+finish(coap_blockwise_state_t *state, coap_request_status_t status,
+       coap_message_t *response)
+{
+  int i;
+
+  state->active = 0;
+  coap_timer_stop(&state->retry_timer);
+  for(i = 0; i < COAP_BLOCKWISE_WINDOW; i++) {
+    if(state->slots[i].transaction != NULL) {
+      coap_clear_transaction(state->slots[i].transaction);
+      state->slots[i].transaction = NULL;
+    }
+  }
+  state->outstanding = 0;
+
+  LOG_DBG("Block-wise transfer done, status %u, %lu bytes\n", status,
+          (unsigned long)state->length);
+
+  state->status = status;
+  state->response = response;
+  state->callback(state);
+  state->response = NULL;
+}
+/*---------------------------------------------------------------------------*/
+static int
+store_block(coap_blockwise_state_t *state, uint32_t offset,
+            const uint8_t *data, uint16_t len)
+{
+#if COAP_BLOCKWISE_WITH_CFS
+  if(state->fd >= 0) {
+    if(cfs_seek(state->fd, offset, CFS_SEEK_SET) != offset ||
+       cfs_write(state->fd, data, len) != len) {
+      return 0;
+    }
+  } else
+#endif /* COAP_BLOCKWISE_WITH_CFS */
+  {
+    if(offset + len > state->buffer_size) {
+      return 0;
+    }
+    memcpy(state->buffer + offset, data, len);
+  }
+
+  if(offset + len > state->length) {
+    state->length = offset + len;
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static const uint8_t *
+load_block(coap_blockwise_state_t *state, uint32_t offset, uint16_t len)
+{
+#if COAP_BLOCKWISE_WITH_CFS
+  if(state->fd >= 0) {
+    if(cfs_seek(state->fd, offset, CFS_SEEK_SET) != offset ||
+       cfs_read(state->fd, block_buffer, len) != len) {
+      return NULL;
+    }
+    return block_buffer;
+  }
+#endif /* COAP_BLOCKWISE_WITH_CFS */
+  return state->buffer + offset;
+}
+/*---------------------------------------------------------------------------*/
+static void
+mark_done(coap_blockwise_state_t *state, uint32_t num)
+{
+  if(num < state->base || num - state->base >= 32) {
+    return;
+  }
+  state->done_map |= (uint32_t)1 << (num - state->base);
+  while(state->done_map & 1) {
+    state->done_map >>= 1;
+    state->base++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+reduce_block_size(coap_blockwise_state_t *state, uint16_t size)
+{
+  LOG_INFO("Block size reduced from %u to %u\n", state->block_size, size);
+
+  /* restart at the first missing byte; replies in the old size are stale */
+  state->base *= state->block_size / size;
+  state->next = state->base;
+  state->done_map = 0;
+  state->block_size = size;
+  state->limit = UNKNOWN_BLOCK;
+  if(state->option == COAP_OPTION_BLOCK2) {
+    state->last = UNKNOWN_BLOCK;
+  } else {
+    state->last = last_block(state);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+response_handler(void *callback_data, coap_message_t *response)
+{
+  struct coap_blockwise_slot *slot = callback_data;
+  coap_blockwise_state_t *state = slot->state;
+  uint32_t num = slot->num;
+  uint32_t offset;
+  uint32_t size2;
+  uint16_t size;
+  uint8_t more;
+
+  /* the transaction was freed by the engine */
+  slot->transaction = NULL;
+  state->outstanding--;
+
+  if(!state->active) {
+    return;
+  }
+
+  if(response == NULL) {
+    LOG_WARN("Block %"PRIu32" timed out\n", num);
+    finish(state, COAP_REQUEST_STATUS_TIMEOUT, NULL);
+    return;
+  }
+
+  state->response_code = response->code;
+
+  if(state->option == COAP_OPTION_BLOCK2) {
+    if(response->code >= BAD_REQUEST_4_00) {
+      if(response->code == BAD_OPTION_4_02 && num > 0 &&
+         (state->last == UNKNOWN_BLOCK || num > state->last)) {
+        /* requested past the end of the representation */
+        state->limit = MIN(state->limit, num);
+        if(state->last == UNKNOWN_BLOCK && state->base >= state->limit) {
+          LOG_WARN("No last block before block %"PRIu32"\n", state->limit);
+          finish(state, COAP_REQUEST_STATUS_BLOCK_ERROR, response);
+        }
+        return;
+      }
+      finish(state, COAP_REQUEST_STATUS_RESPONSE, response);
+      return;
+    }
+
+    if(!coap_get_header_block2(response, &num, &more, &size, &offset)) {
+      if(slot->num != 0) {
+        /* only the response to block 0 may carry the whole representation */
+        LOG_WARN("Block %"PRIu32" has no Block2 option\n", slot->num);
+        finish(state, COAP_REQUEST_STATUS_BLOCK_ERROR, response);
+        return;
+      }
+      more = 0;
+      size = state->block_size;
+      offset = 0;
+    }
+
+    if(size > slot->size) {
+      /* the server may reduce the block size, never increase it */
+      LOG_WARN("Block %"PRIu32" is larger than requested\n", num);
+      finish(state, COAP_REQUEST_STATUS_BLOCK_ERROR, response);
+      return;
+    }
+    if(size < state->block_size) {
+      reduce_block_size(state, size);
+    }
+    if(size == state->block_size) {
+      if(!store_block(state, offset, response->payload,
+                      response->payload_len)) {
+        LOG_WARN("Block %"PRIu32" does not fit\n", num);
+        finish(state, COAP_REQUEST_STATUS_BLOCK_ERROR, response);
+        return;
+      }
+      if(!more) {
+        state->last = num;
+      } else if(state->last == UNKNOWN_BLOCK &&
+                coap_get_header_size2(response, &size2) && size2 > 0) {
+        state->last = (size2 - 1) / state->block_size;
+      }
+      mark_done(state, num);
+    }
+  } else {
+    if(coap_get_header_block1(response, &num, NULL, &size, NULL)) {
+      if(size < state->block_size &&
+         (response->code < BAD_REQUEST_4_00 ||
+          response->code == REQUEST_ENTITY_TOO_LARGE_4_13)) {
+        reduce_block_size(state, size);
+        send_requests(state);
+        return;
+      }
+    } else {
+      size = state->block_size;
+    }
+
+    if(response->code >= BAD_REQUEST_4_00) {
+      finish(state, COAP_REQUEST_STATUS_RESPONSE, response);
+      return;
+    }
+    if(size == state->block_size) {
+      mark_done(state, num);
+    }
+  }
+
+  if(state->last != UNKNOWN_BLOCK && state->base > state->last) {
+    finish(state, COAP_REQUEST_STATUS_FINISHED, response);
+    return;
+  }
+
+  send_requests(state);
+}
+/*---------------------------------------------------------------------------*/
+static int
+send_block(coap_blockwise_state_t *state, struct coap_blockwise_slot *slot,
+           uint32_t num)
+{
+  coap_message_t *request = state->request;
+  coap_transaction_t *transaction;
+  const uint8_t *payload;
+  uint32_t offset;
+  uint16_t len;
+
+  request->mid = coap_get_mid();
+  transaction = coap_new_transaction(request->mid, state->remote_endpoint);
+  if(transaction == NULL) {
+    return 0;
+  }
+
+  if(state->option == COAP_OPTION_BLOCK2) {
+    coap_set_header_block2(request, num, 0, state->block_size);
+  } else {
+    offset = num * state->block_size;
+    len = MIN(state->block_size, state->length - offset);
+    payload = load_block(state, offset, len);
+    if(payload == NULL) {
+      coap_clear_transaction(transaction);
+      return 0;
+    }
+    coap_set_header_block1(request, num, num < state->last,
+                           state->block_size);
+    coap_set_payload(request, payload, len);
+  }
+
+  transaction->callback = response_handler;
+  transaction->callback_data = slot;
+  transaction->message_len = coap_serialize_message(request,
+                                                    transaction->message);
+  if(transaction->message_len == 0) {
+    coap_clear_transaction(transaction);
+    return 0;
+  }
+
+  slot->transaction = transaction;
+  slot->num = num;
+  slot->size = state->block_size;
+  state->outstanding++;
+
+  LOG_DBG("Requested block %"PRIu32" (MID %u)\n", num, request->mid);
+  coap_send_transaction(transaction);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_requests(coap_blockwise_state_t *state)
+{
+  struct coap_blockwise_slot *slot;
+  uint32_t num;
+  int i;
+
+  while(state->active && state->outstanding < state->window) {
+    num = state->next;
+    if(num - state->base >= state->window || num >= state->limit ||
+       (state->last != UNKNOWN_BLOCK && num > state->last)) {
+      break;
+    }
+    if(state->option == COAP_OPTION_BLOCK1 && num == state->last &&
+       state->base < num) {
+      /* the last block completes the request: the others go first */
+      break;
+    }
+
+    slot = NULL;
+    for(i = 0; i < COAP_BLOCKWISE_WINDOW; i++) {
+      if(state->slots[i].transaction == NULL) {
+        slot = &state->slots[i];
+        break;
+      }
+    }
+    if(slot == NULL || !send_block(state, slot, num)) {
+      if(state->outstanding == 0) {
+        /* nothing in flight to trigger the next attempt */
+        coap_timer_set(&state->retry_timer, RETRY_INTERVAL);
+      }
+      break;
+    }
+    state->next++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+retry_requests(coap_timer_t *timer)
+{
+  send_requests(coap_timer_get_user_data(timer));
+}
+/*---------------------------------------------------------------------------*/
+static int
+start(coap_blockwise_state_t *state, coap_endpoint_t *endpoint,
+      coap_message_t *request, uint8_t option,
+      void (*callback)(coap_blockwise_state_t *state))
+{
+  int i;
+
+  state->remote_endpoint = endpoint;
+  state->request = request;
+  state->response = NULL;
+  state->callback = callback;
+  state->option = option;
+  state->base = 0;
+  state->done_map = 0;
+  state->next = 0;
+  state->limit = UNKNOWN_BLOCK;
+  state->last = option == COAP_OPTION_BLOCK2 ?
+    UNKNOWN_BLOCK : last_block(state);
+  state->outstanding = 0;
+  state->response_code = 0;
+  state->active = 1;
+  for(i = 0; i < COAP_BLOCKWISE_WINDOW; i++) {
+    state->slots[i].state = state;
+    state->slots[i].transaction = NULL;
+  }
+  coap_timer_set_callback(&state->retry_timer, retry_requests);
+  coap_timer_set_user_data(&state->retry_timer, state);
+
+  send_requests(state);
+  if(state->outstanding == 0) {
+    coap_blockwise_cancel(state);
+    return 0;
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+void
+coap_blockwise_init(coap_blockwise_state_t *state, uint8_t window,
+                    uint16_t block_size)
+{
+  memset(state, 0, sizeof(coap_blockwise_state_t));
+  state->window = MAX(1, MIN(window, COAP_BLOCKWISE_WINDOW));
+  state->block_size = valid_block_size(block_size);
+#if COAP_BLOCKWISE_WITH_CFS
+  state->fd = -1;
+#endif /* COAP_BLOCKWISE_WITH_CFS */
+}
+/*---------------------------------------------------------------------------*/
+int
+coap_blockwise_get(coap_blockwise_state_t *state, coap_endpoint_t *endpoint,
+                   coap_message_t *request, uint8_t *buffer, size_t size,
+                   void (*callback)(coap_blockwise_state_t *state))
+{
+  state->buffer = buffer;
+  state->buffer_size = size;
+  state->length = 0;
+#if COAP_BLOCKWISE_WITH_CFS
+  state->fd = -1;
+#endif /* COAP_BLOCKWISE_WITH_CFS */
+  return start(state, endpoint, request, COAP_OPTION_BLOCK2, callback);
+}
+/*---------------------------------------------------------------------------*/
+int
+coap_blockwise_put(coap_blockwise_state_t *state, coap_endpoint_t *endpoint,
+                   coap_message_t *request, const uint8_t *data, size_t length,
+                   void (*callback)(coap_blockwise_state_t *state))
+{
+  /* only read from when sending */
+  state->buffer = (uint8_t *)data;
+  state->buffer_size = length;
+  state->length = length;
+#if COAP_BLOCKWISE_WITH_CFS
+  state->fd = -1;
+#endif /* COAP_BLOCKWISE_WITH_CFS */
+  return start(state, endpoint, request, COAP_OPTION_BLOCK1, callback);
+}
+/*---------------------------------------------------------------------------*/
+#if COAP_BLOCKWISE_WITH_CFS
+int
+coap_blockwise_get_file(coap_blockwise_state_t *state,
+                        coap_endpoint_t *endpoint, coap_message_t *request,
+                        int fd,
+                        void (*callback)(coap_blockwise_state_t *state))
+{
+  state->buffer = NULL;
+  state->buffer_size = 0;
+  state->length = 0;
+  state->fd = fd;
+  return start(state, endpoint, request, COAP_OPTION_BLOCK2, callback);
+}
+/*---------------------------------------------------------------------------*/
+int
+coap_blockwise_put_file(coap_blockwise_state_t *state,
+                        coap_endpoint_t *endpoint, coap_message_t *request,
+                        int fd, size_t length,
+                        void (*callback)(coap_blockwise_state_t *state))
+{
+  state->buffer = NULL;
+  state->buffer_size = 0;
+  state->length = length;
+  state->fd = fd;
+  return start(state, endpoint, request, COAP_OPTION_BLOCK1, callback);
+}
+#endif /* COAP_BLOCKWISE_WITH_CFS */
+/*---------------------------------------------------------------------------*/
+void
+coap_blockwise_cancel(coap_blockwise_state_t *state)
+{
+  int i;
+
+  state->active = 0;
+  coap_timer_stop(&state->retry_timer);
+  for(i = 0; i < COAP_BLOCKWISE_WINDOW; i++) {
+    if(state->slots[i].transaction != NULL) {
+      coap_clear_transaction(state->slots[i].transaction);
+      state->slots[i].transaction = NULL;
+    }
+  }
+  state->outstanding = 0;
+}
+/*---------------------------------------------------------------------------*/
+/** @} */
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         Pipelined block-wise transfers: a client that keeps several
+ *         Block2 or Block1 requests outstanding instead of one per round
+ *         trip, and reassembles the blocks in a buffer or a CFS file.
+ */
+
+/**
+ * \addtogroup coap
+ * @{
+ */
+
+#ifndef COAP_BLOCKWISE_H_
+#define COAP_BLOCKWISE_H_
+
+#include "coap-engine.h"
+#include "coap-transactions.h"
+#include "coap-request-state.h"
+#include "coap-timer.h"
+
+typedef struct coap_blockwise_state coap_blockwise_state_t;
+
+struct coap_blockwise_slot {
+  coap_blockwise_state_t *state;
+  coap_transaction_t *transaction;
+  uint32_t num;
+  /* block size the block was requested in */
+  uint16_t size;
+};
+
+struct coap_blockwise_state {
+  coap_endpoint_t *remote_endpoint;
+  coap_message_t *request;
+  /* valid in the callback of a finished transfer */
+  coap_message_t *response;
+  void (*callback)(coap_blockwise_state_t *state);
+  uint8_t *buffer;
+  size_t buffer_size;
+  /* bytes received, or to send */
+  size_t length;
+#if COAP_BLOCKWISE_WITH_CFS
+  int fd;
+#endif /* COAP_BLOCKWISE_WITH_CFS */
+  coap_timer_t retry_timer;
+  /* blocks before base are done, done_map has the ones after it */
+  uint32_t base;
+  uint32_t done_map;
+  uint32_t next;
+  uint32_t last;
+  /* first block past the end of a Block2 representation */
+  uint32_t limit;
+  uint16_t block_size;
+  uint8_t window;
+  uint8_t outstanding;
+  uint8_t option;
+  uint8_t active;
+  uint8_t response_code;
+  coap_request_status_t status;
+  void *user_data;
+  struct coap_blockwise_slot slots[COAP_BLOCKWISE_WINDOW];
+};
+
+/**
+ * \brief      Prepares a transfer.
+ * \param state The transfer state.
+ * \param window Number of outstanding blocks, at most COAP_BLOCKWISE_WINDOW.
+ * \param block_size Block size in bytes, rounded down to a power of two
+ *             between 16 and COAP_MAX_BLOCK_SIZE. The server may reduce it.
+ */
+void coap_blockwise_init(coap_blockwise_state_t *state, uint8_t window,
+                         uint16_t block_size);
+
+/**
+ * \brief      Fetches a resource with Block2, into a buffer.
+ * \param state The transfer state, prepared by coap_blockwise_init().
+ * \param endpoint The server.
+ * \param request The request, without a Block2 option. It is reused to
+ *             serialize every block request and must stay valid.
+ * \param buffer Where the representation is reassembled.
+ * \param size The size of the buffer.
+ * \param callback Called once, when the transfer finished or failed.
+ * \return     1 if the transfer started, 0 otherwise.
+ */
+int coap_blockwise_get(coap_blockwise_state_t *state,
+                       coap_endpoint_t *endpoint, coap_message_t *request,
+                       uint8_t *buffer, size_t size,
+                       void (*callback)(coap_blockwise_state_t *state));
+
+/**
+ * \brief      Sends a buffer with Block1, in a PUT or POST request. The
+ *             last block is sent once all others are acknowledged.
+ * \param state The transfer state, prepared by coap_blockwise_init().
+ * \param endpoint The server.
+ * \param request The request, without payload or Block1 option.
+ * \param data The payload.
+ * \param length The length of the payload.
+ * \param callback Called once, when the transfer finished or failed.
+ * \return     1 if the transfer started, 0 otherwise.
+ */
+int coap_blockwise_put(coap_blockwise_state_t *state,
+                       coap_endpoint_t *endpoint, coap_message_t *request,
+                       const uint8_t *data, size_t length,
+                       void (*callback)(coap_blockwise_state_t *state));
+
+#if COAP_BLOCKWISE_WITH_CFS
+/**
+ * \brief      Fetches a resource with Block2, into a CFS file opened for
+ *             writing, at the offsets of the blocks.
+ */
+int coap_blockwise_get_file(coap_blockwise_state_t *state,
+                            coap_endpoint_t *endpoint,
+                            coap_message_t *request, int fd,
+                            void (*callback)(coap_blockwise_state_t *state));
+
+/**
+ * \brief      Sends the first length bytes of a CFS file opened for
+ *             reading with Block1.
+ */
+int coap_blockwise_put_file(coap_blockwise_state_t *state,
+                            coap_endpoint_t *endpoint,
+                            coap_message_t *request, int fd, size_t length,
+                            void (*callback)(coap_blockwise_state_t *state));
+#endif /* COAP_BLOCKWISE_WITH_CFS */
+
+/**
+ * \brief      Stops a transfer without calling its callback.
+ */
+void coap_blockwise_cancel(coap_blockwise_state_t *state);
+
+#endif /* COAP_BLOCKWISE_H_ */
+/** @} */
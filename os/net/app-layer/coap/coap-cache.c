@@ -0,0 +1,445 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         Server-side CoAP response cache
+ */
+
+/**
+ * \addtogroup coap
+ * @{
+ */
+
+#include "coap-cache.h"
+#include "sys/cc.h"
+#include <string.h>
+
+/* Log configuration */
+#include "coap-log.h"
+#define LOG_MODULE "coap"
+#define LOG_LEVEL  LOG_LEVEL_COAP
+
+#if COAP_WITH_RESPONSE_CACHE
+
+/* EXCHANGE_LIFETIME of RFC 7252, with the default transmission parameters */
+#define EXCHANGE_LIFETIME 247000 /* msec */
+
+#define NO_ACCEPT 0xFFFF
+
+typedef struct {
+  const coap_resource_t *resource;
+  uint32_t expires;       /* uptime in msec */
+  uint32_t block_num;
+  uint16_t block_size;    /* 0 without Block2 */
+  uint16_t accept;
+  uint16_t data_len;
+  uint16_t max_age_pos;   /* offset of the Max-Age option header in data */
+  uint8_t max_age_hdr;    /* length of the Max-Age option header */
+  uint8_t max_age_len;    /* length of the Max-Age option value */
+  uint8_t path_len;       /* the key is the path, then the query */
+  uint8_t key_len;
+  uint8_t etag_len;
+  uint8_t valid;
+  uint8_t etag[COAP_ETAG_LEN];
+  char key[COAP_RESPONSE_CACHE_KEY_LEN];
+  uint8_t data[COAP_RESPONSE_CACHE_SIZE]; /* options and payload */
+} cache_entry_t;
+
+typedef struct {
+  coap_endpoint_t endpoint;
+  uint32_t time;
+  uint16_t mid;
+  uint16_t message_len;   /* 0 if unused */
+  uint8_t message[COAP_MAX_PACKET_SIZE];
+} exchange_t;
+
+static cache_entry_t entries[COAP_RESPONSE_CACHE_ENTRIES];
+static exchange_t exchanges[COAP_RESPONSE_CACHE_EXCHANGES];
+static uint8_t next_exchange;
+static coap_cache_stats_t stats;
+
+/*
+ * Identifies a representation: URI path and query, Accept and Block2. Other
+ * request options must not change the response of a cacheable resource.
+ */
+typedef struct {
+  uint32_t block_num;
+  uint16_t block_size;
+  uint16_t accept;
+  int path_len;
+  int key_len;
+  char key[COAP_RESPONSE_CACHE_KEY_LEN];
+} cache_key_t;
+
+/*---------------------------------------------------------------------------*/
+static uint32_t
+now(void)
+{
+  return (uint32_t)coap_timer_uptime();
+}
+/*---------------------------------------------------------------------------*/
+static int
+make_key(coap_message_t *request, cache_key_t *key)
+{
+  const char *path = NULL;
+  const char *query = NULL;
+  int path_len;
+  int query_len;
+  unsigned int accept;
+
+  path_len = coap_get_header_uri_path(request, &path);
+  query_len = coap_get_header_uri_query(request, &query);
+  if(path_len + query_len > COAP_RESPONSE_CACHE_KEY_LEN) {
+    return 0;
+  }
+  /* No separator, as any character may occur in the path: the path length
+     tells where the query starts */
+  memcpy(key->key, path, path_len);
+  memcpy(key->key + path_len, query, query_len);
+  key->path_len = path_len;
+  key->key_len = path_len + query_len;
+
+  key->accept = coap_get_header_accept(request, &accept) ? accept : NO_ACCEPT;
+  if(!coap_get_header_block2(request, &key->block_num, NULL,
+                             &key->block_size, NULL)) {
+    key->block_num = 0;
+    key->block_size = 0;
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static cache_entry_t *
+find_entry(const cache_key_t *key, uint32_t time)
+{
+  cache_entry_t *entry;
+
+  for(entry = entries; entry < entries + COAP_RESPONSE_CACHE_ENTRIES;
+      entry++) {
+    if(!entry->valid) {
+      continue;
+    }
+    if((int32_t)(entry->expires - time) <= 0) {
+      entry->valid = 0;
+      continue;
+    }
+    if(entry->key_len == key->key_len
+       && entry->path_len == key->path_len
+       && entry->block_num == key->block_num
+       && entry->block_size == key->block_size
+       && entry->accept == key->accept
+       && memcmp(entry->key, key->key, key->key_len) == 0) {
+      return entry;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+/* Writes an unsigned integer option value, returns its length */
+static uint8_t
+write_uint(uint8_t *buffer, uint32_t value)
+{
+  uint8_t len = 0;
+  uint8_t i;
+
+  while(len < 4 && (value >> (8 * len)) != 0) {
+    len++;
+  }
+  for(i = 0; i < len; i++) {
+    buffer[i] = (uint8_t)(value >> (8 * (len - 1 - i)));
+  }
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Serializes a cached response for a request. The Max-Age option is
+ * rewritten with the remaining freshness; its delta stays the same, and its
+ * length always fits in the first header byte.
+ */
+static uint16_t
+write_response(uint8_t *buffer, coap_message_t *request,
+               const cache_entry_t *entry, uint32_t time)
+{
+  uint32_t max_age = (entry->expires - time + 999) / 1000;
+  uint8_t *p = buffer;
+  uint8_t validated;
+  uint16_t pos;
+  uint16_t mid;
+
+  validated = coap_is_option(request, COAP_OPTION_ETAG)
+    && request->etag_len == entry->etag_len
+    && memcmp(request->etag, entry->etag, entry->etag_len) == 0;
+
+  mid = request->type == COAP_TYPE_CON ? request->mid : coap_get_mid();
+  *p = COAP_HEADER_VERSION_MASK & 1 << COAP_HEADER_VERSION_POSITION;
+  *p |= COAP_HEADER_TYPE_MASK
+    & (request->type == COAP_TYPE_CON ? COAP_TYPE_ACK : COAP_TYPE_NON)
+    << COAP_HEADER_TYPE_POSITION;
+  *p++ |= COAP_HEADER_TOKEN_LEN_MASK
+    & request->token_len << COAP_HEADER_TOKEN_LEN_POSITION;
+  *p++ = validated ? VALID_2_03 : CONTENT_2_05;
+  *p++ = (uint8_t)(mid >> 8);
+  *p++ = (uint8_t)mid;
+  memcpy(p, request->token, request->token_len);
+  p += request->token_len;
+
+  if(validated) {
+    /* 2.03 Valid, with the ETag and Max-Age options only */
+    *p++ = COAP_OPTION_ETAG << 4 | entry->etag_len;
+    memcpy(p, entry->etag, entry->etag_len);
+    p += entry->etag_len;
+    *p = (COAP_OPTION_MAX_AGE - COAP_OPTION_ETAG) << 4;
+    *p |= write_uint(p + 1, max_age);
+    p += 1 + (*p & COAP_HEADER_OPTION_SHORT_LENGTH_MASK);
+    stats.validations++;
+    return p - buffer;
+  }
+
+  pos = entry->max_age_pos;
+  memcpy(p, entry->data, pos);
+  p += pos;
+  memcpy(p, entry->data + pos, entry->max_age_hdr);
+  *p &= COAP_HEADER_OPTION_DELTA_MASK;
+  *p |= write_uint(p + entry->max_age_hdr, max_age);
+  p += entry->max_age_hdr + (*p & COAP_HEADER_OPTION_SHORT_LENGTH_MASK);
+  pos += entry->max_age_hdr + entry->max_age_len;
+  memcpy(p, entry->data + pos, entry->data_len - pos);
+  p += entry->data_len - pos;
+  stats.hits++;
+  return p - buffer;
+}
+/*---------------------------------------------------------------------------*/
+int
+coap_cache_respond(coap_message_t *request, const coap_endpoint_t *src)
+{
+  static uint8_t buffer[COAP_HEADER_LEN + COAP_TOKEN_LEN +
+                        COAP_RESPONSE_CACHE_SIZE];
+  exchange_t *exchange;
+  cache_entry_t *entry;
+  cache_key_t key;
+  uint32_t time = now();
+
+  if(request->type == COAP_TYPE_CON) {
+    for(exchange = exchanges;
+        exchange < exchanges + COAP_RESPONSE_CACHE_EXCHANGES; exchange++) {
+      if(exchange->message_len > 0 && exchange->mid == request->mid
+         && time - exchange->time < EXCHANGE_LIFETIME
+         && coap_endpoint_cmp(&exchange->endpoint, src)) {
+        LOG_DBG("Duplicate of MID %u, sending the same response\n",
+                request->mid);
+        stats.duplicates++;
+        coap_sendto(src, exchange->message, exchange->message_len);
+        return 1;
+      }
+    }
+  }
+
+  if(request->code != COAP_GET || coap_is_option(request, COAP_OPTION_OBSERVE)) {
+    return 0;
+  }
+
+  entry = make_key(request, &key) ? find_entry(&key, time) : NULL;
+  if(entry == NULL) {
+    stats.misses++;
+    return 0;
+  }
+
+  LOG_DBG("Cached response for /");
+  LOG_DBG_COAP_STRING(key.key, key.path_len);
+  LOG_DBG_("\n");
+  coap_sendto(src, buffer, write_response(buffer, request, entry, time));
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+store_exchange(coap_message_t *request, const coap_transaction_t *t,
+               uint32_t time)
+{
+  exchange_t *exchange;
+
+  if(COAP_RESPONSE_CACHE_EXCHANGES == 0
+     || t->message_len > sizeof(exchange->message)) {
+    return;
+  }
+  exchange = &exchanges[next_exchange];
+  next_exchange = (next_exchange + 1) % COAP_RESPONSE_CACHE_EXCHANGES;
+  coap_endpoint_copy(&exchange->endpoint, &t->endpoint);
+  exchange->time = time;
+  exchange->mid = request->mid;
+  exchange->message_len = t->message_len;
+  memcpy(exchange->message, t->message, t->message_len);
+}
+/*---------------------------------------------------------------------------*/
+static void
+store_response(coap_message_t *request, const coap_message_view_t *view,
+               uint16_t message_len, uint32_t time)
+{
+  coap_option_iterator_t iterator;
+  cache_entry_t *entry;
+  cache_entry_t *e;
+  cache_key_t key;
+  const uint8_t *max_age = NULL;
+  const uint8_t *header;
+  uint8_t max_age_hdr = 0;
+  uint8_t max_age_len = 0;
+  const uint8_t *etag = NULL;
+  uint8_t etag_len = 0;
+  uint32_t max_age_value = 0;
+  uint16_t data_len;
+
+  coap_option_iterator_init(&iterator, view);
+  for(header = iterator.next; coap_option_iterator_next(&iterator);
+      header = iterator.next) {
+    if(iterator.number == COAP_OPTION_OBSERVE) {
+      return;
+    } else if(iterator.number == COAP_OPTION_ETAG && etag == NULL) {
+      etag = iterator.value;
+      etag_len = MIN(iterator.length, COAP_ETAG_LEN);
+    } else if(iterator.number == COAP_OPTION_MAX_AGE && max_age == NULL) {
+      max_age = header;
+      max_age_hdr = iterator.value - header;
+      max_age_len = iterator.length;
+      max_age_value = coap_option_get_int(&iterator);
+    }
+  }
+
+  /* only responses the handler gave a freshness lifetime are kept */
+  if(max_age == NULL || max_age_value == 0 || max_age_len > 4) {
+    return;
+  }
+  data_len = message_len - (view->options - view->buffer);
+  if(data_len > COAP_RESPONSE_CACHE_SIZE || !make_key(request, &key)) {
+    return;
+  }
+
+  /* replace the same representation, a stale one, or the first to expire */
+  entry = find_entry(&key, time);
+  if(entry == NULL) {
+    for(e = entries; e < entries + COAP_RESPONSE_CACHE_ENTRIES; e++) {
+      if(!e->valid) {
+        entry = e;
+        break;
+      }
+      if(entry == NULL || (int32_t)(e->expires - entry->expires) < 0) {
+        entry = e;
+      }
+    }
+    if(entry == NULL) {
+      return;
+    }
+  }
+
+  entry->resource = coap_get_resource_by_uri(key.key, key.path_len);
+  entry->expires = time + max_age_value * 1000;
+  entry->block_num = key.block_num;
+  entry->block_size = key.block_size;
+  entry->accept = key.accept;
+  entry->path_len = key.path_len;
+  entry->key_len = key.key_len;
+  memcpy(entry->key, key.key, key.key_len);
+  entry->etag_len = etag_len;
+  if(etag_len > 0) {
+    memcpy(entry->etag, etag, etag_len);
+  }
+  entry->data_len = data_len;
+  memcpy(entry->data, view->options, data_len);
+  entry->max_age_pos = max_age - view->options;
+  entry->max_age_hdr = max_age_hdr;
+  entry->max_age_len = max_age_len;
+  entry->valid = 1;
+  stats.stores++;
+  LOG_DBG("Caching /");
+  LOG_DBG_COAP_STRING(key.key, key.path_len);
+  LOG_DBG_(" for %lu s\n", (unsigned long)max_age_value);
+}
+/*---------------------------------------------------------------------------*/
+void
+coap_cache_store(coap_message_t *request, const coap_transaction_t *t)
+{
+  coap_message_view_t view;
+  coap_resource_t *resource;
+  const char *path = NULL;
+  int path_len;
+  uint8_t code;
+  uint32_t time = now();
+
+  if(coap_validate_message(&view, t->message, t->message_len) != NO_ERROR) {
+    return;
+  }
+
+  if(request->type == COAP_TYPE_CON
+     && coap_view_get_type(&view) == COAP_TYPE_ACK) {
+    store_exchange(request, t, time);
+  }
+
+  code = coap_view_get_code(&view);
+  if(request->code != COAP_GET) {
+    /* a change of the resource makes its cached responses stale */
+    if(code >> 5 == 2) {
+      path_len = coap_get_header_uri_path(request, &path);
+      resource = coap_get_resource_by_uri(path, path_len);
+      if(resource != NULL) {
+        coap_cache_invalidate(resource);
+      }
+    }
+  } else if(code == CONTENT_2_05
+            && !coap_is_option(request, COAP_OPTION_OBSERVE)) {
+    store_response(request, &view, t->message_len, time);
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+coap_cache_invalidate(const coap_resource_t *resource)
+{
+  cache_entry_t *entry;
+
+  for(entry = entries; entry < entries + COAP_RESPONSE_CACHE_ENTRIES;
+      entry++) {
+    if(entry->valid && (resource == NULL || entry->resource == resource)) {
+      entry->valid = 0;
+      stats.invalidations++;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+const coap_cache_stats_t *
+coap_cache_get_stats(void)
+{
+  return &stats;
+}
+/*---------------------------------------------------------------------------*/
+void
+coap_cache_reset_stats(void)
+{
+  memset(&stats, 0, sizeof(stats));
+}
+/*---------------------------------------------------------------------------*/
+#endif /* COAP_WITH_RESPONSE_CACHE */
+/** @} */
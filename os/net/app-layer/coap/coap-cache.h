@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         Server-side CoAP response cache. Responses to GET requests that
+ *         carry a Max-Age option are kept, serialized, and answer later
+ *         requests for the same path, query, Accept and Block2 options
+ *         without calling the resource handler. Requests with a matching
+ *         ETag are answered with 2.03 Valid. Piggybacked responses to
+ *         confirmable requests are also kept, to answer duplicates.
+ */
+
+/**
+ * \addtogroup coap
+ * @{
+ */
+
+#ifndef COAP_CACHE_H_
+#define COAP_CACHE_H_
+
+#include "coap-engine.h"
+
+typedef struct coap_cache_stats {
+  uint32_t hits;          /* answered from the cache */
+  uint32_t validations;   /* answered with 2.03 Valid */
+  uint32_t misses;        /* GET requests passed to the handler */
+  uint32_t stores;        /* responses added to the cache */
+  uint32_t invalidations; /* cached responses dropped before expiring */
+  uint32_t duplicates;    /* duplicate confirmable requests */
+} coap_cache_stats_t;
+
+/**
+ * \brief      Answers a request from the cache or the recent exchanges.
+ * \param request The parsed request.
+ * \param src  The endpoint the request came from.
+ * \return     1 if a response was sent, 0 if the request must be handled.
+ */
+int coap_cache_respond(coap_message_t *request, const coap_endpoint_t *src);
+
+/**
+ * \brief      Records a response before it is sent. Cacheable GET
+ *             responses are stored; successful PUT, POST and DELETE
+ *             requests invalidate the responses of their resource.
+ * \param request The parsed request.
+ * \param t    The transaction holding the serialized response.
+ */
+void coap_cache_store(coap_message_t *request, const coap_transaction_t *t);
+
+/**
+ * \brief      Drops the cached responses of a resource, for instance when
+ *             its representation changed.
+ * \param resource The resource, or NULL for all cached responses.
+ */
+void coap_cache_invalidate(const coap_resource_t *resource);
+
+/**
+ * \brief      Returns the counters of the response cache.
+ */
+const coap_cache_stats_t *coap_cache_get_stats(void);
+
+/**
+ * \brief      Resets the counters of the response cache.
+ */
+void coap_cache_reset_stats(void);
+
+#endif /* COAP_CACHE_H_ */
+/** @} */
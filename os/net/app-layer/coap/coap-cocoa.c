@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         CoCoA congestion control for CoAP.
+ *
+ *         Every endpoint gets a strong RTO estimate, from exchanges
+ *         answered without retransmission, and a weak one, from exchanges
+ *         answered after one or two retransmissions and timed from the
+ *         first transmission. Both are computed as in RFC 6298, with K = 4
+ *         for the strong and K = 1 for the weak estimator, and blended into
+ *         the overall RTO used for new exchanges. The backoff factor
+ *         depends on the RTO, and estimates that have not been updated for
+ *         a while age towards the default RTO.
+ */
+
+/**
+ * \addtogroup coap
+ * @{
+ */
+
+#include "coap-cocoa.h"
+#include "coap-timer.h"
+#include <stdlib.h>
+
+/* Log configuration */
+#include "coap-log.h"
+#define LOG_MODULE "coap"
+#define LOG_LEVEL  LOG_LEVEL_COAP
+
+#if COAP_WITH_CONGESTION_CONTROL
+
+#define DEFAULT_RTO        COAP_RESPONSE_TIMEOUT_TICKS
+#define MAX_RTO            60000
+#define STRONG_K           4
+#define WEAK_K             1
+
+typedef struct {
+  coap_endpoint_t endpoint;
+  uint32_t last_used;                   /* uses counter, for LRU */
+  uint32_t last_update;
+  uint32_t rto;
+  uint32_t srtt_strong;
+  uint32_t rttvar_strong;
+  uint32_t srtt_weak;
+  uint32_t rttvar_weak;
+  uint8_t in_use;
+} cocoa_endpoint_t;
+
+static cocoa_endpoint_t endpoints[COAP_CC_ENDPOINTS];
+static uint32_t uses;
+/*---------------------------------------------------------------------------*/
+static uint32_t
+now(void)
+{
+  return (uint32_t)coap_timer_uptime();
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the state of an endpoint, taking over the least recently used
+ * entry for a new one */
+static cocoa_endpoint_t *
+lookup(const coap_endpoint_t *ep)
+{
+  cocoa_endpoint_t *e;
+  cocoa_endpoint_t *oldest = NULL;
+
+  for(e = endpoints; e < endpoints + COAP_CC_ENDPOINTS; e++) {
+    if(e->in_use && coap_endpoint_cmp(&e->endpoint, ep)) {
+      e->last_used = ++uses;
+      return e;
+    }
+    if(oldest == NULL || !e->in_use
+       || (oldest->in_use && (int32_t)(e->last_used - oldest->last_used) < 0)) {
+      oldest = e;
+    }
+  }
+
+  e = oldest;
+  coap_endpoint_copy(&e->endpoint, ep);
+  e->in_use = 1;
+  e->last_used = ++uses;
+  e->last_update = now();
+  e->rto = DEFAULT_RTO;
+  e->srtt_strong = e->rttvar_strong = 0;
+  e->srtt_weak = e->rttvar_weak = 0;
+  return e;
+}
+/*---------------------------------------------------------------------------*/
+/* Lets an estimate that has not been updated for a while age towards the
+ * default RTO */
+static void
+age(cocoa_endpoint_t *e)
+{
+  uint32_t elapsed = now() - e->last_update;
+
+  if(e->rto < 1000 && elapsed > 16 * e->rto) {
+    e->rto *= 2;
+    e->last_update = now();
+  } else if(e->rto > 3000 && elapsed > 4 * e->rto) {
+    e->rto = (DEFAULT_RTO + e->rto) / 2;
+    e->last_update = now();
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Feeds a sample to an estimator, and returns its RTO */
+static uint32_t
+estimate(uint32_t *srtt, uint32_t *rttvar, uint32_t rtt, uint8_t k)
+{
+  if(*srtt == 0) {
+    *srtt = rtt;
+    *rttvar = rtt / 2;
+  } else {
+    *rttvar = (3 * *rttvar + (*srtt > rtt ? *srtt - rtt : rtt - *srtt)) / 4;
+    *srtt = (7 * *srtt + rtt) / 8;
+  }
+  return *srtt + k * *rttvar;
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+coap_cocoa_initial_timeout(const coap_endpoint_t *ep, uint8_t *backoff)
+{
+  cocoa_endpoint_t *e = lookup(ep);
+
+  age(e);
+
+  /* Variable backoff factor: faster for short, slower for long RTOs */
+  if(e->rto < 1000) {
+    *backoff = 6;
+  } else if(e->rto > 3000) {
+    *backoff = 3;
+  } else {
+    *backoff = 4;
+  }
+
+  return e->rto + (rand() % (e->rto / 2 + 1));
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+coap_cocoa_get_rto(const coap_endpoint_t *ep)
+{
+  cocoa_endpoint_t *e;
+
+  for(e = endpoints; e < endpoints + COAP_CC_ENDPOINTS; e++) {
+    if(e->in_use && coap_endpoint_cmp(&e->endpoint, ep)) {
+      return e->rto;
+    }
+  }
+  return DEFAULT_RTO;
+}
+/*---------------------------------------------------------------------------*/
+void
+coap_cocoa_response(const coap_transaction_t *t)
+{
+  cocoa_endpoint_t *e;
+  uint32_t rtt;
+  uint32_t rto;
+
+  if(!t->in_flight || t->retrans_counter > 2) {
+    /* Too ambiguous to tell which transmission was answered */
+    return;
+  }
+
+  e = lookup(&t->endpoint);
+  rtt = now() - t->first_sent;
+  if(rtt == 0) {
+    rtt = 1;
+  }
+
+  if(t->retrans_counter == 0) {
+    rto = estimate(&e->srtt_strong, &e->rttvar_strong, rtt, STRONG_K);
+    e->rto = (rto + e->rto) / 2;
+  } else {
+    rto = estimate(&e->srtt_weak, &e->rttvar_weak, rtt, WEAK_K);
+    e->rto = (rto + 3 * e->rto) / 4;
+  }
+  if(e->rto > MAX_RTO) {
+    e->rto = MAX_RTO;
+  }
+  e->last_update = now();
+
+  LOG_DBG("RTT %lu msec (%u retransmissions), RTO %lu msec for ",
+          (unsigned long)rtt, t->retrans_counter, (unsigned long)e->rto);
+  LOG_DBG_COAP_EP(&t->endpoint);
+  LOG_DBG_("\n");
+}
+/*---------------------------------------------------------------------------*/
+#endif /* COAP_WITH_CONGESTION_CONTROL */
+/** @} */
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         CoCoA congestion control for CoAP, after
+ *         draft-ietf-core-cocoa: retransmission timeouts estimated per
+ *         endpoint from the round-trip times of confirmable exchanges.
+ */
+
+/**
+ * \addtogroup coap
+ * @{
+ */
+
+#ifndef COAP_COCOA_H_
+#define COAP_COCOA_H_
+
+#include "coap-endpoint.h"
+#include "coap-transactions.h"
+
+/**
+ * \brief      Returns the timeout for the first transmission of a
+ *             confirmable message to an endpoint.
+ * \param ep   The destination endpoint.
+ * \param backoff Set to the factor, in halves, by which the timeout grows
+ *             on every retransmission.
+ * \return     The timeout in msec, dithered between RTO and 1.5 RTO.
+ */
+uint32_t coap_cocoa_initial_timeout(const coap_endpoint_t *ep,
+                                    uint8_t *backoff);
+
+/**
+ * \brief      Returns the current RTO estimate for an endpoint.
+ * \param ep   The endpoint.
+ * \return     The RTO in msec, the default one for unknown endpoints.
+ */
+uint32_t coap_cocoa_get_rto(const coap_endpoint_t *ep);
+
+/**
+ * \brief      Updates the RTO of the endpoint of a transaction that was
+ *             answered, with the time since its first transmission.
+ * \param t    The transaction, before it is cleared.
+ */
+void coap_cocoa_response(const coap_transaction_t *t);
+
+#endif /* COAP_COCOA_H_ */
+/** @} */
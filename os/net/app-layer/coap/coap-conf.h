@@ -105,6 +105,106 @@
 #define COAP_OBSERVE_REFRESH_INTERVAL  20
 #endif /* COAP_OBSERVE_REFRESH_INTERVAL */
 
+/*
+ * A notification is generated and serialized once for all the observers of
+ * a resource, then patched for each of them. This takes a buffer of
+ * COAP_MAX_PACKET_SIZE bytes for the serialized notification.
+ */
+#ifdef COAP_CONF_OBSERVE_WITH_SHARED_NOTIFICATION
+#define COAP_OBSERVE_WITH_SHARED_NOTIFICATION COAP_CONF_OBSERVE_WITH_SHARED_NOTIFICATION
+#else
+#define COAP_OBSERVE_WITH_SHARED_NOTIFICATION 0
+#endif
+
+/*
+ * Number of path segment nodes in the resource dispatch trie. Every distinct
+ * URI path prefix of an activated resource takes a node. When 0, or when the
+ * resources do not fit, requests are matched against every resource in turn.
+ */
+#ifdef COAP_CONF_URI_TRIE_NODES
+#define COAP_URI_TRIE_NODES COAP_CONF_URI_TRIE_NODES
+#else
+#define COAP_URI_TRIE_NODES 0
+#endif
+
+/*
+ * CoCoA congestion control: retransmission timeouts estimated per endpoint
+ * from measured round-trip times, instead of the fixed COAP_RESPONSE_TIMEOUT,
+ * and at most COAP_NSTART outstanding confirmable messages per endpoint.
+ */
+#ifdef COAP_CONF_WITH_CONGESTION_CONTROL
+#define COAP_WITH_CONGESTION_CONTROL COAP_CONF_WITH_CONGESTION_CONTROL
+#else
+#define COAP_WITH_CONGESTION_CONTROL 0
+#endif
+
+/* Number of endpoints whose RTO estimates are kept */
+#ifdef COAP_CONF_CC_ENDPOINTS
+#define COAP_CC_ENDPOINTS COAP_CONF_CC_ENDPOINTS
+#else
+#define COAP_CC_ENDPOINTS 4
+#endif
+
+/* Outstanding confirmable messages per endpoint, further ones are queued */
+#ifdef COAP_CONF_NSTART
+#define COAP_NSTART COAP_CONF_NSTART
+#else
+#define COAP_NSTART 1
+#endif
+
+/* Maximum number of outstanding blocks of a pipelined block-wise transfer */
+#ifdef COAP_CONF_BLOCKWISE_WINDOW
+#define COAP_BLOCKWISE_WINDOW COAP_CONF_BLOCKWISE_WINDOW
+#else
+#define COAP_BLOCKWISE_WINDOW 4
+#endif
+
+/* Pipelined block-wise transfers can read from and write to CFS files */
+#ifdef COAP_CONF_BLOCKWISE_WITH_CFS
+#define COAP_BLOCKWISE_WITH_CFS COAP_CONF_BLOCKWISE_WITH_CFS
+#else
+#define COAP_BLOCKWISE_WITH_CFS 0
+#endif
+
+/*
+ * Server-side response cache: GET responses with a Max-Age option are
+ * answered from the cache until they expire or their resource is
+ * invalidated, and duplicate confirmable requests get the same ACK again.
+ */
+#ifdef COAP_CONF_WITH_RESPONSE_CACHE
+#define COAP_WITH_RESPONSE_CACHE COAP_CONF_WITH_RESPONSE_CACHE
+#else
+#define COAP_WITH_RESPONSE_CACHE 0
+#endif
+
+/* Number of cached GET responses */
+#ifdef COAP_CONF_RESPONSE_CACHE_ENTRIES
+#define COAP_RESPONSE_CACHE_ENTRIES COAP_CONF_RESPONSE_CACHE_ENTRIES
+#else
+#define COAP_RESPONSE_CACHE_ENTRIES 4
+#endif
+
+/* Bytes of options and payload of a cached response */
+#ifdef COAP_CONF_RESPONSE_CACHE_SIZE
+#define COAP_RESPONSE_CACHE_SIZE COAP_CONF_RESPONSE_CACHE_SIZE
+#else
+#define COAP_RESPONSE_CACHE_SIZE (COAP_MAX_CHUNK_SIZE + 24)
+#endif
+
+/* Longest URI path and query of a cached response */
+#ifdef COAP_CONF_RESPONSE_CACHE_KEY_LEN
+#define COAP_RESPONSE_CACHE_KEY_LEN COAP_CONF_RESPONSE_CACHE_KEY_LEN
+#else
+#define COAP_RESPONSE_CACHE_KEY_LEN 32
+#endif
+
+/* Number of confirmable exchanges remembered to answer duplicates */
+#ifdef COAP_CONF_RESPONSE_CACHE_EXCHANGES
+#define COAP_RESPONSE_CACHE_EXCHANGES COAP_CONF_RESPONSE_CACHE_EXCHANGES
+#else
+#define COAP_RESPONSE_CACHE_EXCHANGES 4
+#endif
+
 /* Maximal length of observable URL */
 #ifdef COAP_CONF_OBSERVER_URL_LEN
 #define COAP_OBSERVER_URL_LEN COAP_CONF_OBSERVER_URL_LEN
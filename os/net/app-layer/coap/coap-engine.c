@@ -42,6 +42,8 @@
  */
 
 #include "coap-engine.h"
+#include "coap-cocoa.h"
+#include "coap-cache.h"
 #include "sys/cc.h"
 #include "lib/list.h"
 #include <stdio.h>
@@ -72,6 +74,36 @@ LIST(coap_handlers);
 LIST(coap_resource_services);
 static uint8_t is_initialized = 0;
 
+#if COAP_URI_TRIE_NODES
+/*
+ * The resources are indexed by a trie of URI path segments, so that a
+ * request is dispatched in one pass over its path. The trie is rebuilt from
+ * the resource list on the first lookup after a resource is activated, and
+ * each node remembers the list position of its resource: when both a parent
+ * resource and a more specific one match, the one activated first wins, as
+ * with the linear lookup.
+ */
+typedef struct uri_trie_node {
+  struct uri_trie_node *child;
+  struct uri_trie_node *sibling;
+  coap_resource_t *resource;
+  const char *segment;
+  uint16_t segment_len;
+  uint16_t order;
+} uri_trie_node_t;
+
+typedef enum {
+  URI_TRIE_STALE,
+  URI_TRIE_VALID,
+  URI_TRIE_UNUSABLE
+} uri_trie_state_t;
+
+static uri_trie_node_t uri_trie_nodes[COAP_URI_TRIE_NODES];
+static uri_trie_node_t uri_trie_root;
+static uint16_t uri_trie_used;
+static uri_trie_state_t uri_trie_state = URI_TRIE_STALE;
+#endif /* COAP_URI_TRIE_NODES */
+
 /*---------------------------------------------------------------------------*/
 /*- CoAP service handlers---------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
@@ -169,6 +201,11 @@ coap_receive(const coap_endpoint_t *src,
     /* handle requests */
     if(message->code >= COAP_GET && message->code <= COAP_DELETE) {
 
+#if COAP_WITH_RESPONSE_CACHE
+      if(coap_cache_respond(message, src)) {
+        /* answered without calling the handler */
+      } else
+#endif /* COAP_WITH_RESPONSE_CACHE */
       /* use transaction buffer for response to confirmable request */
       if((transaction = coap_new_transaction(message->mid, src))) {
         uint32_t block_num = 0;
@@ -308,6 +345,9 @@ coap_receive(const coap_endpoint_t *src,
       }
 
       if((transaction = coap_get_transaction_by_mid(message->mid))) {
+#if COAP_WITH_CONGESTION_CONTROL
+        coap_cocoa_response(transaction);
+#endif /* COAP_WITH_CONGESTION_CONTROL */
         /* free transaction memory before callback, as it may create a new transaction */
         coap_resource_response_handler_t callback = transaction->callback;
         void *callback_data = transaction->callback_data;
@@ -336,6 +376,9 @@ coap_receive(const coap_endpoint_t *src,
     /* if(parsed correctly) */
   if(coap_status_code == NO_ERROR) {
     if(transaction) {
+#if COAP_WITH_RESPONSE_CACHE
+      coap_cache_store(message, transaction);
+#endif /* COAP_WITH_RESPONSE_CACHE */
       coap_send_transaction(transaction);
     }
   } else if(coap_status_code == MANUAL_RESPONSE) {
@@ -401,6 +444,12 @@ coap_activate_resource(coap_resource_t *resource, const char *path)
   coap_periodic_resource_t *periodic;
   resource->url = path;
   list_add(coap_resource_services, resource);
+#if COAP_URI_TRIE_NODES
+  uri_trie_state = URI_TRIE_STALE;
+#endif /* COAP_URI_TRIE_NODES */
+#if COAP_WITH_RESPONSE_CACHE
+  coap_cache_invalidate(&res_well_known_core);
+#endif /* COAP_WITH_RESPONSE_CACHE */
 
   LOG_INFO("Activating: %s\n", resource->url);
 
@@ -432,19 +481,141 @@ coap_get_next_resource(coap_resource_t *resource)
   return list_item_next(resource);
 }
 /*---------------------------------------------------------------------------*/
+#if COAP_URI_TRIE_NODES
+/* Returns the length of the first segment of a path */
 static int
-invoke_coap_resource_service(coap_message_t *request, coap_message_t *response,
-                             uint8_t *buffer, uint16_t buffer_size,
-                             int32_t *offset)
+uri_segment_len(const char *path, int path_len)
 {
-  uint8_t found = 0;
-  uint8_t allowed = 1;
+  int i;
+  for(i = 0; i < path_len && path[i] != '/'; i++);
+  return i;
+}
+/*---------------------------------------------------------------------------*/
+static uri_trie_node_t *
+uri_trie_child(uri_trie_node_t *node, const char *segment, int segment_len)
+{
+  uri_trie_node_t *child;
+  for(child = node->child; child != NULL; child = child->sibling) {
+    if(child->segment_len == segment_len
+       && memcmp(child->segment, segment, segment_len) == 0) {
+      return child;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static int
+uri_trie_insert(coap_resource_t *resource, uint16_t order)
+{
+  uri_trie_node_t *node = &uri_trie_root;
+  uri_trie_node_t *child;
+  const char *path = resource->url;
+  int path_len = strlen(path);
+  int segment_len;
+
+  while(1) {
+    segment_len = uri_segment_len(path, path_len);
+    child = uri_trie_child(node, path, segment_len);
+    if(child == NULL) {
+      if(uri_trie_used >= COAP_URI_TRIE_NODES) {
+        LOG_WARN("URI trie full, looking resources up linearly\n");
+        return 0;
+      }
+      child = &uri_trie_nodes[uri_trie_used++];
+      child->child = NULL;
+      child->resource = NULL;
+      child->segment = path;
+      child->segment_len = segment_len;
+      child->sibling = node->child;
+      node->child = child;
+    }
+    node = child;
+    if(segment_len == path_len) {
+      break;
+    }
+    path += segment_len + 1;
+    path_len -= segment_len + 1;
+  }
 
-  coap_resource_t *resource = NULL;
-  const char *url = NULL;
-  int url_len, res_url_len;
+  if(node->resource != NULL) {
+    /* Several resources on the same path are only told apart linearly */
+    LOG_WARN("Duplicate resource /%s, looking resources up linearly\n",
+             resource->url);
+    return 0;
+  }
+  node->resource = resource;
+  node->order = order;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+uri_trie_build(void)
+{
+  coap_resource_t *resource;
+  uint16_t order = 0;
+
+  uri_trie_root.child = NULL;
+  uri_trie_used = 0;
+  for(resource = list_head(coap_resource_services);
+      resource != NULL; resource = resource->next) {
+    if(!uri_trie_insert(resource, order++)) {
+      uri_trie_state = URI_TRIE_UNUSABLE;
+      return;
+    }
+  }
+  LOG_DBG("URI trie: %u resources, %u nodes\n", order, uri_trie_used);
+  uri_trie_state = URI_TRIE_VALID;
+}
+/*---------------------------------------------------------------------------*/
+static coap_resource_t *
+uri_trie_lookup(const char *url, int url_len)
+{
+  uri_trie_node_t *node = &uri_trie_root;
+  coap_resource_t *found = NULL;
+  uint16_t found_order = 0;
+  int segment_len;
+
+  if(url == NULL) {
+    url = "";
+    url_len = 0;
+  }
+
+  while(1) {
+    segment_len = uri_segment_len(url, url_len);
+    node = uri_trie_child(node, url, segment_len);
+    if(node == NULL) {
+      return found;
+    }
+    if(node->resource != NULL && (found == NULL || node->order < found_order)
+       && (segment_len == url_len
+           || (node->resource->flags & HAS_SUB_RESOURCES))) {
+      found = node->resource;
+      found_order = node->order;
+    }
+    if(segment_len == url_len) {
+      return found;
+    }
+    url += segment_len + 1;
+    url_len -= segment_len + 1;
+  }
+}
+#endif /* COAP_URI_TRIE_NODES */
+/*---------------------------------------------------------------------------*/
+coap_resource_t *
+coap_get_resource_by_uri(const char *url, int url_len)
+{
+  coap_resource_t *resource;
+  int res_url_len;
+
+#if COAP_URI_TRIE_NODES
+  if(uri_trie_state == URI_TRIE_STALE) {
+    uri_trie_build();
+  }
+  if(uri_trie_state == URI_TRIE_VALID) {
+    return uri_trie_lookup(url, url_len);
+  }
+#endif /* COAP_URI_TRIE_NODES */
 
-  url_len = coap_get_header_uri_path(request, &url);
   for(resource = list_head(coap_resource_services);
       resource; resource = resource->next) {
 
@@ -455,31 +626,50 @@ invoke_coap_resource_service(coap_message_t *request, coap_message_t *response,
             && (resource->flags & HAS_SUB_RESOURCES)
             && url[res_url_len] == '/'))
        && strncmp(resource->url, url, res_url_len) == 0) {
-      coap_resource_flags_t method = coap_get_method_type(request);
-      found = 1;
-
-      LOG_INFO("/%s, method %u, resource->flags %u\n", resource->url,
-               (uint16_t)method, resource->flags);
-
-      if((method & METHOD_GET) && resource->get_handler != NULL) {
-        /* call handler function */
-        resource->get_handler(request, response, buffer, buffer_size, offset);
-      } else if((method & METHOD_POST) && resource->post_handler != NULL) {
-        /* call handler function */
-        resource->post_handler(request, response, buffer, buffer_size,
+      return resource;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static int
+invoke_coap_resource_service(coap_message_t *request, coap_message_t *response,
+                             uint8_t *buffer, uint16_t buffer_size,
+                             int32_t *offset)
+{
+  uint8_t found = 0;
+  uint8_t allowed = 1;
+
+  coap_resource_t *resource = NULL;
+  const char *url = NULL;
+  int url_len;
+
+  url_len = coap_get_header_uri_path(request, &url);
+  resource = coap_get_resource_by_uri(url, url_len);
+  if(resource != NULL) {
+    coap_resource_flags_t method = coap_get_method_type(request);
+    found = 1;
+
+    LOG_INFO("/%s, method %u, resource->flags %u\n", resource->url,
+             (uint16_t)method, resource->flags);
+
+    if((method & METHOD_GET) && resource->get_handler != NULL) {
+      /* call handler function */
+      resource->get_handler(request, response, buffer, buffer_size, offset);
+    } else if((method & METHOD_POST) && resource->post_handler != NULL) {
+      /* call handler function */
+      resource->post_handler(request, response, buffer, buffer_size,
+                             offset);
+    } else if((method & METHOD_PUT) && resource->put_handler != NULL) {
+      /* call handler function */
+      resource->put_handler(request, response, buffer, buffer_size, offset);
+    } else if((method & METHOD_DELETE) && resource->delete_handler != NULL) {
+      /* call handler function */
+      resource->delete_handler(request, response, buffer, buffer_size,
                                offset);
-      } else if((method & METHOD_PUT) && resource->put_handler != NULL) {
-        /* call handler function */
-        resource->put_handler(request, response, buffer, buffer_size, offset);
-      } else if((method & METHOD_DELETE) && resource->delete_handler != NULL) {
-        /* call handler function */
-        resource->delete_handler(request, response, buffer, buffer_size,
-                                 offset);
-      } else {
-        allowed = 0;
-        coap_set_status_code(response, METHOD_NOT_ALLOWED_4_05);
-      }
-      break;
+    } else {
+      allowed = 0;
+      coap_set_status_code(response, METHOD_NOT_ALLOWED_4_05);
     }
   }
   if(!found) {
@@ -167,6 +167,15 @@ coap_resource_t *coap_get_first_resource(void);
  */
 coap_resource_t *coap_get_next_resource(coap_resource_t *resource);
 /*---------------------------------------------------------------------------*/
+/**
+ * \brief      Returns the resource serving a URI path.
+ * \param url  The URI path, without leading slash, as in a request.
+ * \param url_len The length of the URI path.
+ * \return     The first activated resource whose path equals the URI path,
+ *             or is a parent of it and has sub-resources; NULL if none.
+ */
+coap_resource_t *coap_get_resource_by_uri(const char *url, int url_len);
+/*---------------------------------------------------------------------------*/
 
 #include "coap-transactions.h"
 #include "coap-observe.h"
@@ -45,6 +45,7 @@
 #include <string.h>
 #include "coap-observe.h"
 #include "coap-engine.h"
+#include "coap-cache.h"
 #include "lib/memb.h"
 #include "lib/list.h"
 
@@ -56,12 +57,23 @@
 /*---------------------------------------------------------------------------*/
 MEMB(observers_memb, coap_observer_t, COAP_MAX_OBSERVERS);
 LIST(observers_list);
+
+#if COAP_OBSERVE_WITH_SHARED_NOTIFICATION
+/*
+ * A notification is generated and serialized once for all the observers it
+ * goes to. The first serialized notification is kept here, and the next
+ * observers get a copy with their own type, MID, token and observe sequence
+ * number patched in, whenever these take the same room.
+ */
+static uint8_t notification_template[COAP_MAX_PACKET_SIZE];
+#endif /* COAP_OBSERVE_WITH_SHARED_NOTIFICATION */
 /*---------------------------------------------------------------------------*/
 /*- Internal API ------------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
 static coap_observer_t *
-add_observer(const coap_endpoint_t *endpoint, const uint8_t *token,
-             size_t token_len, const char *uri, int uri_len)
+add_observer(coap_resource_t *resource, const coap_endpoint_t *endpoint,
+             const uint8_t *token, size_t token_len,
+             const char *uri, int uri_len)
 {
   /* Remove existing observe relationship, if any. */
   coap_remove_observer_by_uri(endpoint, uri);
@@ -75,6 +87,8 @@ add_observer(const coap_endpoint_t *endpoint, const uint8_t *token,
     }
     memcpy(o->url, uri, max);
     o->url[max] = 0;
+    o->url_len = max;
+    o->resource = resource;
     coap_endpoint_copy(&o->endpoint, endpoint);
     o->token_len = token_len;
     memcpy(o->token, token, token_len);
@@ -152,7 +166,7 @@ coap_remove_observer_by_uri(const coap_endpoint_t *endpoint,
     LOG_DBG("Remove check URL %p\n", uri);
     if((endpoint == NULL
         || (coap_endpoint_cmp(&obs->endpoint, endpoint)))
-       && (obs->url == uri || memcmp(obs->url, uri, strlen(obs->url)) == 0)) {
+       && (obs->url == uri || memcmp(obs->url, uri, obs->url_len) == 0)) {
       coap_remove_observer(obs);
       removed++;
     }
@@ -185,6 +199,63 @@ coap_notify_observers(coap_resource_t *resource)
 {
   coap_notify_observers_sub(resource, NULL);
 }
+#if COAP_OBSERVE_WITH_SHARED_NOTIFICATION
+/* Returns the number of bytes of an observe sequence number option value */
+static uint8_t
+observe_value_len(uint32_t value)
+{
+  uint8_t len = 0;
+  while(value != 0) {
+    len++;
+    value >>= 8;
+  }
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Returns the offset of the observe option value in a serialized message,
+ * and its length in len, or 0 if the message has no observe option.
+ */
+static uint16_t
+find_observe_value(const uint8_t *message, uint16_t message_len, uint8_t *len)
+{
+  uint16_t i;
+  unsigned int number = 0;
+  unsigned int delta;
+  unsigned int option_len;
+
+  i = COAP_HEADER_LEN + (message[0] & COAP_HEADER_TOKEN_LEN_MASK);
+  while(i < message_len && message[i] != 0xFF) {
+    delta = message[i] >> 4;
+    option_len = message[i] & COAP_HEADER_OPTION_SHORT_LENGTH_MASK;
+    i++;
+    if(delta == 13) {
+      delta = 13 + message[i];
+      i++;
+    } else if(delta == 14) {
+      delta = 269 + ((message[i] << 8) | message[i + 1]);
+      i += 2;
+    }
+    if(option_len == 13) {
+      option_len = 13 + message[i];
+      i++;
+    } else if(option_len == 14) {
+      option_len = 269 + ((message[i] << 8) | message[i + 1]);
+      i += 2;
+    }
+    number += delta;
+    if(number == COAP_OPTION_OBSERVE) {
+      *len = option_len;
+      return i;
+    } else if(number > COAP_OPTION_OBSERVE) {
+      break;
+    }
+    i += option_len;
+  }
+  return 0;
+}
+#endif /* COAP_OBSERVE_WITH_SHARED_NOTIFICATION */
+/*---------------------------------------------------------------------------*/
 /* Can be used either for sub - or when there is not resource - just
    a handler */
 void
@@ -194,9 +265,18 @@ coap_notify_observers_sub(coap_resource_t *resource, const char *subpath)
   coap_message_t notification[1]; /* this way the message can be treated as pointer as usual */
   coap_message_t request[1]; /* this way the message can be treated as pointer as usual */
   coap_observer_t *obs = NULL;
-  int url_len, obs_url_len;
+  coap_transaction_t *transaction;
+  int url_len;
   char url[COAP_OBSERVER_URL_LEN];
   uint8_t sub_ok = 0;
+  coap_message_type_t type;
+  uint16_t template_len = 0;
+#if COAP_OBSERVE_WITH_SHARED_NOTIFICATION
+  uint16_t observe_offset = 0;
+  uint8_t observe_len = 0;
+  uint32_t observe;
+  uint8_t i;
+#endif /* COAP_OBSERVE_WITH_SHARED_NOTIFICATION */
 
   if(resource != NULL) {
     url_len = strlen(resource->url);
@@ -211,6 +291,11 @@ coap_notify_observers_sub(coap_resource_t *resource, const char *subpath)
     return;
   }
 
+#if COAP_WITH_RESPONSE_CACHE
+  /* the representation changed */
+  coap_cache_invalidate(resource);
+#endif /* COAP_WITH_RESPONSE_CACHE */
+
   /* Ensure url is null terminated because strncpy does not guarantee this */
   url[COAP_OBSERVER_URL_LEN - 1] = '\0';
   /* url now contains the notify URL that needs to match the observer */
@@ -227,82 +312,122 @@ coap_notify_observers_sub(coap_resource_t *resource, const char *subpath)
   sub_ok = (resource == NULL) || (resource->flags & HAS_SUB_RESOURCES);
   for(obs = (coap_observer_t *)list_head(observers_list); obs;
       obs = obs->next) {
-    obs_url_len = strlen(obs->url);
+
+    /* Observers of another resource can not match */
+    if(resource != NULL && obs->resource != NULL && obs->resource != resource) {
+      continue;
+    }
 
     /* Do a match based on the parent/sub-resource match so that it is
        possible to do parent-node observe */
+    if(!((obs->url_len == url_len
+          || (obs->url_len > url_len
+              && sub_ok
+              && obs->url[url_len] == '/'))
+         && memcmp(url, obs->url, url_len) == 0)) {
+      continue;
+    }
 
-    /***** TODO fix here so that we handle the notofication correctly ******/
-    /* All the new-style ... is assuming that the URL might be within */
-    if((obs_url_len == url_len
-        || (obs_url_len > url_len
-            && sub_ok
-            && obs->url[url_len] == '/'))
-       && strncmp(url, obs->url, url_len) == 0) {
-      coap_transaction_t *transaction = NULL;
-
-      /*TODO implement special transaction for CON, sharing the same buffer to allow for more observers */
-
-      if((transaction = coap_new_transaction(coap_get_mid(), &obs->endpoint))) {
-        /* if COAP_OBSERVE_REFRESH_INTERVAL is zero, never send observations as confirmable messages */
-        if(COAP_OBSERVE_REFRESH_INTERVAL != 0
-            && (obs->obs_counter % COAP_OBSERVE_REFRESH_INTERVAL == 0)) {
-          LOG_DBG("           Force Confirmable for\n");
-          notification->type = COAP_TYPE_CON;
-        }
-
-        LOG_DBG("           Observer ");
-        LOG_DBG_COAP_EP(&obs->endpoint);
-        LOG_DBG_("\n");
-
-        /* update last MID for RST matching */
-        obs->last_mid = transaction->mid;
+    /*TODO implement special transaction for CON, sharing the same buffer to allow for more observers */
 
-        /* prepare response */
-        notification->mid = transaction->mid;
+    if((transaction = coap_new_transaction(coap_get_mid(), &obs->endpoint)) == NULL) {
+      continue;
+    }
 
-	int32_t new_offset = 0;
+    /* if COAP_OBSERVE_REFRESH_INTERVAL is zero, never send observations as confirmable messages */
+    type = COAP_TYPE_NON;
+    if(COAP_OBSERVE_REFRESH_INTERVAL != 0
+       && (obs->obs_counter % COAP_OBSERVE_REFRESH_INTERVAL == 0)) {
+      LOG_DBG("           Force Confirmable for\n");
+      type = COAP_TYPE_CON;
+    }
 
-        /* Either old style get_handler or the full handler */
-        if(coap_call_handlers(request, notification, transaction->message +
-                              COAP_MAX_HEADER_SIZE, COAP_MAX_CHUNK_SIZE,
-                              &new_offset) > 0) {
-          LOG_DBG("Notification on new handlers\n");
+    LOG_DBG("           Observer ");
+    LOG_DBG_COAP_EP(&obs->endpoint);
+    LOG_DBG_("\n");
+
+    /* update last MID for RST matching */
+    obs->last_mid = transaction->mid;
+
+    if(template_len == 0) {
+      int32_t new_offset = 0;
+
+      /* Either old style get_handler or the full handler */
+      if(coap_call_handlers(request, notification, transaction->message +
+                            COAP_MAX_HEADER_SIZE, COAP_MAX_CHUNK_SIZE,
+                            &new_offset) > 0) {
+        LOG_DBG("Notification on new handlers\n");
+      } else {
+        if(resource != NULL) {
+          resource->get_handler(request, notification,
+                                transaction->message + COAP_MAX_HEADER_SIZE,
+                                COAP_MAX_CHUNK_SIZE, &new_offset);
         } else {
-          if(resource != NULL) {
-            resource->get_handler(request, notification,
-                                  transaction->message + COAP_MAX_HEADER_SIZE,
-                                  COAP_MAX_CHUNK_SIZE, &new_offset);
-          } else {
-            /* What to do here? */
-            notification->code = BAD_REQUEST_4_00;
-          }
+          /* What to do here? */
+          notification->code = BAD_REQUEST_4_00;
         }
+      }
 
-        if(notification->code < BAD_REQUEST_4_00) {
-          coap_set_header_observe(notification, (obs->obs_counter)++);
-          /* mask out to keep the CoAP observe option length <= 3 bytes */
-          obs->obs_counter &= 0xffffff;
-        }
-        coap_set_token(notification, obs->token, obs->token_len);
-
-	if(new_offset != 0) {
-	  coap_set_header_block2(notification,
-				 0,
-				 new_offset != -1,
-				 COAP_MAX_BLOCK_SIZE);
-	  coap_set_payload(notification,
-			   notification->payload,
-			   MIN(notification->payload_len,
-			       COAP_MAX_BLOCK_SIZE));
-	}
-
-        transaction->message_len =
-          coap_serialize_message(notification, transaction->message);
-
-        coap_send_transaction(transaction);
+      if(new_offset != 0) {
+        coap_set_header_block2(notification,
+                               0,
+                               new_offset != -1,
+                               COAP_MAX_BLOCK_SIZE);
+        coap_set_payload(notification,
+                         notification->payload,
+                         MIN(notification->payload_len,
+                             COAP_MAX_BLOCK_SIZE));
       }
     }
+
+    /* prepare response */
+    notification->type = type;
+    notification->mid = transaction->mid;
+#if COAP_OBSERVE_WITH_SHARED_NOTIFICATION
+    observe = notification->code < BAD_REQUEST_4_00 ? obs->obs_counter : 0;
+#endif /* COAP_OBSERVE_WITH_SHARED_NOTIFICATION */
+    if(notification->code < BAD_REQUEST_4_00) {
+      coap_set_header_observe(notification, (obs->obs_counter)++);
+      /* mask out to keep the CoAP observe option length <= 3 bytes */
+      obs->obs_counter &= 0xffffff;
+    }
+    coap_set_token(notification, obs->token, obs->token_len);
+
+#if COAP_OBSERVE_WITH_SHARED_NOTIFICATION
+    if(template_len != 0
+       && obs->token_len == (notification_template[0] & COAP_HEADER_TOKEN_LEN_MASK)
+       && (notification->code >= BAD_REQUEST_4_00
+           || (observe_offset != 0 && observe_value_len(observe) == observe_len))) {
+      memcpy(transaction->message, notification_template, template_len);
+      transaction->message[0] &= ~COAP_HEADER_TYPE_MASK;
+      transaction->message[0] |= COAP_HEADER_TYPE_MASK & type << COAP_HEADER_TYPE_POSITION;
+      transaction->message[2] = (uint8_t)(transaction->mid >> 8);
+      transaction->message[3] = (uint8_t)(transaction->mid);
+      memcpy(transaction->message + COAP_HEADER_LEN, obs->token, obs->token_len);
+      for(i = observe_len; i > 0; i--) {
+        transaction->message[observe_offset + i - 1] = (uint8_t)observe;
+        observe >>= 8;
+      }
+      transaction->message_len = template_len;
+    } else
+#endif /* COAP_OBSERVE_WITH_SHARED_NOTIFICATION */
+    {
+      transaction->message_len =
+        coap_serialize_message(notification, transaction->message);
+#if COAP_OBSERVE_WITH_SHARED_NOTIFICATION
+      if(template_len == 0 && transaction->message_len != 0) {
+        template_len = transaction->message_len;
+        memcpy(notification_template, transaction->message, template_len);
+        observe_offset = find_observe_value(notification_template,
+                                            template_len, &observe_len);
+        /* the payload is serialized again from the template when needed */
+        notification->payload = notification_template + template_len -
+          notification->payload_len;
+      }
+#endif /* COAP_OBSERVE_WITH_SHARED_NOTIFICATION */
+    }
+
+    coap_send_transaction(transaction);
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -321,7 +446,7 @@ coap_observe_handler(coap_resource_t *resource, coap_message_t *coap_req,
       if(src_ep == NULL) {
         /* No source endpoint, can not add */
       } else if(coap_req->observe == 0) {
-        obs = add_observer(src_ep,
+        obs = add_observer(resource, src_ep,
                            coap_req->token, coap_req->token_len,
                            coap_req->uri_path, coap_req->uri_path_len);
         if(obs) {
@@ -369,4 +494,10 @@ coap_has_observers(char *path)
   return 0;
 }
 /*---------------------------------------------------------------------------*/
+coap_observer_t *
+coap_get_first_observer(void)
+{
+  return list_head(observers_list);
+}
+/*---------------------------------------------------------------------------*/
 /** @} */
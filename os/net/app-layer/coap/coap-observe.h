@@ -52,6 +52,8 @@ typedef struct coap_observer {
   struct coap_observer *next;   /* for LIST */
 
   char url[COAP_OBSERVER_URL_LEN];
+  uint8_t url_len;
+  coap_resource_t *resource;    /* serving the observe request, or NULL */
   coap_endpoint_t endpoint;
   uint8_t token_len;
   uint8_t token[COAP_TOKEN_LEN];
@@ -80,5 +82,12 @@ void coap_observe_handler(coap_resource_t *resource, coap_message_t *request,
 
 uint8_t coap_has_observers(char *path);
 
+/**
+ * \brief      Returns the first of the current observers.
+ * \return     The first observer or NULL if none exists. The next ones
+ *             follow through the next field.
+ */
+coap_observer_t *coap_get_first_observer(void);
+
 #endif /* COAP_OBSERVE_H_ */
 /** @} */
@@ -191,6 +191,11 @@ well_known_core_get_handler(coap_message_t *request, coap_message_t *response,
 
     coap_set_payload(response, buffer, bufpos);
     coap_set_header_content_format(response, APPLICATION_LINK_FORMAT);
+#if COAP_WITH_RESPONSE_CACHE
+    /* explicit, so that the response cache keeps it until a resource is
+     * activated */
+    coap_set_header_max_age(response, COAP_DEFAULT_MAX_AGE);
+#endif /* COAP_WITH_RESPONSE_CACHE */
   } else if(strpos > 0) {
     LOG_DBG("well_known_core_handler(): bufpos<=0\n");
 
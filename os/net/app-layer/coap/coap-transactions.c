@@ -44,6 +44,7 @@
 #include "coap-transactions.h"
 #include "coap-observe.h"
 #include "coap-timer.h"
+#include "coap-cocoa.h"
 #include "lib/memb.h"
 #include "lib/list.h"
 #include <stdlib.h>
@@ -56,6 +57,7 @@
 /*---------------------------------------------------------------------------*/
 MEMB(transactions_memb, coap_transaction_t, COAP_MAX_OPEN_TRANSACTIONS);
 LIST(transactions_list);
+static uint32_t retransmissions;
 
 /*---------------------------------------------------------------------------*/
 static void
@@ -67,11 +69,43 @@ coap_retransmit_transaction(coap_timer_t *nt)
     return;
   }
   ++(t->retrans_counter);
+  ++retransmissions;
   LOG_DBG("Retransmitting %u (%u)\n", t->mid, t->retrans_counter);
   coap_send_transaction(t);
 }
 /*---------------------------------------------------------------------------*/
+#if COAP_WITH_CONGESTION_CONTROL
+/* Returns the number of confirmable messages awaiting an answer from an
+ * endpoint */
+static int
+count_in_flight(const coap_endpoint_t *endpoint)
+{
+  coap_transaction_t *t;
+  int count = 0;
+
+  for(t = (coap_transaction_t *)list_head(transactions_list); t; t = t->next) {
+    if(t->in_flight && coap_endpoint_cmp(&t->endpoint, endpoint)) {
+      count++;
+    }
+  }
+  return count;
+}
+/*---------------------------------------------------------------------------*/
+/* Sends the oldest message queued for an endpoint, if any */
+static void
+send_deferred(const coap_endpoint_t *endpoint)
+{
+  coap_transaction_t *t;
 
+  for(t = (coap_transaction_t *)list_head(transactions_list); t; t = t->next) {
+    if(t->deferred && coap_endpoint_cmp(&t->endpoint, endpoint)) {
+      LOG_DBG("Sending deferred transaction %u\n", t->mid);
+      coap_send_transaction(t);
+      return;
+    }
+  }
+}
+#endif /* COAP_WITH_CONGESTION_CONTROL */
 /*---------------------------------------------------------------------------*/
 /*- Internal API ------------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
@@ -83,6 +117,10 @@ coap_new_transaction(uint16_t mid, const coap_endpoint_t *endpoint)
   if(t) {
     t->mid = mid;
     t->retrans_counter = 0;
+#if COAP_WITH_CONGESTION_CONTROL
+    t->in_flight = 0;
+    t->deferred = 0;
+#endif /* COAP_WITH_CONGESTION_CONTROL */
 
     /* save client address */
     coap_endpoint_copy(&t->endpoint, endpoint);
@@ -100,6 +138,18 @@ coap_send_transaction(coap_transaction_t *t)
 
   if(COAP_TYPE_CON ==
      ((COAP_HEADER_TYPE_MASK & t->message[0]) >> COAP_HEADER_TYPE_POSITION)) {
+#if COAP_WITH_CONGESTION_CONTROL
+    if(t->retrans_counter == 0 && !t->in_flight) {
+      if(count_in_flight(&t->endpoint) >= COAP_NSTART) {
+        LOG_DBG("Deferring transaction %u, NSTART reached\n", t->mid);
+        t->deferred = 1;
+        return;
+      }
+      t->deferred = 0;
+      t->in_flight = 1;
+      t->first_sent = (uint32_t)coap_timer_uptime();
+    }
+#endif /* COAP_WITH_CONGESTION_CONTROL */
     if(t->retrans_counter <= COAP_MAX_RETRANSMIT) {
       /* not timed out yet */
       coap_sendto(&t->endpoint, t->message, t->message_len);
@@ -108,13 +158,22 @@ coap_send_transaction(coap_transaction_t *t)
       if(t->retrans_counter == 0) {
         coap_timer_set_callback(&t->retrans_timer, coap_retransmit_transaction);
         coap_timer_set_user_data(&t->retrans_timer, t);
+#if COAP_WITH_CONGESTION_CONTROL
+        t->retrans_interval = coap_cocoa_initial_timeout(&t->endpoint,
+                                                         &t->backoff);
+#else /* COAP_WITH_CONGESTION_CONTROL */
         t->retrans_interval =
           COAP_RESPONSE_TIMEOUT_TICKS + (rand() %
                                          COAP_RESPONSE_TIMEOUT_BACKOFF_MASK);
+#endif /* COAP_WITH_CONGESTION_CONTROL */
         LOG_DBG("Initial interval %lu msec\n",
                 (unsigned long)t->retrans_interval);
       } else {
+#if COAP_WITH_CONGESTION_CONTROL
+        t->retrans_interval = t->retrans_interval * t->backoff / 2;
+#else /* COAP_WITH_CONGESTION_CONTROL */
         t->retrans_interval <<= 1;  /* double */
+#endif /* COAP_WITH_CONGESTION_CONTROL */
         LOG_DBG("Doubled (%u) interval %lu s\n", t->retrans_counter,
                 (unsigned long)(t->retrans_interval / 1000));
       }
@@ -146,11 +205,22 @@ void
 coap_clear_transaction(coap_transaction_t *t)
 {
   if(t) {
+#if COAP_WITH_CONGESTION_CONTROL
+    coap_endpoint_t endpoint;
+    uint8_t in_flight = t->in_flight;
+    coap_endpoint_copy(&endpoint, &t->endpoint);
+#endif /* COAP_WITH_CONGESTION_CONTROL */
+
     LOG_DBG("Freeing transaction %u: %p\n", t->mid, t);
 
     coap_timer_stop(&t->retrans_timer);
     list_remove(transactions_list, t);
     memb_free(&transactions_memb, t);
+#if COAP_WITH_CONGESTION_CONTROL
+    if(in_flight) {
+      send_deferred(&endpoint);
+    }
+#endif /* COAP_WITH_CONGESTION_CONTROL */
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -168,4 +238,10 @@ coap_get_transaction_by_mid(uint16_t mid)
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
+uint32_t
+coap_get_retransmission_count(void)
+{
+  return retransmissions;
+}
+/*---------------------------------------------------------------------------*/
 /** @} */
@@ -63,6 +63,12 @@ typedef struct coap_transaction {
   coap_timer_t retrans_timer;
   uint32_t retrans_interval;
   uint8_t retrans_counter;
+#if COAP_WITH_CONGESTION_CONTROL
+  uint32_t first_sent;                  /* msec, for RTT measurement */
+  uint8_t backoff;                      /* retransmission backoff, in halves */
+  uint8_t in_flight;                    /* confirmable message sent */
+  uint8_t deferred;                     /* waiting for NSTART */
+#endif /* COAP_WITH_CONGESTION_CONTROL */
 
   coap_endpoint_t endpoint;
 
@@ -79,5 +85,11 @@ void coap_send_transaction(coap_transaction_t *t);
 void coap_clear_transaction(coap_transaction_t *t);
 coap_transaction_t *coap_get_transaction_by_mid(uint16_t mid);
 
+/**
+ * \brief      Returns the number of retransmissions of confirmable
+ *             messages since boot.
+ */
+uint32_t coap_get_retransmission_count(void);
+
 #endif /* COAP_TRANSACTIONS_H_ */
 /** @} */
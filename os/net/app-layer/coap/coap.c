@@ -83,7 +83,7 @@ coap_log_2(uint16_t value)
 }
 /*---------------------------------------------------------------------------*/
 static uint32_t
-coap_parse_int_option(uint8_t *bytes, size_t length)
+coap_parse_int_option(const uint8_t *bytes, size_t length)
 {
   uint32_t var = 0;
   int i = 0;
@@ -95,6 +95,78 @@ coap_parse_int_option(uint8_t *bytes, size_t length)
   return var;
 }
 /*---------------------------------------------------------------------------*/
+/* returns the option value, or NULL if the option exceeds the message */
+static inline const uint8_t *
+coap_parse_option_header(const uint8_t *option, const uint8_t *end,
+                         unsigned int *delta, size_t *length)
+{
+  *delta = option[0] >> 4;
+  *length = option[0] & 0x0F;
+  ++option;
+
+  if(*delta == 13) {
+    if(option >= end) {
+      return NULL;
+    }
+    *delta += option[0];
+    ++option;
+  } else if(*delta == 14) {
+    if(option + 1 >= end) {
+      return NULL;
+    }
+    *delta += 255 + (option[0] << 8) + option[1];
+    option += 2;
+  }
+
+  if(*length == 13) {
+    if(option >= end) {
+      return NULL;
+    }
+    *length += option[0];
+    ++option;
+  } else if(*length == 14) {
+    if(option + 1 >= end) {
+      return NULL;
+    }
+    *length += 255 + (option[0] << 8) + option[1];
+    option += 2;
+  }
+
+  if(option + *length > end) {
+    return NULL;
+  }
+  return option;
+}
+/*---------------------------------------------------------------------------*/
+static int
+coap_is_known_option(unsigned int number)
+{
+  switch(number) {
+  case COAP_OPTION_IF_MATCH:
+  case COAP_OPTION_URI_HOST:
+  case COAP_OPTION_ETAG:
+  case COAP_OPTION_IF_NONE_MATCH:
+  case COAP_OPTION_OBSERVE:
+  case COAP_OPTION_URI_PORT:
+  case COAP_OPTION_LOCATION_PATH:
+  case COAP_OPTION_URI_PATH:
+  case COAP_OPTION_CONTENT_FORMAT:
+  case COAP_OPTION_MAX_AGE:
+  case COAP_OPTION_URI_QUERY:
+  case COAP_OPTION_ACCEPT:
+  case COAP_OPTION_LOCATION_QUERY:
+  case COAP_OPTION_BLOCK2:
+  case COAP_OPTION_BLOCK1:
+  case COAP_OPTION_SIZE2:
+  case COAP_OPTION_PROXY_URI:
+  case COAP_OPTION_PROXY_SCHEME:
+  case COAP_OPTION_SIZE1:
+    return 1;
+  default:
+    return 0;
+  }
+}
+/*---------------------------------------------------------------------------*/
 static uint8_t
 coap_option_nibble(unsigned int value)
 {
@@ -276,6 +348,242 @@ coap_get_variable(const char *buffer, size_t length, const char *name,
   return 0;
 }
 /*---------------------------------------------------------------------------*/
+static void
+coap_store_option(coap_message_t *coap_pkt, unsigned int option_number,
+                  uint8_t *current_option, size_t option_length)
+{
+  LOG_DBG("OPTION %u (len %zu): ", option_number, option_length);
+
+  coap_set_option(coap_pkt, option_number);
+
+  switch(option_number) {
+  case COAP_OPTION_CONTENT_FORMAT:
+    coap_pkt->content_format = coap_parse_int_option(current_option,
+                                                     option_length);
+    LOG_DBG_("Content-Format [%u]\n", coap_pkt->content_format);
+    break;
+  case COAP_OPTION_MAX_AGE:
+    coap_pkt->max_age = coap_parse_int_option(current_option,
+                                              option_length);
+    LOG_DBG_("Max-Age [%"PRIu32"]\n", coap_pkt->max_age);
+    break;
+  case COAP_OPTION_ETAG:
+    coap_pkt->etag_len = MIN(COAP_ETAG_LEN, option_length);
+    memcpy(coap_pkt->etag, current_option, coap_pkt->etag_len);
+    LOG_DBG_("ETag %u [0x%02X%02X%02X%02X%02X%02X%02X%02X]\n",
+             coap_pkt->etag_len, coap_pkt->etag[0], coap_pkt->etag[1],
+             coap_pkt->etag[2], coap_pkt->etag[3], coap_pkt->etag[4],
+             coap_pkt->etag[5], coap_pkt->etag[6], coap_pkt->etag[7]
+             );                 /*FIXME always prints 8 bytes */
+    break;
+  case COAP_OPTION_ACCEPT:
+    coap_pkt->accept = coap_parse_int_option(current_option, option_length);
+    LOG_DBG_("Accept [%u]\n", coap_pkt->accept);
+    break;
+  case COAP_OPTION_IF_MATCH:
+    /* TODO support multiple ETags */
+    coap_pkt->if_match_len = MIN(COAP_ETAG_LEN, option_length);
+    memcpy(coap_pkt->if_match, current_option, coap_pkt->if_match_len);
+    LOG_DBG_("If-Match %u [0x%02X%02X%02X%02X%02X%02X%02X%02X]\n",
+             coap_pkt->if_match_len, coap_pkt->if_match[0],
+             coap_pkt->if_match[1], coap_pkt->if_match[2],
+             coap_pkt->if_match[3], coap_pkt->if_match[4],
+             coap_pkt->if_match[5], coap_pkt->if_match[6],
+             coap_pkt->if_match[7]
+             ); /* FIXME always prints 8 bytes */
+    break;
+  case COAP_OPTION_IF_NONE_MATCH:
+    coap_pkt->if_none_match = 1;
+    LOG_DBG_("If-None-Match\n");
+    break;
+
+  case COAP_OPTION_URI_HOST:
+    coap_pkt->uri_host = (char *)current_option;
+    coap_pkt->uri_host_len = option_length;
+    LOG_DBG_("Uri-Host [");
+    LOG_DBG_COAP_STRING(coap_pkt->uri_host, coap_pkt->uri_host_len);
+    LOG_DBG_("]\n");
+    break;
+  case COAP_OPTION_URI_PORT:
+    coap_pkt->uri_port = coap_parse_int_option(current_option,
+                                               option_length);
+    LOG_DBG_("Uri-Port [%u]\n", coap_pkt->uri_port);
+    break;
+  case COAP_OPTION_URI_PATH:
+    /* coap_merge_multi_option() operates in-place on the IPBUF, but final message field should be const string -> cast to string */
+    coap_merge_multi_option((char **)&(coap_pkt->uri_path),
+                            &(coap_pkt->uri_path_len), current_option,
+                            option_length, '/');
+    LOG_DBG_("Uri-Path [");
+    LOG_DBG_COAP_STRING(coap_pkt->uri_path, coap_pkt->uri_path_len);
+    LOG_DBG_("]\n");
+    break;
+  case COAP_OPTION_URI_QUERY:
+    /* coap_merge_multi_option() operates in-place on the IPBUF, but final message field should be const string -> cast to string */
+    coap_merge_multi_option((char **)&(coap_pkt->uri_query),
+                            &(coap_pkt->uri_query_len), current_option,
+                            option_length, '&');
+    LOG_DBG_("Uri-Query[");
+    LOG_DBG_COAP_STRING(coap_pkt->uri_query, coap_pkt->uri_query_len);
+    LOG_DBG_("]\n");
+    break;
+
+  case COAP_OPTION_LOCATION_PATH:
+    /* coap_merge_multi_option() operates in-place on the IPBUF, but final message field should be const string -> cast to string */
+    coap_merge_multi_option((char **)&(coap_pkt->location_path),
+                            &(coap_pkt->location_path_len), current_option,
+                            option_length, '/');
+
+    LOG_DBG_("Location-Path [");
+    LOG_DBG_COAP_STRING(coap_pkt->location_path, coap_pkt->location_path_len);
+    LOG_DBG_("]\n");
+    break;
+  case COAP_OPTION_LOCATION_QUERY:
+    /* coap_merge_multi_option() operates in-place on the IPBUF, but final message field should be const string -> cast to string */
+    coap_merge_multi_option((char **)&(coap_pkt->location_query),
+                            &(coap_pkt->location_query_len), current_option,
+                            option_length, '&');
+    LOG_DBG_("Location-Query [");
+    LOG_DBG_COAP_STRING(coap_pkt->location_query, coap_pkt->location_query_len);
+    LOG_DBG_("]\n");
+    break;
+
+  case COAP_OPTION_OBSERVE:
+    coap_pkt->observe = coap_parse_int_option(current_option,
+                                              option_length);
+    LOG_DBG_("Observe [%"PRId32"]\n", coap_pkt->observe);
+    break;
+  case COAP_OPTION_BLOCK2:
+    coap_pkt->block2_num = coap_parse_int_option(current_option,
+                                                 option_length);
+    coap_pkt->block2_more = (coap_pkt->block2_num & 0x08) >> 3;
+    coap_pkt->block2_size = 16 << (coap_pkt->block2_num & 0x07);
+    coap_pkt->block2_offset = (coap_pkt->block2_num & ~0x0000000F)
+      << (coap_pkt->block2_num & 0x07);
+    coap_pkt->block2_num >>= 4;
+    LOG_DBG_("Block2 [%lu%s (%u B/blk)]\n",
+             (unsigned long)coap_pkt->block2_num,
+             coap_pkt->block2_more ? "+" : "", coap_pkt->block2_size);
+    break;
+  case COAP_OPTION_BLOCK1:
+    coap_pkt->block1_num = coap_parse_int_option(current_option,
+                                                 option_length);
+    coap_pkt->block1_more = (coap_pkt->block1_num & 0x08) >> 3;
+    coap_pkt->block1_size = 16 << (coap_pkt->block1_num & 0x07);
+    coap_pkt->block1_offset = (coap_pkt->block1_num & ~0x0000000F)
+      << (coap_pkt->block1_num & 0x07);
+    coap_pkt->block1_num >>= 4;
+    LOG_DBG_("Block1 [%lu%s (%u B/blk)]\n",
+             (unsigned long)coap_pkt->block1_num,
+             coap_pkt->block1_more ? "+" : "", coap_pkt->block1_size);
+    break;
+  case COAP_OPTION_SIZE2:
+    coap_pkt->size2 = coap_parse_int_option(current_option, option_length);
+    LOG_DBG_("Size2 [%"PRIu32"]\n", coap_pkt->size2);
+    break;
+  case COAP_OPTION_SIZE1:
+    coap_pkt->size1 = coap_parse_int_option(current_option, option_length);
+    LOG_DBG_("Size1 [%"PRIu32"]\n", coap_pkt->size1);
+    break;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* validates the message, and stores its options if coap_pkt is not NULL */
+static coap_status_t
+coap_parse_view(coap_message_view_t *view, const uint8_t *data,
+                uint16_t data_len, coap_message_t *coap_pkt)
+{
+  const uint8_t *end = data + data_len;
+  const uint8_t *current_option;
+  unsigned int option_number = 0;
+  unsigned int option_delta;
+  size_t option_length;
+  uint8_t token_len;
+
+  memset(view, 0, sizeof(coap_message_view_t));
+
+  if(data_len < COAP_HEADER_LEN) {
+    /* Too short - malformed CoAP message */
+    LOG_WARN("BAD REQUEST: message too short\n");
+    return BAD_REQUEST_4_00;
+  }
+
+  view->buffer = data;
+
+  if(((COAP_HEADER_VERSION_MASK & data[0])
+      >> COAP_HEADER_VERSION_POSITION) != 1) {
+    coap_error_message = "CoAP version must be 1";
+    return BAD_REQUEST_4_00;
+  }
+
+  token_len = (COAP_HEADER_TOKEN_LEN_MASK & data[0])
+    >> COAP_HEADER_TOKEN_LEN_POSITION;
+  if(token_len > COAP_TOKEN_LEN) {
+    coap_error_message = "Token Length must not be more than 8";
+    return BAD_REQUEST_4_00;
+  }
+
+  current_option = data + COAP_HEADER_LEN + token_len;
+  if(current_option > end) {
+    /* Malformed CoAP message - token length out od message bounds */
+    LOG_WARN("BAD REQUEST: token outside message buffer\n");
+    return BAD_REQUEST_4_00;
+  }
+
+  view->options = current_option;
+  view->options_end = end;
+
+  while(current_option < end) {
+    /* payload marker 0xFF, currently only checking for 0xF* because rest is reserved */
+    if((current_option[0] & 0xF0) == 0xF0) {
+      view->options_end = current_option;
+      view->payload = current_option + 1;
+      view->payload_len = end - view->payload;
+      break;
+    }
+
+    current_option = coap_parse_option_header(current_option, end,
+                                              &option_delta, &option_length);
+    if(current_option == NULL) {
+      /* Malformed CoAP - out of bounds */
+      LOG_WARN("BAD REQUEST: option outside message buffer\n");
+      return BAD_REQUEST_4_00;
+    }
+
+    option_number += option_delta;
+
+    if(option_number > COAP_OPTION_SIZE1) {
+      /* Malformed CoAP - out of bounds */
+      LOG_WARN("BAD REQUEST: option number too large: %u\n", option_number);
+      return BAD_REQUEST_4_00;
+    }
+
+    if(option_number == COAP_OPTION_PROXY_URI
+       || option_number == COAP_OPTION_PROXY_SCHEME) {
+      LOG_DBG("Proxy option %u NOT IMPLEMENTED\n", option_number);
+      coap_error_message = "This is a constrained server (Contiki)";
+      return PROXYING_NOT_SUPPORTED_5_05;
+    }
+
+    /* check if critical (odd) */
+    if((option_number & 1) && !coap_is_known_option(option_number)) {
+      LOG_DBG("OPTION %u unknown\n", option_number);
+      coap_error_message = "Unsupported critical option";
+      return BAD_OPTION_4_02;
+    }
+
+    if(coap_pkt != NULL) {
+      /* the options are in the writable input buffer of coap_parse_message() */
+      coap_store_option(coap_pkt, option_number, (uint8_t *)current_option,
+                        option_length);
+    }
+
+    current_option += option_length;
+  }
+
+  return NO_ERROR;
+}
+/*---------------------------------------------------------------------------*/
 /*- Internal API ------------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
 void
@@ -414,8 +722,94 @@ coap_serialize_message(coap_message_t *coap_pkt, uint8_t *buffer)
 }
 /*---------------------------------------------------------------------------*/
 coap_status_t
+coap_validate_message(coap_message_view_t *view, const uint8_t *data,
+                      uint16_t data_len)
+{
+  return coap_parse_view(view, data, data_len, NULL);
+}
+/*---------------------------------------------------------------------------*/
+void
+coap_option_iterator_init(coap_option_iterator_t *iterator,
+                          const coap_message_view_t *view)
+{
+  iterator->next = view->options;
+  iterator->end = view->options_end;
+  iterator->number = 0;
+  iterator->value = NULL;
+  iterator->length = 0;
+}
+/*---------------------------------------------------------------------------*/
+int
+coap_option_iterator_next(coap_option_iterator_t *iterator)
+{
+  unsigned int delta;
+  size_t length;
+
+  if(iterator->next == NULL || iterator->next >= iterator->end) {
+    return 0;
+  }
+
+  iterator->value = coap_parse_option_header(iterator->next, iterator->end,
+                                             &delta, &length);
+  if(iterator->value == NULL) {
+    /* not a validated view */
+    iterator->next = iterator->end;
+    return 0;
+  }
+
+  iterator->number += delta;
+  iterator->length = length;
+  iterator->next = iterator->value + length;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+coap_option_get_int(const coap_option_iterator_t *iterator)
+{
+  return coap_parse_int_option(iterator->value, iterator->length);
+}
+/*---------------------------------------------------------------------------*/
+int
+coap_view_get_option(const coap_message_view_t *view, unsigned int number,
+                     const uint8_t **value)
+{
+  coap_option_iterator_t iterator;
+
+  coap_option_iterator_init(&iterator, view);
+  while(coap_option_iterator_next(&iterator)) {
+    if(iterator.number == number) {
+      *value = iterator.value;
+      return iterator.length;
+    }
+    if(iterator.number > number) {
+      /* options are sorted by number */
+      break;
+    }
+  }
+  return -1;
+}
+/*---------------------------------------------------------------------------*/
+int
+coap_view_get_int_option(const coap_message_view_t *view, unsigned int number,
+                         uint32_t *value)
+{
+  const uint8_t *bytes;
+  int length;
+
+  length = coap_view_get_option(view, number, &bytes);
+  if(length < 0) {
+    return 0;
+  }
+  *value = coap_parse_int_option(bytes, length);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+coap_status_t
 coap_parse_message(coap_message_t *coap_pkt, uint8_t *data, uint16_t data_len)
 {
+  coap_message_view_t view;
+  coap_status_t status;
+
   if(data_len < COAP_HEADER_LEN) {
     /* Too short - malformed CoAP message */
     LOG_WARN("BAD REQUEST: message too short\n");
@@ -438,285 +832,34 @@ coap_parse_message(coap_message_t *coap_pkt, uint8_t *data, uint16_t data_len)
   coap_pkt->code = coap_pkt->buffer[1];
   coap_pkt->mid = coap_pkt->buffer[2] << 8 | coap_pkt->buffer[3];
 
-  if(coap_pkt->version != 1) {
-    coap_error_message = "CoAP version must be 1";
-    return BAD_REQUEST_4_00;
-  }
-
-  if(coap_pkt->token_len > COAP_TOKEN_LEN) {
-    coap_error_message = "Token Length must not be more than 8";
-    return BAD_REQUEST_4_00;
+  /* validate and store the options in a single pass */
+  status = coap_parse_view(&view, data, data_len, coap_pkt);
+
+  if(view.options != NULL) {
+    /* the token is valid, even if an option is not */
+    memcpy(coap_pkt->token, data + COAP_HEADER_LEN, coap_pkt->token_len);
+    LOG_DBG("Token (len %u) [0x%02X%02X%02X%02X%02X%02X%02X%02X]\n",
+            coap_pkt->token_len, coap_pkt->token[0], coap_pkt->token[1],
+            coap_pkt->token[2], coap_pkt->token[3], coap_pkt->token[4],
+            coap_pkt->token[5], coap_pkt->token[6], coap_pkt->token[7]
+            );                     /* FIXME always prints 8 bytes */
   }
 
-  uint8_t *current_option = data + COAP_HEADER_LEN;
-  if(current_option + coap_pkt->token_len > data + data_len) {
-    /* Malformed CoAP message - token length out od message bounds */
-    LOG_WARN("BAD REQUEST: token outside message buffer");
-    return BAD_REQUEST_4_00;
+  if(status != NO_ERROR) {
+    return status;
   }
 
-  memcpy(coap_pkt->token, current_option, coap_pkt->token_len);
-  LOG_DBG("Token (len %u) [0x%02X%02X%02X%02X%02X%02X%02X%02X]\n",
-          coap_pkt->token_len, coap_pkt->token[0], coap_pkt->token[1],
-          coap_pkt->token[2], coap_pkt->token[3], coap_pkt->token[4],
-          coap_pkt->token[5], coap_pkt->token[6], coap_pkt->token[7]
-          );                     /* FIXME always prints 8 bytes */
-
-  /* parse options */
-  memset(coap_pkt->options, 0, sizeof(coap_pkt->options));
-  current_option += coap_pkt->token_len;
-
-  unsigned int option_number = 0;
-  unsigned int option_delta = 0;
-  size_t option_length = 0;
-
-  while(current_option < data + data_len) {
-    /* payload marker 0xFF, currently only checking for 0xF* because rest is reserved */
-    if((current_option[0] & 0xF0) == 0xF0) {
-      coap_pkt->payload = ++current_option;
-      coap_pkt->payload_len = data_len - (coap_pkt->payload - data);
-
-      /* also for receiving, the Erbium upper bound is COAP_MAX_CHUNK_SIZE */
-      if(coap_pkt->payload_len > COAP_MAX_CHUNK_SIZE) {
-        coap_pkt->payload_len = COAP_MAX_CHUNK_SIZE;
-        /* null-terminate payload */
-      }
-      coap_pkt->payload[coap_pkt->payload_len] = '\0';
-
-      break;
-    }
+  if(view.payload != NULL) {
+    coap_pkt->payload = data + (view.payload - data);
+    coap_pkt->payload_len = view.payload_len;
 
-    option_delta = current_option[0] >> 4;
-    option_length = current_option[0] & 0x0F;
-    ++current_option;
-    if(current_option >= data + data_len) {
-      /* Malformed CoAP - out of bounds */
-      LOG_WARN("BAD REQUEST: option delta outside message buffer\n");
-      return BAD_REQUEST_4_00;
-    }
-
-    if(option_delta == 13) {
-      option_delta += current_option[0];
-      ++current_option;
-    } else if(option_delta == 14) {
-      option_delta += 255;
-      option_delta += current_option[0] << 8;
-      ++current_option;
-      if(current_option >= data + data_len) {
-        /* Malformed CoAP - out of bounds */
-        LOG_WARN("BAD REQUEST: option delta outside message buffer\n");
-        return BAD_REQUEST_4_00;
-      }
-      option_delta += current_option[0];
-      ++current_option;
+    /* also for receiving, the Erbium upper bound is COAP_MAX_CHUNK_SIZE */
+    if(coap_pkt->payload_len > COAP_MAX_CHUNK_SIZE) {
+      coap_pkt->payload_len = COAP_MAX_CHUNK_SIZE;
+      /* null-terminate payload */
     }
-
-    if(current_option >= data + data_len) {
-      /* Malformed CoAP - out of bounds */
-      LOG_WARN("BAD REQUEST: option delta outside message buffer\n");
-      return BAD_REQUEST_4_00;
-    }
-
-    if(option_length == 13) {
-      option_length += current_option[0];
-      ++current_option;
-    } else if(option_length == 14) {
-      option_length += 255;
-      option_length += current_option[0] << 8;
-      ++current_option;
-      if(current_option >= data + data_len) {
-        /* Malformed CoAP - out of bounds */
-        LOG_WARN("BAD REQUEST: option length outside message buffer\n");
-        return BAD_REQUEST_4_00;
-      }
-      option_length += current_option[0];
-      ++current_option;
-    }
-
-    if(current_option + option_length > data + data_len) {
-      /* Malformed CoAP - out of bounds */
-      LOG_WARN("BAD REQUEST: options outside data message: %u > %u\n",
-               (unsigned)(current_option + option_length - data), data_len);
-      return BAD_REQUEST_4_00;
-    }
-
-    option_number += option_delta;
-
-    if(option_number > COAP_OPTION_SIZE1) {
-      /* Malformed CoAP - out of bounds */
-      LOG_WARN("BAD REQUEST: option number too large: %u\n", option_number);
-      return BAD_REQUEST_4_00;
-    }
-
-    LOG_DBG("OPTION %u (delta %u, len %zu): ", option_number, option_delta,
-            option_length);
-
-    coap_set_option(coap_pkt, option_number);
-
-    switch(option_number) {
-    case COAP_OPTION_CONTENT_FORMAT:
-      coap_pkt->content_format = coap_parse_int_option(current_option,
-                                                       option_length);
-      LOG_DBG_("Content-Format [%u]\n", coap_pkt->content_format);
-      break;
-    case COAP_OPTION_MAX_AGE:
-      coap_pkt->max_age = coap_parse_int_option(current_option,
-                                                option_length);
-      LOG_DBG_("Max-Age [%"PRIu32"]\n", coap_pkt->max_age);
-      break;
-    case COAP_OPTION_ETAG:
-      coap_pkt->etag_len = MIN(COAP_ETAG_LEN, option_length);
-      memcpy(coap_pkt->etag, current_option, coap_pkt->etag_len);
-      LOG_DBG_("ETag %u [0x%02X%02X%02X%02X%02X%02X%02X%02X]\n",
-               coap_pkt->etag_len, coap_pkt->etag[0], coap_pkt->etag[1],
-               coap_pkt->etag[2], coap_pkt->etag[3], coap_pkt->etag[4],
-               coap_pkt->etag[5], coap_pkt->etag[6], coap_pkt->etag[7]
-               );                 /*FIXME always prints 8 bytes */
-      break;
-    case COAP_OPTION_ACCEPT:
-      coap_pkt->accept = coap_parse_int_option(current_option, option_length);
-      LOG_DBG_("Accept [%u]\n", coap_pkt->accept);
-      break;
-    case COAP_OPTION_IF_MATCH:
-      /* TODO support multiple ETags */
-      coap_pkt->if_match_len = MIN(COAP_ETAG_LEN, option_length);
-      memcpy(coap_pkt->if_match, current_option, coap_pkt->if_match_len);
-      LOG_DBG_("If-Match %u [0x%02X%02X%02X%02X%02X%02X%02X%02X]\n",
-               coap_pkt->if_match_len, coap_pkt->if_match[0],
-               coap_pkt->if_match[1], coap_pkt->if_match[2],
-               coap_pkt->if_match[3], coap_pkt->if_match[4],
-               coap_pkt->if_match[5], coap_pkt->if_match[6],
-               coap_pkt->if_match[7]
-               ); /* FIXME always prints 8 bytes */
-      break;
-    case COAP_OPTION_IF_NONE_MATCH:
-      coap_pkt->if_none_match = 1;
-      LOG_DBG_("If-None-Match\n");
-      break;
-
-    case COAP_OPTION_PROXY_URI:
-#if COAP_PROXY_OPTION_PROCESSING
-      coap_pkt->proxy_uri = (char *)current_option;
-      coap_pkt->proxy_uri_len = option_length;
-#endif /* COAP_PROXY_OPTION_PROCESSING */
-      LOG_DBG_("Proxy-Uri NOT IMPLEMENTED [");
-      LOG_DBG_COAP_STRING(coap_pkt->proxy_uri, coap_pkt->proxy_uri_len);
-      LOG_DBG_("]\n");
-
-      coap_error_message = "This is a constrained server (Contiki)";
-      return PROXYING_NOT_SUPPORTED_5_05;
-      break;
-    case COAP_OPTION_PROXY_SCHEME:
-#if COAP_PROXY_OPTION_PROCESSING
-      coap_pkt->proxy_scheme = (char *)current_option;
-      coap_pkt->proxy_scheme_len = option_length;
-#endif
-      LOG_DBG_("Proxy-Scheme NOT IMPLEMENTED [");
-      LOG_DBG_COAP_STRING(coap_pkt->proxy_scheme, coap_pkt->proxy_scheme_len);
-      LOG_DBG_("]\n");
-      coap_error_message = "This is a constrained server (Contiki)";
-      return PROXYING_NOT_SUPPORTED_5_05;
-      break;
-
-    case COAP_OPTION_URI_HOST:
-      coap_pkt->uri_host = (char *)current_option;
-      coap_pkt->uri_host_len = option_length;
-      LOG_DBG_("Uri-Host [");
-      LOG_DBG_COAP_STRING(coap_pkt->uri_host, coap_pkt->uri_host_len);
-      LOG_DBG_("]\n");
-      break;
-    case COAP_OPTION_URI_PORT:
-      coap_pkt->uri_port = coap_parse_int_option(current_option,
-                                                 option_length);
-      LOG_DBG_("Uri-Port [%u]\n", coap_pkt->uri_port);
-      break;
-    case COAP_OPTION_URI_PATH:
-      /* coap_merge_multi_option() operates in-place on the IPBUF, but final message field should be const string -> cast to string */
-      coap_merge_multi_option((char **)&(coap_pkt->uri_path),
-                              &(coap_pkt->uri_path_len), current_option,
-                              option_length, '/');
-      LOG_DBG_("Uri-Path [");
-      LOG_DBG_COAP_STRING(coap_pkt->uri_path, coap_pkt->uri_path_len);
-      LOG_DBG_("]\n");
-      break;
-    case COAP_OPTION_URI_QUERY:
-      /* coap_merge_multi_option() operates in-place on the IPBUF, but final message field should be const string -> cast to string */
-      coap_merge_multi_option((char **)&(coap_pkt->uri_query),
-                              &(coap_pkt->uri_query_len), current_option,
-                              option_length, '&');
-      LOG_DBG_("Uri-Query[");
-      LOG_DBG_COAP_STRING(coap_pkt->uri_query, coap_pkt->uri_query_len);
-      LOG_DBG_("]\n");
-      break;
-
-    case COAP_OPTION_LOCATION_PATH:
-      /* coap_merge_multi_option() operates in-place on the IPBUF, but final message field should be const string -> cast to string */
-      coap_merge_multi_option((char **)&(coap_pkt->location_path),
-                              &(coap_pkt->location_path_len), current_option,
-                              option_length, '/');
-
-      LOG_DBG_("Location-Path [");
-      LOG_DBG_COAP_STRING(coap_pkt->location_path, coap_pkt->location_path_len);
-      LOG_DBG_("]\n");
-      break;
-    case COAP_OPTION_LOCATION_QUERY:
-      /* coap_merge_multi_option() operates in-place on the IPBUF, but final message field should be const string -> cast to string */
-      coap_merge_multi_option((char **)&(coap_pkt->location_query),
-                              &(coap_pkt->location_query_len), current_option,
-                              option_length, '&');
-      LOG_DBG_("Location-Query [");
-      LOG_DBG_COAP_STRING(coap_pkt->location_query, coap_pkt->location_query_len);
-      LOG_DBG_("]\n");
-      break;
-
-    case COAP_OPTION_OBSERVE:
-      coap_pkt->observe = coap_parse_int_option(current_option,
-                                                option_length);
-      LOG_DBG_("Observe [%"PRId32"]\n", coap_pkt->observe);
-      break;
-    case COAP_OPTION_BLOCK2:
-      coap_pkt->block2_num = coap_parse_int_option(current_option,
-                                                   option_length);
-      coap_pkt->block2_more = (coap_pkt->block2_num & 0x08) >> 3;
-      coap_pkt->block2_size = 16 << (coap_pkt->block2_num & 0x07);
-      coap_pkt->block2_offset = (coap_pkt->block2_num & ~0x0000000F)
-        << (coap_pkt->block2_num & 0x07);
-      coap_pkt->block2_num >>= 4;
-      LOG_DBG_("Block2 [%lu%s (%u B/blk)]\n",
-               (unsigned long)coap_pkt->block2_num,
-               coap_pkt->block2_more ? "+" : "", coap_pkt->block2_size);
-      break;
-    case COAP_OPTION_BLOCK1:
-      coap_pkt->block1_num = coap_parse_int_option(current_option,
-                                                   option_length);
-      coap_pkt->block1_more = (coap_pkt->block1_num & 0x08) >> 3;
-      coap_pkt->block1_size = 16 << (coap_pkt->block1_num & 0x07);
-      coap_pkt->block1_offset = (coap_pkt->block1_num & ~0x0000000F)
-        << (coap_pkt->block1_num & 0x07);
-      coap_pkt->block1_num >>= 4;
-      LOG_DBG_("Block1 [%lu%s (%u B/blk)]\n",
-               (unsigned long)coap_pkt->block1_num,
-               coap_pkt->block1_more ? "+" : "", coap_pkt->block1_size);
-      break;
-    case COAP_OPTION_SIZE2:
-      coap_pkt->size2 = coap_parse_int_option(current_option, option_length);
-      LOG_DBG_("Size2 [%"PRIu32"]\n", coap_pkt->size2);
-      break;
-    case COAP_OPTION_SIZE1:
-      coap_pkt->size1 = coap_parse_int_option(current_option, option_length);
-      LOG_DBG_("Size1 [%"PRIu32"]\n", coap_pkt->size1);
-      break;
-    default:
-      LOG_DBG_("unknown (%u)\n", option_number);
-      /* check if critical (odd) */
-      if(option_number & 1) {
-        coap_error_message = "Unsupported critical option";
-        return BAD_OPTION_4_02;
-      }
-    }
-
-    current_option += option_length;
-  }                             /* for */
+    coap_pkt->payload[coap_pkt->payload_len] = '\0';
+  }
   LOG_DBG("-Done parsing-------\n");
 
   return NO_ERROR;
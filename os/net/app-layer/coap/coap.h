@@ -128,6 +128,24 @@ typedef struct {
   uint8_t *payload;
 } coap_message_t;
 
+/* validated view of a received message; options are decoded on demand */
+typedef struct {
+  const uint8_t *buffer;      /* CoAP header of the datagram */
+  const uint8_t *options;     /* first option header, after the token */
+  const uint8_t *options_end; /* payload marker or end of the datagram */
+  const uint8_t *payload;
+  uint16_t payload_len;
+} coap_message_view_t;
+
+/* option iterator over a validated view */
+typedef struct {
+  const uint8_t *next;
+  const uint8_t *end;
+  unsigned int number;        /* number of the current option */
+  const uint8_t *value;       /* value of the current option, in place */
+  uint16_t length;
+} coap_option_iterator_t;
+
 static inline int
 coap_set_option(coap_message_t *message, unsigned int opt)
 {
@@ -199,6 +217,56 @@ size_t coap_serialize_message(coap_message_t *message, uint8_t *buffer);
 coap_status_t coap_parse_message(coap_message_t *request, uint8_t *data,
                                  uint16_t data_len);
 
+/*
+ * Zero-copy option access. coap_validate_message() checks the header and
+ * walks the options once, with the same checks and status codes as
+ * coap_parse_message(). The options of a valid view can then be decoded
+ * on demand, straight from the datagram, without filling in a
+ * coap_message_t. Repeated options such as Uri-Path are seen one by one.
+ *
+ * coap_parse_message() merges repeated options in place, so a view must
+ * not be used after the same buffer has been parsed.
+ */
+coap_status_t coap_validate_message(coap_message_view_t *view,
+                                    const uint8_t *data, uint16_t data_len);
+
+void coap_option_iterator_init(coap_option_iterator_t *iterator,
+                               const coap_message_view_t *view);
+/* returns 1 and moves to the next option, or 0 after the last one */
+int coap_option_iterator_next(coap_option_iterator_t *iterator);
+uint32_t coap_option_get_int(const coap_option_iterator_t *iterator);
+
+/* returns the length of the first instance of an option, or -1 */
+int coap_view_get_option(const coap_message_view_t *view, unsigned int number,
+                         const uint8_t **value);
+int coap_view_get_int_option(const coap_message_view_t *view,
+                             unsigned int number, uint32_t *value);
+
+static inline coap_message_type_t
+coap_view_get_type(const coap_message_view_t *view)
+{
+  return (COAP_HEADER_TYPE_MASK & view->buffer[0]) >> COAP_HEADER_TYPE_POSITION;
+}
+
+static inline uint8_t
+coap_view_get_code(const coap_message_view_t *view)
+{
+  return view->buffer[1];
+}
+
+static inline uint16_t
+coap_view_get_mid(const coap_message_view_t *view)
+{
+  return view->buffer[2] << 8 | view->buffer[3];
+}
+
+static inline uint8_t
+coap_view_get_token(const coap_message_view_t *view, const uint8_t **token)
+{
+  *token = view->buffer + COAP_HEADER_LEN;
+  return view->options - *token;
+}
+
 int coap_get_query_variable(coap_message_t *message, const char *name,
                             const char **output);
 int coap_get_post_variable(coap_message_t *message, const char *name,
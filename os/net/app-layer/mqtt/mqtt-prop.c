@@ -51,29 +51,29 @@ mqtt_props_init()
 #endif
 }
 /*----------------------------------------------------------------------------*/
-static void
-encode_prop_fixed_len_int(struct mqtt_prop_out_property **prop_out,
+static uint32_t
+encode_prop_fixed_len_int(uint8_t *val_out, uint32_t max_len,
                           int val, uint8_t len)
 {
   int8_t i;
 
   DBG("MQTT - Creating %d-byte int property %i\n", len, val);
 
-  if(len > MQTT_PROP_MAX_PROP_LENGTH) {
-    DBG("MQTT - Error, property too long (max %i bytes)", MQTT_PROP_MAX_PROP_LENGTH);
-    return;
+  if(len > max_len) {
+    DBG("MQTT - Error, property too long (max %i bytes)", max_len);
+    return 0;
   }
 
   for(i = len - 1; i >= 0; i--) {
-    (*prop_out)->val[i] = val & 0x00FF;
+    val_out[i] = val & 0x00FF;
     val = val >> 8;
   }
 
-  (*prop_out)->property_len = len;
+  return len;
 }
 /*---------------------------------------------------------------------------*/
-static void
-encode_prop_utf8(struct mqtt_prop_out_property **prop_out,
+static uint32_t
+encode_prop_utf8(uint8_t *val_out, uint32_t max_len,
                  const char *str)
 {
   int str_len;
@@ -82,66 +82,62 @@ encode_prop_utf8(struct mqtt_prop_out_property **prop_out,
   str_len = strlen(str);
 
   /* 2 bytes are needed for each string to encode its length */
-  if((str_len + 2) > MQTT_PROP_MAX_PROP_LENGTH) {
-    DBG("MQTT - Error, property too long (max %i bytes)", MQTT_PROP_MAX_PROP_LENGTH);
-    return;
+  if((str_len + 2) > max_len) {
+    DBG("MQTT - Error, property too long (max %i bytes)", max_len);
+    return 0;
   }
 
-  (*prop_out)->val[0] = str_len >> 8;
-  (*prop_out)->val[1] = str_len & 0x00FF;
-  memcpy((*prop_out)->val + 2, str, str_len);
+  val_out[0] = str_len >> 8;
+  val_out[1] = str_len & 0x00FF;
+  memcpy(val_out + 2, str, str_len);
 
-  (*prop_out)->property_len = str_len + 2;
+  return str_len + 2;
 }
 /*---------------------------------------------------------------------------*/
-static void
-encode_prop_binary(struct mqtt_prop_out_property **prop_out,
+static uint32_t
+encode_prop_binary(uint8_t *val_out, uint32_t max_len,
                    const char *data, int data_len)
 {
   DBG("MQTT - Encoding Binary Data (%d bytes)\n", data_len);
 
-  if((data_len + 2) > MQTT_PROP_MAX_PROP_LENGTH) {
-    DBG("MQTT - Error, property too long (max %i bytes)", MQTT_PROP_MAX_PROP_LENGTH);
-    return;
+  if((data_len + 2) > max_len) {
+    DBG("MQTT - Error, property too long (max %i bytes)", max_len);
+    return 0;
   }
 
-  (*prop_out)->val[0] = data_len >> 8;
-  (*prop_out)->val[1] = data_len & 0x00FF;
-  memcpy((*prop_out)->val + 2, data, data_len);
+  val_out[0] = data_len >> 8;
+  val_out[1] = data_len & 0x00FF;
+  memcpy(val_out + 2, data, data_len);
 
-  (*prop_out)->property_len = data_len + 2;
+  return data_len + 2;
 }
 /*---------------------------------------------------------------------------*/
-static void
-encode_prop_var_byte_int(struct mqtt_prop_out_property **prop_out,
+static uint32_t
+encode_prop_var_byte_int(uint8_t *val_out, uint32_t max_len,
                          int val)
 {
+  uint8_t enc[MQTT_MAX_REMAINING_LENGTH_BYTES];
   uint8_t id_len;
 
   DBG("MQTT - Encoding Variable Byte Integer %d\n", val);
 
-  mqtt_encode_var_byte_int(
-    (*prop_out)->val,
-    &id_len,
-    val);
-
-  (*prop_out)->property_len = id_len;
-}
-/*---------------------------------------------------------------------------*/
-uint32_t
-mqtt_prop_encode(struct mqtt_prop_out_property **prop_out, mqtt_vhdr_prop_t prop_id,
-                 va_list args)
-{
-  DBG("MQTT - Creating property with ID %i\n", prop_id);
+  mqtt_encode_var_byte_int(enc, &id_len, val);
 
-  if(!(*prop_out)) {
-    DBG("MQTT - Error, property target NULL!\n");
+  if(id_len > max_len) {
+    DBG("MQTT - Error, property too long (max %i bytes)", max_len);
     return 0;
   }
 
-  (*prop_out)->property_len = 0;
-  (*prop_out)->id = prop_id;
+  memcpy(val_out, enc, id_len);
 
+  return id_len;
+}
+/*---------------------------------------------------------------------------*/
+/* Encodes the value of a property into val_out, returns its length or 0 */
+static uint32_t
+encode_prop(uint8_t *val_out, uint32_t max_len, mqtt_vhdr_prop_t prop_id,
+            va_list args)
+{
   /* Decode varargs and create encoded property value for selected type */
   switch(prop_id) {
   case MQTT_VHDR_PROP_PAYLOAD_FMT_IND:
@@ -150,9 +146,7 @@ mqtt_prop_encode(struct mqtt_prop_out_property **prop_out, mqtt_vhdr_prop_t prop
     int val;
 
     val = va_arg(args, int);
-    encode_prop_fixed_len_int(prop_out, val, 1);
-
-    break;
+    return encode_prop_fixed_len_int(val_out, max_len, val, 1);
   }
   case MQTT_VHDR_PROP_RECEIVE_MAX:
   case MQTT_VHDR_PROP_TOPIC_ALIAS_MAX:
@@ -160,9 +154,7 @@ mqtt_prop_encode(struct mqtt_prop_out_property **prop_out, mqtt_vhdr_prop_t prop
     int val;
 
     val = va_arg(args, int);
-    encode_prop_fixed_len_int(prop_out, val, 2);
-
-    break;
+    return encode_prop_fixed_len_int(val_out, max_len, val, 2);
   }
   case MQTT_VHDR_PROP_MSG_EXP_INT:
   case MQTT_VHDR_PROP_SESS_EXP_INT:
@@ -171,9 +163,7 @@ mqtt_prop_encode(struct mqtt_prop_out_property **prop_out, mqtt_vhdr_prop_t prop
     int val;
 
     val = va_arg(args, int);
-    encode_prop_fixed_len_int(prop_out, val, 4);
-
-    break;
+    return encode_prop_fixed_len_int(val_out, max_len, val, 4);
   }
   case MQTT_VHDR_PROP_CONTENT_TYPE:
   case MQTT_VHDR_PROP_RESP_TOPIC:
@@ -181,9 +171,7 @@ mqtt_prop_encode(struct mqtt_prop_out_property **prop_out, mqtt_vhdr_prop_t prop
     const char *str;
 
     str = va_arg(args, const char *);
-    encode_prop_utf8(prop_out, str);
-
-    break;
+    return encode_prop_utf8(val_out, max_len, str);
   }
   case MQTT_VHDR_PROP_CORRELATION_DATA:
   case MQTT_VHDR_PROP_AUTH_DATA: {
@@ -193,18 +181,14 @@ mqtt_prop_encode(struct mqtt_prop_out_property **prop_out, mqtt_vhdr_prop_t prop
     data = va_arg(args, const char *);
     data_len = va_arg(args, int);
 
-    encode_prop_binary(prop_out, data, data_len);
-
-    break;
+    return encode_prop_binary(val_out, max_len, data, data_len);
   }
   case MQTT_VHDR_PROP_SUB_ID: {
     int val;
 
     val = va_arg(args, int);
 
-    encode_prop_var_byte_int(prop_out, val);
-
-    break;
+    return encode_prop_var_byte_int(val_out, max_len, val);
   }
   case MQTT_VHDR_PROP_USER_PROP: {
     const char *name;
@@ -221,23 +205,42 @@ mqtt_prop_encode(struct mqtt_prop_out_property **prop_out, mqtt_vhdr_prop_t prop
     DBG("MQTT - Encoding User Property '%s: %s'\n", name, value);
 
     /* 2 bytes are needed for each string to encode its length */
-    if((name_len + val_len + 4) > MQTT_PROP_MAX_PROP_LENGTH) {
-      DBG("MQTT - Error, property '%i' too long (max %i bytes)", prop_id, MQTT_PROP_MAX_PROP_LENGTH);
+    if((name_len + val_len + 4) > max_len) {
+      DBG("MQTT - Error, property '%i' too long (max %i bytes)", prop_id, max_len);
       return 0;
     }
 
-    (*prop_out)->val[0] = name_len >> 8;
-    (*prop_out)->val[1] = name_len & 0x00FF;
-    memcpy((*prop_out)->val + 2, name, strlen(name));
-    (*prop_out)->val[name_len + 2] = val_len >> 8;
-    (*prop_out)->val[name_len + 3] = val_len & 0x00FF;
-    memcpy((*prop_out)->val + name_len + 4, value, strlen(value));
+    val_out[0] = name_len >> 8;
+    val_out[1] = name_len & 0x00FF;
+    memcpy(val_out + 2, name, name_len);
+    val_out[name_len + 2] = val_len >> 8;
+    val_out[name_len + 3] = val_len & 0x00FF;
+    memcpy(val_out + name_len + 4, value, val_len);
 
-    (*prop_out)->property_len = strlen(name) + strlen(value) + 4;
-    break;
+    return name_len + val_len + 4;
   }
   default:
     DBG("MQTT - Error, no such property '%i'\n", prop_id);
+    return 0;
+  }
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+mqtt_prop_encode(struct mqtt_prop_out_property **prop_out, mqtt_vhdr_prop_t prop_id,
+                 va_list args)
+{
+  DBG("MQTT - Creating property with ID %i\n", prop_id);
+
+  if(!(*prop_out)) {
+    DBG("MQTT - Error, property target NULL!\n");
+    return 0;
+  }
+
+  (*prop_out)->id = prop_id;
+  (*prop_out)->property_len = encode_prop((*prop_out)->val,
+                                         MQTT_PROP_MAX_PROP_LENGTH,
+                                         prop_id, args);
+  if((*prop_out)->property_len == 0) {
     *prop_out = NULL;
     return 0;
   }
@@ -480,6 +483,139 @@ parse_prop(struct mqtt_connection *conn,
 }
 /*---------------------------------------------------------------------------*/
 #if MQTT_5
+/* Length of the encoded value of a property, 0 if unknown or truncated */
+static uint32_t
+prop_value_len(mqtt_vhdr_prop_t prop_id, const uint8_t *buf, uint32_t len)
+{
+  uint32_t value_len;
+  uint32_t i;
+
+  switch(prop_id) {
+  case MQTT_VHDR_PROP_PAYLOAD_FMT_IND:
+  case MQTT_VHDR_PROP_REQ_PROBLEM_INFO:
+  case MQTT_VHDR_PROP_REQ_RESP_INFO:
+  case MQTT_VHDR_PROP_MAX_QOS:
+  case MQTT_VHDR_PROP_RETAIN_AVAIL:
+  case MQTT_VHDR_PROP_WILD_SUB_AVAIL:
+  case MQTT_VHDR_PROP_SUB_ID_AVAIL:
+  case MQTT_VHDR_PROP_SHARED_SUB_AVAIL:
+    value_len = 1;
+    break;
+  case MQTT_VHDR_PROP_RECEIVE_MAX:
+  case MQTT_VHDR_PROP_TOPIC_ALIAS_MAX:
+  case MQTT_VHDR_PROP_TOPIC_ALIAS:
+  case MQTT_VHDR_PROP_SERVER_KEEP_ALIVE:
+    value_len = 2;
+    break;
+  case MQTT_VHDR_PROP_MSG_EXP_INT:
+  case MQTT_VHDR_PROP_SESS_EXP_INT:
+  case MQTT_VHDR_PROP_WILL_DELAY_INT:
+  case MQTT_VHDR_PROP_MAX_PKT_SZ:
+    value_len = 4;
+    break;
+  case MQTT_VHDR_PROP_CONTENT_TYPE:
+  case MQTT_VHDR_PROP_RESP_TOPIC:
+  case MQTT_VHDR_PROP_AUTH_METHOD:
+  case MQTT_VHDR_PROP_ASSIGNED_CLIENT_ID:
+  case MQTT_VHDR_PROP_RESP_INFO:
+  case MQTT_VHDR_PROP_SERVER_REFERENCE:
+  case MQTT_VHDR_PROP_REASON_STRING:
+  case MQTT_VHDR_PROP_CORRELATION_DATA:
+  case MQTT_VHDR_PROP_AUTH_DATA:
+    if(len < MQTT_STRING_LEN_SIZE) {
+      return 0;
+    }
+    value_len = MQTT_STRING_LEN_SIZE + ((buf[0] << 8) | buf[1]);
+    break;
+  case MQTT_VHDR_PROP_USER_PROP:
+    if(len < MQTT_STRING_LEN_SIZE) {
+      return 0;
+    }
+    i = MQTT_STRING_LEN_SIZE + ((buf[0] << 8) | buf[1]);
+    if(len < i + MQTT_STRING_LEN_SIZE) {
+      return 0;
+    }
+    value_len = i + MQTT_STRING_LEN_SIZE + ((buf[i] << 8) | buf[i + 1]);
+    break;
+  case MQTT_VHDR_PROP_SUB_ID:
+    for(i = 0; i < len && i < MQTT_MAX_REMAINING_LENGTH_BYTES; i++) {
+      if((buf[i] & 0x80) == 0) {
+        return i + 1;
+      }
+    }
+    return 0;
+  default:
+    DBG("MQTT - Error, no such property '%i'\n", prop_id);
+    return 0;
+  }
+
+  return value_len <= len ? value_len : 0;
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+mqtt_prop_find(struct mqtt_connection *conn,
+               mqtt_vhdr_prop_t prop_id, const uint8_t **value)
+{
+  const uint8_t *pos;
+  const uint8_t *end;
+  uint32_t value_len;
+  mqtt_vhdr_prop_t id;
+
+  if(!conn->in_packet.has_props) {
+    return 0;
+  }
+
+  pos = conn->in_packet.props_start;
+  end = MIN(conn->in_packet.props_start + conn->in_packet.properties_len,
+            conn->in_packet.payload + MQTT_INPUT_BUFF_SIZE);
+  if(*value != NULL) {
+    /* Continue after the previous occurrence */
+    pos = *value + prop_value_len(prop_id, *value, end - *value);
+  }
+
+  /* Property identifiers all fit in a single Variable Byte Integer byte */
+  while(pos < end && (*pos & 0x80) == 0) {
+    id = *pos++;
+    value_len = prop_value_len(id, pos, end - pos);
+    if(value_len == 0) {
+      break;
+    }
+    if(id == prop_id) {
+      *value = pos;
+      return value_len;
+    }
+    pos += value_len;
+  }
+
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+mqtt_prop_get_int(struct mqtt_connection *conn,
+                  mqtt_vhdr_prop_t prop_id, uint32_t *val)
+{
+  const uint8_t *value = NULL;
+  uint32_t value_len;
+  uint32_t i;
+
+  value_len = mqtt_prop_find(conn, prop_id, &value);
+  if(value_len == 0) {
+    return 0;
+  }
+
+  *val = 0;
+  if(prop_id == MQTT_VHDR_PROP_SUB_ID) {
+    for(i = 0; i < value_len; i++) {
+      *val |= (uint32_t)(value[i] & 0x7F) << (7 * i);
+    }
+  } else {
+    for(i = 0; i < value_len; i++) {
+      *val = (*val << 8) | value[i];
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
 uint32_t
 mqtt_get_next_in_prop(struct mqtt_connection *conn,
                       mqtt_vhdr_prop_t *prop_id, uint8_t *data)
@@ -524,86 +660,59 @@ mqtt_get_next_in_prop(struct mqtt_connection *conn,
 void
 mqtt_prop_parse_connack_props(struct mqtt_connection *conn)
 {
-  uint32_t prop_len;
-  mqtt_vhdr_prop_t prop_id;
-  uint8_t data[MQTT_PROP_MAX_PROP_LENGTH];
   uint32_t val_int;
 
   DBG("MQTT - Parsing CONNACK properties for server capabilities\n");
 
-  prop_len = mqtt_get_next_in_prop(conn, &prop_id, data);
-  while(prop_len) {
-    switch(prop_id) {
-    case MQTT_VHDR_PROP_RETAIN_AVAIL: {
-      val_int = (uint32_t)*data;
-      if(val_int == 0) {
-        conn->srv_feature_en &= ~MQTT_CAP_RETAIN_AVAIL;
-      }
-      break;
-    }
-    case MQTT_VHDR_PROP_WILD_SUB_AVAIL: {
-      val_int = (uint32_t)*data;
-      if(val_int == 0) {
-        conn->srv_feature_en &= ~MQTT_CAP_WILD_SUB_AVAIL;
-      }
-      break;
-    }
-    case MQTT_VHDR_PROP_SUB_ID_AVAIL: {
-      val_int = (uint32_t)*data;
-      if(val_int == 0) {
-        conn->srv_feature_en &= ~MQTT_CAP_SUB_ID_AVAIL;
-      }
-      break;
-    }
-    case MQTT_VHDR_PROP_SHARED_SUB_AVAIL:  {
-      val_int = (uint32_t)*data;
-      if(val_int == 0) {
-        conn->srv_feature_en &= ~MQTT_CAP_SHARED_SUB_AVAIL;
-      }
-      break;
-    }
-    default:
-      DBG("MQTT - Error, unexpected CONNACK property '%i'", prop_id);
-      return;
-    }
-
-    prop_id = 0;
-    prop_len = mqtt_get_next_in_prop(conn, &prop_id, data);
+  if(mqtt_prop_get_int(conn, MQTT_VHDR_PROP_RETAIN_AVAIL, &val_int) &&
+     val_int == 0) {
+    conn->srv_feature_en &= ~MQTT_CAP_RETAIN_AVAIL;
+  }
+  if(mqtt_prop_get_int(conn, MQTT_VHDR_PROP_WILD_SUB_AVAIL, &val_int) &&
+     val_int == 0) {
+    conn->srv_feature_en &= ~MQTT_CAP_WILD_SUB_AVAIL;
+  }
+  if(mqtt_prop_get_int(conn, MQTT_VHDR_PROP_SUB_ID_AVAIL, &val_int) &&
+     val_int == 0) {
+    conn->srv_feature_en &= ~MQTT_CAP_SUB_ID_AVAIL;
+  }
+  if(mqtt_prop_get_int(conn, MQTT_VHDR_PROP_SHARED_SUB_AVAIL, &val_int) &&
+     val_int == 0) {
+    conn->srv_feature_en &= ~MQTT_CAP_SHARED_SUB_AVAIL;
   }
 }
 /*---------------------------------------------------------------------------*/
 void
 mqtt_prop_parse_auth_props(struct mqtt_connection *conn, struct mqtt_prop_auth_event *event)
 {
+  const uint8_t *value = NULL;
   uint32_t prop_len;
-  mqtt_vhdr_prop_t prop_id;
-  uint8_t data[MQTT_PROP_MAX_PROP_LENGTH];
 
-  DBG("MQTT - Parsing CONNACK properties for server capabilities\n");
+  DBG("MQTT - Parsing AUTH properties\n");
 
   event->auth_data.len = 0;
   event->auth_method.length = 0;
+  event->method_buf[0] = '\0';
+  event->auth_method.string = event->method_buf;
+
+  /* 2 bytes are used to encode len */
+  prop_len = mqtt_prop_find(conn, MQTT_VHDR_PROP_AUTH_DATA, &value);
+  if(prop_len > MQTT_STRING_LEN_SIZE &&
+     prop_len - MQTT_STRING_LEN_SIZE <= MQTT_PROP_MAX_PROP_LENGTH) {
+    event->auth_data.len = prop_len - MQTT_STRING_LEN_SIZE;
+    memcpy(event->auth_data.data, value + MQTT_STRING_LEN_SIZE,
+           event->auth_data.len);
+  }
 
-  prop_len = mqtt_get_next_in_prop(conn, &prop_id, data);
-  while(prop_len) {
-    switch(prop_id) {
-    case MQTT_VHDR_PROP_AUTH_DATA: {
-      event->auth_data.len = prop_len - 2; /* 2 bytes are used to encode len */
-      memcpy(event->auth_data.data, data, prop_len - 2);
-      break;
-    }
-    case MQTT_VHDR_PROP_AUTH_METHOD: {
-      event->auth_method.length = prop_len - 2; /* 2 bytes are used to encode len */
-      memcpy(event->auth_method.string, data, prop_len - 2);
-      break;
-    }
-    default:
-      DBG("MQTT - Unhandled AUTH property '%i'", prop_id);
-      return;
-    }
-
-    prop_id = 0;
-    prop_len = mqtt_get_next_in_prop(conn, &prop_id, data);
+  /* The packet is not NULL-terminated, copy the method out of it */
+  value = NULL;
+  prop_len = mqtt_prop_find(conn, MQTT_VHDR_PROP_AUTH_METHOD, &value);
+  if(prop_len > MQTT_STRING_LEN_SIZE &&
+     prop_len - MQTT_STRING_LEN_SIZE <= MQTT_PROP_MAX_PROP_LENGTH) {
+    event->auth_method.length = prop_len - MQTT_STRING_LEN_SIZE;
+    memcpy(event->method_buf, value + MQTT_STRING_LEN_SIZE,
+           event->auth_method.length);
+    event->method_buf[event->auth_method.length] = '\0';
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -702,6 +811,70 @@ mqtt_prop_create_list(struct mqtt_prop_list **prop_list_out)
 
   (*prop_list_out)->properties_len = 0;
   (*prop_list_out)->properties_len_enc_bytes = 1; /* 1 byte needed for len = 0 */
+  (*prop_list_out)->buf = NULL;
+}
+/*----------------------------------------------------------------------------*/
+void
+mqtt_prop_create_buf_list(struct mqtt_prop_list *prop_list,
+                          uint8_t *buf, uint16_t buf_size)
+{
+  DBG("MQTT - Creating Property List in a %u-byte buffer\n", buf_size);
+
+  /* The total length must fit in properties_len_enc */
+  buf_size = MIN(buf_size, (1UL << (7 * MQTT_PROP_MAX_PROP_LEN_BYTES)) - 1);
+
+  LIST_STRUCT_INIT(prop_list, props);
+  prop_list->properties_len = 0;
+  prop_list->properties_len_enc[0] = 0;
+  prop_list->properties_len_enc_bytes = 1; /* 1 byte needed for len = 0 */
+  prop_list->buf = buf;
+  prop_list->buf_size = buf_size;
+}
+/*----------------------------------------------------------------------------*/
+static uint8_t
+buf_list_add(struct mqtt_prop_list *prop_list, mqtt_vhdr_prop_t prop_id,
+             va_list args)
+{
+  uint8_t *pos;
+  uint32_t prop_len;
+
+  pos = prop_list->buf + prop_list->properties_len;
+  if(prop_list->properties_len >= prop_list->buf_size) {
+    DBG("MQTT - Error, property buffer full\n");
+    return 1;
+  }
+
+  prop_len = encode_prop(pos + 1, prop_list->buf_size -
+                         prop_list->properties_len - 1, prop_id, args);
+  if(prop_len == 0) {
+    DBG("MQTT - Error encoding prop %i into buffer\n", prop_id);
+    return 1;
+  }
+  *pos = prop_id;
+
+  prop_list->properties_len += 1 + prop_len;
+  mqtt_encode_var_byte_int(prop_list->properties_len_enc,
+                           &prop_list->properties_len_enc_bytes,
+                           prop_list->properties_len);
+  DBG("MQTT - New prop_list length %i\n", prop_list->properties_len);
+  return 0;
+}
+/*----------------------------------------------------------------------------*/
+uint8_t
+mqtt_prop_add(struct mqtt_prop_list *prop_list, mqtt_vhdr_prop_t prop_id, ...)
+{
+  va_list args;
+  uint8_t ret;
+
+  if(prop_list == NULL || prop_list->buf == NULL) {
+    DBG("MQTT - Error, not a buffer property list\n");
+    return 1;
+  }
+
+  va_start(args, prop_id);
+  ret = buf_list_add(prop_list, prop_id, args);
+  va_end(args);
+  return ret;
 }
 /*----------------------------------------------------------------------------*/
 /* Prints all properties in the given property list (debug)
@@ -715,6 +888,9 @@ mqtt_prop_print_list(struct mqtt_prop_list *prop_list, mqtt_vhdr_prop_t prop_id)
 
   if(prop_list == NULL || prop_list->props == NULL) {
     DBG("MQTT - Prop list empty\n");
+  } else if(prop_list->buf != NULL) {
+    DBG("Property buffer %p len %i\n", prop_list->buf,
+        prop_list->properties_len);
   } else {
     prop = (struct mqtt_prop_out_property *)list_head(prop_list->props);
 
@@ -739,6 +915,7 @@ mqtt_prop_register(struct mqtt_prop_list **prop_list,
 #if MQTT_PROP_USE_MEMB
   struct mqtt_prop_out_property *prop;
 #endif
+  struct mqtt_prop_out_property *allocated;
   va_list args;
   uint32_t prop_len;
 
@@ -755,6 +932,15 @@ mqtt_prop_register(struct mqtt_prop_list **prop_list,
   DBG("MQTT - prop list %p\n", *prop_list);
   DBG("MQTT - prop list->list %p\n", (*prop_list)->props);
 
+  if((*prop_list)->buf != NULL) {
+    if(prop_out) {
+      *prop_out = NULL;
+    }
+    prop_len = buf_list_add(*prop_list, prop_id, args);
+    va_end(args);
+    return prop_len;
+  }
+
 #if MQTT_PROP_USE_MEMB
   prop = (struct mqtt_prop_out_property *)memb_alloc(&props_mem);
 #endif
@@ -762,11 +948,13 @@ mqtt_prop_register(struct mqtt_prop_list **prop_list,
   if(!prop) {
     DBG("MQTT - Error, allocated too many properties (max %i)\n", MQTT_PROP_MAX_OUT_PROPS);
     prop_out = NULL;
+    va_end(args);
     return 1;
   }
 
   DBG("MQTT - Allocated prop %p\n", prop);
 
+  allocated = prop;
   prop_len = mqtt_prop_encode(&prop, prop_id, args);
 
   if(prop) {
@@ -782,7 +970,7 @@ mqtt_prop_register(struct mqtt_prop_list **prop_list,
   } else {
     DBG("MQTT - Error encoding prop %i on msg %i\n", prop_id, msg);
 #if MQTT_PROP_USE_MEMB
-    memb_free(&props_mem, prop);
+    memb_free(&props_mem, allocated);
 #endif
     va_end(args);
     prop_out = NULL;
@@ -834,6 +1022,12 @@ mqtt_prop_clear_list(struct mqtt_prop_list **prop_list)
 
   DBG("MQTT - Clearing Property List\n");
 
+  if(prop_list != NULL && (*prop_list)->buf != NULL) {
+    mqtt_prop_create_buf_list(*prop_list, (*prop_list)->buf,
+                              (*prop_list)->buf_size);
+    return;
+  }
+
   if(prop_list == NULL || list_length((*prop_list)->props) == 0) {
     DBG("MQTT - Prop list empty\n");
     return;
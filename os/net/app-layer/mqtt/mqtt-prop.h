@@ -69,6 +69,9 @@ struct mqtt_prop_list {
   uint8_t properties_len_enc[MQTT_PROP_MAX_PROP_LEN_BYTES];
   uint8_t properties_len_enc_bytes;
   LIST_STRUCT(props);
+  /* Properties encoded into this buffer as they are added, instead of props */
+  uint8_t *buf;
+  uint16_t buf_size;
 };
 
 /* This struct represents output packet Properties (MQTTv5.0). */
@@ -92,9 +95,16 @@ struct mqtt_prop_bin_data {
   uint8_t data[MQTT_PROP_MAX_PROP_LENGTH];
 };
 
+/*
+ * Passed with MQTT_EVENT_AUTH. auth_method.string points to method_buf: the
+ * method is copied out of the packet and NULL-terminated, so it can be
+ * registered again as is. The event, and the copy, belong to the caller of
+ * mqtt_prop_parse_auth_props().
+ */
 struct mqtt_prop_auth_event {
   struct mqtt_string auth_method;
   struct mqtt_prop_bin_data auth_data;
+  char method_buf[MQTT_PROP_MAX_PROP_LENGTH + 1];
 };
 /*----------------------------------------------------------------------------*/
 void mqtt_prop_print_input_props(struct mqtt_connection *conn);
@@ -118,6 +128,33 @@ uint8_t mqtt_prop_register(struct mqtt_prop_list **prop_list,
 
 void mqtt_prop_create_list(struct mqtt_prop_list **prop_list_out);
 
+/* Sets up a list that encodes its properties straight into buf, in wire
+ * format. Nothing is allocated, the list and buf are owned by the caller.
+ * mqtt_prop_register() and mqtt_prop_add() append to it.
+ */
+void mqtt_prop_create_buf_list(struct mqtt_prop_list *prop_list,
+                               uint8_t *buf, uint16_t buf_size);
+
+/* Appends a property to a list set up with mqtt_prop_create_buf_list().
+ * Returns 0 on success, 1 if the property is unknown or does not fit.
+ */
+uint8_t mqtt_prop_add(struct mqtt_prop_list *prop_list,
+                      mqtt_vhdr_prop_t prop_id, ...);
+
+/* Looks up a property of the received packet in its raw encoding. Set *value
+ * to NULL to find the first occurrence, or leave the previous result in it to
+ * find the next one. Returns the length of the value *value points to, which
+ * includes the length field of strings and binary data, or 0 if not found.
+ */
+uint32_t mqtt_prop_find(struct mqtt_connection *conn,
+                        mqtt_vhdr_prop_t prop_id, const uint8_t **value);
+
+/* Looks up an integer property of the received packet. Returns 1 and sets
+ * *val if found.
+ */
+uint8_t mqtt_prop_get_int(struct mqtt_connection *conn,
+                          mqtt_vhdr_prop_t prop_id, uint32_t *val);
+
 void mqtt_prop_print_list(struct mqtt_prop_list *prop_list, mqtt_vhdr_prop_t prop_id);
 
 void mqtt_prop_clear_list(struct mqtt_prop_list **prop_list);
@@ -59,6 +59,11 @@
 #include "lib/list.h"
 #include "sys/cc.h"
 
+#if MQTT_WITH_SESSION_STORE
+#include "cfs/cfs.h"
+#include "lib/crc16.h"
+#endif
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -172,12 +177,16 @@ typedef enum {
 #define PT_MQTT_WRITE_BYTES(conn, data, len)                                   \
   conn->out_write_pos = 0;                                                     \
   while(write_bytes(conn, data, len)) {                                        \
+    (conn)->out_writing = 1;                                                   \
     PT_WAIT_UNTIL(pt, (conn)->out_buffer_sent);                                \
+    (conn)->out_writing = 0;                                                   \
   }
 
 #define PT_MQTT_WRITE_BYTE(conn, data)                                         \
   while(write_byte(conn, data)) {                                              \
+    (conn)->out_writing = 1;                                                   \
     PT_WAIT_UNTIL(pt, (conn)->out_buffer_sent);                                \
+    (conn)->out_writing = 0;                                                   \
   }
 /*---------------------------------------------------------------------------*/
 /*
@@ -232,6 +241,7 @@ static void tcp_event(struct tcp_socket *s, void *ptr,
                       tcp_socket_event_t event);
 
 static void reset_packet(struct mqtt_in_packet *packet);
+static void inflight_reset(struct mqtt_connection *conn);
 /*---------------------------------------------------------------------------*/
 LIST(mqtt_conn_list);
 /*---------------------------------------------------------------------------*/
@@ -251,6 +261,7 @@ reset_defaults(struct mqtt_connection *conn)
 {
   conn->mid_counter = 1;
   PT_INIT(&conn->out_proto_thread);
+  conn->out_writing = 0;
   conn->waiting_for_pingresp = 0;
 
   reset_packet(&conn->in_packet);
@@ -262,6 +273,8 @@ abort_connection(struct mqtt_connection *conn)
 {
   conn->out_buffer_ptr = conn->out_buffer;
   conn->out_queue_full = 0;
+  conn->out_writing = 0;
+  ctimer_stop(&conn->keep_alive_timer);
 
   /* Reset outgoing packet */
   memset(&conn->out_packet, 0, sizeof(conn->out_packet));
@@ -280,6 +293,7 @@ connect_tcp(struct mqtt_connection *conn)
   conn->state = MQTT_CONN_STATE_TCP_CONNECTING;
 
   reset_defaults(conn);
+  inflight_reset(conn);
   tcp_socket_register(&(conn->socket),
                       conn,
                       conn->in_buffer,
@@ -301,11 +315,20 @@ disconnect_tcp(struct mqtt_connection *conn)
   memset(&conn->socket, 0, sizeof(conn->socket));
 }
 /*---------------------------------------------------------------------------*/
+/*
+ * The output buffer is also the output buffer of the socket. Its first
+ * tcp_socket_queuelen() bytes are queued in the socket, anything written
+ * after them up to out_buffer_ptr is appended to that queue here.
+ */
 static void
 send_out_buffer(struct mqtt_connection *conn)
 {
-  if(conn->out_buffer_ptr - conn->out_buffer == 0) {
-    conn->out_buffer_sent = 1;
+  uint8_t *unsent = conn->out_buffer + tcp_socket_queuelen(&conn->socket);
+
+  if(conn->out_buffer_ptr - unsent == 0) {
+    if(unsent == conn->out_buffer) {
+      conn->out_buffer_sent = 1;
+    }
     return;
   }
   conn->out_buffer_sent = 0;
@@ -313,8 +336,7 @@ send_out_buffer(struct mqtt_connection *conn)
   DBG("MQTT - (send_out_buffer) Space used in buffer: %i\n",
       conn->out_buffer_ptr - conn->out_buffer);
 
-  tcp_socket_send(&conn->socket, conn->out_buffer,
-                  conn->out_buffer_ptr - conn->out_buffer);
+  tcp_socket_send(&conn->socket, unsent, conn->out_buffer_ptr - unsent);
 }
 /*---------------------------------------------------------------------------*/
 static void
@@ -373,6 +395,259 @@ write_bytes(struct mqtt_connection *conn, uint8_t *data, uint16_t len)
   }
 }
 /*---------------------------------------------------------------------------*/
+static struct mqtt_inflight *
+inflight_lookup(struct mqtt_connection *conn, uint16_t mid)
+{
+  int i;
+
+  for(i = 0; i < MQTT_MAX_INFLIGHT; i++) {
+    if(conn->inflight[i].state != MQTT_INFLIGHT_FREE &&
+       conn->inflight[i].mid == mid) {
+      return &conn->inflight[i];
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static struct mqtt_inflight *
+inflight_alloc(struct mqtt_connection *conn)
+{
+  int i;
+
+  for(i = 0; i < MQTT_MAX_INFLIGHT; i++) {
+    if(conn->inflight[i].state == MQTT_INFLIGHT_FREE) {
+      return &conn->inflight[i];
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+/* Message IDs of unacknowledged messages may not be reused */
+static uint16_t
+next_mid(struct mqtt_connection *conn)
+{
+  do {
+    INCREMENT_MID(conn);
+  } while(inflight_lookup(conn, conn->mid_counter) != NULL);
+  return conn->mid_counter;
+}
+/*---------------------------------------------------------------------------*/
+#if MQTT_WITH_SESSION_STORE
+/*
+ * Each stored message is a file named after the client ID and the slot in the
+ * in-flight table, holding the message ID and state followed by the packet to
+ * send again on reconnect: the PUBLISH with the DUP flag set, or the PUBREL.
+ */
+#define SESSION_HDR_LEN 3
+#define SESSION_NAME_LEN 12
+
+static void
+session_name(struct mqtt_connection *conn, struct mqtt_inflight *f,
+             char *name)
+{
+  snprintf(name, SESSION_NAME_LEN, "mq%04x.%u",
+           crc16_data((unsigned char *)conn->client_id.string,
+                      conn->client_id.length, 0),
+           (unsigned)(f - conn->inflight));
+}
+/*---------------------------------------------------------------------------*/
+static void
+session_remove(struct mqtt_connection *conn, struct mqtt_inflight *f)
+{
+  char name[SESSION_NAME_LEN];
+
+  if(f->stored_len > 0) {
+    session_name(conn, f, name);
+    cfs_remove(name);
+    f->stored_len = 0;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+session_write(struct mqtt_connection *conn, struct mqtt_inflight *f,
+              uint8_t state, const uint8_t *hdr, uint16_t hdr_len,
+              const uint8_t *payload, uint16_t payload_len)
+{
+  char name[SESSION_NAME_LEN];
+  uint8_t session_hdr[SESSION_HDR_LEN];
+  int fd;
+
+  session_remove(conn, f);
+  session_name(conn, f, name);
+  fd = cfs_open(name, CFS_WRITE);
+  if(fd < 0) {
+    PRINTF("MQTT - Error, cannot store message %u\n", f->mid);
+    return;
+  }
+  session_hdr[0] = f->mid >> 8;
+  session_hdr[1] = f->mid & 0x00FF;
+  session_hdr[2] = state;
+  if(cfs_write(fd, session_hdr, SESSION_HDR_LEN) == SESSION_HDR_LEN &&
+     cfs_write(fd, hdr, hdr_len) == hdr_len &&
+     (payload_len == 0 ||
+      cfs_write(fd, payload, payload_len) == payload_len)) {
+    f->stored_len = hdr_len + payload_len;
+  }
+  cfs_close(fd);
+  if(f->stored_len == 0) {
+    PRINTF("MQTT - Error, cannot store message %u\n", f->mid);
+    cfs_remove(name);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+session_store_publish(struct mqtt_connection *conn, struct mqtt_inflight *f)
+{
+  uint8_t hdr[MQTT_FHDR_SIZE + MQTT_MAX_REMAINING_LENGTH_BYTES +
+              MQTT_STRING_LEN_SIZE + MQTT_MAX_TOPIC_LENGTH + MQTT_MID_SIZE + 1];
+  struct mqtt_out_packet *p = &conn->out_packet;
+  uint8_t *ptr = hdr;
+
+  if(MQTT_FHDR_SIZE + p->remaining_length_enc_bytes + p->remaining_length >
+     MQTT_TCP_OUTPUT_BUFF_SIZE || p->topic_length > MQTT_MAX_TOPIC_LENGTH) {
+    return;
+  }
+#if MQTT_5
+  if(conn->out_props != NULL) {
+    return;
+  }
+#endif
+
+  *ptr++ = p->fhdr | MQTT_FHDR_DUP_FLAG;
+  memcpy(ptr, p->remaining_length_enc, p->remaining_length_enc_bytes);
+  ptr += p->remaining_length_enc_bytes;
+  *ptr++ = p->topic_length >> 8;
+  *ptr++ = p->topic_length & 0x00FF;
+  memcpy(ptr, p->topic, p->topic_length);
+  ptr += p->topic_length;
+  *ptr++ = p->mid >> 8;
+  *ptr++ = p->mid & 0x00FF;
+#if MQTT_5
+  *ptr++ = 0;
+#endif
+  session_write(conn, f, f->state, hdr, ptr - hdr,
+                p->payload, p->payload_size);
+}
+/*---------------------------------------------------------------------------*/
+static void
+session_store_pubrel(struct mqtt_connection *conn, struct mqtt_inflight *f)
+{
+  uint8_t pubrel[4];
+
+  pubrel[0] = MQTT_FHDR_MSG_TYPE_PUBREL | MQTT_FHDR_QOS_LEVEL_1;
+  pubrel[1] = MQTT_MID_SIZE;
+  pubrel[2] = f->mid >> 8;
+  pubrel[3] = f->mid & 0x00FF;
+  session_write(conn, f, MQTT_INFLIGHT_WAIT_PUBCOMP, pubrel, sizeof(pubrel),
+                NULL, 0);
+}
+/*---------------------------------------------------------------------------*/
+static int
+session_read(struct mqtt_connection *conn, struct mqtt_inflight *f,
+             uint8_t *buf)
+{
+  char name[SESSION_NAME_LEN];
+  int fd;
+  int ok;
+
+  session_name(conn, f, name);
+  fd = cfs_open(name, CFS_READ);
+  if(fd < 0) {
+    return 0;
+  }
+  ok = cfs_seek(fd, SESSION_HDR_LEN, CFS_SEEK_SET) == SESSION_HDR_LEN &&
+    cfs_read(fd, buf, f->stored_len) == f->stored_len;
+  cfs_close(fd);
+  return ok;
+}
+/*---------------------------------------------------------------------------*/
+/* Restores the in-flight table of a previous run */
+static void
+session_load(struct mqtt_connection *conn)
+{
+  char name[SESSION_NAME_LEN];
+  uint8_t session_hdr[SESSION_HDR_LEN];
+  struct mqtt_inflight *f;
+  cfs_offset_t len;
+  int fd;
+
+  for(f = conn->inflight; f < &conn->inflight[MQTT_MAX_INFLIGHT]; f++) {
+    session_name(conn, f, name);
+    fd = cfs_open(name, CFS_READ);
+    if(fd < 0) {
+      continue;
+    }
+    len = cfs_seek(fd, 0, CFS_SEEK_END);
+    if(cfs_seek(fd, 0, CFS_SEEK_SET) == 0 &&
+       cfs_read(fd, session_hdr, SESSION_HDR_LEN) == SESSION_HDR_LEN &&
+       len > SESSION_HDR_LEN && len - SESSION_HDR_LEN <= MQTT_TCP_OUTPUT_BUFF_SIZE) {
+      f->mid = (session_hdr[0] << 8) | session_hdr[1];
+      f->state = session_hdr[2];
+      f->stored_len = len - SESSION_HDR_LEN;
+      DBG("MQTT - Restored message %u\n", f->mid);
+    }
+    cfs_close(fd);
+  }
+}
+#endif /* MQTT_WITH_SESSION_STORE */
+/*---------------------------------------------------------------------------*/
+static void
+inflight_free(struct mqtt_connection *conn, struct mqtt_inflight *f)
+{
+#if MQTT_WITH_SESSION_STORE
+  session_remove(conn, f);
+#endif
+  f->state = MQTT_INFLIGHT_FREE;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Forgets the messages that will not be sent again on the new connection:
+ * all of them with a clean session, else those not in the session store.
+ */
+static void
+inflight_reset(struct mqtt_connection *conn)
+{
+  int i;
+
+  for(i = 0; i < MQTT_MAX_INFLIGHT; i++) {
+    if(conn->inflight[i].stored_len == 0 ||
+       (conn->connect_vhdr_flags & MQTT_VHDR_CLEAN_SESSION_FLAG)) {
+      inflight_free(conn, &conn->inflight[i]);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Sends the PUBRELs due, unless the protothread is in the middle of a packet
+ * or the buffer is full. Called again once more data has been acknowledged.
+ */
+static void
+send_pubrels(struct mqtt_connection *conn)
+{
+  int i;
+  uint8_t *start = conn->out_buffer_ptr;
+
+  for(i = 0; i < MQTT_MAX_INFLIGHT; i++) {
+    if(conn->inflight[i].state != MQTT_INFLIGHT_SEND_PUBREL) {
+      continue;
+    }
+    if(conn->out_writing ||
+       conn->state != MQTT_CONN_STATE_CONNECTED_TO_BROKER ||
+       &conn->out_buffer[MQTT_TCP_OUTPUT_BUFF_SIZE] - conn->out_buffer_ptr <
+       MQTT_FHDR_SIZE + 1 + MQTT_MID_SIZE) {
+      break;
+    }
+    *conn->out_buffer_ptr++ = MQTT_FHDR_MSG_TYPE_PUBREL | MQTT_FHDR_QOS_LEVEL_1;
+    *conn->out_buffer_ptr++ = MQTT_MID_SIZE;
+    *conn->out_buffer_ptr++ = conn->inflight[i].mid >> 8;
+    *conn->out_buffer_ptr++ = conn->inflight[i].mid & 0x00FF;
+    conn->inflight[i].state = MQTT_INFLIGHT_WAIT_PUBCOMP;
+  }
+  if(conn->out_buffer_ptr != start) {
+    send_out_buffer(conn);
+  }
+}
+/*---------------------------------------------------------------------------*/
 uint8_t
 mqtt_decode_var_byte_int(const uint8_t *input_data_ptr,
                          int input_data_len,
@@ -477,6 +752,12 @@ PT_THREAD(write_out_props(struct pt *pt, struct mqtt_connection *conn,
                         prop_list->properties_len_enc,
                         prop_list->properties_len_enc_bytes);
 
+    /* Already encoded */
+    if(prop_list->buf) {
+      PT_MQTT_WRITE_BYTES(conn, prop_list->buf, prop_list->properties_len);
+      PT_EXIT(pt);
+    }
+
     prop = (struct mqtt_prop_out_property *)list_head(prop_list->props);
     do {
       if(prop != NULL) {
@@ -501,6 +782,10 @@ PT_THREAD(write_out_props(struct pt *pt, struct mqtt_connection *conn,
 static
 PT_THREAD(connect_pt(struct pt *pt, struct mqtt_connection *conn))
 {
+#if MQTT_WITH_SESSION_STORE
+  static struct mqtt_inflight *f;
+#endif
+
   PT_BEGIN(pt);
 
 #if MQTT_5
@@ -566,7 +851,8 @@ PT_THREAD(connect_pt(struct pt *pt, struct mqtt_connection *conn))
 
 #if MQTT_5
   /* Write Properties */
-  write_out_props(pt, conn, conn->out_props);
+  PT_SPAWN(pt, &conn->out_props_thread,
+           write_out_props(&conn->out_props_thread, conn, conn->out_props));
 #endif
 
   /* Write Payload */
@@ -579,7 +865,8 @@ PT_THREAD(connect_pt(struct pt *pt, struct mqtt_connection *conn))
 #if MQTT_5
     /* Write Will Properties */
     DBG("MQTT - Writing will properties\n");
-    write_out_props(pt, conn, will_props);
+    PT_SPAWN(pt, &conn->out_props_thread,
+             write_out_props(&conn->out_props_thread, conn, will_props));
 #endif
     PT_MQTT_WRITE_BYTE(conn, conn->will.topic.length >> 8);
     PT_MQTT_WRITE_BYTE(conn, conn->will.topic.length & 0x00FF);
@@ -631,6 +918,29 @@ PT_THREAD(connect_pt(struct pt *pt, struct mqtt_connection *conn))
   }
   reset_packet(&conn->in_packet);
 
+#if MQTT_WITH_SESSION_STORE
+  /* Send the unacknowledged messages of the session again */
+  for(f = conn->inflight; f < &conn->inflight[MQTT_MAX_INFLIGHT]; f++) {
+    if(f->state == MQTT_INFLIGHT_FREE || f->stored_len == 0) {
+      continue;
+    }
+    PT_WAIT_UNTIL(pt, conn->state != MQTT_CONN_STATE_CONNECTED_TO_BROKER ||
+                  &conn->out_buffer[MQTT_TCP_OUTPUT_BUFF_SIZE] -
+                  conn->out_buffer_ptr >= f->stored_len);
+    if(conn->state != MQTT_CONN_STATE_CONNECTED_TO_BROKER) {
+      PT_EXIT(pt);
+    }
+    if(session_read(conn, f, conn->out_buffer_ptr)) {
+      DBG("MQTT - Resending message %u\n", f->mid);
+      conn->out_buffer_ptr += f->stored_len;
+      if(f->state == MQTT_INFLIGHT_SEND_PUBREL) {
+        f->state = MQTT_INFLIGHT_WAIT_PUBCOMP;
+      }
+      send_out_buffer(conn);
+    }
+  }
+#endif /* MQTT_WITH_SESSION_STORE */
+
   DBG("MQTT - Done sending CONNECT\n");
 
 #if DEBUG_MQTT == 1
@@ -655,7 +965,8 @@ PT_THREAD(disconnect_pt(struct pt *pt, struct mqtt_connection *conn))
 
 #if MQTT_5
 /* Write Properties */
-  write_out_props(pt, conn, conn->out_props);
+  PT_SPAWN(pt, &conn->out_props_thread,
+           write_out_props(&conn->out_props_thread, conn, conn->out_props));
 #endif
 
   send_out_buffer(conn);
@@ -715,7 +1026,8 @@ PT_THREAD(subscribe_pt(struct pt *pt, struct mqtt_connection *conn))
 
 #if MQTT_5
   /* Write Properties */
-  write_out_props(pt, conn, conn->out_props);
+  PT_SPAWN(pt, &conn->out_props_thread,
+           write_out_props(&conn->out_props_thread, conn, conn->out_props));
 #endif
 
   /* Write Payload */
@@ -795,7 +1107,8 @@ PT_THREAD(unsubscribe_pt(struct pt *pt, struct mqtt_connection *conn))
   PT_MQTT_WRITE_BYTE(conn, (conn->out_packet.mid & 0x00FF));
 #if MQTT_5
   /* Write Properties */
-  write_out_props(pt, conn, conn->out_props);
+  PT_SPAWN(pt, &conn->out_props_thread,
+           write_out_props(&conn->out_props_thread, conn, conn->out_props));
 #endif
 
   /* Write Payload */
@@ -887,7 +1200,8 @@ PT_THREAD(publish_pt(struct pt *pt, struct mqtt_connection *conn))
 
 #if MQTT_5
   /* Write Properties */
-  write_out_props(pt, conn, conn->out_props);
+  PT_SPAWN(pt, &conn->out_props_thread,
+           write_out_props(&conn->out_props_thread, conn, conn->out_props));
 #endif
 
   /* Write Payload */
@@ -896,36 +1210,19 @@ PT_THREAD(publish_pt(struct pt *pt, struct mqtt_connection *conn))
                       conn->out_packet.payload_size);
 
   send_out_buffer(conn);
-  timer_set(&conn->t, RESPONSE_WAIT_TIMEOUT);
 
-  /*
-   * If QoS is zero then wait until the message has been sent, since there is
-   * no ACK to wait for.
-   *
-   * Also notify the app will not be notified via PUBACK or PUBCOMP
-   */
-  if(conn->out_packet.qos == 0) {
-    process_post(conn->app_process, mqtt_update_event, NULL);
-  } else if(conn->out_packet.qos == 1) {
-    /* Wait for PUBACK */
-    reset_packet(&conn->in_packet);
-    PT_WAIT_UNTIL(pt, conn->out_packet.qos_state == MQTT_QOS_STATE_GOT_ACK ||
-                  timer_expired(&conn->t));
-    if(timer_expired(&conn->t)) {
-      DBG("Timeout waiting for PUBACK\n");
-    }
-    if(conn->in_packet.mid != conn->out_packet.mid) {
-      DBG("MQTT - Warning, got PUBACK with none matching MID. Currently there "
-          "is no support for several concurrent PUBLISH messages.\n");
-    }
-  } else if(conn->out_packet.qos == 2) {
-    DBG("MQTT - QoS not implemented yet.\n");
-    /* Should wait for PUBREC, send PUBREL and then wait for PUBCOMP */
+#if MQTT_WITH_SESSION_STORE
+  if(conn->out_packet.qos > MQTT_QOS_LEVEL_0) {
+    session_store_publish(conn, inflight_lookup(conn, conn->out_packet.mid));
   }
+#endif
 
-  reset_packet(&conn->in_packet);
+  /*
+   * QoS 1 and 2 messages are acknowledged in the in-flight table, the app is
+   * notified via PUBACK or PUBCOMP. Another message can be published now.
+   */
+  process_post(conn->app_process, mqtt_update_event, NULL);
 
-  /* This is clear after the entire transaction is complete */
   conn->out_queue_full = 0;
 
   DBG("MQTT - Publish Enqueued\n");
@@ -933,6 +1230,77 @@ PT_THREAD(publish_pt(struct pt *pt, struct mqtt_connection *conn))
   PT_END(pt);
 }
 /*---------------------------------------------------------------------------*/
+#if MQTT_DIRECT_PUBLISH
+/*
+ * Frames a QoS 0 PUBLISH in the free part of the output buffer and hands it to
+ * the socket, bypassing the MQTT process. MQTTv5 properties must come from a
+ * buffer property list. Returns 1 on success, 0 if there is no room until
+ * queued data has been acknowledged and -1 if the message is larger than the
+ * buffer.
+ */
+static int
+publish_direct(struct mqtt_connection *conn, const char *topic,
+               uint16_t topic_length, const uint8_t *payload,
+               uint32_t payload_size, mqtt_retain_t retain
+#if MQTT_5
+               , struct mqtt_prop_list *prop_list
+#endif
+               )
+{
+  uint8_t remaining_length_enc[MQTT_MAX_REMAINING_LENGTH_BYTES];
+  uint8_t remaining_length_enc_bytes;
+  uint32_t remaining_length;
+  uint8_t *ptr;
+
+  remaining_length = MQTT_STRING_LEN_SIZE + topic_length + payload_size;
+#if MQTT_5
+  /* Property Length and properties */
+  remaining_length += prop_list ?
+    prop_list->properties_len_enc_bytes + prop_list->properties_len : 1;
+#endif
+  if(remaining_length > MQTT_TCP_OUTPUT_BUFF_SIZE) {
+    return -1;
+  }
+  mqtt_encode_var_byte_int(remaining_length_enc, &remaining_length_enc_bytes,
+                           remaining_length);
+  if(conn->out_writing ||
+     &conn->out_buffer[MQTT_TCP_OUTPUT_BUFF_SIZE] - conn->out_buffer_ptr <
+     MQTT_FHDR_SIZE + remaining_length_enc_bytes + remaining_length) {
+    return MQTT_FHDR_SIZE + remaining_length_enc_bytes + remaining_length >
+      MQTT_TCP_OUTPUT_BUFF_SIZE ? -1 : 0;
+  }
+
+  ptr = conn->out_buffer_ptr;
+  *ptr++ = MQTT_FHDR_MSG_TYPE_PUBLISH |
+    (retain == MQTT_RETAIN_ON ? MQTT_FHDR_RETAIN_FLAG : 0);
+  memcpy(ptr, remaining_length_enc, remaining_length_enc_bytes);
+  ptr += remaining_length_enc_bytes;
+  *ptr++ = topic_length >> 8;
+  *ptr++ = topic_length & 0x00FF;
+  memcpy(ptr, topic, topic_length);
+  ptr += topic_length;
+#if MQTT_5
+  if(prop_list) {
+    memcpy(ptr, prop_list->properties_len_enc,
+           prop_list->properties_len_enc_bytes);
+    ptr += prop_list->properties_len_enc_bytes;
+    memcpy(ptr, prop_list->buf, prop_list->properties_len);
+    ptr += prop_list->properties_len;
+  } else {
+    *ptr++ = 0;
+  }
+#endif
+  memcpy(ptr, payload, payload_size);
+  conn->out_buffer_ptr = ptr + payload_size;
+
+  send_out_buffer(conn);
+
+  DBG("MQTT - Publish queued directly, %i bytes in buffer\n",
+      conn->out_buffer_ptr - conn->out_buffer);
+  return 1;
+}
+#endif /* MQTT_DIRECT_PUBLISH */
+/*---------------------------------------------------------------------------*/
 static
 PT_THREAD(pingreq_pt(struct pt *pt, struct mqtt_connection *conn))
 {
@@ -991,7 +1359,8 @@ PT_THREAD(auth_pt(struct pt *pt, struct mqtt_connection *conn))
   PT_MQTT_WRITE_BYTE(conn, conn->out_packet.auth_reason_code);
 
   /* Write Properties */
-  write_out_props(pt, conn, conn->out_props);
+  PT_SPAWN(pt, &conn->out_props_thread,
+           write_out_props(&conn->out_props_thread, conn, conn->out_props));
 
   /* No Payload */
   send_out_buffer(conn);
@@ -1144,13 +1513,63 @@ handle_unsuback(struct mqtt_connection *conn)
 static void
 handle_puback(struct mqtt_connection *conn)
 {
+  struct mqtt_inflight *f;
+
   DBG("MQTT - Got PUBACK\n");
 
-  conn->out_packet.qos_state = MQTT_QOS_STATE_GOT_ACK;
+  f = inflight_lookup(conn, conn->in_packet.mid);
+  if(f == NULL || f->state != MQTT_INFLIGHT_WAIT_PUBACK) {
+    DBG("MQTT - Warning, got PUBACK for unknown MID %u\n",
+        conn->in_packet.mid);
+    return;
+  }
+  inflight_free(conn, f);
 
   call_event(conn, MQTT_EVENT_PUBACK, &conn->in_packet.mid);
 }
 /*---------------------------------------------------------------------------*/
+static void
+handle_pubrec(struct mqtt_connection *conn)
+{
+  struct mqtt_inflight *f;
+
+  DBG("MQTT - Got PUBREC\n");
+
+  /* A repeated PUBREC is answered with the PUBREL again */
+  f = inflight_lookup(conn, conn->in_packet.mid);
+  if(f == NULL || (f->state != MQTT_INFLIGHT_WAIT_PUBREC &&
+                   f->state != MQTT_INFLIGHT_WAIT_PUBCOMP)) {
+    DBG("MQTT - Warning, got PUBREC for unknown MID %u\n",
+        conn->in_packet.mid);
+    return;
+  }
+  f->state = MQTT_INFLIGHT_SEND_PUBREL;
+#if MQTT_WITH_SESSION_STORE
+  session_store_pubrel(conn, f);
+#endif
+
+  send_pubrels(conn);
+}
+/*---------------------------------------------------------------------------*/
+static void
+handle_pubcomp(struct mqtt_connection *conn)
+{
+  struct mqtt_inflight *f;
+
+  DBG("MQTT - Got PUBCOMP\n");
+
+  f = inflight_lookup(conn, conn->in_packet.mid);
+  if(f == NULL || (f->state != MQTT_INFLIGHT_WAIT_PUBCOMP &&
+                   f->state != MQTT_INFLIGHT_SEND_PUBREL)) {
+    DBG("MQTT - Warning, got PUBCOMP for unknown MID %u\n",
+        conn->in_packet.mid);
+    return;
+  }
+  inflight_free(conn, f);
+
+  call_event(conn, MQTT_EVENT_PUBCOMP, &conn->in_packet.mid);
+}
+/*---------------------------------------------------------------------------*/
 static mqtt_pub_status_t
 handle_publish(struct mqtt_connection *conn)
 {
@@ -1202,16 +1621,18 @@ parse_publish_vhdr(struct mqtt_connection *conn,
 {
   uint16_t copy_bytes;
 
-  /* Read out topic length */
-  if(conn->in_packet.topic_len_received == 0) {
-    conn->in_packet.topic_pos = 0;
-    conn->in_packet.topic_len = (input_data_ptr[(*pos)++] << 8);
-    conn->in_packet.byte_counter++;
+  /* Read out topic length, its two bytes may arrive in different segments */
+  while(conn->in_packet.topic_len_received == 0) {
     if(*pos >= input_data_len) {
       return;
     }
-    conn->in_packet.topic_len |= input_data_ptr[(*pos)++];
+    conn->in_packet.topic_len = (conn->in_packet.topic_len << 8) |
+      input_data_ptr[(*pos)++];
     conn->in_packet.byte_counter++;
+    if(conn->in_packet.byte_counter < MQTT_FHDR_SIZE + MQTT_STRING_LEN_SIZE) {
+      continue;
+    }
+    conn->in_packet.topic_pos = 0;
     conn->in_packet.topic_len_received = 1;
     /* Abort if topic is longer than our topic buffer */
     if(conn->in_packet.topic_len > MQTT_MAX_TOPIC_LENGTH) {
@@ -1224,7 +1645,10 @@ parse_publish_vhdr(struct mqtt_connection *conn,
 
   /* Read out topic */
   if(conn->in_packet.topic_len_received == 1 &&
-     conn->in_packet.topic_received == 0) {
+     conn->in_packet.topic_received == 0 &&
+     conn->in_packet.topic_len <= MQTT_MAX_TOPIC_LENGTH &&
+     MQTT_STRING_LEN_SIZE + conn->in_packet.topic_len <=
+     conn->in_packet.remaining_length) {
     copy_bytes = MIN(conn->in_packet.topic_len - conn->in_packet.topic_pos,
                      input_data_len - *pos);
     DBG("MQTT - topic_pos: %i copy_bytes: %i\n", conn->in_packet.topic_pos,
@@ -1250,6 +1674,150 @@ parse_publish_vhdr(struct mqtt_connection *conn,
   }
 }
 /*---------------------------------------------------------------------------*/
+#if MQTT_STREAM_PUBLISH
+/*
+ * Length of the PUBLISH variable header that follows the topic: the packet
+ * identifier for QoS > 0 and, for MQTTv5, the properties. While the property
+ * length is incomplete, one byte more than buffered is asked for.
+ */
+static uint16_t
+publish_vhdr_len(struct mqtt_connection *conn)
+{
+  uint16_t len = 0;
+#if MQTT_5
+  uint32_t props_len = 0;
+  uint8_t i;
+#endif
+
+  if(conn->in_packet.fhdr & (MQTT_FHDR_QOS_LEVEL_1 | MQTT_FHDR_QOS_LEVEL_2)) {
+    len = MQTT_MID_SIZE;
+  }
+
+#if MQTT_5
+  for(i = 0; len + i < conn->in_packet.payload_pos; i++) {
+    props_len |= (uint32_t)(conn->in_packet.payload[len + i] & 0x7F) << (7 * i);
+    if((conn->in_packet.payload[len + i] & 0x80) == 0) {
+      return MIN(len + i + 1 + props_len, 0xFFFF);
+    }
+    if(i == MQTT_MAX_REMAINING_LENGTH_BYTES - 1) {
+      return 0xFFFF;
+    }
+  }
+  return len + i + 1;
+#else
+  return len;
+#endif
+}
+/*---------------------------------------------------------------------------*/
+/* Drops what this segment holds of a PUBLISH that cannot be handled */
+static void
+skip_publish(struct mqtt_connection *conn, uint32_t *pos, int input_data_len)
+{
+  uint32_t skip_bytes;
+
+  DBG("MQTT - Skipping unsupported PUBLISH\n");
+
+  skip_bytes = MIN(input_data_len - *pos,
+                   MQTT_FHDR_SIZE + conn->in_packet.remaining_length -
+                   conn->in_packet.byte_counter);
+  conn->in_packet.byte_counter += skip_bytes;
+  *pos += skip_bytes;
+  if(conn->in_packet.byte_counter >=
+     MQTT_FHDR_SIZE + conn->in_packet.remaining_length) {
+    reset_packet(&conn->in_packet);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Parses the topic, packet identifier and properties of an incoming PUBLISH
+ * into the connection and then hands the payload bytes of this segment to the
+ * application, pointing into the TCP input buffer. The packet is reset after
+ * its last chunk.
+ */
+static mqtt_pub_status_t
+stream_publish(struct mqtt_connection *conn,
+               uint32_t *pos,
+               const uint8_t *input_data_ptr,
+               int input_data_len)
+{
+  uint32_t packet_end = MQTT_FHDR_SIZE + conn->in_packet.remaining_length;
+  uint32_t copy_bytes;
+  uint16_t vhdr_len;
+
+  if(!conn->in_packet.topic_received) {
+    parse_publish_vhdr(conn, pos, input_data_ptr, input_data_len);
+    if(conn->in_packet.topic_len_received &&
+       (conn->in_packet.topic_len > MQTT_MAX_TOPIC_LENGTH ||
+        MQTT_STRING_LEN_SIZE + conn->in_packet.topic_len >
+        conn->in_packet.remaining_length)) {
+      skip_publish(conn, pos, input_data_len);
+      return MQTT_PUBLISH_OK;
+    }
+    if(!conn->in_packet.topic_received) {
+      return MQTT_PUBLISH_OK;
+    }
+  }
+
+  /* The rest of the variable header is collected in the packet buffer */
+  while(conn->in_packet.payload_start == NULL) {
+    vhdr_len = publish_vhdr_len(conn);
+    if(vhdr_len > MQTT_INPUT_BUFF_SIZE ||
+       conn->in_packet.byte_counter + vhdr_len - conn->in_packet.payload_pos >
+       packet_end) {
+      skip_publish(conn, pos, input_data_len);
+      return MQTT_PUBLISH_OK;
+    }
+
+    if(conn->in_packet.payload_pos < vhdr_len) {
+      if(*pos >= input_data_len) {
+        return MQTT_PUBLISH_OK;
+      }
+      copy_bytes = MIN(vhdr_len - conn->in_packet.payload_pos,
+                       input_data_len - *pos);
+      memcpy(&conn->in_packet.payload[conn->in_packet.payload_pos],
+             &input_data_ptr[*pos], copy_bytes);
+      conn->in_packet.payload_pos += copy_bytes;
+      conn->in_packet.byte_counter += copy_bytes;
+      *pos += copy_bytes;
+      continue;
+    }
+
+    conn->in_packet.payload_start = conn->in_packet.payload;
+    if(conn->in_packet.fhdr & (MQTT_FHDR_QOS_LEVEL_1 | MQTT_FHDR_QOS_LEVEL_2)) {
+      conn->in_packet.mid = (conn->in_packet.payload[0] << 8) |
+        conn->in_packet.payload[1];
+      conn->in_publish_msg.mid = conn->in_packet.mid;
+      conn->in_packet.payload_start += MQTT_MID_SIZE;
+    }
+#if MQTT_5
+    mqtt_prop_decode_input_props(conn);
+#endif
+    conn->in_packet.payload_start = conn->in_packet.payload + vhdr_len;
+
+    conn->in_publish_msg.payload_length = packet_end -
+      conn->in_packet.byte_counter;
+    conn->in_publish_msg.payload_left = conn->in_publish_msg.payload_length;
+    conn->in_publish_msg.first_chunk = 1;
+  }
+
+  /* An empty payload is still reported, once */
+  copy_bytes = MIN(input_data_len - *pos,
+                   packet_end - conn->in_packet.byte_counter);
+  if(copy_bytes == 0 && conn->in_publish_msg.payload_left > 0) {
+    return MQTT_PUBLISH_OK;
+  }
+
+  /* The TCP input buffer is the connection's own in_buffer */
+  conn->in_publish_msg.payload_chunk = (uint8_t *)&input_data_ptr[*pos];
+  conn->in_publish_msg.payload_chunk_length = copy_bytes;
+  conn->in_publish_msg.payload_left -= copy_bytes;
+  conn->in_packet.byte_counter += copy_bytes;
+  *pos += copy_bytes;
+
+  return handle_publish(conn);
+}
+/*---------------------------------------------------------------------------*/
+#endif /* MQTT_STREAM_PUBLISH */
 /* MQTTv5 only */
 #if MQTT_5
 static void
@@ -1295,6 +1863,8 @@ parse_vhdr(struct mqtt_connection *conn)
   /* Some message types include a packet identifier */
   switch(conn->in_packet.fhdr & 0xF0) {
   case MQTT_FHDR_MSG_TYPE_PUBACK:
+  case MQTT_FHDR_MSG_TYPE_PUBREC:
+  case MQTT_FHDR_MSG_TYPE_PUBCOMP:
   case MQTT_FHDR_MSG_TYPE_SUBACK:
   case MQTT_FHDR_MSG_TYPE_UNSUBACK:
     conn->in_packet.mid = (conn->in_packet.payload[0] << 8) |
@@ -1315,6 +1885,9 @@ parse_vhdr(struct mqtt_connection *conn)
    */
   switch(conn->in_packet.fhdr & 0xF0) {
   case MQTT_FHDR_MSG_TYPE_CONNACK:
+    /* The Reason Code follows the Connect Acknowledge Flags */
+    conn->in_packet.payload_start += 1;
+  /* fall through */
   case MQTT_FHDR_MSG_TYPE_PUBACK:
   case MQTT_FHDR_MSG_TYPE_PUBREC:
   case MQTT_FHDR_MSG_TYPE_PUBREL:
@@ -1347,221 +1920,270 @@ tcp_input(struct tcp_socket *s,
   uint32_t pos = 0;
   uint32_t copy_bytes = 0;
   mqtt_pub_status_t pub_status;
-  uint8_t remaining_length_bytes;
+  uint32_t remaining_length;
+  uint8_t byte_in;
 
   if(input_data_len == 0) {
     return 0;
   }
 
-  if(conn->in_packet.packet_received) {
-    reset_packet(&conn->in_packet);
-  }
-
   DBG("tcp_input with %i bytes of data:\n", input_data_len);
 
-  /* Read the fixed header field, if we do not have it */
-  if(!conn->in_packet.fhdr) {
-    conn->in_packet.fhdr = input_data_ptr[pos++];
-    conn->in_packet.byte_counter++;
-
-    DBG("MQTT - Read VHDR '%02X'\n", conn->in_packet.fhdr);
-
-    if(pos >= input_data_len) {
-      return 0;
+  /* A segment may hold several packets, such as a burst of PUBACKs */
+  while(pos < input_data_len) {
+    if(conn->in_packet.packet_received) {
+      reset_packet(&conn->in_packet);
     }
-  }
 
-  /* Read the Remaining Length field, if we do not have it */
-  if(!conn->in_packet.has_remaining_length) {
-    remaining_length_bytes =
-      mqtt_decode_var_byte_int(input_data_ptr, input_data_len, &pos,
-                               &conn->in_packet.byte_counter,
-                               &conn->in_packet.remaining_length);
+    /* Read the fixed header field, if we do not have it */
+    if(!conn->in_packet.fhdr) {
+      conn->in_packet.fhdr = input_data_ptr[pos++];
+      conn->in_packet.byte_counter++;
 
-    if(remaining_length_bytes == 0) {
-      call_event(conn, MQTT_EVENT_ERROR, NULL);
-      return 0;
-    }
+      DBG("MQTT - Read VHDR '%02X'\n", conn->in_packet.fhdr);
 
-    DBG("MQTT - Finished reading remaining length byte\n");
-    conn->in_packet.has_remaining_length = 1;
-  }
-
-  /*
-   * Check for unsupported payload length. Will read all incoming data from the
-   * server in any case and then reset the packet.
-   *
-   * TODO: Decide if we, for example, want to disconnect instead.
-   */
-  if((conn->in_packet.remaining_length > MQTT_INPUT_BUFF_SIZE) &&
-     (conn->in_packet.fhdr & 0xF0) != MQTT_FHDR_MSG_TYPE_PUBLISH) {
+      if(pos >= input_data_len) {
+        return 0;
+      }
+    }
 
-    PRINTF("MQTT - Error, unsupported payload size for non-PUBLISH message\n");
+    /*
+     * Read the Remaining Length field, if we do not have it. The field may be
+     * split over segments. The byte counter is compared to
+     * MQTT_FHDR_SIZE + remaining_length and does not include its bytes.
+     */
+    while(!conn->in_packet.has_remaining_length) {
+      if(pos >= input_data_len) {
+        return 0;
+      }
+      if(conn->in_packet.remaining_length_bytes ==
+         MQTT_MAX_REMAINING_LENGTH_BYTES) {
+        call_event(conn, MQTT_EVENT_ERROR, NULL);
+        return 0;
+      }
+      byte_in = input_data_ptr[pos++];
+      remaining_length = conn->in_packet.remaining_length +
+        ((uint32_t)(byte_in & 0x7F) <<
+         (7 * conn->in_packet.remaining_length_bytes++));
+      if(remaining_length > 0xFFFF) {
+        PRINTF("MQTT - Error, unsupported remaining length\n");
+        call_event(conn, MQTT_EVENT_ERROR, NULL);
+        return 0;
+      }
+      conn->in_packet.remaining_length = remaining_length;
 
-    conn->in_packet.byte_counter += input_data_len;
-    if(conn->in_packet.byte_counter >=
-       (MQTT_FHDR_SIZE + conn->in_packet.remaining_length)) {
-      conn->in_packet.packet_received = 1;
+      if((byte_in & 0x80) == 0) {
+        DBG("MQTT - Finished reading remaining length byte\n");
+        conn->in_packet.has_remaining_length = 1;
+      }
     }
-    return 0;
-  }
 
-  /*
-   * Supported payload, reads out both VHDR and Payload of all packets.
-   *
-   * Note: There will always be at least one byte left to read when we enter
-   *       this loop.
-   */
-  while(conn->in_packet.byte_counter <
-        (MQTT_FHDR_SIZE + conn->in_packet.remaining_length)) {
+    /*
+     * Check for unsupported payload length. Will read all incoming data from the
+     * server in any case and then reset the packet.
+     *
+     * TODO: Decide if we, for example, want to disconnect instead.
+     */
+    if((conn->in_packet.remaining_length > MQTT_INPUT_BUFF_SIZE) &&
+       (conn->in_packet.fhdr & 0xF0) != MQTT_FHDR_MSG_TYPE_PUBLISH) {
+
+      PRINTF("MQTT - Error, unsupported payload size for non-PUBLISH message\n");
+
+      copy_bytes = MIN(input_data_len - pos,
+                       MQTT_FHDR_SIZE + conn->in_packet.remaining_length -
+                       conn->in_packet.byte_counter);
+      conn->in_packet.byte_counter += copy_bytes;
+      pos += copy_bytes;
+      if(conn->in_packet.byte_counter >=
+         (MQTT_FHDR_SIZE + conn->in_packet.remaining_length)) {
+        conn->in_packet.packet_received = 1;
+      }
+      continue;
+    }
 
-    if((conn->in_packet.fhdr & 0xF0) == MQTT_FHDR_MSG_TYPE_PUBLISH &&
-       conn->in_packet.topic_received == 0) {
-      parse_publish_vhdr(conn, &pos, input_data_ptr, input_data_len);
+#if MQTT_STREAM_PUBLISH
+    if((conn->in_packet.fhdr & 0xF0) == MQTT_FHDR_MSG_TYPE_PUBLISH) {
+      if(stream_publish(conn, &pos, input_data_ptr, input_data_len) !=
+         MQTT_PUBLISH_OK) {
+        return 0;
+      }
+      /* The packet is reset once it has been read completely */
+      if(conn->in_packet.fhdr != 0 ||
+         conn->state == MQTT_CONN_STATE_NOT_CONNECTED) {
+        return 0;
+      }
+      continue;
     }
+#endif
 
-    /* Read in as much as we can into the packet payload */
-    copy_bytes = MIN(input_data_len - pos,
-                     MQTT_INPUT_BUFF_SIZE - conn->in_packet.payload_pos);
-    DBG("- Copied %i payload bytes\n", copy_bytes);
-    memcpy(&conn->in_packet.payload[conn->in_packet.payload_pos],
-           &input_data_ptr[pos],
-           copy_bytes);
-    conn->in_packet.byte_counter += copy_bytes;
-    conn->in_packet.payload_pos += copy_bytes;
-    pos += copy_bytes;
+    /*
+     * Supported payload, reads out both VHDR and Payload of all packets.
+     *
+     * Note: The segment may end right after the Remaining Length field.
+     */
+    while(conn->in_packet.byte_counter <
+          (MQTT_FHDR_SIZE + conn->in_packet.remaining_length)) {
+
+      if((conn->in_packet.fhdr & 0xF0) == MQTT_FHDR_MSG_TYPE_PUBLISH &&
+         conn->in_packet.topic_received == 0) {
+        parse_publish_vhdr(conn, &pos, input_data_ptr, input_data_len);
+      }
+
+      /* Read in as much of this packet as we can into the packet payload */
+      copy_bytes = MIN(input_data_len - pos,
+                       MQTT_INPUT_BUFF_SIZE - conn->in_packet.payload_pos);
+      copy_bytes = MIN(copy_bytes,
+                       MQTT_FHDR_SIZE + conn->in_packet.remaining_length -
+                       conn->in_packet.byte_counter);
+      DBG("- Copied %i payload bytes\n", copy_bytes);
+      memcpy(&conn->in_packet.payload[conn->in_packet.payload_pos],
+             &input_data_ptr[pos],
+             copy_bytes);
+      conn->in_packet.byte_counter += copy_bytes;
+      conn->in_packet.payload_pos += copy_bytes;
+      pos += copy_bytes;
 
 #if DEBUG_MQTT == 1
-    uint32_t i;
-    DBG("MQTT - Copied bytes: \n");
-    for(i = 0; i < copy_bytes; i++) {
-      DBG("%02X ", conn->in_packet.payload[i]);
-    }
-    DBG("\n");
+      uint32_t i;
+      DBG("MQTT - Copied bytes: \n");
+      for(i = 0; i < copy_bytes; i++) {
+        DBG("%02X ", conn->in_packet.payload[i]);
+      }
+      DBG("\n");
 #endif
 
-    /* Full buffer, shall only happen to PUBLISH messages. */
-    if(MQTT_INPUT_BUFF_SIZE - conn->in_packet.payload_pos == 0) {
-      conn->in_publish_msg.payload_chunk = conn->in_packet.payload;
-      conn->in_publish_msg.payload_chunk_length = MQTT_INPUT_BUFF_SIZE;
-      conn->in_publish_msg.payload_left -= MQTT_INPUT_BUFF_SIZE;
+      /* Full buffer, shall only happen to PUBLISH messages. */
+      if(MQTT_INPUT_BUFF_SIZE - conn->in_packet.payload_pos == 0) {
+        conn->in_publish_msg.payload_chunk = conn->in_packet.payload;
+        conn->in_publish_msg.payload_chunk_length = MQTT_INPUT_BUFF_SIZE;
+        conn->in_publish_msg.payload_left -= MQTT_INPUT_BUFF_SIZE;
 
 #if MQTT_5
-      if(!conn->in_packet.has_props) {
-        mqtt_prop_decode_input_props(conn);
-      }
+        if(!conn->in_packet.has_props) {
+          mqtt_prop_decode_input_props(conn);
+        }
 
-      if(conn->in_publish_msg.first_chunk) {
-        conn->in_publish_msg.payload_chunk_length -= conn->in_packet.properties_len +
-          conn->in_packet.properties_enc_len;
+        if(conn->in_publish_msg.first_chunk) {
+          conn->in_publish_msg.payload_chunk_length -= conn->in_packet.properties_len +
+            conn->in_packet.properties_enc_len;
 
-        /* Payload chunk should point past the MQTT properties and to the payload itself */
-        conn->in_publish_msg.payload_chunk += conn->in_packet.properties_len +
-          conn->in_packet.properties_enc_len;
-      }
+          /* Payload chunk should point past the MQTT properties and to the payload itself */
+          conn->in_publish_msg.payload_chunk += conn->in_packet.properties_len +
+            conn->in_packet.properties_enc_len;
+        }
 #endif
 
-      pub_status = handle_publish(conn);
+        pub_status = handle_publish(conn);
 
-      conn->in_publish_msg.payload_chunk = conn->in_packet.payload;
-      conn->in_packet.payload_pos = 0;
+        conn->in_publish_msg.payload_chunk = conn->in_packet.payload;
+        conn->in_packet.payload_pos = 0;
 
-      if(pub_status != MQTT_PUBLISH_OK) {
-        return 0;
+        if(pub_status != MQTT_PUBLISH_OK) {
+          return 0;
+        }
       }
-    }
 
-    if(pos >= input_data_len &&
-       (conn->in_packet.byte_counter < (MQTT_FHDR_SIZE + conn->in_packet.remaining_length))) {
-      return 0;
+      if(pos >= input_data_len &&
+         (conn->in_packet.byte_counter < (MQTT_FHDR_SIZE + conn->in_packet.remaining_length))) {
+        return 0;
+      }
     }
-  }
 
-  parse_vhdr(conn);
+    parse_vhdr(conn);
 
-  /* Debug information */
-  DBG("\n");
-  /* Take care of input */
-  DBG("MQTT - Finished reading packet!\n");
-  /* What to return? */
-  DBG("MQTT - total data was %i bytes of data. \n",
-      (MQTT_FHDR_SIZE + conn->in_packet.remaining_length));
+    /* Debug information */
+    DBG("\n");
+    /* Take care of input */
+    DBG("MQTT - Finished reading packet!\n");
+    /* What to return? */
+    DBG("MQTT - total data was %i bytes of data. \n",
+        (MQTT_FHDR_SIZE + conn->in_packet.remaining_length));
 
 #if MQTT_5
-  if(conn->in_packet.has_reason_code &&
-     conn->in_packet.reason_code >= MQTT_VHDR_RC_UNSPEC_ERR) {
-    PRINTF("MQTT - Reason Code indicated error %i\n",
-           conn->in_packet.reason_code);
-    call_event(conn,
-               MQTT_EVENT_ERROR,
-               NULL);
-    abort_connection(conn);
-    return 0;
-  }
+    if(conn->in_packet.has_reason_code &&
+       conn->in_packet.reason_code >= MQTT_VHDR_RC_UNSPEC_ERR) {
+      PRINTF("MQTT - Reason Code indicated error %i\n",
+             conn->in_packet.reason_code);
+      call_event(conn,
+                 MQTT_EVENT_ERROR,
+                 NULL);
+      abort_connection(conn);
+      return 0;
+    }
 #endif
 
-  /* Handle packet here. */
-  switch(conn->in_packet.fhdr & 0xF0) {
-  case MQTT_FHDR_MSG_TYPE_CONNACK:
-    handle_connack(conn);
-    break;
-  case MQTT_FHDR_MSG_TYPE_PUBLISH:
-    /* This is the only or the last chunk of publish payload */
-    conn->in_publish_msg.payload_chunk = conn->in_packet.payload;
-    conn->in_publish_msg.payload_chunk_length = conn->in_packet.payload_pos;
-    conn->in_publish_msg.payload_left = 0;
+    /* Handle packet here. */
+    switch(conn->in_packet.fhdr & 0xF0) {
+    case MQTT_FHDR_MSG_TYPE_CONNACK:
+      handle_connack(conn);
+      break;
+    case MQTT_FHDR_MSG_TYPE_PUBLISH:
+      /* This is the only or the last chunk of publish payload */
+      conn->in_publish_msg.payload_chunk = conn->in_packet.payload;
+      conn->in_publish_msg.payload_chunk_length = conn->in_packet.payload_pos;
+      conn->in_publish_msg.payload_left = 0;
 
-    DBG("MQTT - First chunk? %i\n", conn->in_publish_msg.first_chunk);
+      DBG("MQTT - First chunk? %i\n", conn->in_publish_msg.first_chunk);
 #if MQTT_5
-    if(conn->in_publish_msg.first_chunk) {
-      conn->in_publish_msg.payload_chunk_length -= conn->in_packet.properties_len +
-        conn->in_packet.properties_enc_len;
-      /* Payload chunk should point past the MQTT properties and to the payload itself */
-      conn->in_publish_msg.payload_chunk += conn->in_packet.properties_len +
-        conn->in_packet.properties_enc_len;
-    }
+      if(conn->in_publish_msg.first_chunk) {
+        conn->in_publish_msg.payload_chunk_length -= conn->in_packet.properties_len +
+          conn->in_packet.properties_enc_len;
+        /* Payload chunk should point past the MQTT properties and to the payload itself */
+        conn->in_publish_msg.payload_chunk += conn->in_packet.properties_len +
+          conn->in_packet.properties_enc_len;
+      }
 #endif
-    (void)handle_publish(conn);
-    break;
-  case MQTT_FHDR_MSG_TYPE_PUBACK:
-    handle_puback(conn);
-    break;
-  case MQTT_FHDR_MSG_TYPE_SUBACK:
-    handle_suback(conn);
-    break;
-  case MQTT_FHDR_MSG_TYPE_UNSUBACK:
-    handle_unsuback(conn);
-    break;
-  case MQTT_FHDR_MSG_TYPE_PINGRESP:
-    handle_pingresp(conn);
-    break;
-
-  /* QoS 2 not implemented yet */
-  case MQTT_FHDR_MSG_TYPE_PUBREC:
-  case MQTT_FHDR_MSG_TYPE_PUBREL:
-  case MQTT_FHDR_MSG_TYPE_PUBCOMP:
-    call_event(conn, MQTT_EVENT_NOT_IMPLEMENTED_ERROR, NULL);
-    PRINTF("MQTT - Got unhandled MQTT Message Type '%i'",
-           (conn->in_packet.fhdr & 0xF0));
-    break;
+      (void)handle_publish(conn);
+      break;
+    case MQTT_FHDR_MSG_TYPE_PUBACK:
+      handle_puback(conn);
+      break;
+    case MQTT_FHDR_MSG_TYPE_PUBREC:
+      handle_pubrec(conn);
+      break;
+    case MQTT_FHDR_MSG_TYPE_PUBCOMP:
+      handle_pubcomp(conn);
+      break;
+    case MQTT_FHDR_MSG_TYPE_SUBACK:
+      handle_suback(conn);
+      break;
+    case MQTT_FHDR_MSG_TYPE_UNSUBACK:
+      handle_unsuback(conn);
+      break;
+    case MQTT_FHDR_MSG_TYPE_PINGRESP:
+      handle_pingresp(conn);
+      break;
+
+    /* QoS 2 is not implemented for incoming PUBLISH messages yet */
+    case MQTT_FHDR_MSG_TYPE_PUBREL:
+      call_event(conn, MQTT_EVENT_NOT_IMPLEMENTED_ERROR, NULL);
+      PRINTF("MQTT - Got unhandled MQTT Message Type '%i'",
+             (conn->in_packet.fhdr & 0xF0));
+      break;
 
 #if MQTT_PROTOCOL_VERSION >= MQTT_PROTOCOL_VERSION_5
-  case MQTT_FHDR_MSG_TYPE_DISCONNECT:
-    handle_disconnect(conn);
-    break;
+    case MQTT_FHDR_MSG_TYPE_DISCONNECT:
+      handle_disconnect(conn);
+      break;
 
-  case MQTT_FHDR_MSG_TYPE_AUTH:
-    handle_auth(conn);
-    break;
+    case MQTT_FHDR_MSG_TYPE_AUTH:
+      handle_auth(conn);
+      break;
 #endif
 
-  default:
-    /* All server-only message */
-    PRINTF("MQTT - Got MQTT Message Type '%i'", (conn->in_packet.fhdr & 0xF0));
-    break;
-  }
+    default:
+      /* All server-only message */
+      PRINTF("MQTT - Got MQTT Message Type '%i'", (conn->in_packet.fhdr & 0xF0));
+      break;
+    }
+
+    conn->in_packet.packet_received = 1;
 
-  conn->in_packet.packet_received = 1;
+    /* The handler may have torn the connection down */
+    if(conn->state == MQTT_CONN_STATE_NOT_CONNECTED) {
+      return 0;
+    }
+  }
 
   return 0;
 }
@@ -1605,10 +2227,16 @@ tcp_event(struct tcp_socket *s, void *ptr, tcp_socket_event_t event)
   case TCP_SOCKET_DATA_SENT: {
     DBG("MQTT - Got TCP_DATA_SENT\n");
 
+    /* The socket has moved the data still queued to the buffer start */
+    conn->out_buffer_ptr = conn->out_buffer + conn->socket.output_data_len;
     if(conn->socket.output_data_len == 0) {
       conn->out_buffer_sent = 1;
-      conn->out_buffer_ptr = conn->out_buffer;
     }
+    send_pubrels(conn);
+#if MQTT_DIRECT_PUBLISH
+    /* Publishes refused for lack of buffer space can be retried */
+    process_post(conn->app_process, mqtt_update_event, NULL);
+#endif
 
     ctimer_restart(&conn->keep_alive_timer);
     break;
@@ -1678,8 +2306,7 @@ PROCESS_THREAD(mqtt_process, ev, data)
       conn = data;
       DBG("MQTT - Got mqtt_do_pingreq_event!\n");
 
-      if(conn->out_buffer_sent == 1 &&
-         conn->state == MQTT_CONN_STATE_CONNECTED_TO_BROKER) {
+      if(conn->state == MQTT_CONN_STATE_CONNECTED_TO_BROKER) {
         PT_INIT(&conn->out_proto_thread);
         while(conn->state == MQTT_CONN_STATE_CONNECTED_TO_BROKER &&
               pingreq_pt(&conn->out_proto_thread, conn) < PT_EXITED) {
@@ -1691,8 +2318,7 @@ PROCESS_THREAD(mqtt_process, ev, data)
       conn = data;
       DBG("MQTT - Got mqtt_do_subscribe_mqtt_event!\n");
 
-      if(conn->out_buffer_sent == 1 &&
-         conn->state == MQTT_CONN_STATE_CONNECTED_TO_BROKER) {
+      if(conn->state == MQTT_CONN_STATE_CONNECTED_TO_BROKER) {
         PT_INIT(&conn->out_proto_thread);
         while(conn->state == MQTT_CONN_STATE_CONNECTED_TO_BROKER &&
               subscribe_pt(&conn->out_proto_thread, conn) < PT_EXITED) {
@@ -1704,8 +2330,7 @@ PROCESS_THREAD(mqtt_process, ev, data)
       conn = data;
       DBG("MQTT - Got mqtt_do_unsubscribe_mqtt_event!\n");
 
-      if(conn->out_buffer_sent == 1 &&
-         conn->state == MQTT_CONN_STATE_CONNECTED_TO_BROKER) {
+      if(conn->state == MQTT_CONN_STATE_CONNECTED_TO_BROKER) {
         PT_INIT(&conn->out_proto_thread);
         while(conn->state == MQTT_CONN_STATE_CONNECTED_TO_BROKER &&
               unsubscribe_pt(&conn->out_proto_thread, conn) < PT_EXITED) {
@@ -1717,8 +2342,7 @@ PROCESS_THREAD(mqtt_process, ev, data)
       conn = data;
       DBG("MQTT - Got mqtt_do_publish_mqtt_event!\n");
 
-      if(conn->out_buffer_sent == 1 &&
-         conn->state == MQTT_CONN_STATE_CONNECTED_TO_BROKER) {
+      if(conn->state == MQTT_CONN_STATE_CONNECTED_TO_BROKER) {
         PT_INIT(&conn->out_proto_thread);
         while(conn->state == MQTT_CONN_STATE_CONNECTED_TO_BROKER &&
               publish_pt(&conn->out_proto_thread, conn) < PT_EXITED) {
@@ -1797,6 +2421,9 @@ mqtt_register(struct mqtt_connection *conn, struct process *app_process,
   conn->max_segment_size = max_segment_size;
 
   reset_defaults(conn);
+#if MQTT_WITH_SESSION_STORE
+  session_load(conn);
+#endif
 
   mqtt_init();
 
@@ -1909,7 +2536,7 @@ mqtt_subscribe(struct mqtt_connection *conn, uint16_t *mid, char *topic,
   conn->out_queue_full = 1;
   DBG("MQTT - Accepted!\n");
 
-  conn->out_packet.mid = INCREMENT_MID(conn);
+  conn->out_packet.mid = next_mid(conn);
   conn->out_packet.topic = topic;
   conn->out_packet.topic_length = strlen(topic);
   conn->out_packet.qos_state = MQTT_QOS_STATE_NO_ACK;
@@ -1958,7 +2585,7 @@ mqtt_unsubscribe(struct mqtt_connection *conn, uint16_t *mid,
   conn->out_queue_full = 1;
   DBG("MQTT - Accepted!\n");
 
-  conn->out_packet.mid = INCREMENT_MID(conn);
+  conn->out_packet.mid = next_mid(conn);
   conn->out_packet.topic = topic;
   conn->out_packet.topic_length = strlen(topic);
   conn->out_packet.qos_state = MQTT_QOS_STATE_NO_ACK;
@@ -1987,6 +2614,8 @@ mqtt_publish(struct mqtt_connection *conn, uint16_t *mid, char *topic,
              mqtt_retain_t retain)
 #endif
 {
+  struct mqtt_inflight *f;
+
   if(conn->state != MQTT_CONN_STATE_CONNECTED_TO_BROKER) {
     return MQTT_STATUS_NOT_CONNECTED_ERROR;
   }
@@ -1998,10 +2627,54 @@ mqtt_publish(struct mqtt_connection *conn, uint16_t *mid, char *topic,
     DBG("MQTT - Not accepted!\n");
     return MQTT_STATUS_OUT_QUEUE_FULL;
   }
+
+#if MQTT_DIRECT_PUBLISH
+#if MQTT_5
+  /* Properties are copied along if they are encoded already */
+  if(qos_level == MQTT_QOS_LEVEL_0 &&
+     (prop_list == NULL || prop_list->buf != NULL) &&
+     topic_alias_en != MQTT_TOPIC_ALIAS_ON) {
+    switch(publish_direct(conn, topic, strlen(topic), payload, payload_size,
+                          retain, prop_list)) {
+#else
+  if(qos_level == MQTT_QOS_LEVEL_0) {
+    switch(publish_direct(conn, topic, strlen(topic), payload, payload_size,
+                          retain)) {
+#endif
+    case 1:
+      INCREMENT_MID(conn);
+      if(mid) {
+        *mid = conn->mid_counter;
+      }
+      return MQTT_STATUS_OK;
+    case 0:
+      /* mqtt_update_event follows when the broker has acknowledged data */
+      DBG("MQTT - Not accepted, output buffer full\n");
+      return MQTT_STATUS_OUT_QUEUE_FULL;
+    default:
+      break;
+    }
+  }
+#endif /* MQTT_DIRECT_PUBLISH */
+
+  if(qos_level > MQTT_QOS_LEVEL_0) {
+    f = inflight_alloc(conn);
+    if(f == NULL) {
+      DBG("MQTT - Not accepted, %u messages in flight\n", MQTT_MAX_INFLIGHT);
+      return MQTT_STATUS_OUT_QUEUE_FULL;
+    }
+    f->mid = next_mid(conn);
+    f->state = qos_level == MQTT_QOS_LEVEL_1 ?
+      MQTT_INFLIGHT_WAIT_PUBACK : MQTT_INFLIGHT_WAIT_PUBREC;
+    f->stored_len = 0;
+    conn->out_packet.mid = f->mid;
+  } else {
+    conn->out_packet.mid = INCREMENT_MID(conn);
+  }
+
   conn->out_queue_full = 1;
   DBG("MQTT - Accepted!\n");
 
-  conn->out_packet.mid = INCREMENT_MID(conn);
   conn->out_packet.retain = retain;
 #if MQTT_5
   if(topic_alias_en == MQTT_TOPIC_ALIAS_ON) {
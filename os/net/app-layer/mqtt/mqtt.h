@@ -125,7 +125,53 @@
 #define MQTT_TCP_INPUT_BUFF_SIZE 512
 #define MQTT_TCP_OUTPUT_BUFF_SIZE 512
 
+/* Buffer for incoming packets, except for streamed PUBLISH payloads */
+#ifdef MQTT_CONF_INPUT_BUFF_SIZE
+#define MQTT_INPUT_BUFF_SIZE MQTT_CONF_INPUT_BUFF_SIZE
+#else
 #define MQTT_INPUT_BUFF_SIZE 512
+#endif
+
+/*
+ * Incoming PUBLISH payloads are handed to the application in chunks straight
+ * from the TCP input buffer, as they arrive, instead of being collected in the
+ * input buffer first. The topic, packet identifier and properties are parsed
+ * before the first chunk, so payloads may be larger than MQTT_INPUT_BUFF_SIZE.
+ */
+#ifdef MQTT_CONF_STREAM_PUBLISH
+#define MQTT_STREAM_PUBLISH MQTT_CONF_STREAM_PUBLISH
+#else
+#define MQTT_STREAM_PUBLISH 0
+#endif
+
+/*
+ * QoS 0 publishes that fit in the output buffer are framed into it directly by
+ * mqtt_publish() and queued behind the data still in flight, so that several
+ * small publishes leave in one TCP segment
+ */
+#ifdef MQTT_CONF_DIRECT_PUBLISH
+#define MQTT_DIRECT_PUBLISH MQTT_CONF_DIRECT_PUBLISH
+#else
+#define MQTT_DIRECT_PUBLISH 1
+#endif
+
+/* Number of QoS 1 and 2 publishes that may await acknowledgement at once */
+#ifdef MQTT_CONF_MAX_INFLIGHT
+#define MQTT_MAX_INFLIGHT MQTT_CONF_MAX_INFLIGHT
+#else
+#define MQTT_MAX_INFLIGHT 4
+#endif
+
+/*
+ * Unacknowledged QoS 1 and 2 publishes that fit in the output buffer are kept
+ * in CFS and sent again when the client reconnects without a clean session,
+ * also after a reboot. Without the store they are dropped on reconnect.
+ */
+#ifdef MQTT_CONF_WITH_SESSION_STORE
+#define MQTT_WITH_SESSION_STORE MQTT_CONF_WITH_SESSION_STORE
+#else
+#define MQTT_WITH_SESSION_STORE 0
+#endif
 #define MQTT_MAX_TOPIC_LENGTH 64
 #define MQTT_MAX_TOPICS_PER_SUBSCRIBE 1
 
@@ -223,6 +269,7 @@ typedef enum {
   MQTT_EVENT_UNSUBACK,
   MQTT_EVENT_PUBLISH,
   MQTT_EVENT_PUBACK,
+  MQTT_EVENT_PUBCOMP,
 
   /* Errors */
   MQTT_EVENT_ERROR = 0x80,
@@ -264,6 +311,14 @@ typedef enum {
   MQTT_PUBLISH_OK,
   MQTT_PUBLISH_ERR,
 } mqtt_pub_status_t;
+
+typedef enum {
+  MQTT_INFLIGHT_FREE,
+  MQTT_INFLIGHT_WAIT_PUBACK,
+  MQTT_INFLIGHT_WAIT_PUBREC,
+  MQTT_INFLIGHT_SEND_PUBREL,
+  MQTT_INFLIGHT_WAIT_PUBCOMP,
+} mqtt_inflight_state_t;
 /*---------------------------------------------------------------------------*/
 /*
  * This is the state of the connection itself.
@@ -435,6 +490,7 @@ struct mqtt_in_packet {
 
   /* Helper variables needed to decode the remaining_length */
   uint8_t has_remaining_length;
+  uint8_t remaining_length_bytes;
 
   /* Not the same as payload in the MQTT sense, it also contains the variable
    * header.
@@ -485,6 +541,13 @@ struct mqtt_out_packet {
   uint8_t auth_reason_code;
 #endif
 };
+/* A QoS 1 or 2 PUBLISH the broker has not acknowledged yet */
+struct mqtt_inflight {
+  uint16_t mid;
+  uint8_t state;
+  /* Length of the packet in the session store, 0 if not stored */
+  uint16_t stored_len;
+};
 /*---------------------------------------------------------------------------*/
 /**
  * \brief           MQTT event callback function
@@ -548,8 +611,15 @@ struct mqtt_connection {
   uint8_t *out_buffer_ptr;
   uint8_t out_buffer[MQTT_TCP_OUTPUT_BUFF_SIZE];
   uint8_t out_buffer_sent;
+  /* The protothread waits for buffer space in the middle of a packet */
+  uint8_t out_writing;
   struct mqtt_out_packet out_packet;
+  struct mqtt_inflight inflight[MQTT_MAX_INFLIGHT];
   struct pt out_proto_thread;
+#if MQTT_5
+  /* Writes the properties in the middle of a packet */
+  struct pt out_props_thread;
+#endif
   uint32_t out_write_pos;
   uint16_t max_segment_size;
 
@@ -686,7 +756,7 @@ mqtt_status_t mqtt_unsubscribe(struct mqtt_connection *conn,
  * \param topic A pointer to the topic to subscribe to.
  * \param payload A pointer to the topic payload.
  * \param payload_size Payload size.
- * \param qos_level Quality Of Service level to use. Currently supports 0, 1.
+ * \param qos_level Quality Of Service level to use.
  * \param retain If the RETAIN flag is set to 1, in a PUBLISH Packet sent by a
  *        Client to a Server, the Server MUST store the Application Message
  *        and its QoS, so that it can be delivered to future subscribers whose
@@ -698,6 +768,20 @@ mqtt_status_t mqtt_unsubscribe(struct mqtt_connection *conn,
  * \return MQTT_STATUS_OK or some error status
  *
  * This function publishes to a topic on a MQTT broker.
+ *
+ * With MQTT_DIRECT_PUBLISH, a QoS 0 message that fits in the output buffer
+ * and has no properties, or only those of a list set up with
+ * mqtt_prop_create_buf_list(), is copied there before this function returns,
+ * so the payload buffer may be reused right away. If the buffer is too full,
+ * the function returns MQTT_STATUS_OUT_QUEUE_FULL and posts mqtt_update_event
+ * once the broker has acknowledged some data. Other messages are sent from
+ * the MQTT process, and topic and payload must stay valid until
+ * mqtt_update_event is posted.
+ *
+ * Up to MQTT_MAX_INFLIGHT QoS 1 and 2 messages may await acknowledgement at
+ * a time, further ones are refused with MQTT_STATUS_OUT_QUEUE_FULL. Their
+ * completion is reported with MQTT_EVENT_PUBACK and MQTT_EVENT_PUBCOMP,
+ * respectively, in the order the broker acknowledges them.
  */
 mqtt_status_t mqtt_publish(struct mqtt_connection *conn,
                            uint16_t *mid,
@@ -100,6 +100,9 @@ static struct ctimer mcast_periodic;
 static uint8_t mcast_len;
 static uip_buf_t mcast_buf;
 static uint8_t fwd_delay;
+#if UIP_MCAST6_STATS
+static clock_time_t mcast_received;
+#endif
 static uint8_t fwd_spread;
 static struct uip_udp_conn *c;
 static uip_ipaddr_t src_ip;
@@ -254,6 +257,7 @@ mcast_fwd(void *p)
   memcpy(uip_buf, &mcast_buf, mcast_len);
   uip_len = mcast_len;
   UIP_IP_BUF->ttl--;
+  UIP_MCAST6_STATS_FWD_DELAY(mcast_received);
   tcpip_output(NULL);
   uipbuf_clear();
 }
@@ -333,6 +337,7 @@ in()
     if(fwd_delay == 0) {
       /* No delay required, send it, do it now, why wait? */
       UIP_IP_BUF->ttl--;
+      UIP_MCAST6_STATS_FWD_DELAY(clock_time());
       tcpip_output(NULL);
       UIP_IP_BUF->ttl++;        /* Restore before potential upstack delivery */
     } else {
@@ -347,6 +352,11 @@ in()
 
       memcpy(&mcast_buf, uip_buf, uip_len);
       mcast_len = uip_len;
+#if UIP_MCAST6_STATS
+      /* A single buffer, overwritten if still pending */
+      mcast_received = clock_time();
+      UIP_MCAST6_STATS_OCCUPANCY(1, 1);
+#endif
       ctimer_set(&mcast_periodic, fwd_delay, mcast_fwd, NULL);
     }
     PRINTF("ESMRF: %u bytes: fwd in %u [%u]\n",
@@ -370,7 +380,7 @@ static void
 init()
 {
   ESMRF_STATS_INIT();
-  UIP_MCAST6_STATS_INIT(&stats);
+  UIP_MCAST6_STATS_INIT(&stats, sizeof(stats));
 
   uip_mcast6_route_init();
   /* Register the ICMPv6 input handler */
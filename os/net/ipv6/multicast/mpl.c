@@ -52,6 +52,7 @@
 #include "os/lib/trickle-timer.h"
 #include "os/lib/list.h"
 #include "sys/ctimer.h"
+#include <stddef.h>
 #include <string.h>
 
 #include "sys/log.h"
@@ -157,6 +158,14 @@ struct mpl_msg {
   uint16_t size; /* Side of the data stored above */
   uint8_t seq; /* The sequence number of the message */
   uint8_t e; /* Expiration count for trickle timer */
+#if UIP_MCAST6_STATS
+  clock_time_t received; /* For the forwarding delay */
+  uint8_t forwarded; /* Forwarded at least once, or ours */
+#endif
+#if MPL_WITH_INDEX
+  struct mpl_msg *older; /* Previously buffered message */
+  struct mpl_msg *newer; /* Next buffered message */
+#endif
   uint8_t data[UIP_BUFSIZE]; /* Message payload */
 };
 /**
@@ -201,6 +210,11 @@ struct mpl_msg {
 #define SEQ_VAL_ADD(s, n) (((s) + (n)) % 0x100)
 /*---------------------------------------------------------------------------*/
 /* Seed Set */
+/**
+ * \brief The number of bytes needed to cover all sequence numbers from the
+ *  minimum one of a seed
+ */
+#define SEED_WINDOW_LEN 32
 struct mpl_seed {
   seed_id_t seed_id;
   uint8_t min_seqno; /* Used when the seed set is empty */
@@ -208,6 +222,10 @@ struct mpl_seed {
   uint8_t count; /* Only used for determining largest msg set during reclaim */
   LIST_STRUCT(min_seq); /* Pointer to the first msg in this seed's set */
   struct mpl_domain *domain; /* The domain this seed belongs to */
+#if MPL_WITH_INDEX
+  struct mpl_seed *hash_next; /* Next seed in the same hash bucket */
+  uint8_t window[SEED_WINDOW_LEN]; /* Bit i is set if min_seqno + i is buffered */
+#endif
 };
 /**
  * \brief Get the state of the used flag in the buffered message set entry
@@ -226,6 +244,9 @@ struct mpl_domain {
   uip_ip6addr_t ctrl_addr; /* Link-local scoped version of data address */
   struct trickle_timer tt;
   uint8_t e; /* Expiration count for trickle timer */
+#if MPL_WITH_INDEX
+  struct mpl_domain *hash_next; /* Next domain in the same hash bucket */
+#endif
 };
 /**
  * \brief Get the state of the used flag in the buffered message set entry
@@ -405,6 +426,13 @@ static seed_id_t local_seed_id;
 static uip_ip6addr_t all_forwarders;
 #endif
 static struct ctimer lifetime_timer;
+#if MPL_WITH_INDEX
+static struct mpl_seed *seed_hash[MPL_SEED_HASH_BUCKETS];
+static struct mpl_domain *domain_hash[MPL_DOMAIN_HASH_BUCKETS];
+static struct mpl_msg *free_msgs; /* Unused buffers, linked through next */
+static struct mpl_msg *oldest_msg; /* Used buffers, from the oldest... */
+static struct mpl_msg *newest_msg; /* ...to the newest */
+#endif
 /*---------------------------------------------------------------------------*/
 /* Temporary Stores */
 /*---------------------------------------------------------------------------*/
@@ -460,15 +488,161 @@ extern uint16_t uip_slen;
  * a: uip_ip6addr_t address to modify
  */
 #define UIP_ADDR_MAKE_LINK_LOCAL(a) (((uip_ip6addr_t *)a)->u8[1] = UIP_MCAST6_SCOPE_LINK_LOCAL)
+/**
+ * \brief Get whether a seed may have buffered a sequence number. Without the
+ *  index, this is only known after walking the message set of the seed.
+ * s: pointer to the seed set entry, with a non-empty message set
+ * seq: the sequence number
+ */
+#if MPL_WITH_INDEX
+#define SEED_WINDOW_HAS_SEQ(s, seq) BIT_VECTOR_GET_BIT((s)->window, (uint8_t)((seq) - (s)->min_seqno))
+#else
+#define SEED_WINDOW_HAS_SEQ(s, seq) 1
+#endif
 /*---------------------------------------------------------------------------*/
 /* Local function prototypes */
 /*---------------------------------------------------------------------------*/
 static void icmp_in(void);
 UIP_ICMP6_HANDLER(mpl_icmp_handler, ICMP6_MPL, 0, icmp_in);
 
+#if MPL_WITH_INDEX
+static uint8_t
+seed_hash_key(seed_id_t *seed_id, struct mpl_domain *domain)
+{
+  uint8_t i;
+  uint16_t key;
+
+  key = domain - domain_set;
+  for(i = 0; i < sizeof(seed_id->id); i++) {
+    key = key * 31 + seed_id->id[i];
+  }
+  return key % MPL_SEED_HASH_BUCKETS;
+}
+static void
+seed_index_add(struct mpl_seed *s)
+{
+  uint8_t key = seed_hash_key(&s->seed_id, s->domain);
+  s->hash_next = seed_hash[key];
+  seed_hash[key] = s;
+}
+static void
+seed_index_remove(struct mpl_seed *s)
+{
+  struct mpl_seed **sp;
+  for(sp = &seed_hash[seed_hash_key(&s->seed_id, s->domain)]; *sp != NULL; sp = &(*sp)->hash_next) {
+    if(*sp == s) {
+      *sp = s->hash_next;
+      return;
+    }
+  }
+}
+/* The scope is left out, so that both addresses of a domain share a bucket */
+static uint8_t
+domain_hash_key(uip_ip6addr_t *address)
+{
+  uint8_t i;
+  uint16_t key;
+
+  key = address->u8[0];
+  for(i = 2; i < sizeof(address->u8); i++) {
+    key = key * 31 + address->u8[i];
+  }
+  return key % MPL_DOMAIN_HASH_BUCKETS;
+}
+static void
+domain_index_add(struct mpl_domain *d)
+{
+  uint8_t key = domain_hash_key(&d->data_addr);
+  d->hash_next = domain_hash[key];
+  domain_hash[key] = d;
+}
+static void
+domain_index_remove(struct mpl_domain *d)
+{
+  struct mpl_domain **dp;
+  for(dp = &domain_hash[domain_hash_key(&d->data_addr)]; *dp != NULL; dp = &(*dp)->hash_next) {
+    if(*dp == d) {
+      *dp = d->hash_next;
+      return;
+    }
+  }
+}
+/* Move the window of a seed up by n sequence numbers */
+static void
+seed_window_advance(struct mpl_seed *s, uint16_t n)
+{
+  uint8_t i;
+  uint8_t bytes = n / 8;
+  uint8_t bits = n % 8;
+
+  if(n >= SEED_WINDOW_LEN * 8) {
+    memset(s->window, 0, sizeof(s->window));
+    return;
+  }
+  for(i = 0; i < SEED_WINDOW_LEN; i++) {
+    if(i + bytes >= SEED_WINDOW_LEN) {
+      s->window[i] = 0;
+      continue;
+    }
+    s->window[i] = s->window[i + bytes] << bits;
+    if(bits > 0 && i + bytes + 1 < SEED_WINDOW_LEN) {
+      s->window[i] |= s->window[i + bytes + 1] >> (8 - bits);
+    }
+  }
+}
+static void
+age_append(struct mpl_msg *msg)
+{
+  msg->older = newest_msg;
+  msg->newer = NULL;
+  if(newest_msg != NULL) {
+    newest_msg->newer = msg;
+  } else {
+    oldest_msg = msg;
+  }
+  newest_msg = msg;
+}
+static void
+age_remove(struct mpl_msg *msg)
+{
+  if(msg->older != NULL) {
+    msg->older->newer = msg->newer;
+  } else {
+    oldest_msg = msg->newer;
+  }
+  if(msg->newer != NULL) {
+    msg->newer->older = msg->older;
+  } else {
+    newest_msg = msg->older;
+  }
+}
+static void
+index_init(void)
+{
+  memset(seed_hash, 0, sizeof(seed_hash));
+  memset(domain_hash, 0, sizeof(domain_hash));
+  oldest_msg = NULL;
+  newest_msg = NULL;
+  free_msgs = NULL;
+  for(locmmptr = &buffered_message_set[MPL_BUFFERED_MESSAGE_SET_SIZE - 1]; locmmptr >= buffered_message_set; locmmptr--) {
+    locmmptr->next = free_msgs;
+    free_msgs = locmmptr;
+  }
+}
+#endif /* MPL_WITH_INDEX */
 static struct mpl_msg *
 buffer_allocate(void)
 {
+#if MPL_WITH_INDEX
+  locmmptr = free_msgs;
+  if(locmmptr != NULL) {
+    free_msgs = locmmptr->next;
+    /* The payload is overwritten on accept */
+    memset(locmmptr, 0, offsetof(struct mpl_msg, data));
+    age_append(locmmptr);
+  }
+  return locmmptr;
+#else
   for(locmmptr = &buffered_message_set[MPL_BUFFERED_MESSAGE_SET_SIZE - 1]; locmmptr >= buffered_message_set; locmmptr--) {
     if(!MSG_SET_IS_USED(locmmptr)) {
       memset(locmmptr, 0, sizeof(struct mpl_msg));
@@ -476,6 +650,7 @@ buffer_allocate(void)
     }
   }
   return NULL;
+#endif
 }
 static void
 buffer_free(struct mpl_msg *msg)
@@ -484,22 +659,36 @@ buffer_free(struct mpl_msg *msg)
     trickle_timer_stop(&msg->tt);
   }
   MSG_SET_CLEAR_USED(msg);
+#if MPL_WITH_INDEX
+  age_remove(msg);
+  msg->next = free_msgs;
+  free_msgs = msg;
+#endif
 }
 static struct mpl_msg *
 buffer_reclaim(void)
 {
-  static struct mpl_seed *ssptr; /* Can't use locssptr since it's used by calling function */
-  static struct mpl_seed *largest;
+  static struct mpl_seed *victim; /* Can't use locssptr since it's used by calling function */
   static struct mpl_msg *reclaim;
+#if !MPL_WITH_INDEX
+  static struct mpl_seed *ssptr;
+#endif
 
-  /* Reclaim the message with min_seq in the largest seed set */
-  largest = NULL;
+  victim = NULL;
   reclaim = NULL;
-  for(ssptr = &seed_set[MPL_SEED_SET_SIZE]; ssptr >= seed_set; ssptr--) {
-    if(SEED_SET_IS_USED(ssptr) && (largest == NULL || ssptr->count > largest->count)) {
-      largest = ssptr;
+#if MPL_WITH_INDEX
+  /* Reclaim the message with min_seq in the seed set of the oldest message */
+  if(oldest_msg != NULL) {
+    victim = oldest_msg->seed;
+  }
+#else
+  /* Reclaim the message with min_seq in the largest seed set */
+  for(ssptr = &seed_set[MPL_SEED_SET_SIZE - 1]; ssptr >= seed_set; ssptr--) {
+    if(SEED_SET_IS_USED(ssptr) && (victim == NULL || ssptr->count > victim->count)) {
+      victim = ssptr;
     }
   }
+#endif
   /**
    * To reclaim this, we need to increment the min seq number to
    *   the next largest sequence number in the set.
@@ -508,16 +697,42 @@ buffer_reclaim(void)
    *   order messages are sent.
    * We've already worked out what this new value is.
    */
-  if(largest != NULL) {
-    reclaim = list_pop(largest->min_seq);
-    largest->min_seqno = list_item_next(reclaim) == NULL ? reclaim->seq : ((struct mpl_msg *)list_item_next(reclaim))->seq;
-    largest->count--;
+  if(victim != NULL) {
+    reclaim = list_pop(victim->min_seq);
+#if MPL_WITH_INDEX
+    seed_window_advance(victim, list_head(victim->min_seq) == NULL ? SEED_WINDOW_LEN * 8 :
+                        (uint8_t)(((struct mpl_msg *)list_head(victim->min_seq))->seq - victim->min_seqno));
+#endif
+    victim->min_seqno = list_item_next(reclaim) == NULL ? reclaim->seq : ((struct mpl_msg *)list_item_next(reclaim))->seq;
+    victim->count--;
     trickle_timer_stop(&reclaim->tt);
     mpl_trickle_timer_reset(reclaim->seed->domain);
+#if MPL_WITH_INDEX
+    /* Reuse it as the newest message */
+    age_remove(reclaim);
+    memset(reclaim, 0, offsetof(struct mpl_msg, data));
+    age_append(reclaim);
+#else
     memset(reclaim, 0, sizeof(struct mpl_msg));
+#endif
   }
   return reclaim;
 }
+#if UIP_MCAST6_STATS
+static uint16_t
+buffer_count_used(void)
+{
+  struct mpl_msg *msg;
+  uint16_t used = 0;
+
+  for(msg = &buffered_message_set[MPL_BUFFERED_MESSAGE_SET_SIZE - 1]; msg >= buffered_message_set; msg--) {
+    if(MSG_SET_IS_USED(msg)) {
+      used++;
+    }
+  }
+  return used;
+}
+#endif /* UIP_MCAST6_STATS */
 static struct mpl_domain *
 domain_set_allocate(uip_ip6addr_t *address)
 {
@@ -564,6 +779,9 @@ domain_set_allocate(uip_ip6addr_t *address)
         DOMAIN_SET_CLEAR_USED(locdsptr);
         return NULL;
       }
+#if MPL_WITH_INDEX
+      domain_index_add(locdsptr);
+#endif
       return locdsptr;
     }
   }
@@ -573,12 +791,21 @@ domain_set_allocate(uip_ip6addr_t *address)
 static struct mpl_seed *
 seed_set_lookup(seed_id_t *seed_id, struct mpl_domain *domain)
 {
+#if MPL_WITH_INDEX
+  for(locssptr = seed_hash[seed_hash_key(seed_id, domain)]; locssptr != NULL; locssptr = locssptr->hash_next) {
+    if(seed_id_cmp(seed_id, &locssptr->seed_id) && locssptr->domain == domain) {
+      return locssptr;
+    }
+  }
+  return NULL;
+#else
   for(locssptr = &seed_set[MPL_SEED_SET_SIZE - 1]; locssptr >= seed_set; locssptr--) {
     if(SEED_SET_IS_USED(locssptr) && seed_id_cmp(seed_id, &locssptr->seed_id) && locssptr->domain == domain) {
       return locssptr;
     }
   }
   return NULL;
+#endif
 }
 static struct mpl_seed *
 seed_set_allocate(void)
@@ -598,11 +825,23 @@ seed_set_free(struct mpl_seed *s)
   while((locmmptr = list_pop(s->min_seq)) != NULL) {
     buffer_free(locmmptr);
   }
+#if MPL_WITH_INDEX
+  seed_index_remove(s);
+#endif
   SEED_SET_CLEAR_USED(s);
 }
 static struct mpl_domain *
 domain_set_lookup(uip_ip6addr_t *domain)
 {
+#if MPL_WITH_INDEX
+  for(locdsptr = domain_hash[domain_hash_key(domain)]; locdsptr != NULL; locdsptr = locdsptr->hash_next) {
+    if(uip_ip6addr_cmp(domain, &locdsptr->data_addr)
+       || uip_ip6addr_cmp(domain, &locdsptr->ctrl_addr)) {
+      return locdsptr;
+    }
+  }
+  return NULL;
+#else
   for(locdsptr = &domain_set[MPL_DOMAIN_SET_SIZE - 1]; locdsptr >= domain_set; locdsptr--) {
     if(DOMAIN_SET_IS_USED(locdsptr)) {
       if(uip_ip6addr_cmp(domain, &locdsptr->data_addr)
@@ -612,13 +851,14 @@ domain_set_lookup(uip_ip6addr_t *domain)
     }
   }
   return NULL;
+#endif
 }
 static void
 domain_set_free(struct mpl_domain *domain)
 {
   uip_ds6_maddr_t *addr;
   /* Must include freeing seeds otherwise we leak memory */
-  for(locssptr = &seed_set[MPL_SEED_SET_SIZE]; locssptr >= seed_set; locssptr--) {
+  for(locssptr = &seed_set[MPL_SEED_SET_SIZE - 1]; locssptr >= seed_set; locssptr--) {
     if(SEED_SET_IS_USED(locssptr) && locssptr->domain == domain) {
       seed_set_free(locssptr);
     }
@@ -634,6 +874,9 @@ domain_set_free(struct mpl_domain *domain)
   if(trickle_timer_is_running(&domain->tt)) {
     trickle_timer_stop(&domain->tt);
   }
+#if MPL_WITH_INDEX
+  domain_index_remove(domain);
+#endif
   DOMAIN_SET_CLEAR_USED(domain);
 }
 static void
@@ -759,7 +1002,9 @@ icmp_out(struct mpl_domain *dom)
   uint8_t vector[32];
   uint8_t vec_size;
   uint8_t vec_len;
+#if !MPL_WITH_INDEX
   uint8_t cur_seq;
+#endif
   uint16_t payload_len;
   uip_ds6_addr_t *addr;
   size_t seed_info_len;
@@ -823,12 +1068,18 @@ icmp_out(struct mpl_domain *dom)
       }
 
       /* Populate the seed info message vector */
-      memset(vector, 0, sizeof(vector));
-      vec_len = 0;
-      cur_seq = 0;
       LOG_INFO("\nBuffer for seed: ");
       LOG_INFO_SEED(locssptr->seed_id);
       LOG_INFO_("\n");
+#if MPL_WITH_INDEX
+      /* The window is the vector, up to its last non-zero byte */
+      memcpy(vector, locssptr->window, sizeof(vector));
+      for(vec_size = sizeof(vector); vec_size > 1 && vector[vec_size - 1] == 0; vec_size--);
+      vec_len = locssptr->count;
+#else
+      memset(vector, 0, sizeof(vector));
+      vec_len = 0;
+      cur_seq = 0;
       for(locmmptr = list_head(locssptr->min_seq); locmmptr != NULL; locmmptr = list_item_next(locmmptr)) {
         LOG_INFO("%d -- %x\n", locmmptr->seq, locmmptr->data[locmmptr->size - 1]);
         cur_seq = SEQ_VAL_ADD(locssptr->min_seqno, vec_len);
@@ -845,6 +1096,7 @@ icmp_out(struct mpl_domain *dom)
 
       /* Convert vector length from bits to bytes */
       vec_size = (vec_len - 1) / 8 + 1;
+#endif
 
       SEED_INFO_SET_LEN(locsiptr, vec_size);
 
@@ -981,9 +1233,17 @@ data_message_expiration(void *ptr, uint8_t suppress)
     uip_len += locmmptr->size;
     uipbuf_set_len_field(UIP_IP_BUF, uip_len - UIP_IPH_LEN);
     uip_ip6addr_copy(&UIP_IP_BUF->srcipaddr, &locmmptr->srcipaddr);
+#if UIP_MCAST6_STATS
+    if(!locmmptr->forwarded) {
+      UIP_MCAST6_STATS_FWD_DELAY(locmmptr->received);
+      locmmptr->forwarded = 1;
+    }
+#endif
     tcpip_output(NULL);
     uipbuf_clear();
     UIP_MCAST6_STATS_ADD(mcast_out);
+  } else {
+    UIP_MCAST6_STATS_ADD(mcast_suppressed);
   }
 
   locmmptr->e++;
@@ -1115,7 +1375,7 @@ icmp_in(void)
     locdsptr = domain_set_allocate(&UIP_IP_BUF->destipaddr);
     if(!locdsptr) {
       LOG_ERR("Couldn't allocate new domain. Dropping.\n");
-      UIP_MCAST6_STATS_ADD(icmp_bad);
+      MPL_STATS_ADD(icmp_bad);
       goto discard;
     }
     mpl_control_trickle_timer_start(locdsptr);
@@ -1509,11 +1769,12 @@ accept(uint8_t in)
       UIP_MCAST6_STATS_ADD(mcast_dropped);
       return UIP_MCAST6_DROP;
     }
-    if(list_head(locssptr->min_seq) != NULL) {
+    if(list_head(locssptr->min_seq) != NULL && SEED_WINDOW_HAS_SEQ(locssptr, seq_val)) {
       for(locmmptr = list_head(locssptr->min_seq); locmmptr != NULL; locmmptr = list_item_next(locmmptr)) {
         if(SEQ_VAL_IS_EQ(seq_val, locmmptr->seq)) {
           /* Seen before , drop */
           LOG_INFO("Seen before\n");
+          UIP_MCAST6_STATS_ADD(mcast_in_dup);
           if(HBH_GET_M(lochbhmptr) && list_item_next(locmmptr) != NULL) {
             mpl_trickle_timer_inconsistency(locmmptr);
           } else {
@@ -1541,6 +1802,9 @@ accept(uint8_t in)
     LIST_STRUCT_INIT(locssptr, min_seq);
     seed_id_cpy(&locssptr->seed_id, &seed_id);
     locssptr->domain = locdsptr;
+#if MPL_WITH_INDEX
+    seed_index_add(locssptr);
+#endif
   }
 
   /* Allocate a buffer */
@@ -1553,6 +1817,13 @@ accept(uint8_t in)
       UIP_MCAST6_STATS_ADD(mcast_dropped);
       return UIP_MCAST6_DROP;
     }
+    /* The reclaimed message may have moved this seed's min seq past ours */
+    if(list_head(locssptr->min_seq) != NULL && SEQ_VAL_IS_LT(seq_val, locssptr->min_seqno)) {
+      LOG_INFO("Too old after reclaim\n");
+      buffer_free(locmmptr);
+      UIP_MCAST6_STATS_ADD(mcast_dropped);
+      return UIP_MCAST6_DROP;
+    }
   }
 
   /* We have a domain set, a seed set, and we have a buffer. Accept this message */
@@ -1579,6 +1850,11 @@ accept(uint8_t in)
   memcpy(&locmmptr->data, hptr, locmmptr->size);
   locmmptr->seq = seq_val;
   locmmptr->seed = locssptr;
+#if UIP_MCAST6_STATS
+  locmmptr->received = clock_time();
+  locmmptr->forwarded = in != MPL_DGRAM_IN;
+  UIP_MCAST6_STATS_OCCUPANCY(buffer_count_used(), MPL_BUFFERED_MESSAGE_SET_SIZE);
+#endif
   if(!trickle_timer_config(&locmmptr->tt,
                            MPL_DATA_MESSAGE_IMIN,
                            MPL_DATA_MESSAGE_IMAX,
@@ -1601,6 +1877,9 @@ accept(uint8_t in)
       }
     }
   }
+#if MPL_WITH_INDEX
+  BIT_VECTOR_SET_BIT(locssptr->window, (uint8_t)(locmmptr->seq - locssptr->min_seqno));
+#endif
   locssptr->count++;
 
 #if MPL_PROACTIVE_FORWARDING
@@ -1772,6 +2051,9 @@ init(void)
   memset(domain_set, 0, sizeof(struct mpl_domain) * MPL_DOMAIN_SET_SIZE);
   memset(seed_set, 0, sizeof(struct mpl_seed) * MPL_SEED_SET_SIZE);
   memset(buffered_message_set, 0, sizeof(struct mpl_msg) * MPL_BUFFERED_MESSAGE_SET_SIZE);
+#if MPL_WITH_INDEX
+  index_init();
+#endif
 
   /* Register the ICMPv6 input handler */
   uip_icmp6_register_input_handler(&mpl_icmp_handler);
@@ -1780,6 +2062,7 @@ init(void)
 
   /* Init MPL Stats */
   MPL_STATS_INIT();
+  UIP_MCAST6_STATS_INIT(&stats, sizeof(stats));
 
 #if MPL_SUB_TO_ALL_FORWARDERS
   /* Subscribe to the All MPL Forwarders Address by default */
@@ -216,6 +216,46 @@
 #define MPL_BUFFERED_MESSAGE_SET_SIZE MPL_CONF_BUFFERED_MESSAGE_SET_SIZE
 #endif
 /*---------------------------------------------------------------------------*/
+/**
+ * Seed, Domain and Buffered Message Set Index
+ * With large sets, looking up seeds and domains and reclaiming buffers for
+ * every received message and every trickle expiration gets expensive. With
+ * the index enabled, seeds and domains are kept in hash tables, each seed
+ * keeps a bitmap of the sequence numbers it has buffered, which answers
+ * duplicate checks and is sent as is in control messages, and free and used
+ * buffers are kept on lists so that allocation and reclaim take constant
+ * time. Reclaim then drops the lowest sequence number of the seed that owns
+ * the oldest buffered message, instead of that of the largest seed.
+ * 1 - Indicates that the index be enabled
+ * 0 - Indicates that the index be disabled
+ */
+#ifndef MPL_CONF_WITH_INDEX
+#define MPL_WITH_INDEX                      0
+#else
+#define MPL_WITH_INDEX MPL_CONF_WITH_INDEX
+#endif
+/*---------------------------------------------------------------------------*/
+/**
+ * Seed Set Hash Buckets
+ * The number of hash buckets seeds are spread over when the index is enabled.
+ */
+#ifndef MPL_CONF_SEED_HASH_BUCKETS
+#define MPL_SEED_HASH_BUCKETS               8
+#else
+#define MPL_SEED_HASH_BUCKETS MPL_CONF_SEED_HASH_BUCKETS
+#endif
+/*---------------------------------------------------------------------------*/
+/**
+ * Domain Set Hash Buckets
+ * The number of hash buckets domains are spread over when the index is
+ * enabled. The data and control addresses of a domain share a bucket.
+ */
+#ifndef MPL_CONF_DOMAIN_HASH_BUCKETS
+#define MPL_DOMAIN_HASH_BUCKETS             4
+#else
+#define MPL_DOMAIN_HASH_BUCKETS MPL_CONF_DOMAIN_HASH_BUCKETS
+#endif
+/*---------------------------------------------------------------------------*/
 /**
  * MPL Forwarding Strategy
  * Two forwarding strategies are defined for MPL. With Proactive forwarding
@@ -276,11 +276,15 @@ struct mcast_packet {
   uint16_t seq_val;             /* host-byte order */
   struct sliding_window *sw;    /* Pointer to the SW this packet belongs to */
   uint8_t flags;                /* Is-Used, Must Send, Is Listed */
+#if UIP_MCAST6_STATS
+  clock_time_t received;        /* For the forwarding delay */
+#endif
   uint8_t buff[UIP_BUFSIZE];
 };
 
 /* Flag bits */
 #define MCAST_PACKET_U_BIT       0x80   /* Is Used */
+#define MCAST_PACKET_F_BIT       0x40   /* Forwarded, or ours */
 #define MCAST_PACKET_S_BIT       0x20   /* Must Send Next Pass */
 #define MCAST_PACKET_L_BIT       0x10   /* Is listed in ICMP message */
 
@@ -356,6 +360,18 @@ struct mcast_packet {
  * p: pointer to a struct mcast_packet
  */
 #define MCAST_PACKET_FREE(p) ((p)->flags = 0)
+
+/**
+ * \brief Check if a packet has been forwarded, or was sent by us
+ * p: pointer to a packet buffer
+ */
+#define MCAST_PACKET_IS_FORWARDED(p) ((p)->flags & MCAST_PACKET_F_BIT)
+
+/**
+ * \brief Mark a packet as forwarded
+ * p: pointer to a packet buffer
+ */
+#define MCAST_PACKET_FORWARDED_SET(p) ((p)->flags |= MCAST_PACKET_F_BIT)
 /*---------------------------------------------------------------------------*/
 /* Sequence Lists in Multicast Trickle ICMP messages */
 struct sequence_list_header {
@@ -622,9 +638,18 @@ handle_timer(void *ptr)
           memcpy(UIP_IP_BUF, &locmpptr->buff, uip_len);
 
           UIP_MCAST6_STATS_ADD(mcast_fwd);
+#if UIP_MCAST6_STATS
+          if(!MCAST_PACKET_IS_FORWARDED(locmpptr)) {
+            UIP_MCAST6_STATS_FWD_DELAY(locmpptr->received);
+            MCAST_PACKET_FORWARDED_SET(locmpptr);
+          }
+#endif
           tcpip_output(NULL);
           MCAST_PACKET_SEND_CLR(locmpptr);
           watchdog_periodic();
+        } else if(locmpptr->active < TRICKLE_ACTIVE(param)) {
+          /* Neighbors have it already */
+          UIP_MCAST6_STATS_ADD(mcast_suppressed);
         }
       }
     }
@@ -790,6 +815,22 @@ buffer_allocate()
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
+#if UIP_MCAST6_STATS
+static uint16_t
+buffer_count_used(void)
+{
+  struct mcast_packet *p;
+  uint16_t used = 0;
+
+  for(p = &buffered_msgs[ROLL_TM_BUFF_NUM - 1]; p >= buffered_msgs; p--) {
+    if(MCAST_PACKET_IS_USED(p)) {
+      used++;
+    }
+  }
+  return used;
+}
+#endif /* UIP_MCAST6_STATS */
+/*---------------------------------------------------------------------------*/
 static void
 icmp_output()
 {
@@ -980,6 +1021,7 @@ accept(uint8_t in)
          SEQ_VAL_IS_EQ(seq_val, locmpptr->seq_val)) {
         /* Seen before , drop */
         PRINTF("ROLL TM: Seen before\n");
+        UIP_MCAST6_STATS_ADD(mcast_in_dup);
         UIP_MCAST6_STATS_ADD(mcast_dropped);
         return UIP_MCAST6_DROP;
       }
@@ -1057,6 +1099,13 @@ accept(uint8_t in)
   locmpptr->buff_len = uip_len;
   locmpptr->seq_val = seq_val;
   MCAST_PACKET_USED_SET(locmpptr);
+#if UIP_MCAST6_STATS
+  locmpptr->received = clock_time();
+  if(in != ROLL_TM_DGRAM_IN) {
+    MCAST_PACKET_FORWARDED_SET(locmpptr);
+  }
+  UIP_MCAST6_STATS_OCCUPANCY(buffer_count_used(), ROLL_TM_BUFF_NUM);
+#endif
 
   PRINTF("ROLL TM: Window for seed ");
   PRINT_SEED(&locswptr->seed_id);
@@ -1410,7 +1459,7 @@ init()
   memset(t, 0, sizeof(t));
 
   ROLL_TM_STATS_INIT();
-  UIP_MCAST6_STATS_INIT(&stats);
+  UIP_MCAST6_STATS_INIT(&stats, sizeof(stats));
 
   /* Register the ICMPv6 input handler */
   uip_icmp6_register_input_handler(&roll_tm_icmp_handler);
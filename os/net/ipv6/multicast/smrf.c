@@ -75,6 +75,9 @@ static struct ctimer mcast_periodic;
 static uint8_t mcast_len;
 static uip_buf_t mcast_buf;
 static uint8_t fwd_delay;
+#if UIP_MCAST6_STATS
+static clock_time_t mcast_received;
+#endif
 static uint8_t fwd_spread;
 /*---------------------------------------------------------------------------*/
 static void
@@ -83,6 +86,7 @@ mcast_fwd(void *p)
   memcpy(uip_buf, &mcast_buf, mcast_len);
   uip_len = mcast_len;
   UIP_IP_BUF->ttl--;
+  UIP_MCAST6_STATS_FWD_DELAY(mcast_received);
   tcpip_output(NULL);
   uipbuf_clear();
 }
@@ -162,6 +166,7 @@ in()
     if(fwd_delay == 0) {
       /* No delay required, send it, do it now, why wait? */
       UIP_IP_BUF->ttl--;
+      UIP_MCAST6_STATS_FWD_DELAY(clock_time());
       tcpip_output(NULL);
       UIP_IP_BUF->ttl++;        /* Restore before potential upstack delivery */
     } else {
@@ -176,6 +181,11 @@ in()
 
       memcpy(&mcast_buf, uip_buf, uip_len);
       mcast_len = uip_len;
+#if UIP_MCAST6_STATS
+      /* A single buffer, overwritten if still pending */
+      mcast_received = clock_time();
+      UIP_MCAST6_STATS_OCCUPANCY(1, 1);
+#endif
       ctimer_set(&mcast_periodic, fwd_delay, mcast_fwd, NULL);
     }
     PRINTF("SMRF: %u bytes: fwd in %u [%u]\n",
@@ -198,7 +208,7 @@ in()
 static void
 init()
 {
-  UIP_MCAST6_STATS_INIT(NULL);
+  UIP_MCAST6_STATS_INIT(NULL, 0);
 
   uip_mcast6_route_init();
 }
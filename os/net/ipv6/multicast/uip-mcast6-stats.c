@@ -39,16 +39,114 @@
  *    George Oikonomou - <oikonomou@users.sourceforge.net>
  */
 #include "net/ipv6/multicast/uip-mcast6-stats.h"
+#include "net/ipv6/multicast/uip-mcast6.h"
 
 #include <string.h>
 /*---------------------------------------------------------------------------*/
 uip_mcast6_stats_t uip_mcast6_stats;
 /*---------------------------------------------------------------------------*/
 void
-uip_mcast6_stats_init(void *stats)
+uip_mcast6_stats_init(void *stats, uint16_t len)
 {
   memset(&uip_mcast6_stats, 0, sizeof(uip_mcast6_stats));
   uip_mcast6_stats.engine_stats = stats;
+  uip_mcast6_stats.engine_stats_len = stats == NULL ? 0 : len;
+}
+/*---------------------------------------------------------------------------*/
+void
+uip_mcast6_stats_reset(void)
+{
+  void *stats = uip_mcast6_stats.engine_stats;
+  uint16_t len = uip_mcast6_stats.engine_stats_len;
+
+  if(stats != NULL) {
+    memset(stats, 0, len);
+  }
+  uip_mcast6_stats_init(stats, len);
+}
+/*---------------------------------------------------------------------------*/
+void
+uip_mcast6_stats_fwd_delay(clock_time_t received)
+{
+  uint32_t delay;
+  uint8_t bin;
+
+  delay = (uint32_t)(clock_time() - received) * 1000 / CLOCK_SECOND;
+  uip_mcast6_stats.fwd_delay_count++;
+  uip_mcast6_stats.fwd_delay_sum += delay;
+  if(delay > uip_mcast6_stats.fwd_delay_max) {
+    uip_mcast6_stats.fwd_delay_max = delay;
+  }
+  for(bin = 0; bin < UIP_MCAST6_STATS_DELAY_BINS - 1; bin++) {
+    if(delay < ((uint32_t)UIP_MCAST6_STATS_DELAY_BIN_MS << bin)) {
+      break;
+    }
+  }
+  uip_mcast6_stats.fwd_delay_hist[bin]++;
+}
+/*---------------------------------------------------------------------------*/
+void
+uip_mcast6_stats_occupancy(uint16_t used, uint16_t total)
+{
+  uint8_t bin;
+
+  if(total == 0) {
+    return;
+  }
+  bin = (uint32_t)used * UIP_MCAST6_STATS_OCCUPANCY_BINS / total;
+  if(bin >= UIP_MCAST6_STATS_OCCUPANCY_BINS) {
+    bin = UIP_MCAST6_STATS_OCCUPANCY_BINS - 1;
+  }
+  uip_mcast6_stats.occupancy_hist[bin]++;
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t *
+put_u32(uint8_t *p, uint32_t val)
+{
+  *p++ = val >> 24;
+  *p++ = val >> 16;
+  *p++ = val >> 8;
+  *p++ = val;
+  return p;
+}
+/*---------------------------------------------------------------------------*/
+int
+uip_mcast6_stats_dump(uint8_t *buf, int buflen)
+{
+  uint8_t *p = buf;
+  uint8_t i;
+
+  if(buflen < UIP_MCAST6_STATS_DUMP_LEN) {
+    return 0;
+  }
+
+  *p++ = 'M';
+  *p++ = '6';
+  *p++ = 1;
+  *p++ = UIP_MCAST6_ENGINE;
+  *p++ = UIP_MCAST6_STATS_DELAY_BIN_MS >> 8;
+  *p++ = UIP_MCAST6_STATS_DELAY_BIN_MS & 0xff;
+
+  p = put_u32(p, uip_mcast6_stats.mcast_in_unique);
+  p = put_u32(p, uip_mcast6_stats.mcast_in_all);
+  p = put_u32(p, uip_mcast6_stats.mcast_in_ours);
+  p = put_u32(p, uip_mcast6_stats.mcast_fwd);
+  p = put_u32(p, uip_mcast6_stats.mcast_out);
+  p = put_u32(p, uip_mcast6_stats.mcast_bad);
+  p = put_u32(p, uip_mcast6_stats.mcast_dropped);
+  p = put_u32(p, uip_mcast6_stats.mcast_in_dup);
+  p = put_u32(p, uip_mcast6_stats.mcast_suppressed);
+  p = put_u32(p, uip_mcast6_stats.fwd_delay_count);
+  p = put_u32(p, uip_mcast6_stats.fwd_delay_sum);
+  p = put_u32(p, uip_mcast6_stats.fwd_delay_max);
+  for(i = 0; i < UIP_MCAST6_STATS_DELAY_BINS; i++) {
+    p = put_u32(p, uip_mcast6_stats.fwd_delay_hist[i]);
+  }
+  for(i = 0; i < UIP_MCAST6_STATS_OCCUPANCY_BINS; i++) {
+    p = put_u32(p, uip_mcast6_stats.occupancy_hist[i]);
+  }
+
+  return p - buf;
 }
 /*---------------------------------------------------------------------------*/
 /** @} */
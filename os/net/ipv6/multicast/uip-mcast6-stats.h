@@ -58,6 +58,28 @@
 #define UIP_MCAST6_STATS 0
 #endif
 /*---------------------------------------------------------------------------*/
+/**
+ * Forwarding delays are kept in a histogram with bins of exponentially
+ * increasing width: bin 0 holds delays under UIP_MCAST6_STATS_DELAY_BIN_MS,
+ * bin i delays under UIP_MCAST6_STATS_DELAY_BIN_MS << i, and the last bin
+ * all longer delays.
+ */
+#ifdef UIP_MCAST6_CONF_STATS_DELAY_BIN_MS
+#define UIP_MCAST6_STATS_DELAY_BIN_MS UIP_MCAST6_CONF_STATS_DELAY_BIN_MS
+#else
+#define UIP_MCAST6_STATS_DELAY_BIN_MS 16
+#endif
+
+#define UIP_MCAST6_STATS_DELAY_BINS 8
+
+/**
+ * Buffer occupancy is sampled every time an engine buffers a datagram, and
+ * kept in a histogram with bins of equal width: bin i holds the samples
+ * where between i and i + 1 eighths of the buffers were in use, with full
+ * buffers in the last bin.
+ */
+#define UIP_MCAST6_STATS_OCCUPANCY_BINS 8
+/*---------------------------------------------------------------------------*/
 /* Stats datatype */
 /*---------------------------------------------------------------------------*/
 /**
@@ -87,8 +109,32 @@ typedef struct uip_mcast6_stats {
   /** Count of multicast datagrams correclty formed but dropped by us */
   UIP_MCAST6_STATS_DATATYPE mcast_dropped;
 
+  /** Count of datagrams received again, and dropped as duplicates */
+  UIP_MCAST6_STATS_DATATYPE mcast_in_dup;
+
+  /** Count of datagram transmissions that we suppressed */
+  UIP_MCAST6_STATS_DATATYPE mcast_suppressed;
+
+  /** Count of datagrams whose forwarding delay was measured */
+  UIP_MCAST6_STATS_DATATYPE fwd_delay_count;
+
+  /** Sum of the forwarding delays, in milliseconds */
+  uint32_t fwd_delay_sum;
+
+  /** Longest forwarding delay, in milliseconds */
+  uint32_t fwd_delay_max;
+
+  /** Histogram of the forwarding delays */
+  UIP_MCAST6_STATS_DATATYPE fwd_delay_hist[UIP_MCAST6_STATS_DELAY_BINS];
+
+  /** Histogram of the buffer occupancy */
+  UIP_MCAST6_STATS_DATATYPE occupancy_hist[UIP_MCAST6_STATS_OCCUPANCY_BINS];
+
   /** Opaque pointer to an engine's additional stats */
   void *engine_stats;
+
+  /** Size of the engine's additional stats */
+  uint16_t engine_stats_len;
 } uip_mcast6_stats_t;
 /*---------------------------------------------------------------------------*/
 /* Access macros */
@@ -99,18 +145,64 @@ extern uip_mcast6_stats_t uip_mcast6_stats;
 
 #define UIP_MCAST6_STATS_ADD(x) uip_mcast6_stats.x++
 #define UIP_MCAST6_STATS_GET(x) uip_mcast6_stats.x
-#define UIP_MCAST6_STATS_INIT(s) uip_mcast6_stats_init(s)
+#define UIP_MCAST6_STATS_INIT(s, len) uip_mcast6_stats_init(s, len)
+#define UIP_MCAST6_STATS_RESET() uip_mcast6_stats_reset()
+#define UIP_MCAST6_STATS_FWD_DELAY(t) uip_mcast6_stats_fwd_delay(t)
+#define UIP_MCAST6_STATS_OCCUPANCY(u, n) uip_mcast6_stats_occupancy(u, n)
 #else /* UIP_MCAST6_STATS */
 #define UIP_MCAST6_STATS_ADD(x)
 #define UIP_MCAST6_STATS_GET(x) 0
-#define UIP_MCAST6_STATS_INIT(s)
+#define UIP_MCAST6_STATS_INIT(s, len)
+#define UIP_MCAST6_STATS_RESET()
+#define UIP_MCAST6_STATS_FWD_DELAY(t)
+#define UIP_MCAST6_STATS_OCCUPANCY(u, n)
 #endif /* UIP_MCAST6_STATS */
 /*---------------------------------------------------------------------------*/
 /**
  * \brief Initialise multicast stats
  * \param stats A pointer to a struct holding an engine's additional statistics
+ * \param len The size of that struct
+ */
+void uip_mcast6_stats_init(void *stats, uint16_t len);
+
+/**
+ * \brief Clear the multicast stats, including the engine's additional ones
+ */
+void uip_mcast6_stats_reset(void);
+
+/**
+ * \brief Record the forwarding delay of a datagram, as it is forwarded
+ * \param received The clock time when the datagram was received
+ */
+void uip_mcast6_stats_fwd_delay(clock_time_t received);
+
+/**
+ * \brief Record the buffer occupancy, as a datagram is buffered
+ * \param used The number of buffers in use, including the new one
+ * \param total The number of buffers
+ */
+void uip_mcast6_stats_occupancy(uint16_t used, uint16_t total);
+
+/** Length of a binary stats dump */
+#define UIP_MCAST6_STATS_DUMP_LEN \
+  (6 + 4 * (12 + UIP_MCAST6_STATS_DELAY_BINS + UIP_MCAST6_STATS_OCCUPANCY_BINS))
+
+/**
+ * \brief Serialize the stats in binary form
+ *
+ * The dump starts with a header: the characters 'M' and '6', the format
+ * version (1), the engine (UIP_MCAST6_ENGINE), and the delay histogram bin
+ * width in milliseconds. Then come 32-bit counters: mcast_in_unique,
+ * mcast_in_all, mcast_in_ours, mcast_fwd, mcast_out, mcast_bad,
+ * mcast_dropped, mcast_in_dup, mcast_suppressed, fwd_delay_count,
+ * fwd_delay_sum and fwd_delay_max, followed by the delay and occupancy
+ * histograms. Integers are in network byte order.
+ *
+ * \param buf The buffer where to write the dump
+ * \param buflen The buffer len, at least UIP_MCAST6_STATS_DUMP_LEN
+ * \return The number of bytes written, 0 if the buffer is too small
  */
-void uip_mcast6_stats_init(void *stats);
+int uip_mcast6_stats_dump(uint8_t *buf, int buflen);
 /*---------------------------------------------------------------------------*/
 #endif /* UIP_MCAST6_STATS_H_ */
 /*---------------------------------------------------------------------------*/
@@ -93,6 +93,21 @@ enum {
   PACKET_INPUT
 };
 
+#if TCPIP_NEXTHOP_CACHE_SIZE
+#if !UIP_DS6_NOTIFICATIONS
+#error "TCPIP_CONF_NEXTHOP_CACHE_SIZE requires UIP_DS6_NOTIFICATIONS"
+#endif /* !UIP_DS6_NOTIFICATIONS */
+/* Destinations and their next-hop neighbor, as last resolved without SRH */
+static struct nexthop_cache_entry {
+  uip_ipaddr_t destipaddr;
+  uip_ds6_nbr_t *nbr; /* NULL for an unused entry */
+} nexthop_cache[TCPIP_NEXTHOP_CACHE_SIZE];
+/* The entry to replace next, round-robin */
+static uint8_t nexthop_cache_next;
+static struct uip_ds6_notification nexthop_cache_notification;
+struct tcpip_nexthop_cache_stats tcpip_nexthop_cache_stats;
+#endif /* TCPIP_NEXTHOP_CACHE_SIZE */
+
 /*---------------------------------------------------------------------------*/
 static void
 init_appstate(uip_tcp_appstate_t *as, void *state)
@@ -490,8 +505,50 @@ annotate_transmission(const uip_ipaddr_t *nexthop)
 #endif /* TCPIP_CONF_ANNOTATE_TRANSMISSIONS */
 }
 /*---------------------------------------------------------------------------*/
+void
+tcpip_nexthop_cache_flush(void)
+{
+#if TCPIP_NEXTHOP_CACHE_SIZE
+  memset(nexthop_cache, 0, sizeof(nexthop_cache));
+  tcpip_nexthop_cache_stats.flushes++;
+#endif /* TCPIP_NEXTHOP_CACHE_SIZE */
+}
+#if TCPIP_NEXTHOP_CACHE_SIZE
+/*---------------------------------------------------------------------------*/
+static void
+nexthop_cache_route_callback(int event, const uip_ipaddr_t *route,
+                             const uip_ipaddr_t *nexthop, int num_routes)
+{
+  tcpip_nexthop_cache_flush();
+}
+/*---------------------------------------------------------------------------*/
+static uip_ds6_nbr_t *
+nexthop_cache_lookup(const uip_ipaddr_t *destipaddr)
+{
+  int i;
+  for(i = 0; i < TCPIP_NEXTHOP_CACHE_SIZE; i++) {
+    if(nexthop_cache[i].nbr != NULL
+       && uip_ipaddr_cmp(&nexthop_cache[i].destipaddr, destipaddr)) {
+      tcpip_nexthop_cache_stats.hits++;
+      return nexthop_cache[i].nbr;
+    }
+  }
+  tcpip_nexthop_cache_stats.misses++;
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+nexthop_cache_add(const uip_ipaddr_t *destipaddr, uip_ds6_nbr_t *nbr)
+{
+  struct nexthop_cache_entry *e = &nexthop_cache[nexthop_cache_next];
+  uip_ipaddr_copy(&e->destipaddr, destipaddr);
+  e->nbr = nbr;
+  nexthop_cache_next = (nexthop_cache_next + 1) % TCPIP_NEXTHOP_CACHE_SIZE;
+}
+#endif /* TCPIP_NEXTHOP_CACHE_SIZE */
+/*---------------------------------------------------------------------------*/
 static const uip_ipaddr_t*
-get_nexthop(uip_ipaddr_t *addr)
+get_nexthop(uip_ipaddr_t *addr, uip_ds6_nbr_t **cached_nbr)
 {
   const uip_ipaddr_t *nexthop;
   uip_ds6_route_t *route;
@@ -509,6 +566,15 @@ get_nexthop(uip_ipaddr_t *addr)
     return addr;
   }
 
+#if TCPIP_NEXTHOP_CACHE_SIZE
+  if((*cached_nbr = nexthop_cache_lookup(&UIP_IP_BUF->destipaddr)) != NULL) {
+    LOG_INFO("output: found next hop in cache: ");
+    LOG_INFO_6ADDR(&(*cached_nbr)->ipaddr);
+    LOG_INFO_("\n");
+    return &(*cached_nbr)->ipaddr;
+  }
+#endif /* TCPIP_NEXTHOP_CACHE_SIZE */
+
   /* We first check if the destination address is on our immediate
      link. If so, we simply use the destination address as our
      nexthop address. */
@@ -632,6 +698,7 @@ tcpip_ipv6_output(void)
 {
   uip_ipaddr_t ipaddr;
   uip_ds6_nbr_t *nbr = NULL;
+  uip_ds6_nbr_t *cached_nbr = NULL;
   const uip_lladdr_t *linkaddr;
   const uip_ipaddr_t *nexthop;
 
@@ -671,12 +738,12 @@ tcpip_ipv6_output(void)
   }
 
   /* Look for a next hop */
-  if((nexthop = get_nexthop(&ipaddr)) == NULL) {
+  if((nexthop = get_nexthop(&ipaddr, &cached_nbr)) == NULL) {
     goto exit;
   }
   annotate_transmission(nexthop);
 
-  nbr = uip_ds6_nbr_lookup(nexthop);
+  nbr = cached_nbr != NULL ? cached_nbr : uip_ds6_nbr_lookup(nexthop);
 
 #if UIP_ND6_AUTOFILL_NBR_CACHE
   if(nbr == NULL) {
@@ -724,6 +791,13 @@ tcpip_ipv6_output(void)
   }
 #endif /* UIP_ND6_SEND_NS */
 
+#if TCPIP_NEXTHOP_CACHE_SIZE
+  /* Next hops from an SRH depend on the packet, not only on its destination */
+  if(cached_nbr == NULL && nexthop != &ipaddr) {
+    nexthop_cache_add(&UIP_IP_BUF->destipaddr, nbr);
+  }
+#endif /* TCPIP_NEXTHOP_CACHE_SIZE */
+
 send_packet:
   if(nbr) {
     linkaddr = uip_ds6_nbr_get_ll(nbr);
@@ -822,6 +896,11 @@ PROCESS_THREAD(tcpip_process, ev, data)
   etimer_set(&periodic, CLOCK_SECOND / 2);
 
   uip_init();
+#if TCPIP_NEXTHOP_CACHE_SIZE
+  tcpip_nexthop_cache_flush();
+  uip_ds6_notification_add(&nexthop_cache_notification,
+                           nexthop_cache_route_callback);
+#endif /* TCPIP_NEXTHOP_CACHE_SIZE */
 #ifdef UIP_FALLBACK_INTERFACE
   UIP_FALLBACK_INTERFACE.init();
 #endif
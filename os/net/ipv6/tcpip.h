@@ -347,6 +347,36 @@ uint8_t tcpip_output(const uip_lladdr_t *);
  */
 void tcpip_ipv6_output(void);
 
+/**
+ * \brief The number of destinations for which tcpip_ipv6_output() caches
+ * the next-hop neighbor, to skip the on-link check and the route lookups.
+ * 0 disables the cache. The cache relies on route notifications
+ * (UIP_DS6_NOTIFICATIONS) for invalidation.
+ */
+#ifdef TCPIP_CONF_NEXTHOP_CACHE_SIZE
+#define TCPIP_NEXTHOP_CACHE_SIZE TCPIP_CONF_NEXTHOP_CACHE_SIZE
+#else
+#define TCPIP_NEXTHOP_CACHE_SIZE 0
+#endif
+
+#if TCPIP_NEXTHOP_CACHE_SIZE
+/** \brief Next-hop cache statistics */
+struct tcpip_nexthop_cache_stats {
+  uint32_t hits;
+  uint32_t misses;
+  uint32_t flushes;
+};
+
+extern struct tcpip_nexthop_cache_stats tcpip_nexthop_cache_stats;
+#endif /* TCPIP_NEXTHOP_CACHE_SIZE */
+
+/**
+ * \brief Invalidate the next-hop cache. Called whenever a neighbor cache
+ * entry or an on-link prefix is added or removed; route changes are
+ * caught through route notifications.
+ */
+void tcpip_nexthop_cache_flush(void);
+
 /**
  * \brief Is forwarding generally enabled?
  */
@@ -53,6 +53,7 @@
 #include "net/ipv6/uip-ds6.h"
 #include "net/ipv6/uip-ds6-nbr.h"
 #include "net/ipv6/uip-nd6.h"
+#include "net/ipv6/tcpip.h"
 #include "net/routing/routing.h"
 
 #if UIP_DS6_NBR_MULTI_IPV6_ADDRS
@@ -104,11 +105,56 @@ MEMB(uip_ds6_nbr_memb, uip_ds6_nbr_t, UIP_DS6_NBR_MAX_NEIGHBOR_CACHES);
 NBR_TABLE(uip_ds6_nbr_t, ds6_neighbors);
 #endif /* UIP_DS6_NBR_MULTI_IPV6_ADDRS */
 
+#if UIP_DS6_NBR_HASH_BUCKETS
+/*
+ * Neighbor cache entries, chained by the hash of the IID of their IPv6
+ * address. The link-local and global addresses derived from the same
+ * link-layer address thus fall into the same bucket.
+ */
+static uip_ds6_nbr_t *hash_buckets[UIP_DS6_NBR_HASH_BUCKETS];
+/*---------------------------------------------------------------------------*/
+static uint16_t
+hash_bucket(const uip_ipaddr_t *ipaddr)
+{
+  uint16_t hash = 0;
+  int i;
+  for(i = 8; i < 16; i++) {
+    hash = (hash << 3) ^ (hash >> 13) ^ ipaddr->u8[i];
+  }
+  return hash % UIP_DS6_NBR_HASH_BUCKETS;
+}
+/*---------------------------------------------------------------------------*/
+static void
+hash_add(uip_ds6_nbr_t *nbr)
+{
+  uint16_t bucket = hash_bucket(&nbr->ipaddr);
+  nbr->hash_next = hash_buckets[bucket];
+  hash_buckets[bucket] = nbr;
+}
+/*---------------------------------------------------------------------------*/
+static void
+hash_remove(uip_ds6_nbr_t *nbr)
+{
+  uip_ds6_nbr_t **pp;
+  for(pp = &hash_buckets[hash_bucket(&nbr->ipaddr)];
+      *pp != NULL;
+      pp = &(*pp)->hash_next) {
+    if(*pp == nbr) {
+      *pp = nbr->hash_next;
+      nbr->hash_next = NULL;
+      return;
+    }
+  }
+}
+#endif /* UIP_DS6_NBR_HASH_BUCKETS */
 /*---------------------------------------------------------------------------*/
 void
 uip_ds6_neighbors_init(void)
 {
   link_stats_init();
+#if UIP_DS6_NBR_HASH_BUCKETS
+  memset(hash_buckets, 0, sizeof(hash_buckets));
+#endif /* UIP_DS6_NBR_HASH_BUCKETS */
 #if UIP_DS6_NBR_MULTI_IPV6_ADDRS
   memb_init(&uip_ds6_nbr_memb);
   nbr_table_register(uip_ds6_nbr_entries,
@@ -124,6 +170,9 @@ uip_ds6_nbr_add(const uip_ipaddr_t *ipaddr, const uip_lladdr_t *lladdr,
                 void *data)
 {
   uip_ds6_nbr_t *nbr;
+#if UIP_DS6_NBR_HASH_BUCKETS && !UIP_DS6_NBR_MULTI_IPV6_ADDRS
+  uip_ds6_nbr_t *prev_nbr;
+#endif /* UIP_DS6_NBR_HASH_BUCKETS && !UIP_DS6_NBR_MULTI_IPV6_ADDRS */
 
 #if UIP_DS6_NBR_MULTI_IPV6_ADDRS
   uip_ds6_nbr_entry_t *nbr_entry;
@@ -177,11 +226,27 @@ uip_ds6_nbr_add(const uip_ipaddr_t *ipaddr, const uip_lladdr_t *lladdr,
     add_uip_ds6_nbr_to_nbr_entry(nbr, nbr_entry);
   }
 #else
+#if UIP_DS6_NBR_HASH_BUCKETS
+  /* An existing entry for lladdr gets overwritten: take it out of the
+   * index first, and put it back if it turns out to be kept */
+  prev_nbr = nbr_table_get_from_lladdr(ds6_neighbors, (const linkaddr_t *)lladdr);
+  if(prev_nbr != NULL) {
+    hash_remove(prev_nbr);
+  }
+#endif /* UIP_DS6_NBR_HASH_BUCKETS */
   nbr = nbr_table_add_lladdr(ds6_neighbors, (linkaddr_t*)lladdr, reason, data);
+#if UIP_DS6_NBR_HASH_BUCKETS
+  if(nbr == NULL && prev_nbr != NULL) {
+    hash_add(prev_nbr);
+  }
+#endif /* UIP_DS6_NBR_HASH_BUCKETS */
 #endif /* UIP_DS6_NBR_MULTI_IPV6_ADDRS */
 
   if(nbr) {
     uip_ipaddr_copy(&nbr->ipaddr, ipaddr);
+#if UIP_DS6_NBR_HASH_BUCKETS
+    hash_add(nbr);
+#endif /* UIP_DS6_NBR_HASH_BUCKETS */
 #if UIP_ND6_SEND_RA || !UIP_CONF_ROUTER
     nbr->isrouter = isrouter;
 #endif /* UIP_ND6_SEND_RA || !UIP_CONF_ROUTER */
@@ -204,6 +269,7 @@ uip_ds6_nbr_add(const uip_ipaddr_t *ipaddr, const uip_lladdr_t *lladdr,
     LOG_INFO_(" link addr ");
     LOG_INFO_LLADDR((linkaddr_t*)lladdr);
     LOG_INFO_(" state %u\n", state);
+    tcpip_nexthop_cache_flush();
     NETSTACK_ROUTING.neighbor_state_changed(nbr);
     return nbr;
   } else {
@@ -260,6 +326,10 @@ free_uip_ds6_nbr(uip_ds6_nbr_t *nbr)
   uip_packetqueue_free(&nbr->packethandle);
 #endif /* UIP_CONF_IPV6_QUEUE_PKT */
   NETSTACK_ROUTING.neighbor_state_changed(nbr);
+#if UIP_DS6_NBR_HASH_BUCKETS
+  hash_remove(nbr);
+#endif /* UIP_DS6_NBR_HASH_BUCKETS */
+  tcpip_nexthop_cache_flush();
   assert(nbr->nbr_entry != NULL);
   if(nbr->nbr_entry == NULL) {
     LOG_ERR("%s: unexpected error nbr->nbr_entry is NULL\n", __func__);
@@ -306,6 +376,10 @@ uip_ds6_nbr_rm(uip_ds6_nbr_t *nbr)
     uip_packetqueue_free(&nbr->packethandle);
 #endif /* UIP_CONF_IPV6_QUEUE_PKT */
     NETSTACK_ROUTING.neighbor_state_changed(nbr);
+#if UIP_DS6_NBR_HASH_BUCKETS
+    hash_remove(nbr);
+#endif /* UIP_DS6_NBR_HASH_BUCKETS */
+    tcpip_nexthop_cache_flush();
     return nbr_table_remove(ds6_neighbors, nbr);
   }
   return 0;
@@ -375,6 +449,10 @@ uip_ds6_nbr_update_ll(uip_ds6_nbr_t **nbr_pp, const uip_lladdr_t *new_ll_addr)
     LOG_ERR("%s: cannot allocate a new nbr for new_ll_addr\n", __func__);
     return -1;
   }
+#if UIP_DS6_NBR_HASH_BUCKETS
+  /* Keep the hash chain of the new entry */
+  nbr_backup.hash_next = (*nbr_pp)->hash_next;
+#endif /* UIP_DS6_NBR_HASH_BUCKETS */
   memcpy(*nbr_pp, &nbr_backup, sizeof(uip_ds6_nbr_t));
 #endif /* UIP_DS6_NBR_MULTI_IPV6_ADDRS */
 
@@ -470,7 +548,11 @@ uip_ds6_nbr_lookup(const uip_ipaddr_t *ipaddr)
   if(ipaddr == NULL) {
     return NULL;
   }
+#if UIP_DS6_NBR_HASH_BUCKETS
+  for(nbr = hash_buckets[hash_bucket(ipaddr)]; nbr != NULL; nbr = nbr->hash_next) {
+#else /* UIP_DS6_NBR_HASH_BUCKETS */
   for(nbr = uip_ds6_nbr_head(); nbr != NULL; nbr = uip_ds6_nbr_next(nbr)) {
+#endif /* UIP_DS6_NBR_HASH_BUCKETS */
     if(uip_ipaddr_cmp(&nbr->ipaddr, ipaddr)) {
       return nbr;
     }
@@ -91,6 +91,15 @@
   (NBR_TABLE_MAX_NEIGHBORS * UIP_DS6_NBR_MAX_6ADDRS_PER_NBR)
 #endif /* UIP_DS6_NBR_CONF_MAX_NEIGHBOR_CACHES */
 
+/** \brief Set the number of buckets of the hash index on IPv6 addresses,
+ * used by uip_ds6_nbr_lookup(). Set 0 to disable the index: lookups then
+ * go through the whole neighbor cache */
+#ifdef UIP_DS6_NBR_CONF_HASH_BUCKETS
+#define UIP_DS6_NBR_HASH_BUCKETS UIP_DS6_NBR_CONF_HASH_BUCKETS
+#else
+#define UIP_DS6_NBR_HASH_BUCKETS 0
+#endif /* UIP_DS6_NBR_CONF_HASH_BUCKETS */
+
 #if UIP_DS6_NBR_MULTI_IPV6_ADDRS
 /** \brief nbr_table entry when UIP_DS6_NBR_MULTI_IPV6_ADDRS is
  * enabled. uip_ds6_nbrs is a list of uip_ds6_nbr_t objects */
@@ -107,6 +116,9 @@ typedef struct uip_ds6_nbr {
   struct uip_ds6_nbr *next;
   uip_ds6_nbr_entry_t *nbr_entry;
 #endif /* UIP_DS6_NBR_MULTI_IPV6_ADDRS */
+#if UIP_DS6_NBR_HASH_BUCKETS
+  struct uip_ds6_nbr *hash_next;
+#endif /* UIP_DS6_NBR_HASH_BUCKETS */
   uip_ipaddr_t ipaddr;
   uint8_t isrouter;
   uint8_t state;
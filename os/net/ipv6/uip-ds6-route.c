@@ -46,6 +46,8 @@
 #include "lib/memb.h"
 #include "net/nbr-table.h"
 
+#include <string.h>
+
 /* Log configuration */
 #include "sys/log.h"
 #define LOG_MODULE "IPv6 Route"
@@ -277,6 +279,25 @@ uip_ds6_route_num_routes(void)
 #endif /* (UIP_MAX_ROUTES != 0) */
 }
 /*---------------------------------------------------------------------------*/
+#if (UIP_MAX_ROUTES != 0)
+/* Whether the first length bits of addr and prefix are equal. Unlike
+   uip_ipaddr_prefixcmp(), this also compares the last bits of prefixes
+   whose length is not a multiple of 8, as found in aggregated routes. */
+static int
+prefix_match(const uip_ipaddr_t *addr, const uip_ipaddr_t *prefix,
+             uint8_t length)
+{
+  if(memcmp(addr, prefix, length >> 3) != 0) {
+    return 0;
+  }
+  if((length & 7) == 0) {
+    return 1;
+  }
+  return ((addr->u8[length >> 3] ^ prefix->u8[length >> 3]) &
+          ~(0xff >> (length & 7))) == 0;
+}
+#endif /* (UIP_MAX_ROUTES != 0) */
+/*---------------------------------------------------------------------------*/
 uip_ds6_route_t *
 uip_ds6_route_lookup(const uip_ipaddr_t *addr)
 {
@@ -299,7 +320,7 @@ uip_ds6_route_lookup(const uip_ipaddr_t *addr)
       r != NULL;
       r = uip_ds6_route_next(r)) {
     if(r->length >= longestmatch &&
-       uip_ipaddr_prefixcmp(addr, &r->ipaddr, r->length)) {
+       prefix_match(addr, &r->ipaddr, r->length)) {
       longestmatch = r->length;
       found_route = r;
       /* check if total match - e.g. all 128 bits do match */
@@ -335,6 +356,90 @@ uip_ds6_route_lookup(const uip_ipaddr_t *addr)
 #endif /* (UIP_MAX_ROUTES != 0) */
 }
 /*---------------------------------------------------------------------------*/
+#if (UIP_MAX_ROUTES != 0) && UIP_DS6_ROUTE_WITH_AGGREGATION
+/* Copy the first length bits of prefix, clearing the others */
+static void
+set_prefix(uip_ipaddr_t *dest, const uip_ipaddr_t *prefix, uint8_t length)
+{
+  uint8_t i;
+
+  for(i = 0; i < sizeof(uip_ipaddr_t); i++) {
+    if(length >= 8) {
+      dest->u8[i] = prefix->u8[i];
+      length -= 8;
+    } else {
+      dest->u8[i] = prefix->u8[i] & ~(0xff >> length);
+      length = 0;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* The prefix of the same length that differs from prefix in its last bit */
+static void
+set_buddy_prefix(uip_ipaddr_t *dest, const uip_ipaddr_t *prefix,
+                 uint8_t length)
+{
+  set_prefix(dest, prefix, length);
+  dest->u8[(length - 1) / 8] ^= 0x80 >> ((length - 1) % 8);
+}
+/*---------------------------------------------------------------------------*/
+static uip_ds6_route_t *
+lookup_exact(const uip_ipaddr_t *ipaddr, uint8_t length)
+{
+  uip_ds6_route_t *r;
+
+  for(r = uip_ds6_route_head(); r != NULL; r = uip_ds6_route_next(r)) {
+    if(r->length == length && prefix_match(ipaddr, &r->ipaddr, length)) {
+      return r;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static int
+route_is_via(uip_ds6_route_t *route, const uip_lladdr_t *nexthop_lladdr)
+{
+  return route->neighbor_routes != NULL &&
+    route->neighbor_routes == nbr_table_get_from_lladdr(nbr_routes,
+                                                        (linkaddr_t *)nexthop_lladdr);
+}
+/*---------------------------------------------------------------------------*/
+/* The route via the given next hop to a prefix that covers ipaddr/length */
+static uip_ds6_route_t *
+lookup_covering(const uip_ipaddr_t *ipaddr, uint8_t length,
+                const uip_lladdr_t *nexthop_lladdr)
+{
+  uip_ds6_route_t *r;
+
+  for(r = uip_ds6_route_head(); r != NULL; r = uip_ds6_route_next(r)) {
+    if(r->length <= length &&
+       prefix_match(ipaddr, &r->ipaddr, r->length) &&
+       route_is_via(r, nexthop_lladdr)) {
+      return r;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+/* Change the prefix of a route in place, keeping its entry, next hop and
+   state */
+static void
+reprefix_route(uip_ds6_route_t *route, const uip_ipaddr_t *ipaddr,
+               uint8_t length)
+{
+#if UIP_DS6_NOTIFICATIONS
+  call_route_callback(UIP_DS6_NOTIFICATION_ROUTE_RM,
+                      &route->ipaddr, uip_ds6_route_nexthop(route));
+#endif
+  set_prefix(&route->ipaddr, ipaddr, length);
+  route->length = length;
+#if UIP_DS6_NOTIFICATIONS
+  call_route_callback(UIP_DS6_NOTIFICATION_ROUTE_ADD,
+                      &route->ipaddr, uip_ds6_route_nexthop(route));
+#endif
+}
+#endif /* (UIP_MAX_ROUTES != 0) && UIP_DS6_ROUTE_WITH_AGGREGATION */
+/*---------------------------------------------------------------------------*/
 uip_ds6_route_t *
 uip_ds6_route_add(const uip_ipaddr_t *ipaddr, uint8_t length,
                   const uip_ipaddr_t *nexthop)
@@ -363,6 +468,24 @@ uip_ds6_route_add(const uip_ipaddr_t *ipaddr, uint8_t length,
   /* First make sure that we don't add a route twice. If we find an
      existing route for our destination, we'll delete the old
      one first. */
+#if UIP_DS6_ROUTE_WITH_AGGREGATION
+  /* Only a route with the same prefix and length is replaced: a less
+     specific route, such as an aggregated one, stays for the rest of the
+     prefix it covers. */
+  r = lookup_exact(ipaddr, length);
+  if(r != NULL && !route_is_via(r, nexthop_lladdr)) {
+    LOG_INFO("Add: old route for ");
+    LOG_INFO_6ADDR(ipaddr);
+    LOG_INFO_(" found, deleting it\n");
+    uip_ds6_route_rm(r);
+  }
+  /* A route via the same next hop that covers the new one makes it
+     redundant */
+  r = lookup_covering(ipaddr, length, nexthop_lladdr);
+  if(r != NULL) {
+    return r;
+  }
+#else /* UIP_DS6_ROUTE_WITH_AGGREGATION */
   r = uip_ds6_route_lookup(ipaddr);
   if(r != NULL) {
     const uip_ipaddr_t *current_nexthop;
@@ -377,6 +500,7 @@ uip_ds6_route_add(const uip_ipaddr_t *ipaddr, uint8_t length,
 
     uip_ds6_route_rm(r);
   }
+#endif /* UIP_DS6_ROUTE_WITH_AGGREGATION */
   {
     struct uip_ds6_route_neighbor_routes *routes;
     /* If there is no routing entry, create one. We first need to
@@ -594,6 +718,115 @@ rm_routelist_callback(nbr_table_item_t *ptr)
 }
 #endif /* (UIP_MAX_ROUTES != 0) */
 /*---------------------------------------------------------------------------*/
+#if UIP_DS6_ROUTE_WITH_AGGREGATION
+uip_ds6_route_t *
+uip_ds6_route_lookup_buddy(uip_ds6_route_t *route)
+{
+#if (UIP_MAX_ROUTES != 0)
+  uip_ds6_route_t *r;
+  uip_ipaddr_t buddy_prefix;
+
+  if(route == NULL || route->length == 0) {
+    return NULL;
+  }
+
+  set_buddy_prefix(&buddy_prefix, &route->ipaddr, route->length);
+  for(r = uip_ds6_route_head(); r != NULL; r = uip_ds6_route_next(r)) {
+    if(r->length == route->length &&
+       r->neighbor_routes == route->neighbor_routes &&
+       prefix_match(&buddy_prefix, &r->ipaddr, r->length)) {
+      return r;
+    }
+  }
+#endif /* (UIP_MAX_ROUTES != 0) */
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+uip_ds6_route_t *
+uip_ds6_route_merge(uip_ds6_route_t *route, uip_ds6_route_t *buddy)
+{
+#if (UIP_MAX_ROUTES != 0)
+  uip_ipaddr_t buddy_prefix;
+
+  if(route == NULL || buddy == NULL || route == buddy ||
+     route->length == 0 || route->length != buddy->length ||
+     route->neighbor_routes != buddy->neighbor_routes) {
+    return NULL;
+  }
+  set_buddy_prefix(&buddy_prefix, &route->ipaddr, route->length);
+  if(!prefix_match(&buddy_prefix, &buddy->ipaddr, buddy->length)) {
+    return NULL;
+  }
+
+  LOG_INFO("Merge: ");
+  LOG_INFO_6ADDR(&route->ipaddr);
+  LOG_INFO_(" and ");
+  LOG_INFO_6ADDR(&buddy->ipaddr);
+  LOG_INFO_("/%u\n", route->length);
+
+  uip_ds6_route_rm(buddy);
+  reprefix_route(route, &route->ipaddr, route->length - 1);
+  return route;
+#else /* (UIP_MAX_ROUTES != 0) */
+  return NULL;
+#endif /* (UIP_MAX_ROUTES != 0) */
+}
+/*---------------------------------------------------------------------------*/
+uip_ds6_route_t *
+uip_ds6_route_split(uip_ds6_route_t *route, const uip_ipaddr_t *ipaddr,
+                    uint8_t length)
+{
+#if (UIP_MAX_ROUTES != 0)
+  uip_ds6_route_t *r;
+  uip_ipaddr_t nexthop;
+  uip_ipaddr_t buddy_prefix;
+  uint8_t route_length;
+
+  if(route == NULL || ipaddr == NULL || length > 128 ||
+     length <= route->length ||
+     !prefix_match(ipaddr, &route->ipaddr, route->length) ||
+     uip_ds6_route_nexthop(route) == NULL) {
+    return NULL;
+  }
+
+  LOG_INFO("Split: ");
+  LOG_INFO_6ADDR(&route->ipaddr);
+  LOG_INFO_("/%u for ", route->length);
+  LOG_INFO_6ADDR(ipaddr);
+  LOG_INFO_("/%u\n", length);
+
+  uip_ipaddr_copy(&nexthop, uip_ds6_route_nexthop(route));
+  route_length = route->length;
+  reprefix_route(route, ipaddr, length);
+
+  /* Move the route to the front of the list, away from the least
+     recently used end where entries are taken for the new routes */
+  if(route != list_head(routelist)) {
+    list_remove(routelist, route);
+    list_push(routelist, route);
+  }
+
+  /* The rest of the original prefix, from the longest part down */
+  for(; length > route_length; length--) {
+    set_buddy_prefix(&buddy_prefix, ipaddr, length);
+    r = uip_ds6_route_add(&buddy_prefix, length, &nexthop);
+    if(r == NULL) {
+      LOG_WARN("Split: could not add route\n");
+      continue;
+    }
+#ifdef UIP_DS6_ROUTE_STATE_TYPE
+    if(r != route) {
+      memcpy(&r->state, &route->state, sizeof(UIP_DS6_ROUTE_STATE_TYPE));
+    }
+#endif
+  }
+  return route;
+#else /* (UIP_MAX_ROUTES != 0) */
+  return NULL;
+#endif /* (UIP_MAX_ROUTES != 0) */
+}
+#endif /* UIP_DS6_ROUTE_WITH_AGGREGATION */
+/*---------------------------------------------------------------------------*/
 void
 uip_ds6_route_rm_by_nexthop(const uip_ipaddr_t *nexthop)
 {
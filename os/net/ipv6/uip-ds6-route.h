@@ -111,6 +111,27 @@ void uip_ds6_notification_rm(struct uip_ds6_notification *n);
 #define UIP_DS6_ROUTE_NB 4
 #endif /* UIP_MAX_ROUTES */
 
+/** \brief Whether routes via the same next hop to the two halves of a
+ *  prefix may be merged into a single route to the whole prefix, and
+ *  split again when one of the destinations needs its own entry. With
+ *  nodes addressed from contiguous interface identifiers, a router then
+ *  holds one entry per block of descendants below each next hop rather
+ *  than one per descendant. Routes of different lengths coexist in the
+ *  table: a route is only replaced by a route with the same prefix and
+ *  length. */
+#ifdef UIP_DS6_ROUTE_CONF_WITH_AGGREGATION
+#define UIP_DS6_ROUTE_WITH_AGGREGATION UIP_DS6_ROUTE_CONF_WITH_AGGREGATION
+#else /* UIP_DS6_ROUTE_CONF_WITH_AGGREGATION */
+#define UIP_DS6_ROUTE_WITH_AGGREGATION 0
+#endif /* UIP_DS6_ROUTE_CONF_WITH_AGGREGATION */
+
+/** \brief The shortest prefix length that aggregated routes may have */
+#ifdef UIP_DS6_ROUTE_CONF_AGGREGATION_MIN_LENGTH
+#define UIP_DS6_ROUTE_AGGREGATION_MIN_LENGTH UIP_DS6_ROUTE_CONF_AGGREGATION_MIN_LENGTH
+#else /* UIP_DS6_ROUTE_CONF_AGGREGATION_MIN_LENGTH */
+#define UIP_DS6_ROUTE_AGGREGATION_MIN_LENGTH 112
+#endif /* UIP_DS6_ROUTE_CONF_AGGREGATION_MIN_LENGTH */
+
 /** \brief define some additional RPL related route state and
  *  neighbor callback for RPL - if not a DS6_ROUTE_STATE is already set */
 #ifndef UIP_DS6_ROUTE_STATE_TYPE
@@ -227,5 +248,47 @@ int uip_ds6_route_is_nexthop(const uip_ipaddr_t *ipaddr);
 int uip_ds6_route_count_nexthop_neighbors(void);
 /** @} */
 
+#if UIP_DS6_ROUTE_WITH_AGGREGATION
+/** \name Routing Table aggregation */
+/** @{ */
+
+/**
+ * \brief Find the route that can be merged with a given route
+ * \param route The route
+ * \return The route to the other half of the prefix one bit shorter than
+ * that of \p route, with the same length and next hop, or NULL
+ */
+uip_ds6_route_t *uip_ds6_route_lookup_buddy(uip_ds6_route_t *route);
+
+/**
+ * \brief Merge two routes into a route to the prefix one bit shorter
+ * \param route The route to keep, with its state
+ * \param buddy The route to remove, as returned by uip_ds6_route_lookup_buddy()
+ * \return The merged route, i.e. \p route, or NULL if the routes
+ * cannot be merged
+ */
+uip_ds6_route_t *uip_ds6_route_merge(uip_ds6_route_t *route,
+                                     uip_ds6_route_t *buddy);
+
+/**
+ * \brief Split a route so that a prefix it covers gets its own entry
+ *
+ * The route is shortened to \p ipaddr / \p length, and the rest of
+ * the prefix it covered gets one route per bit of difference in length,
+ * all with the next hop and state of the original route. This takes up to
+ * \p length - route->length new entries.
+ *
+ * \param route The route
+ * \param ipaddr The prefix to give its own entry
+ * \param length The length of that prefix
+ * \return The route to \p ipaddr / \p length, or NULL if \p route
+ * does not cover it
+ */
+uip_ds6_route_t *uip_ds6_route_split(uip_ds6_route_t *route,
+                                     const uip_ipaddr_t *ipaddr,
+                                     uint8_t length);
+/** @} */
+#endif /* UIP_DS6_ROUTE_WITH_AGGREGATION */
+
 #endif /* UIP_DS6_ROUTE_H */
 /** @} */
@@ -51,6 +51,7 @@
 #include "net/ipv6/uip-ds6.h"
 #include "net/ipv6/multicast/uip-mcast6.h"
 #include "net/ipv6/uip-packetqueue.h"
+#include "net/ipv6/tcpip.h"
 
 /* Log configuration */
 #include "sys/log.h"
@@ -284,6 +285,7 @@ uip_ds6_prefix_add(uip_ipaddr_t *ipaddr, uint8_t ipaddrlen,
     LOG_INFO_6ADDR(&locprefix->ipaddr);
     LOG_INFO_("length %u, flags %x, Valid lifetime %lx, Preffered lifetime %lx\n",
        ipaddrlen, flags, vtime, ptime);
+    tcpip_nexthop_cache_flush();
     return locprefix;
   } else {
     LOG_INFO("No more space in Prefix list\n");
@@ -313,6 +315,7 @@ uip_ds6_prefix_add(uip_ipaddr_t *ipaddr, uint8_t ipaddrlen,
     LOG_INFO("Adding prefix ");
     LOG_INFO_6ADDR(&locprefix->ipaddr);
     LOG_INFO_("length %u, vlifetime %lu\n", ipaddrlen, interval);
+    tcpip_nexthop_cache_flush();
     return locprefix;
   }
   return NULL;
@@ -325,6 +328,7 @@ uip_ds6_prefix_rm(uip_ds6_prefix_t *prefix)
 {
   if(prefix != NULL) {
     prefix->isused = 0;
+    tcpip_nexthop_cache_flush();
   }
   return;
 }
@@ -53,11 +53,27 @@
 
 /* Total number of nodes */
 static int num_nodes;
+/* Incremented whenever a path in the graph may have changed */
+static uint32_t graph_version;
 
 /* Every known node in the network */
 LIST(nodelist);
 MEMB(nodememb, uip_sr_node_t, UIP_SR_LINK_NUM);
 
+#if UIP_SR_WITH_SNAPSHOT
+/* Incremented whenever anything in the graph changes */
+static uint32_t snapshot_version;
+/* Clients with an older version need a full dump */
+static uint32_t snapshot_reset_version;
+/* The last removed nodes, in a ring */
+static struct {
+  unsigned char link_identifier[8];
+  uint32_t version;
+} removed_nodes[UIP_SR_SNAPSHOT_REMOVED_NUM];
+static uint8_t removed_head;
+static uint8_t removed_num;
+#endif /* UIP_SR_WITH_SNAPSHOT */
+
 /*---------------------------------------------------------------------------*/
 int
 uip_sr_num_nodes(void)
@@ -65,6 +81,43 @@ uip_sr_num_nodes(void)
   return num_nodes;
 }
 /*---------------------------------------------------------------------------*/
+uint32_t
+uip_sr_graph_version(void)
+{
+  return graph_version;
+}
+/*---------------------------------------------------------------------------*/
+#if UIP_SR_WITH_SNAPSHOT
+static void
+snapshot_node_updated(uip_sr_node_t *node)
+{
+  node->snapshot_version = ++snapshot_version;
+}
+/*---------------------------------------------------------------------------*/
+static void
+snapshot_node_removed(const uip_sr_node_t *node)
+{
+  if(removed_num == UIP_SR_SNAPSHOT_REMOVED_NUM) {
+    /* Overwrite the oldest removal, clients that have not seen it need a
+     * full dump from now on */
+    snapshot_reset_version = removed_nodes[removed_head].version;
+  } else {
+    removed_num++;
+  }
+  memcpy(removed_nodes[removed_head].link_identifier, node->link_identifier, 8);
+  removed_nodes[removed_head].version = ++snapshot_version;
+  removed_head = (removed_head + 1) % UIP_SR_SNAPSHOT_REMOVED_NUM;
+}
+/*---------------------------------------------------------------------------*/
+static void
+snapshot_reset(void)
+{
+  removed_head = 0;
+  removed_num = 0;
+  snapshot_reset_version = ++snapshot_version;
+}
+#endif /* UIP_SR_WITH_SNAPSHOT */
+/*---------------------------------------------------------------------------*/
 static int
 node_matches_address(void *graph, const uip_sr_node_t *node, const uip_ipaddr_t *addr)
 {
@@ -116,6 +169,9 @@ uip_sr_expire_parent(void *graph, const uip_ipaddr_t *child, const uip_ipaddr_t
   /* Check if parent matches */
   if(l != NULL && node_matches_address(graph, l->parent, parent)) {
     l->lifetime = UIP_SR_REMOVAL_DELAY;
+#if UIP_SR_WITH_SNAPSHOT
+    snapshot_node_updated(l);
+#endif /* UIP_SR_WITH_SNAPSHOT */
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -125,6 +181,8 @@ uip_sr_update_node(void *graph, const uip_ipaddr_t *child, const uip_ipaddr_t *p
   uip_sr_node_t *child_node = uip_sr_get_node(graph, child);
   uip_sr_node_t *parent_node = uip_sr_get_node(graph, parent);
   uip_sr_node_t *old_parent_node;
+  uip_sr_node_t *prev_parent_node;
+  void *prev_graph;
 
   if(parent != NULL) {
     /* No node for the parent, add one with infinite lifetime */
@@ -148,9 +206,12 @@ uip_sr_update_node(void *graph, const uip_ipaddr_t *child, const uip_ipaddr_t *p
       return NULL;
     }
     child_node->parent = NULL;
+    child_node->graph = NULL;
     list_add(nodelist, child_node);
     num_nodes++;
   }
+  prev_parent_node = child_node->parent;
+  prev_graph = child_node->graph;
 
   /* Initialize node */
   child_node->graph = graph;
@@ -173,6 +234,13 @@ uip_sr_update_node(void *graph, const uip_ipaddr_t *child, const uip_ipaddr_t *p
     child_node->parent = parent_node;
   }
 
+  if(child_node->parent != prev_parent_node || child_node->graph != prev_graph) {
+    graph_version++;
+  }
+#if UIP_SR_WITH_SNAPSHOT
+  snapshot_node_updated(child_node);
+#endif /* UIP_SR_WITH_SNAPSHOT */
+
   LOG_INFO("NS: updating link, child ");
   LOG_INFO_6ADDR(child);
   LOG_INFO_(", parent ");
@@ -186,8 +254,12 @@ void
 uip_sr_init(void)
 {
   num_nodes = 0;
+  graph_version++;
   memb_init(&nodememb);
   list_init(nodelist);
+#if UIP_SR_WITH_SNAPSHOT
+  snapshot_reset();
+#endif /* UIP_SR_WITH_SNAPSHOT */
 }
 /*---------------------------------------------------------------------------*/
 uip_sr_node_t *
@@ -226,9 +298,13 @@ uip_sr_periodic(unsigned seconds)
         LOG_INFO_("\n");
       }
       /* No child found, deallocate node */
+#if UIP_SR_WITH_SNAPSHOT
+      snapshot_node_removed(l);
+#endif /* UIP_SR_WITH_SNAPSHOT */
       list_remove(nodelist, l);
       memb_free(&nodememb, l);
       num_nodes--;
+      graph_version++;
     } else if(l->lifetime != UIP_SR_INFINITE_LIFETIME) {
       l->lifetime = l->lifetime > seconds ? l->lifetime - seconds : 0;
     }
@@ -246,6 +322,10 @@ uip_sr_free_all(void)
     memb_free(&nodememb, l);
     num_nodes--;
   }
+  graph_version++;
+#if UIP_SR_WITH_SNAPSHOT
+  snapshot_reset();
+#endif /* UIP_SR_WITH_SNAPSHOT */
 }
 /*---------------------------------------------------------------------------*/
 int
@@ -300,4 +380,184 @@ uip_sr_link_snprint(char *buf, int buflen, uip_sr_node_t *link)
   }
   return index;
 }
+#if UIP_SR_WITH_SNAPSHOT
+/*---------------------------------------------------------------------------*/
+uint32_t
+uip_sr_snapshot_version(void)
+{
+  return snapshot_version;
+}
+/*---------------------------------------------------------------------------*/
+void
+uip_sr_snapshot_start(uip_sr_snapshot_t *snapshot, uint32_t since)
+{
+  snapshot->since = since;
+  snapshot->version = snapshot_version;
+  snapshot->flags = 0;
+  if(since < snapshot_reset_version || since > snapshot_version) {
+    snapshot->flags |= UIP_SR_SNAPSHOT_FLAG_FULL;
+  }
+  snapshot->removed_index = 0;
+  snapshot->node = list_head(nodelist);
+}
+/*---------------------------------------------------------------------------*/
+int
+uip_sr_snapshot_next(uip_sr_snapshot_t *snapshot, uip_sr_snapshot_record_t *record)
+{
+  int full = snapshot->flags & UIP_SR_SNAPSHOT_FLAG_FULL;
+
+  /* Removals first, from the oldest, as a removed node may have been added
+   * again since */
+  while(!full && snapshot->removed_index < removed_num) {
+    int i = (removed_head + UIP_SR_SNAPSHOT_REMOVED_NUM - removed_num
+             + snapshot->removed_index) % UIP_SR_SNAPSHOT_REMOVED_NUM;
+    snapshot->removed_index++;
+    if(removed_nodes[i].version > snapshot->since) {
+      record->node = NULL;
+      record->link_identifier = removed_nodes[i].link_identifier;
+      return 1;
+    }
+  }
+
+  while(snapshot->node != NULL) {
+    const uip_sr_node_t *node = snapshot->node;
+    snapshot->node = list_item_next((void *)node);
+    if(full || node->snapshot_version > snapshot->since) {
+      record->node = node;
+      record->link_identifier = node->link_identifier;
+      return 1;
+    }
+  }
+
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+write_uint32(uint8_t *buf, uint32_t val)
+{
+  buf[0] = val >> 24;
+  buf[1] = val >> 16;
+  buf[2] = val >> 8;
+  buf[3] = val;
+}
+/*---------------------------------------------------------------------------*/
+int
+uip_sr_snapshot_serialize(uint8_t *buf, int buflen, uint32_t since, uint16_t offset)
+{
+  uip_sr_snapshot_t snapshot;
+  uip_sr_snapshot_record_t record;
+  uip_ipaddr_t root_ipaddr;
+  uint16_t index = 0;
+  uint16_t count = 0;
+  int pos = UIP_SR_SNAPSHOT_HDR_LEN;
+
+  if(buflen < UIP_SR_SNAPSHOT_HDR_LEN) {
+    return 0;
+  }
+
+  uip_sr_snapshot_start(&snapshot, since);
+  while(uip_sr_snapshot_next(&snapshot, &record)) {
+    int len = record.node != NULL ? UIP_SR_SNAPSHOT_NODE_LEN : UIP_SR_SNAPSHOT_REMOVED_LEN;
+    if(index++ < offset) {
+      continue;
+    }
+    if(pos + len > buflen) {
+      snapshot.flags |= UIP_SR_SNAPSHOT_FLAG_MORE;
+      break;
+    }
+    if(record.node != NULL) {
+      buf[pos++] = UIP_SR_SNAPSHOT_TYPE_NODE;
+      memcpy(buf + pos, record.link_identifier, 8);
+      pos += 8;
+      if(record.node->parent != NULL) {
+        memcpy(buf + pos, record.node->parent->link_identifier, 8);
+      } else {
+        memset(buf + pos, 0, 8);
+      }
+      pos += 8;
+      write_uint32(buf + pos, record.node->lifetime);
+      pos += 4;
+    } else {
+      buf[pos++] = UIP_SR_SNAPSHOT_TYPE_REMOVED;
+      memcpy(buf + pos, record.link_identifier, 8);
+      pos += 8;
+    }
+    count++;
+  }
+
+  buf[0] = UIP_SR_SNAPSHOT_FORMAT;
+  buf[1] = snapshot.flags;
+  write_uint32(buf + 2, since);
+  write_uint32(buf + 6, snapshot.version);
+  buf[10] = count >> 8;
+  buf[11] = count;
+  if(NETSTACK_ROUTING.get_root_ipaddr(&root_ipaddr)) {
+    memcpy(buf + 12, &root_ipaddr, 8);
+  } else {
+    memset(buf + 12, 0, 8);
+  }
+
+  return pos;
+}
+/*---------------------------------------------------------------------------*/
+int
+uip_sr_snapshot_record_snprint_json(char *buf, int buflen, const uip_sr_snapshot_record_t *record)
+{
+  int index = 0;
+  uip_ipaddr_t ipaddr;
+
+  if(record->node == NULL) {
+    /* Removed node: the prefix is the one of the root */
+    if(!NETSTACK_ROUTING.get_root_ipaddr(&ipaddr)) {
+      memset(&ipaddr, 0, sizeof(ipaddr));
+    }
+    memcpy(((unsigned char *)&ipaddr) + 8, record->link_identifier, 8);
+    index += snprintf(buf + index, buflen - index, "{\"removed\":\"");
+    if(index >= buflen) {
+      return index;
+    }
+    index += uiplib_ipaddr_snprint(buf + index, buflen - index, &ipaddr);
+    if(index >= buflen) {
+      return index;
+    }
+    index += snprintf(buf + index, buflen - index, "\"}");
+    return index;
+  }
+
+  NETSTACK_ROUTING.get_sr_node_ipaddr(&ipaddr, record->node);
+  index += snprintf(buf + index, buflen - index, "{\"node\":\"");
+  if(index >= buflen) {
+    return index;
+  }
+  index += uiplib_ipaddr_snprint(buf + index, buflen - index, &ipaddr);
+  if(index >= buflen) {
+    return index;
+  }
+  if(record->node->parent != NULL) {
+    NETSTACK_ROUTING.get_sr_node_ipaddr(&ipaddr, record->node->parent);
+    index += snprintf(buf + index, buflen - index, "\",\"parent\":\"");
+    if(index >= buflen) {
+      return index;
+    }
+    index += uiplib_ipaddr_snprint(buf + index, buflen - index, &ipaddr);
+    if(index >= buflen) {
+      return index;
+    }
+    index += snprintf(buf + index, buflen - index, "\"");
+  } else {
+    index += snprintf(buf + index, buflen - index, "\",\"parent\":null");
+  }
+  if(index >= buflen) {
+    return index;
+  }
+  if(record->node->lifetime != UIP_SR_INFINITE_LIFETIME) {
+    index += snprintf(buf + index, buflen - index, ",\"lifetime\":%lu}",
+                      (unsigned long)record->node->lifetime);
+  } else {
+    index += snprintf(buf + index, buflen - index, ",\"lifetime\":null}");
+  }
+  return index;
+}
+#endif /* UIP_SR_WITH_SNAPSHOT */
+/*---------------------------------------------------------------------------*/
 /** @} */
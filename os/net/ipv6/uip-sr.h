@@ -85,6 +85,37 @@
 
 #define UIP_SR_INFINITE_LIFETIME           0xFFFFFFFF
 
+/* Keep track of graph changes, to export snapshots of the graph: a full
+ * dump, then deltas */
+#ifdef UIP_SR_CONF_WITH_SNAPSHOT
+#define UIP_SR_WITH_SNAPSHOT          UIP_SR_CONF_WITH_SNAPSHOT
+#else /* UIP_SR_CONF_WITH_SNAPSHOT */
+#define UIP_SR_WITH_SNAPSHOT          0
+#endif /* UIP_SR_CONF_WITH_SNAPSHOT */
+
+/* The number of node removals remembered for deltas. Clients that are
+ * further behind get a full dump instead. */
+#ifdef UIP_SR_CONF_SNAPSHOT_REMOVED_NUM
+#define UIP_SR_SNAPSHOT_REMOVED_NUM   UIP_SR_CONF_SNAPSHOT_REMOVED_NUM
+#else /* UIP_SR_CONF_SNAPSHOT_REMOVED_NUM */
+#define UIP_SR_SNAPSHOT_REMOVED_NUM   16
+#endif /* UIP_SR_CONF_SNAPSHOT_REMOVED_NUM */
+
+/* Snapshot flags: the records replace the whole graph */
+#define UIP_SR_SNAPSHOT_FLAG_FULL     0x01
+/* Snapshot flags: more records follow, fetch them from the next offset */
+#define UIP_SR_SNAPSHOT_FLAG_MORE     0x02
+
+/* Binary snapshot format version, header and record lengths */
+#define UIP_SR_SNAPSHOT_FORMAT        1
+#define UIP_SR_SNAPSHOT_HDR_LEN       20
+#define UIP_SR_SNAPSHOT_NODE_LEN      21
+#define UIP_SR_SNAPSHOT_REMOVED_LEN   9
+
+/* Binary snapshot record types */
+#define UIP_SR_SNAPSHOT_TYPE_NODE     0
+#define UIP_SR_SNAPSHOT_TYPE_REMOVED  1
+
 /********** Data Structures  **********/
 
 /** \brief A node in a source routing graph, stored at the root and representing
@@ -98,8 +129,36 @@ typedef struct uip_sr_node {
   us with the prefix */
   unsigned char link_identifier[8];
   struct uip_sr_node *parent;
+#if UIP_SR_WITH_SNAPSHOT
+  /* The snapshot version at the last update of the node */
+  uint32_t snapshot_version;
+#endif /* UIP_SR_WITH_SNAPSHOT */
 } uip_sr_node_t;
 
+#if UIP_SR_WITH_SNAPSHOT
+/** \brief A record of a graph snapshot: an added or updated node, or a
+ * removed node */
+typedef struct uip_sr_snapshot_record {
+  /* The node, NULL if it was removed */
+  const uip_sr_node_t *node;
+  /* The IPv6 link identifier of the node */
+  const unsigned char *link_identifier;
+} uip_sr_snapshot_record_t;
+
+/** \brief An iteration over the records of a graph snapshot. Removals come
+ * first, then nodes. The iteration must complete without yielding. */
+typedef struct uip_sr_snapshot {
+  /* The version the client has, 0 if none */
+  uint32_t since;
+  /* The version the client gets */
+  uint32_t version;
+  uint8_t flags;
+  /* Iteration state */
+  uint8_t removed_index;
+  const uip_sr_node_t *node;
+} uip_sr_snapshot_t;
+#endif /* UIP_SR_WITH_SNAPSHOT */
+
 /********** Public functions **********/
 
 /**
@@ -109,6 +168,15 @@ typedef struct uip_sr_node {
 */
 int uip_sr_num_nodes(void);
 
+/**
+ * Returns the version of the source routing graph. The version changes
+ * whenever a node is removed or gets a new parent, i.e. whenever the path
+ * to a node may have changed. Lets the routing protocol cache paths.
+ *
+ * \return The graph version
+*/
+uint32_t uip_sr_graph_version(void);
+
 /**
  * Expires a given child-parent link
  *
@@ -191,6 +259,61 @@ void uip_sr_free_all(void);
 */
 int uip_sr_link_snprint(char *buf, int buflen, uip_sr_node_t *link);
 
+#if UIP_SR_WITH_SNAPSHOT
+/**
+ * Returns the snapshot version, which changes with any update of the graph,
+ * including lifetime refreshes
+ *
+ * \return The snapshot version
+*/
+uint32_t uip_sr_snapshot_version(void);
+
+/**
+ * Starts iterating over a snapshot of the graph. The snapshot holds the
+ * changes since a given version, or the whole graph (flag
+ * UIP_SR_SNAPSHOT_FLAG_FULL) if since is 0 or too old.
+ *
+ * \param snapshot The snapshot to initialize
+ * \param since The version the client has, 0 for a full dump
+*/
+void uip_sr_snapshot_start(uip_sr_snapshot_t *snapshot, uint32_t since);
+
+/**
+ * Gets the next record of a snapshot
+ *
+ * \param snapshot The snapshot
+ * \param record The record to fill
+ * \return 1 if a record was found, 0 at the end of the snapshot
+*/
+int uip_sr_snapshot_next(uip_sr_snapshot_t *snapshot, uip_sr_snapshot_record_t *record);
+
+/**
+ * Serializes a snapshot in binary form: a header (format, flags, since and
+ * version, number of records, 8-byte prefix), then node records (type, link
+ * identifier, parent link identifier or zeros for none, lifetime) and
+ * removal records (type, link identifier). Integers are in network byte
+ * order. Large snapshots are served in chunks, starting at a given record.
+ *
+ * \param buf The buffer where to write content
+ * \param buflen The buffer len, at least UIP_SR_SNAPSHOT_HDR_LEN
+ * \param since The version the client has, 0 for a full dump
+ * \param offset The index of the first record to write
+ * \return The number of bytes written, 0 if the buffer is too small
+*/
+int uip_sr_snapshot_serialize(uint8_t *buf, int buflen, uint32_t since, uint16_t offset);
+
+/**
+ * Prints a snapshot record as a JSON value: an object with the node, its
+ * parent and lifetime, or the address of a removed node
+ *
+ * \param buf The buffer where to write content
+ * \param buflen The buffer len
+ * \param record The snapshot record
+ * \return Identical to snprintf
+*/
+int uip_sr_snapshot_record_snprint_json(char *buf, int buflen, const uip_sr_snapshot_record_t *record);
+#endif /* UIP_SR_WITH_SNAPSHOT */
+
  /** @} */
 
 #endif /* UIP_SR_H */
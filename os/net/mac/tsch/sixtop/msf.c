@@ -0,0 +1,1005 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * \addtogroup sixtop
+ * @{
+ */
+/**
+ * \file
+ *         A traffic-adaptive Scheduling Function, modeled after MSF
+ */
+
+#include "contiki.h"
+#include "lib/random.h"
+#include "sys/critical.h"
+
+#include "net/mac/tsch/tsch.h"
+#include "sixtop.h"
+#include "sixtop-conf.h"
+#include "sixp.h"
+#include "sixp-pkt.h"
+#include "sixp-trans.h"
+#include "msf.h"
+
+#include <string.h>
+
+/* Log configuration */
+#include "sys/log.h"
+#define LOG_MODULE "MSF"
+#define LOG_LEVEL LOG_LEVEL_6TOP
+
+/* Cell directions, from our point of view */
+enum { MSF_DIR_RX, MSF_DIR_TX, MSF_DIR_COUNT };
+
+/* The on-air size of a cell in a CellList */
+#define MSF_CELL_SIZE sizeof(sixp_pkt_cell_t)
+/* Metadata, CellOptions and NumCells */
+#define MSF_REQ_HEADER_LEN 4
+
+typedef struct {
+  uint16_t timeslot;
+  uint16_t channel_offset;
+} msf_cell_t;
+
+/* A cell negotiated with the parent */
+struct msf_negotiated_cell {
+  struct tsch_link *link;
+  /* Transmissions and acknowledged transmissions, for Tx cells */
+  uint16_t num_tx;
+  uint16_t num_tx_ack;
+};
+
+/* Cell usage since the last evaluation, updated from interrupt */
+struct msf_usage {
+  uint16_t num_cells_elapsed;
+  uint16_t num_cells_used;
+};
+
+/* Context of a response to a request of a child, until it is sent */
+struct msf_response {
+  linkaddr_t peer_addr;
+  sixp_pkt_cmd_t cmd;
+  uint8_t link_options;
+  uint8_t num_cells;
+  uint8_t in_use;
+  msf_cell_t cells[MSF_CELL_LIST_LEN];
+  msf_cell_t rel_cells[MSF_CELL_LIST_LEN];
+};
+
+static struct msf_negotiated_cell negotiated_cells[MSF_DIR_COUNT][MSF_MAX_NEGOTIATED_CELLS];
+static struct msf_usage usage[MSF_DIR_COUNT];
+static struct msf_response responses[SIXTOP_MAX_TRANSACTIONS];
+
+/* The parent we negotiated cells with */
+static linkaddr_t parent_addr;
+/* Set when the parent must be sent a CLEAR request */
+static uint8_t clear_pending;
+
+/* The request in progress with the parent */
+static struct {
+  sixp_pkt_cmd_t cmd;
+  uint8_t dir;
+  struct msf_negotiated_cell *cell;
+} pending;
+
+/* ASN of the last cell usage update and slots not yet accounted for */
+static struct tsch_asn_t last_asn;
+static uint32_t pending_slots;
+
+static struct ctimer housekeeping_timer;
+static uint8_t req_storage[MSF_REQ_HEADER_LEN + (1 + MSF_CELL_LIST_LEN) * MSF_CELL_SIZE];
+static uint8_t res_storage[MSF_CELL_LIST_LEN * MSF_CELL_SIZE];
+
+static void housekeeping(void *ptr);
+/*---------------------------------------------------------------------------*/
+static void
+read_cell(const uint8_t *buf, msf_cell_t *cell)
+{
+  cell->timeslot = buf[0] + (buf[1] << 8);
+  cell->channel_offset = buf[2] + (buf[3] << 8);
+}
+/*---------------------------------------------------------------------------*/
+static void
+write_cell(uint8_t *buf, const msf_cell_t *cell)
+{
+  buf[0] = cell->timeslot & 0xff;
+  buf[1] = cell->timeslot >> 8;
+  buf[2] = cell->channel_offset & 0xff;
+  buf[3] = cell->channel_offset >> 8;
+}
+/*---------------------------------------------------------------------------*/
+static struct tsch_slotframe *
+get_slotframe(void)
+{
+  struct tsch_slotframe *sf;
+  sf = tsch_schedule_get_slotframe_by_handle(MSF_SLOTFRAME_HANDLE);
+  if(sf == NULL) {
+    sf = tsch_schedule_add_slotframe(MSF_SLOTFRAME_HANDLE, MSF_SLOTFRAME_LENGTH);
+  }
+  return sf;
+}
+/*---------------------------------------------------------------------------*/
+/* Is the timeslot unused in all slotframes of the same length? Timeslots
+ * of slotframes of other lengths collide periodically whatever we pick,
+ * TSCH then resolves the conflicts by link priority. */
+static int
+timeslot_is_free(uint16_t timeslot)
+{
+  struct tsch_slotframe *sf;
+  struct tsch_link *l;
+
+  if(timeslot >= MSF_SLOTFRAME_LENGTH) {
+    return 0;
+  }
+  for(sf = tsch_schedule_slotframe_head(); sf != NULL;
+      sf = tsch_schedule_slotframe_next(sf)) {
+    if(sf->size.val != MSF_SLOTFRAME_LENGTH) {
+      continue;
+    }
+    for(l = list_head(sf->links_list); l != NULL; l = list_item_next(l)) {
+      if(l->timeslot == timeslot) {
+        return 0;
+      }
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Pick up to max random free cells, with distinct timeslots */
+static int
+select_candidate_cells(msf_cell_t *cells, int max)
+{
+  int num = 0;
+  int trials;
+  int i;
+
+  for(trials = 0; num < max && trials < 4 * MSF_SLOTFRAME_LENGTH; trials++) {
+    uint16_t timeslot = random_rand() % MSF_SLOTFRAME_LENGTH;
+    if(!timeslot_is_free(timeslot)) {
+      continue;
+    }
+    for(i = 0; i < num; i++) {
+      if(cells[i].timeslot == timeslot) {
+        break;
+      }
+    }
+    if(i == num) {
+      cells[num].timeslot = timeslot;
+      cells[num].channel_offset = random_rand() % tsch_hopping_sequence_length.val;
+      num++;
+    }
+  }
+  return num;
+}
+/*---------------------------------------------------------------------------*/
+static int
+num_negotiated_cells(int dir)
+{
+  int i;
+  int num = 0;
+  for(i = 0; i < MSF_MAX_NEGOTIATED_CELLS; i++) {
+    if(negotiated_cells[dir][i].link != NULL) {
+      num++;
+    }
+  }
+  return num;
+}
+/*---------------------------------------------------------------------------*/
+static void
+reset_usage(int dir)
+{
+  int_master_status_t status = critical_enter();
+  usage[dir].num_cells_elapsed = 0;
+  usage[dir].num_cells_used = 0;
+  critical_exit(status);
+}
+/*---------------------------------------------------------------------------*/
+static struct msf_negotiated_cell *
+add_negotiated_cell(int dir, const msf_cell_t *cell)
+{
+  struct tsch_slotframe *sf;
+  struct msf_negotiated_cell *c = NULL;
+  int i;
+
+  for(i = 0; i < MSF_MAX_NEGOTIATED_CELLS; i++) {
+    if(negotiated_cells[dir][i].link == NULL) {
+      c = &negotiated_cells[dir][i];
+      break;
+    }
+  }
+  if(c == NULL || (sf = get_slotframe()) == NULL
+     || !timeslot_is_free(cell->timeslot)) {
+    return NULL;
+  }
+
+  c->num_tx = 0;
+  c->num_tx_ack = 0;
+  c->link = tsch_schedule_add_link(sf,
+                                   dir == MSF_DIR_TX ? LINK_OPTION_TX : LINK_OPTION_RX,
+                                   LINK_TYPE_NORMAL, &parent_addr,
+                                   cell->timeslot, cell->channel_offset, 1);
+  if(c->link != NULL) {
+    c->link->data = c;
+    LOG_INFO("added %s cell %u/%u with ", dir == MSF_DIR_TX ? "Tx" : "Rx",
+             cell->timeslot, cell->channel_offset);
+    LOG_INFO_LLADDR(&parent_addr);
+    LOG_INFO_("\n");
+  }
+  return c->link != NULL ? c : NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+remove_negotiated_cell(struct msf_negotiated_cell *c)
+{
+  struct tsch_slotframe *sf;
+
+  if(c->link == NULL) {
+    return;
+  }
+  LOG_INFO("removed %s cell %u/%u\n",
+           (c->link->link_options & LINK_OPTION_TX) ? "Tx" : "Rx",
+           c->link->timeslot, c->link->channel_offset);
+  sf = tsch_schedule_get_slotframe_by_handle(MSF_SLOTFRAME_HANDLE);
+  if(sf != NULL) {
+    tsch_schedule_remove_link(sf, c->link);
+  }
+  c->link = NULL;
+}
+/*---------------------------------------------------------------------------*/
+static struct msf_negotiated_cell *
+find_negotiated_cell(int dir, const msf_cell_t *cell)
+{
+  int i;
+  for(i = 0; i < MSF_MAX_NEGOTIATED_CELLS; i++) {
+    struct tsch_link *l = negotiated_cells[dir][i].link;
+    if(l != NULL && l->timeslot == cell->timeslot
+       && l->channel_offset == cell->channel_offset) {
+      return &negotiated_cells[dir][i];
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+remove_all_negotiated_cells(void)
+{
+  int dir, i;
+  for(dir = 0; dir < MSF_DIR_COUNT; dir++) {
+    for(i = 0; i < MSF_MAX_NEGOTIATED_CELLS; i++) {
+      remove_negotiated_cell(&negotiated_cells[dir][i]);
+    }
+    reset_usage(dir);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Remove the cells a child negotiated with us */
+static void
+remove_child_cells(const linkaddr_t *peer_addr)
+{
+  struct tsch_slotframe *sf;
+  struct tsch_link *l;
+  struct tsch_link *next;
+
+  sf = tsch_schedule_get_slotframe_by_handle(MSF_SLOTFRAME_HANDLE);
+  if(sf == NULL) {
+    return;
+  }
+  for(l = list_head(sf->links_list); l != NULL; l = next) {
+    next = list_item_next(l);
+    if(l->data == NULL && linkaddr_cmp(&l->addr, peer_addr)) {
+      tsch_schedule_remove_link(sf, l);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static struct tsch_link *
+find_child_cell(const linkaddr_t *peer_addr, const msf_cell_t *cell)
+{
+  struct tsch_link *l;
+  l = tsch_schedule_get_link_by_timeslot(
+        tsch_schedule_get_slotframe_by_handle(MSF_SLOTFRAME_HANDLE),
+        cell->timeslot, cell->channel_offset);
+  if(l != NULL && l->data == NULL && linkaddr_cmp(&l->addr, peer_addr)) {
+    return l;
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+/* The cell to give up when deleting or relocating: the one with the
+ * worst delivery ratio for Tx cells, the last one for Rx cells */
+static struct msf_negotiated_cell *
+worst_negotiated_cell(int dir, uint32_t *worst_pdr, uint32_t *best_pdr)
+{
+  struct msf_negotiated_cell *worst = NULL;
+  int i;
+
+  *worst_pdr = 101;
+  *best_pdr = 0;
+  for(i = 0; i < MSF_MAX_NEGOTIATED_CELLS; i++) {
+    struct msf_negotiated_cell *c = &negotiated_cells[dir][i];
+    uint32_t pdr;
+    if(c->link == NULL) {
+      continue;
+    }
+    if(dir == MSF_DIR_RX || c->num_tx < MSF_MIN_NUM_TX) {
+      /* No trusted delivery ratio */
+      if(worst == NULL || *worst_pdr == 101) {
+        worst = c;
+      }
+      continue;
+    }
+    pdr = (uint32_t)c->num_tx_ack * 100 / c->num_tx;
+    if(pdr < *worst_pdr) {
+      *worst_pdr = pdr;
+      worst = c;
+    }
+    if(pdr > *best_pdr) {
+      *best_pdr = pdr;
+    }
+  }
+  return worst;
+}
+/*---------------------------------------------------------------------------*/
+static struct msf_response *
+alloc_response(const linkaddr_t *peer_addr)
+{
+  int i;
+  struct msf_response *free_response = NULL;
+
+  for(i = 0; i < SIXTOP_MAX_TRANSACTIONS; i++) {
+    /* A response whose transaction is gone will never see its callback */
+    if(responses[i].in_use && sixp_trans_find(&responses[i].peer_addr) == NULL) {
+      responses[i].in_use = 0;
+    }
+    if(responses[i].in_use && linkaddr_cmp(&responses[i].peer_addr, peer_addr)) {
+      return &responses[i];
+    }
+    if(!responses[i].in_use && free_response == NULL) {
+      free_response = &responses[i];
+    }
+  }
+  if(free_response != NULL) {
+    memset(free_response, 0, sizeof(*free_response));
+    linkaddr_copy(&free_response->peer_addr, peer_addr);
+    free_response->in_use = 1;
+  }
+  return free_response;
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_response(struct msf_response *r, sixp_pkt_rc_t rc,
+              sixp_sent_callback_t callback)
+{
+  uint16_t res_len = 0;
+  int i;
+
+  memset(res_storage, 0, sizeof(res_storage));
+  if(rc == SIXP_PKT_RC_SUCCESS) {
+    for(i = 0; i < r->num_cells; i++) {
+      write_cell(&res_storage[res_len], &r->cells[i]);
+      res_len += MSF_CELL_SIZE;
+    }
+  }
+  if(sixp_output(SIXP_PKT_TYPE_RESPONSE, (sixp_pkt_code_t)(uint8_t)rc,
+                 MSF_SFID, res_storage, res_len, &r->peer_addr,
+                 callback, r, sizeof(*r)) < 0) {
+    r->in_use = 0;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Install the cells of a response once the child got it */
+static void
+response_sent_callback(void *arg, uint16_t arg_len,
+                       const linkaddr_t *dest_addr,
+                       sixp_output_status_t status)
+{
+  struct msf_response *r = (struct msf_response *)arg;
+  struct tsch_slotframe *sf;
+  struct tsch_link *l;
+  int i;
+
+  if(r == NULL || !r->in_use) {
+    return;
+  }
+  r->in_use = 0;
+  if(status != SIXP_OUTPUT_STATUS_SUCCESS || (sf = get_slotframe()) == NULL) {
+    return;
+  }
+
+  for(i = 0; i < r->num_cells; i++) {
+    switch(r->cmd) {
+      case SIXP_PKT_CMD_RELOCATE:
+        if((l = find_child_cell(dest_addr, &r->rel_cells[i])) != NULL) {
+          tsch_schedule_remove_link(sf, l);
+        }
+        /* Continue with adding the new cell */
+      case SIXP_PKT_CMD_ADD:
+        /* The cell may have been taken since the response was built */
+        if(timeslot_is_free(r->cells[i].timeslot)) {
+          tsch_schedule_add_link(sf, r->link_options, LINK_TYPE_NORMAL, dest_addr,
+                                 r->cells[i].timeslot, r->cells[i].channel_offset, 1);
+        }
+        break;
+      case SIXP_PKT_CMD_DELETE:
+        if((l = find_child_cell(dest_addr, &r->cells[i])) != NULL) {
+          tsch_schedule_remove_link(sf, l);
+        }
+        break;
+      default:
+        break;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+request_input(sixp_pkt_cmd_t cmd, const uint8_t *body, uint16_t body_len,
+              const linkaddr_t *peer_addr)
+{
+  struct msf_response *r;
+  sixp_pkt_code_t code = (sixp_pkt_code_t)(uint8_t)cmd;
+  sixp_pkt_cell_options_t cell_options;
+  sixp_pkt_num_cells_t num_cells;
+  const uint8_t *cell_list;
+  sixp_pkt_offset_t cell_list_len;
+  const uint8_t *rel_cell_list = NULL;
+  sixp_pkt_offset_t rel_cell_list_len = 0;
+  msf_cell_t cell;
+  uint16_t i;
+  int j;
+
+  if((r = alloc_response(peer_addr)) == NULL) {
+    LOG_WARN("no room for a response\n");
+    return;
+  }
+  r->cmd = cmd;
+
+  if(cmd == SIXP_PKT_CMD_CLEAR) {
+    LOG_INFO("clear from ");
+    LOG_INFO_LLADDR(peer_addr);
+    LOG_INFO_("\n");
+    remove_child_cells(peer_addr);
+    if(linkaddr_cmp(peer_addr, &parent_addr)) {
+      remove_all_negotiated_cells();
+    }
+    send_response(r, SIXP_PKT_RC_SUCCESS, NULL);
+    r->in_use = 0;
+    return;
+  }
+
+  if(cmd != SIXP_PKT_CMD_ADD && cmd != SIXP_PKT_CMD_DELETE
+     && cmd != SIXP_PKT_CMD_RELOCATE) {
+    send_response(r, SIXP_PKT_RC_ERR, NULL);
+    r->in_use = 0;
+    return;
+  }
+
+  if(sixp_pkt_get_cell_options(SIXP_PKT_TYPE_REQUEST, code, &cell_options,
+                               body, body_len) < 0
+     || sixp_pkt_get_num_cells(SIXP_PKT_TYPE_REQUEST, code, &num_cells,
+                               body, body_len) < 0) {
+    send_response(r, SIXP_PKT_RC_ERR, NULL);
+    r->in_use = 0;
+    return;
+  }
+  if(cmd == SIXP_PKT_CMD_RELOCATE) {
+    if(sixp_pkt_get_rel_cell_list(SIXP_PKT_TYPE_REQUEST, code, &rel_cell_list,
+                                  &rel_cell_list_len, body, body_len) < 0
+       || sixp_pkt_get_cand_cell_list(SIXP_PKT_TYPE_REQUEST, code, &cell_list,
+                                      &cell_list_len, body, body_len) < 0) {
+      send_response(r, SIXP_PKT_RC_ERR, NULL);
+      r->in_use = 0;
+      return;
+    }
+  } else if(sixp_pkt_get_cell_list(SIXP_PKT_TYPE_REQUEST, code, &cell_list,
+                                   &cell_list_len, body, body_len) < 0) {
+    send_response(r, SIXP_PKT_RC_ERR, NULL);
+    r->in_use = 0;
+    return;
+  }
+
+  /* The cell options are expressed from the requester's point of view */
+  if(cell_options == SIXP_PKT_CELL_OPTION_TX) {
+    r->link_options = LINK_OPTION_RX;
+  } else if(cell_options == SIXP_PKT_CELL_OPTION_RX) {
+    r->link_options = LINK_OPTION_TX;
+  } else {
+    send_response(r, SIXP_PKT_RC_ERR, NULL);
+    r->in_use = 0;
+    return;
+  }
+
+  r->num_cells = 0;
+  if(cmd == SIXP_PKT_CMD_DELETE) {
+    for(i = 0; i < cell_list_len && r->num_cells < num_cells
+          && r->num_cells < MSF_CELL_LIST_LEN; i += MSF_CELL_SIZE) {
+      read_cell(&cell_list[i], &cell);
+      if(find_child_cell(peer_addr, &cell) != NULL) {
+        r->cells[r->num_cells++] = cell;
+      }
+    }
+    if(r->num_cells == 0) {
+      /* None of the cells is ours, let the child clear them */
+      send_response(r, SIXP_PKT_RC_ERR_CELLLIST, NULL);
+      r->in_use = 0;
+      return;
+    }
+  } else {
+    /* ADD and RELOCATE: pick free candidates. For RELOCATE, pair them
+     * with the cells to relocate, which must exist. */
+    uint8_t num_rel = 0;
+    if(cmd == SIXP_PKT_CMD_RELOCATE) {
+      for(i = 0; i < rel_cell_list_len && num_rel < MSF_CELL_LIST_LEN;
+          i += MSF_CELL_SIZE) {
+        read_cell(&rel_cell_list[i], &cell);
+        if(find_child_cell(peer_addr, &cell) == NULL) {
+          /* Our schedules disagree, let the child clear it */
+          send_response(r, SIXP_PKT_RC_ERR_CELLLIST, NULL);
+          r->in_use = 0;
+          return;
+        }
+        r->rel_cells[num_rel++] = cell;
+      }
+      num_cells = MIN(num_cells, num_rel);
+    }
+    for(i = 0; i < cell_list_len && r->num_cells < num_cells
+          && r->num_cells < MSF_CELL_LIST_LEN; i += MSF_CELL_SIZE) {
+      read_cell(&cell_list[i], &cell);
+      if(!timeslot_is_free(cell.timeslot)
+         || cell.channel_offset >= tsch_hopping_sequence_length.val) {
+        continue;
+      }
+      for(j = 0; j < r->num_cells; j++) {
+        if(r->cells[j].timeslot == cell.timeslot) {
+          break;
+        }
+      }
+      if(j == r->num_cells) {
+        r->cells[r->num_cells++] = cell;
+      }
+    }
+  }
+
+  LOG_INFO("request %u for %u cells from ", cmd, num_cells);
+  LOG_INFO_LLADDR(peer_addr);
+  LOG_INFO_(", granting %u\n", r->num_cells);
+  send_response(r, SIXP_PKT_RC_SUCCESS, response_sent_callback);
+}
+/*---------------------------------------------------------------------------*/
+static void
+response_input(sixp_pkt_rc_t rc, const uint8_t *body, uint16_t body_len,
+               const linkaddr_t *peer_addr)
+{
+  const uint8_t *cell_list;
+  sixp_pkt_offset_t cell_list_len;
+  msf_cell_t cell;
+  uint16_t i;
+  sixp_pkt_cmd_t cmd = pending.cmd;
+
+  pending.cmd = SIXP_PKT_CMD_UNAVAILABLE;
+  if(cmd == SIXP_PKT_CMD_UNAVAILABLE || !linkaddr_cmp(peer_addr, &parent_addr)) {
+    return;
+  }
+
+  if(rc != SIXP_PKT_RC_SUCCESS) {
+    LOG_WARN("request %u failed with rc %u\n", cmd, rc);
+    if(rc == SIXP_PKT_RC_ERR_SEQNUM || rc == SIXP_PKT_RC_RESET
+       || rc == SIXP_PKT_RC_ERR_CELLLIST) {
+      /* Schedule inconsistency: start over */
+      remove_all_negotiated_cells();
+      clear_pending = 1;
+    }
+    return;
+  }
+
+  if(cmd == SIXP_PKT_CMD_CLEAR) {
+    return;
+  }
+
+  if(sixp_pkt_get_cell_list(SIXP_PKT_TYPE_RESPONSE,
+                            (sixp_pkt_code_t)(uint8_t)SIXP_PKT_RC_SUCCESS,
+                            &cell_list, &cell_list_len, body, body_len) < 0) {
+    cell_list_len = 0;
+  }
+
+  for(i = 0; i < cell_list_len; i += MSF_CELL_SIZE) {
+    read_cell(&cell_list[i], &cell);
+    switch(cmd) {
+      case SIXP_PKT_CMD_RELOCATE:
+        if(pending.cell != NULL) {
+          remove_negotiated_cell(pending.cell);
+          pending.cell = NULL;
+        }
+        /* Continue with adding the new cell */
+      case SIXP_PKT_CMD_ADD:
+        if(add_negotiated_cell(pending.dir, &cell) == NULL) {
+          /* The parent installed a cell we cannot use: start over */
+          LOG_WARN("cannot install cell %u/%u\n", cell.timeslot, cell.channel_offset);
+          remove_all_negotiated_cells();
+          clear_pending = 1;
+          return;
+        }
+        break;
+      case SIXP_PKT_CMD_DELETE:
+        {
+          struct msf_negotiated_cell *c = find_negotiated_cell(pending.dir, &cell);
+          if(c != NULL) {
+            remove_negotiated_cell(c);
+          }
+        }
+        break;
+      default:
+        break;
+    }
+  }
+  reset_usage(pending.dir);
+}
+/*---------------------------------------------------------------------------*/
+static void
+request_sent_callback(void *arg, uint16_t arg_len,
+                      const linkaddr_t *dest_addr,
+                      sixp_output_status_t status)
+{
+  if(status != SIXP_OUTPUT_STATUS_SUCCESS) {
+    /* The transaction is over, retry at the next housekeeping */
+    pending.cmd = SIXP_PKT_CMD_UNAVAILABLE;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+send_request(sixp_pkt_cmd_t cmd, int dir, struct msf_negotiated_cell *cell)
+{
+  sixp_pkt_code_t code = (sixp_pkt_code_t)(uint8_t)cmd;
+  msf_cell_t cells[MSF_CELL_LIST_LEN];
+  uint16_t req_len = MSF_REQ_HEADER_LEN;
+  int num_cand = 0;
+  int i;
+
+  memset(req_storage, 0, sizeof(req_storage));
+
+  if(cmd != SIXP_PKT_CMD_CLEAR) {
+    if(sixp_pkt_set_cell_options(SIXP_PKT_TYPE_REQUEST, code,
+                                 dir == MSF_DIR_TX ? SIXP_PKT_CELL_OPTION_TX
+                                                   : SIXP_PKT_CELL_OPTION_RX,
+                                 req_storage, sizeof(req_storage)) < 0
+       || sixp_pkt_set_num_cells(SIXP_PKT_TYPE_REQUEST, code, 1,
+                                 req_storage, sizeof(req_storage)) < 0) {
+      return -1;
+    }
+  } else {
+    /* Metadata only */
+    req_len = 2;
+  }
+
+  if(cmd == SIXP_PKT_CMD_DELETE || cmd == SIXP_PKT_CMD_RELOCATE) {
+    uint8_t buf[MSF_CELL_SIZE];
+    msf_cell_t c;
+    c.timeslot = cell->link->timeslot;
+    c.channel_offset = cell->link->channel_offset;
+    write_cell(buf, &c);
+    if(cmd == SIXP_PKT_CMD_DELETE) {
+      if(sixp_pkt_set_cell_list(SIXP_PKT_TYPE_REQUEST, code, buf, sizeof(buf), 0,
+                                req_storage, sizeof(req_storage)) < 0) {
+        return -1;
+      }
+    } else if(sixp_pkt_set_rel_cell_list(SIXP_PKT_TYPE_REQUEST, code, buf, sizeof(buf), 0,
+                                         req_storage, sizeof(req_storage)) < 0) {
+      return -1;
+    }
+    req_len += MSF_CELL_SIZE;
+  }
+
+  if(cmd == SIXP_PKT_CMD_ADD || cmd == SIXP_PKT_CMD_RELOCATE) {
+    num_cand = select_candidate_cells(cells, MSF_CELL_LIST_LEN);
+    if(num_cand == 0) {
+      LOG_WARN("no free cell left\n");
+      return -1;
+    }
+    for(i = 0; i < num_cand; i++) {
+      uint8_t buf[MSF_CELL_SIZE];
+      int ret;
+      write_cell(buf, &cells[i]);
+      if(cmd == SIXP_PKT_CMD_ADD) {
+        ret = sixp_pkt_set_cell_list(SIXP_PKT_TYPE_REQUEST, code, buf, sizeof(buf),
+                                     i * MSF_CELL_SIZE, req_storage, sizeof(req_storage));
+      } else {
+        ret = sixp_pkt_set_cand_cell_list(SIXP_PKT_TYPE_REQUEST, code, buf, sizeof(buf),
+                                          i * MSF_CELL_SIZE, req_storage, sizeof(req_storage));
+      }
+      if(ret < 0) {
+        return -1;
+      }
+    }
+    req_len += num_cand * MSF_CELL_SIZE;
+  }
+
+  if(sixp_output(SIXP_PKT_TYPE_REQUEST, code, MSF_SFID,
+                 req_storage, req_len, &parent_addr,
+                 request_sent_callback, NULL, 0) < 0) {
+    return -1;
+  }
+
+  pending.cmd = cmd;
+  pending.dir = dir;
+  pending.cell = cell;
+  LOG_INFO("sent request %u for a %s cell to ", cmd, dir == MSF_DIR_TX ? "Tx" : "Rx");
+  LOG_INFO_LLADDR(&parent_addr);
+  LOG_INFO_("\n");
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Account for the negotiated cells that elapsed since the last call */
+static void
+update_elapsed_cells(void)
+{
+  uint32_t num_slotframes;
+  int dir;
+
+  pending_slots += TSCH_ASN_DIFF(tsch_current_asn, last_asn);
+  last_asn = tsch_current_asn;
+  num_slotframes = pending_slots / MSF_SLOTFRAME_LENGTH;
+  pending_slots -= num_slotframes * MSF_SLOTFRAME_LENGTH;
+
+  for(dir = 0; dir < MSF_DIR_COUNT; dir++) {
+    uint32_t elapsed = num_slotframes * num_negotiated_cells(dir);
+    int_master_status_t status = critical_enter();
+    usage[dir].num_cells_elapsed = MIN(0xffff, usage[dir].num_cells_elapsed + elapsed);
+    critical_exit(status);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Evaluate the cell usage in one direction. Returns 1 if a request was sent. */
+static int
+adapt_cells(int dir)
+{
+  struct tsch_neighbor *n;
+  int num_cells = num_negotiated_cells(dir);
+  uint32_t elapsed, used;
+  uint32_t worst_pdr, best_pdr;
+  struct msf_negotiated_cell *worst;
+
+  if(num_cells < MSF_MIN_NEGOTIATED_CELLS) {
+    return send_request(SIXP_PKT_CMD_ADD, dir, NULL) == 0;
+  }
+
+  elapsed = usage[dir].num_cells_elapsed;
+  used = usage[dir].num_cells_used;
+  worst = worst_negotiated_cell(dir, &worst_pdr, &best_pdr);
+
+  if(elapsed >= MSF_MAX_NUM_CELLS) {
+    LOG_DBG("%s usage %lu/%lu with %u cells\n", dir == MSF_DIR_TX ? "Tx" : "Rx",
+            (unsigned long)used, (unsigned long)elapsed, num_cells);
+    if(used * 100 > elapsed * MSF_LIM_NUMCELLSUSED_HIGH
+       && num_cells < MSF_MAX_NEGOTIATED_CELLS) {
+      return send_request(SIXP_PKT_CMD_ADD, dir, NULL) == 0;
+    }
+    if(used * 100 < elapsed * MSF_LIM_NUMCELLSUSED_LOW
+       && num_cells > MSF_MIN_NEGOTIATED_CELLS && worst != NULL) {
+      return send_request(SIXP_PKT_CMD_DELETE, dir, worst) == 0;
+    }
+    reset_usage(dir);
+  }
+
+  if(dir == MSF_DIR_TX) {
+    /* Relocate a Tx cell that performs much worse than the best one */
+    if(worst != NULL && worst_pdr <= 100
+       && worst_pdr * 100 < best_pdr * MSF_RELOCATE_PDR_THRESHOLD) {
+      return send_request(SIXP_PKT_CMD_RELOCATE, dir, worst) == 0;
+    }
+    /* Do not wait for the usage counters if the queue builds up */
+    n = tsch_queue_get_nbr(&parent_addr);
+    if(n != NULL && tsch_queue_nbr_packet_count(n) >= MSF_QUEUE_THRESHOLD
+       && num_cells < MSF_MAX_NEGOTIATED_CELLS) {
+      return send_request(SIXP_PKT_CMD_ADD, dir, NULL) == 0;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+housekeeping(void *ptr)
+{
+  struct tsch_neighbor *n;
+  const linkaddr_t *time_source_addr;
+
+  ctimer_set(&housekeeping_timer,
+             MSF_HOUSEKEEPING_PERIOD - MSF_HOUSEKEEPING_PERIOD / 4
+             + random_rand() % (MSF_HOUSEKEEPING_PERIOD / 2 + 1),
+             housekeeping, NULL);
+
+  if(!tsch_is_associated || tsch_is_coordinator) {
+    return;
+  }
+
+  update_elapsed_cells();
+
+  /* One transaction at a time with the parent */
+  if(pending.cmd != SIXP_PKT_CMD_UNAVAILABLE
+     || sixp_trans_find(&parent_addr) != NULL) {
+    return;
+  }
+
+  n = tsch_queue_get_time_source();
+  time_source_addr = n != NULL ? tsch_queue_get_nbr_address(n) : NULL;
+  if(time_source_addr == NULL) {
+    return;
+  }
+
+  if(!linkaddr_cmp(time_source_addr, &parent_addr)) {
+    /* Parent switch: release the cells with the former parent */
+    if(!linkaddr_cmp(&parent_addr, &linkaddr_null)) {
+      LOG_INFO("parent switch, clearing cells with ");
+      LOG_INFO_LLADDR(&parent_addr);
+      LOG_INFO_("\n");
+      remove_all_negotiated_cells();
+      send_request(SIXP_PKT_CMD_CLEAR, MSF_DIR_TX, NULL);
+      pending.cmd = SIXP_PKT_CMD_UNAVAILABLE;
+    }
+    linkaddr_copy(&parent_addr, time_source_addr);
+    clear_pending = 0;
+    return;
+  }
+
+  if(clear_pending) {
+    if(send_request(SIXP_PKT_CMD_CLEAR, MSF_DIR_TX, NULL) == 0) {
+      clear_pending = 0;
+    }
+    return;
+  }
+
+  if(!adapt_cells(MSF_DIR_TX)) {
+    adapt_cells(MSF_DIR_RX);
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+msf_callback_link_used(const struct tsch_link *link, int is_tx,
+                       int mac_tx_status)
+{
+  struct msf_negotiated_cell *c;
+
+  if(link == NULL || link->slotframe_handle != MSF_SLOTFRAME_HANDLE
+     || link->data == NULL) {
+    return;
+  }
+  c = (struct msf_negotiated_cell *)link->data;
+  if(is_tx) {
+    usage[MSF_DIR_TX].num_cells_used++;
+    c->num_tx++;
+    if(mac_tx_status == MAC_TX_OK) {
+      c->num_tx_ack++;
+    }
+    if(c->num_tx >= 2 * MSF_MIN_NUM_TX) {
+      c->num_tx /= 2;
+      c->num_tx_ack /= 2;
+    }
+  } else {
+    usage[MSF_DIR_RX].num_cells_used++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+msf_num_negotiated_cells(int is_tx)
+{
+  return num_negotiated_cells(is_tx ? MSF_DIR_TX : MSF_DIR_RX);
+}
+/*---------------------------------------------------------------------------*/
+void
+msf_print(void)
+{
+  int dir, i;
+
+  LOG_PRINT("parent ");
+  LOG_PRINT_LLADDR(&parent_addr);
+  LOG_PRINT_("\n");
+  for(dir = 0; dir < MSF_DIR_COUNT; dir++) {
+    LOG_PRINT("%s usage %u/%u\n", dir == MSF_DIR_TX ? "Tx" : "Rx",
+              usage[dir].num_cells_used, usage[dir].num_cells_elapsed);
+    for(i = 0; i < MSF_MAX_NEGOTIATED_CELLS; i++) {
+      struct msf_negotiated_cell *c = &negotiated_cells[dir][i];
+      if(c->link != NULL) {
+        LOG_PRINT("-- cell %u/%u, tx %u, acked %u\n",
+                  c->link->timeslot, c->link->channel_offset,
+                  c->num_tx, c->num_tx_ack);
+      }
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+input(sixp_pkt_type_t type, sixp_pkt_code_t code,
+      const uint8_t *body, uint16_t body_len, const linkaddr_t *src_addr)
+{
+  if(type == SIXP_PKT_TYPE_REQUEST) {
+    request_input(code.cmd, body, body_len, src_addr);
+  } else if(type == SIXP_PKT_TYPE_RESPONSE) {
+    response_input(code.rc, body, body_len, src_addr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+timeout(sixp_pkt_cmd_t cmd, const linkaddr_t *peer_addr)
+{
+  if(linkaddr_cmp(peer_addr, &parent_addr)) {
+    pending.cmd = SIXP_PKT_CMD_UNAVAILABLE;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+error(sixp_error_t err, sixp_pkt_cmd_t cmd, uint8_t seqno,
+      const linkaddr_t *peer_addr)
+{
+  if(err != SIXP_ERROR_SCHEDULE_INCONSISTENCY) {
+    return;
+  }
+  LOG_WARN("schedule inconsistency with ");
+  LOG_WARN_LLADDR(peer_addr);
+  LOG_WARN_("\n");
+  if(linkaddr_cmp(peer_addr, &parent_addr)) {
+    remove_all_negotiated_cells();
+    clear_pending = 1;
+  } else {
+    remove_child_cells(peer_addr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Called when installed and at every association: the schedule of the
+ * previous network, if any, is obsolete */
+static void
+init(void)
+{
+  struct tsch_slotframe *sf;
+
+  sf = tsch_schedule_get_slotframe_by_handle(MSF_SLOTFRAME_HANDLE);
+  if(sf != NULL) {
+    tsch_schedule_remove_slotframe(sf);
+  }
+  memset(negotiated_cells, 0, sizeof(negotiated_cells));
+  memset(usage, 0, sizeof(usage));
+  memset(responses, 0, sizeof(responses));
+  linkaddr_copy(&parent_addr, &linkaddr_null);
+  clear_pending = 0;
+  pending.cmd = SIXP_PKT_CMD_UNAVAILABLE;
+  pending.cell = NULL;
+  last_asn = tsch_current_asn;
+  pending_slots = 0;
+
+  ctimer_set(&housekeeping_timer, MSF_HOUSEKEEPING_PERIOD, housekeeping, NULL);
+}
+/*---------------------------------------------------------------------------*/
+const sixtop_sf_t msf_driver = {
+  MSF_SFID,
+  MSF_TIMEOUT,
+  init,
+  input,
+  timeout,
+  error
+};
+/*---------------------------------------------------------------------------*/
+/** @} */
@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * \addtogroup sixtop
+ * @{
+ */
+/**
+ * \file
+ *         A traffic-adaptive Scheduling Function, modeled after the
+ *         6TiSCH Minimal Scheduling Function (MSF, RFC 9033).
+ *
+ *         A node negotiates dedicated Tx and Rx cells with its time
+ *         source (the RPL preferred parent) and adds or deletes cells
+ *         as the observed cell usage crosses the configured thresholds.
+ *         A Tx cell is also added as soon as the queue towards the
+ *         parent builds up, and the Tx cell with the worst delivery
+ *         ratio is relocated when it performs much worse than the best
+ *         one. Negotiated cells live in their own slotframe, next to the
+ *         6TiSCH minimal slotframe which carries the 6P traffic.
+ *
+ *         Enable with SIXTOP_CONF_WITH_MSF; 6top then installs the SF
+ *         at start-up and TSCH reports cell usage through
+ *         TSCH_CALLBACK_LINK_USED.
+ */
+
+#ifndef _SIXTOP_MSF_H_
+#define _SIXTOP_MSF_H_
+
+#include "net/mac/tsch/tsch.h"
+#include "sixtop.h"
+
+/******** Configuration *******/
+
+/* The SFID of MSF, as assigned by IANA */
+#ifdef MSF_CONF_SFID
+#define MSF_SFID MSF_CONF_SFID
+#else
+#define MSF_SFID 0x00
+#endif
+
+/* The slotframe holding the negotiated cells */
+#ifdef MSF_CONF_SLOTFRAME_HANDLE
+#define MSF_SLOTFRAME_HANDLE MSF_CONF_SLOTFRAME_HANDLE
+#else
+#define MSF_SLOTFRAME_HANDLE 1
+#endif
+
+/* The length of the MSF slotframe. Using the length of the minimal
+ * slotframe lets MSF stay clear of the minimal shared cell. */
+#ifdef MSF_CONF_SLOTFRAME_LENGTH
+#define MSF_SLOTFRAME_LENGTH MSF_CONF_SLOTFRAME_LENGTH
+#else
+#define MSF_SLOTFRAME_LENGTH TSCH_SCHEDULE_DEFAULT_LENGTH
+#endif
+
+/* The maximum number of negotiated cells with the parent, per direction */
+#ifdef MSF_CONF_MAX_NEGOTIATED_CELLS
+#define MSF_MAX_NEGOTIATED_CELLS MSF_CONF_MAX_NEGOTIATED_CELLS
+#else
+#define MSF_MAX_NEGOTIATED_CELLS 6
+#endif
+
+/* The number of negotiated cells kept with the parent in each direction,
+ * regardless of the load */
+#ifdef MSF_CONF_MIN_NEGOTIATED_CELLS
+#define MSF_MIN_NEGOTIATED_CELLS MSF_CONF_MIN_NEGOTIATED_CELLS
+#else
+#define MSF_MIN_NEGOTIATED_CELLS 1
+#endif
+
+/* The number of elapsed cells after which the cell usage is evaluated */
+#ifdef MSF_CONF_MAX_NUM_CELLS
+#define MSF_MAX_NUM_CELLS MSF_CONF_MAX_NUM_CELLS
+#else
+#define MSF_MAX_NUM_CELLS 100
+#endif
+
+/* Add a cell when more than this percentage of the cells were used */
+#ifdef MSF_CONF_LIM_NUMCELLSUSED_HIGH
+#define MSF_LIM_NUMCELLSUSED_HIGH MSF_CONF_LIM_NUMCELLSUSED_HIGH
+#else
+#define MSF_LIM_NUMCELLSUSED_HIGH 75
+#endif
+
+/* Delete a cell when less than this percentage of the cells were used */
+#ifdef MSF_CONF_LIM_NUMCELLSUSED_LOW
+#define MSF_LIM_NUMCELLSUSED_LOW MSF_CONF_LIM_NUMCELLSUSED_LOW
+#else
+#define MSF_LIM_NUMCELLSUSED_LOW 25
+#endif
+
+/* Add a Tx cell right away when this many packets are queued to the parent */
+#ifdef MSF_CONF_QUEUE_THRESHOLD
+#define MSF_QUEUE_THRESHOLD MSF_CONF_QUEUE_THRESHOLD
+#else
+#define MSF_QUEUE_THRESHOLD (TSCH_QUEUE_NUM_PER_NEIGHBOR / 2)
+#endif
+
+/* The number of transmissions in a Tx cell before its delivery ratio is
+ * trusted for relocation. The counters are halved when reaching twice
+ * this value, so that they follow recent conditions. */
+#ifdef MSF_CONF_MIN_NUM_TX
+#define MSF_MIN_NUM_TX MSF_CONF_MIN_NUM_TX
+#else
+#define MSF_MIN_NUM_TX 32
+#endif
+
+/* Relocate a Tx cell whose delivery ratio is below this percentage of
+ * the best Tx cell delivery ratio */
+#ifdef MSF_CONF_RELOCATE_PDR_THRESHOLD
+#define MSF_RELOCATE_PDR_THRESHOLD MSF_CONF_RELOCATE_PDR_THRESHOLD
+#else
+#define MSF_RELOCATE_PDR_THRESHOLD 50
+#endif
+
+/* The number of candidate cells proposed in a request */
+#ifdef MSF_CONF_CELL_LIST_LEN
+#define MSF_CELL_LIST_LEN MSF_CONF_CELL_LIST_LEN
+#else
+#define MSF_CELL_LIST_LEN 5
+#endif
+
+/* The period of cell usage evaluation and schedule housekeeping */
+#ifdef MSF_CONF_HOUSEKEEPING_PERIOD
+#define MSF_HOUSEKEEPING_PERIOD MSF_CONF_HOUSEKEEPING_PERIOD
+#else
+#define MSF_HOUSEKEEPING_PERIOD (4 * CLOCK_SECOND)
+#endif
+
+/* The 6P transaction timeout */
+#ifdef MSF_CONF_TIMEOUT
+#define MSF_TIMEOUT MSF_CONF_TIMEOUT
+#else
+#define MSF_TIMEOUT (8 * CLOCK_SECOND)
+#endif
+
+/**
+ * \brief Report the use of a link by TSCH. Called from interrupt.
+ * \param link The link in which a unicast frame was sent or received
+ * \param is_tx 1 for a transmission attempt, 0 for a reception
+ * \param mac_tx_status The MAC status of a transmission attempt
+ */
+void msf_callback_link_used(const struct tsch_link *link, int is_tx,
+                            int mac_tx_status);
+
+/**
+ * \brief Get the number of cells negotiated with the parent
+ * \param is_tx 1 for Tx cells, 0 for Rx cells
+ * \return The number of negotiated cells
+ */
+int msf_num_negotiated_cells(int is_tx);
+
+/**
+ * \brief Print the negotiated cells and their statistics
+ */
+void msf_print(void);
+
+extern const sixtop_sf_t msf_driver;
+
+#endif /* !_SIXTOP_MSF_H_ */
+/** @} */
@@ -61,5 +61,15 @@
 #define SIXTOP_MAX_TRANSACTIONS 1
 #endif
 
+/**
+ * \brief Install the built-in traffic-adaptive Scheduling Function (see
+ * msf.h) at start-up.
+ */
+#ifdef SIXTOP_CONF_WITH_MSF
+#define SIXTOP_WITH_MSF SIXTOP_CONF_WITH_MSF
+#else
+#define SIXTOP_WITH_MSF 0
+#endif
+
 #endif /* !__SIXTOP_CONF_H__ */
 /** @} */
@@ -49,6 +49,9 @@
 #include "sixtop.h"
 #include "sixtop-conf.h"
 #include "sixp.h"
+#if SIXTOP_WITH_MSF
+#include "msf.h"
+#endif /* SIXTOP_WITH_MSF */
 
 /* Log configuration */
 #include "sys/log.h"
@@ -87,9 +90,6 @@ sixtop_add_sf(const sixtop_sf_t *sf)
   for(i = 0; i < SIXTOP_MAX_SCHEDULING_FUNCTIONS; i++) {
     if(scheduling_functions[i] == NULL) {
       scheduling_functions[i] = sf;
-      if(sf->init != NULL) {
-        sf->init();
-      }
       break;
     }
   }
@@ -269,6 +269,10 @@ sixtop_init(void)
   }
 
   sixtop_init_sf();
+
+#if SIXTOP_WITH_MSF
+  sixtop_add_sf(&msf_driver);
+#endif /* SIXTOP_WITH_MSF */
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -56,6 +56,14 @@ struct tsch_asn_divisor_t {
   uint16_t asn_ms1b_remainder; /* Remainder of the operation 0x100000000 / val */
 };
 
+/** \brief For incremental modulo operation on an ASN that moves forward
+ * by small steps, as the current ASN does from one active slot to the next */
+struct tsch_asn_mod_tracker_t {
+  struct tsch_asn_t asn; /* ASN of the last operation */
+  uint16_t divisor; /* Divisor of the last operation, 0 if none */
+  uint16_t remainder; /* Result of the last operation */
+};
+
 /************ Macros **********/
 
 /** \brief Initialize ASN */
@@ -95,5 +103,51 @@ struct tsch_asn_divisor_t {
    + (uint16_t)((asn).ms1b * (div).asn_ms1b_remainder % (div).val)) \
   % (div).val
 
+/** \brief Reset an ASN modulo tracker. The next operation performs a full
+ * modulo */
+#define TSCH_ASN_MOD_TRACKER_RESET(tracker) do { \
+    (tracker).divisor = 0; \
+} while(0);
+
+/** \brief The largest ASN step, in number of divisors, for which a tracker
+ * is advanced by subtraction rather than by a full modulo */
+#define TSCH_ASN_MOD_TRACKER_MAX_STEPS 8
+
+/**
+ * \brief Returns the result (16 bits) of a modulo operation on ASN, as
+ * TSCH_ASN_MOD does, but derived from the previous operation on the same
+ * tracker. When the ASN moved forward by less than
+ * TSCH_ASN_MOD_TRACKER_MAX_STEPS divisors, this takes a few subtractions
+ * instead of 32-bit divisions, which are costly on MCUs without a
+ * hardware divider.
+ * \param tracker The tracker, updated with the new ASN and result
+ * \param asn The ASN
+ * \param div The divisor
+ * \return asn % div
+ */
+static inline uint16_t
+tsch_asn_mod_tracked(struct tsch_asn_mod_tracker_t *tracker,
+                     const struct tsch_asn_t *asn,
+                     const struct tsch_asn_divisor_t *div)
+{
+  uint32_t diff = TSCH_ASN_DIFF(*asn, tracker->asn);
+  /* The ms1b must have moved along with any carry of ls4b, or the ASN went
+   * back or jumped by more than 32 bits */
+  if(tracker->divisor == div->val
+     && (uint8_t)(asn->ms1b - tracker->asn.ms1b) == (asn->ls4b < tracker->asn.ls4b)
+     && diff < (uint32_t)TSCH_ASN_MOD_TRACKER_MAX_STEPS * div->val) {
+    uint32_t remainder = tracker->remainder + diff;
+    while(remainder >= div->val) {
+      remainder -= div->val;
+    }
+    tracker->remainder = (uint16_t)remainder;
+  } else {
+    tracker->remainder = TSCH_ASN_MOD(*asn, *div);
+    tracker->divisor = div->val;
+  }
+  tracker->asn = *asn;
+  return tracker->remainder;
+}
+
 #endif /* __TSCH_ASN_H__ */
 /** @} */
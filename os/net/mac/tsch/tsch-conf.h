@@ -229,7 +229,8 @@
 #ifdef TSCH_PACKET_CONF_EB_WITH_TIMESLOT_TIMING
 #define TSCH_PACKET_EB_WITH_TIMESLOT_TIMING TSCH_PACKET_CONF_EB_WITH_TIMESLOT_TIMING
 #else
-#define TSCH_PACKET_EB_WITH_TIMESLOT_TIMING 0
+/* Needed for the nodes to learn an adaptive timeslot timing template */
+#define TSCH_PACKET_EB_WITH_TIMESLOT_TIMING TSCH_ADAPTIVE_TIMESLOT_TIMING
 #endif
 
 /* TSCH EB: include hopping sequence Information Element? */
@@ -450,5 +451,48 @@ by default, useful in case of duplicate seqno */
 #define TSCH_CONF_RX_WAIT 2200
 #endif /* TSCH_CONF_RX_WAIT */
 
+/* Adaptive timeslot timing: the coordinator measures its worst-case
+ * processing time for every phase of slot operation (see
+ * TSCH_STATS_CONF_SLOT_PROFILER), derives from it the shortest safe timeslot
+ * timing template, and restarts the network with that template, which it
+ * then advertises in its EBs. The radio-dependent timings (guard times,
+ * maximum frame and ACK durations) are taken from TSCH_DEFAULT_TIMESLOT_TIMING.
+ * All nodes are assumed to be at least as fast as the coordinator. */
+#ifdef TSCH_CONF_ADAPTIVE_TIMESLOT_TIMING
+#define TSCH_ADAPTIVE_TIMESLOT_TIMING TSCH_CONF_ADAPTIVE_TIMESLOT_TIMING
+#else
+#define TSCH_ADAPTIVE_TIMESLOT_TIMING 0
+#endif
+
+/* How long the coordinator measures processing times, using the default
+ * template, before deriving the adaptive template */
+#ifdef TSCH_CONF_ADAPTIVE_TIMESLOT_TIMING_CALIBRATION
+#define TSCH_ADAPTIVE_TIMESLOT_TIMING_CALIBRATION TSCH_CONF_ADAPTIVE_TIMESLOT_TIMING_CALIBRATION
+#else
+#define TSCH_ADAPTIVE_TIMESLOT_TIMING_CALIBRATION (120 * CLOCK_SECOND)
+#endif
+
+/* Minimum number of samples of each phase needed to derive the template */
+#ifdef TSCH_CONF_ADAPTIVE_TIMESLOT_TIMING_MIN_SAMPLES
+#define TSCH_ADAPTIVE_TIMESLOT_TIMING_MIN_SAMPLES TSCH_CONF_ADAPTIVE_TIMESLOT_TIMING_MIN_SAMPLES
+#else
+#define TSCH_ADAPTIVE_TIMESLOT_TIMING_MIN_SAMPLES 16
+#endif
+
+/* Safety margin added to every measured processing time, in micro-seconds */
+#ifdef TSCH_CONF_ADAPTIVE_TIMESLOT_TIMING_MARGIN
+#define TSCH_ADAPTIVE_TIMESLOT_TIMING_MARGIN TSCH_CONF_ADAPTIVE_TIMESLOT_TIMING_MARGIN
+#else
+#define TSCH_ADAPTIVE_TIMESLOT_TIMING_MARGIN 200
+#endif
+
+/* Time added to the ASN skipped over when the coordinator restarts the
+ * network, on top of the time elapsed and TSCH_DESYNC_THRESHOLD */
+#ifdef TSCH_CONF_ADAPTIVE_TIMESLOT_TIMING_ASN_MARGIN
+#define TSCH_ADAPTIVE_TIMESLOT_TIMING_ASN_MARGIN TSCH_CONF_ADAPTIVE_TIMESLOT_TIMING_ASN_MARGIN
+#else
+#define TSCH_ADAPTIVE_TIMESLOT_TIMING_ASN_MARGIN (10 * CLOCK_SECOND)
+#endif
+
 #endif /* __TSCH_CONF_H__ */
 /** @} */
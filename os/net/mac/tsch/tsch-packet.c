@@ -456,6 +456,13 @@ tsch_packet_set_frame_pending(uint8_t *buf, int buf_size)
   buf[0] |= (1 << IEEE802154_FRAME_PENDING_BIT_OFFSET);
 }
 /*---------------------------------------------------------------------------*/
+/* Clear frame pending bit in a packet (whose header was already build) */
+void
+tsch_packet_clear_frame_pending(uint8_t *buf, int buf_size)
+{
+  buf[0] &= ~(1 << IEEE802154_FRAME_PENDING_BIT_OFFSET);
+}
+/*---------------------------------------------------------------------------*/
 /* Get frame pending bit from a packet */
 int
 tsch_packet_get_frame_pending(uint8_t *buf, int buf_size)
@@ -87,6 +87,7 @@ tsch_schedule_add_slotframe(uint16_t handle, uint16_t size)
       /* Initialize the slotframe */
       sf->handle = handle;
       TSCH_ASN_DIVISOR_INIT(sf->size, size);
+      TSCH_ASN_MOD_TRACKER_RESET(sf->asn_mod);
       LIST_STRUCT_INIT(sf, links_list);
       /* Add the slotframe to the global list */
       list_add(slotframe_list, sf);
@@ -417,7 +418,7 @@ tsch_schedule_get_next_active_link(struct tsch_asn_t *asn, uint16_t *time_offset
     /* For each slotframe, look for the earliest occurring link */
     while(sf != NULL) {
       /* Get timeslot from ASN, given the slotframe length */
-      uint16_t timeslot = TSCH_ASN_MOD(*asn, sf->size);
+      uint16_t timeslot = tsch_asn_mod_tracked(&sf->asn_mod, asn, &sf->size);
       struct tsch_link *l = list_head(sf->links_list);
       while(l != NULL) {
         uint16_t time_to_timeslot =
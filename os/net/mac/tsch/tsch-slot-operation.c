@@ -106,6 +106,18 @@
 #define RTIMER_GUARD 2u
 #endif
 
+#if TSCH_STATS_SLOT_PROFILER
+/* Start time of the slot operation phase being profiled. Phases never
+ * overlap and never span a yield, so a single timestamp is enough. */
+static rtimer_clock_t profiler_phase_start;
+#define TSCH_PROFILER_PHASE_START() (profiler_phase_start = RTIMER_NOW())
+#define TSCH_PROFILER_PHASE_END(phase) \
+  tsch_stats_profiler_record((phase), profiler_phase_start, RTIMER_NOW())
+#else /* TSCH_STATS_SLOT_PROFILER */
+#define TSCH_PROFILER_PHASE_START()
+#define TSCH_PROFILER_PHASE_END(phase)
+#endif /* TSCH_STATS_SLOT_PROFILER */
+
 enum tsch_radio_state_on_cmd {
   TSCH_RADIO_CMD_ON_START_OF_TIMESLOT,
   TSCH_RADIO_CMD_ON_WITHIN_TIMESLOT,
@@ -165,6 +177,8 @@ static struct tsch_neighbor *current_neighbor = NULL;
 
 /* Indicates whether an extra link is needed to handle the current burst */
 static int burst_link_scheduled = 0;
+/* Indicates whether we are the sender (1) or the receiver (0) of the current burst */
+static int burst_link_tx = 0;
 /* Counts the length of the current burst */
 int tsch_current_burst_count = 0;
 
@@ -264,9 +278,19 @@ tsch_get_channel_offset(struct tsch_link *link, struct tsch_packet *p)
 static uint8_t
 tsch_calculate_channel(struct tsch_asn_t *asn, uint16_t channel_offset)
 {
+  /* ASN%hopping sequence length at the last active slot */
+  static struct tsch_asn_mod_tracker_t hopping_asn_mod;
   uint16_t index_of_0, index_of_offset;
-  index_of_0 = TSCH_ASN_MOD(*asn, tsch_hopping_sequence_length);
-  index_of_offset = (index_of_0 + channel_offset) % tsch_hopping_sequence_length.val;
+  index_of_0 = tsch_asn_mod_tracked(&hopping_asn_mod, asn, &tsch_hopping_sequence_length);
+  if(channel_offset < tsch_hopping_sequence_length.val) {
+    /* Both terms are below the length: no division needed */
+    index_of_offset = index_of_0 + channel_offset;
+    if(index_of_offset >= tsch_hopping_sequence_length.val) {
+      index_of_offset -= tsch_hopping_sequence_length.val;
+    }
+  } else {
+    index_of_offset = (index_of_0 + channel_offset) % tsch_hopping_sequence_length.val;
+  }
   return tsch_hopping_sequence[index_of_offset];
 }
 
@@ -298,7 +322,8 @@ check_timer_miss(rtimer_clock_t ref_time, rtimer_clock_t offset, rtimer_clock_t
  * Provides basic protection against missed deadlines and timer overflows
  * A return value of zero signals a missed deadline: no rtimer was scheduled. */
 static uint8_t
-tsch_schedule_slot_operation(struct rtimer *tm, rtimer_clock_t ref_time, rtimer_clock_t offset, const char *str)
+tsch_schedule_slot_operation(struct rtimer *tm, rtimer_clock_t ref_time, rtimer_clock_t offset,
+                             enum tsch_slot_deadline deadline, const char *str)
 {
   rtimer_clock_t now = RTIMER_NOW();
   int r;
@@ -307,6 +332,7 @@ tsch_schedule_slot_operation(struct rtimer *tm, rtimer_clock_t ref_time, rtimer_
   int missed = check_timer_miss(ref_time, offset - RTIMER_GUARD, now);
 
   if(missed) {
+    tsch_stats_profiler_deadline_miss(deadline);
     TSCH_LOG_ADD(tsch_log_message,
                 snprintf(log->message, sizeof(log->message),
                     "!dl-miss %s %d %d",
@@ -327,9 +353,9 @@ tsch_schedule_slot_operation(struct rtimer *tm, rtimer_clock_t ref_time, rtimer_
 /* Schedule slot operation conditionally, and YIELD if success only.
  * Always attempt to schedule RTIMER_GUARD before the target to make sure to wake up
  * ahead of time and then busy wait to exactly hit the target. */
-#define TSCH_SCHEDULE_AND_YIELD(pt, tm, ref_time, offset, str) \
+#define TSCH_SCHEDULE_AND_YIELD(pt, tm, ref_time, offset, deadline, str) \
   do { \
-    if(tsch_schedule_slot_operation(tm, ref_time, offset - RTIMER_GUARD, str)) { \
+    if(tsch_schedule_slot_operation(tm, ref_time, offset - RTIMER_GUARD, deadline, str)) { \
       PT_YIELD(pt); \
     } \
     RTIMER_BUSYWAIT_UNTIL_ABS(0, ref_time, offset); \
@@ -495,6 +521,7 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
   PT_BEGIN(pt);
 
   TSCH_DEBUG_TX_EVENT();
+  TSCH_PROFILER_PHASE_START();
 
   /* First check if we have space to store a newly dequeued packet (in case of
    * successful Tx or Drop) */
@@ -535,6 +562,9 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
              && tsch_queue_nbr_packet_count(current_neighbor) > 1) {
         burst_link_requested = 1;
         tsch_packet_set_frame_pending(packet, packet_len);
+      } else {
+        /* The packet may be a retransmission that requested a burst earlier */
+        tsch_packet_clear_frame_pending(packet, packet_len);
       }
       /* read seqno from payload */
       seqno = ((uint8_t *)(packet))[2];
@@ -562,10 +592,12 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
       if(packet_ready && NETSTACK_RADIO.prepare(packet, packet_len) == 0) { /* 0 means success */
         static rtimer_clock_t tx_duration;
 
+        TSCH_PROFILER_PHASE_END(tsch_sp_tx_prepare);
+
 #if TSCH_CCA_ENABLED
         cca_status = 1;
         /* delay before CCA */
-        TSCH_SCHEDULE_AND_YIELD(pt, t, current_slot_start, tsch_timing[tsch_ts_cca_offset], "cca");
+        TSCH_SCHEDULE_AND_YIELD(pt, t, current_slot_start, tsch_timing[tsch_ts_cca_offset], tsch_sd_cca, "cca");
         TSCH_DEBUG_TX_EVENT();
         tsch_radio_on(TSCH_RADIO_CMD_ON_WITHIN_TIMESLOT);
         /* CCA */
@@ -580,7 +612,7 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
 #endif /* TSCH_CCA_ENABLED */
         {
           /* delay before TX */
-          TSCH_SCHEDULE_AND_YIELD(pt, t, current_slot_start, tsch_timing[tsch_ts_tx_offset] - RADIO_DELAY_BEFORE_TX, "TxBeforeTx");
+          TSCH_SCHEDULE_AND_YIELD(pt, t, current_slot_start, tsch_timing[tsch_ts_tx_offset] - RADIO_DELAY_BEFORE_TX, tsch_sd_tx_before_tx, "TxBeforeTx");
           TSCH_DEBUG_TX_EVENT();
           /* send packet already in radio tx buffer */
           mac_tx_status = NETSTACK_RADIO.transmit(packet_len);
@@ -612,7 +644,7 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
 #endif /* TSCH_HW_FRAME_FILTERING */
               /* Unicast: wait for ack after tx: sleep until ack time */
               TSCH_SCHEDULE_AND_YIELD(pt, t, current_slot_start,
-                  tsch_timing[tsch_ts_tx_offset] + tx_duration + tsch_timing[tsch_ts_rx_ack_delay] - RADIO_DELAY_BEFORE_RX, "TxBeforeAck");
+                  tsch_timing[tsch_ts_tx_offset] + tx_duration + tsch_timing[tsch_ts_rx_ack_delay] - RADIO_DELAY_BEFORE_RX, tsch_sd_tx_before_ack, "TxBeforeAck");
               TSCH_DEBUG_TX_EVENT();
               tsch_radio_on(TSCH_RADIO_CMD_ON_WITHIN_TIMESLOT);
               /* Wait for ACK to come */
@@ -634,6 +666,7 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
               NETSTACK_RADIO.set_value(RADIO_PARAM_RX_MODE, radio_rx_mode | RADIO_RX_MODE_ADDRESS_FILTER);
 #endif /* TSCH_HW_FRAME_FILTERING */
 
+              TSCH_PROFILER_PHASE_START();
               /* Read ack frame */
               ack_len = NETSTACK_RADIO.read((void *)ackbuf, sizeof(ackbuf));
 
@@ -694,10 +727,12 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
                 the extra slot will be scheduled at the received */
                 if(burst_link_requested) {
                   burst_link_scheduled = 1;
+                  burst_link_tx = 1;
                 }
               } else {
                 mac_tx_status = MAC_TX_NOACK;
               }
+              TSCH_PROFILER_PHASE_END(tsch_sp_tx_ack_process);
             } else {
               mac_tx_status = MAC_TX_OK;
             }
@@ -712,6 +747,7 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
 
     tsch_radio_off(TSCH_RADIO_CMD_OFF_END_OF_TIMESLOT);
 
+    TSCH_PROFILER_PHASE_START();
     current_packet->transmissions++;
     current_packet->ret = mac_tx_status;
 
@@ -729,6 +765,12 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
       tsch_stats_tx_packet(current_neighbor, mac_tx_status, tsch_current_channel);
     }
 
+#ifdef TSCH_CALLBACK_LINK_USED
+    if(current_neighbor != NULL && !current_neighbor->is_broadcast) {
+      TSCH_CALLBACK_LINK_USED(current_link, 1, mac_tx_status);
+    }
+#endif /* TSCH_CALLBACK_LINK_USED */
+
     /* Log every tx attempt */
     TSCH_LOG_ADD(tsch_log_tx,
         log->tx.mac_tx_status = mac_tx_status;
@@ -745,6 +787,7 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
         linkaddr_copy(&log->tx.dest, queuebuf_addr(current_packet->qb, PACKETBUF_ADDR_RECEIVER));
         log->tx.seqno = queuebuf_attr(current_packet->qb, PACKETBUF_ATTR_MAC_SEQNO);
     );
+    TSCH_PROFILER_PHASE_END(tsch_sp_tx_post);
 
     /* Poll process for later processing of packet sent events and logs */
     process_poll(&tsch_pending_events_process);
@@ -797,7 +840,7 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
     current_input = &input_array[input_index];
 
     /* Wait before starting to listen */
-    TSCH_SCHEDULE_AND_YIELD(pt, t, current_slot_start, tsch_timing[tsch_ts_rx_offset] - RADIO_DELAY_BEFORE_RX, "RxBeforeListen");
+    TSCH_SCHEDULE_AND_YIELD(pt, t, current_slot_start, tsch_timing[tsch_ts_rx_offset] - RADIO_DELAY_BEFORE_RX, tsch_sd_rx_before_listen, "RxBeforeListen");
     TSCH_DEBUG_RX_EVENT();
 
     /* Start radio for at least guard time */
@@ -829,6 +872,7 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
         radio_value_t radio_last_rssi;
         radio_value_t radio_last_lqi;
 
+        TSCH_PROFILER_PHASE_START();
         /* Read packet */
         current_input->len = NETSTACK_RADIO.read((void *)current_input->payload, TSCH_PACKET_MAX_LEN);
         NETSTACK_RADIO.get_value(RADIO_PARAM_LAST_RSSI, &radio_last_rssi);
@@ -880,6 +924,7 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
           }
         }
 #endif /* LLSEC802154_ENABLED */
+        TSCH_PROFILER_PHASE_END(tsch_sp_rx_process);
 
         if(frame_valid) {
           /* Check that frome is for us or broadcast, AND that it is not from
@@ -915,6 +960,7 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
               static uint8_t ack_buf[TSCH_PACKET_MAX_LEN];
               static int ack_len;
 
+              TSCH_PROFILER_PHASE_START();
               /* Build ACK frame */
               ack_len = tsch_packet_create_eack(ack_buf, sizeof(ack_buf),
                   &source_address, frame.seq, (int16_t)RTIMERTICKS_TO_US(estimated_drift), do_nack);
@@ -929,19 +975,22 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
 
                 /* Copy to radio buffer */
                 NETSTACK_RADIO.prepare((const void *)ack_buf, ack_len);
+                TSCH_PROFILER_PHASE_END(tsch_sp_rx_ack_prepare);
 
                 /* Wait for time to ACK and transmit ACK */
                 TSCH_SCHEDULE_AND_YIELD(pt, t, rx_start_time,
-                                        packet_duration + tsch_timing[tsch_ts_tx_ack_delay] - RADIO_DELAY_BEFORE_TX, "RxBeforeAck");
+                                        packet_duration + tsch_timing[tsch_ts_tx_ack_delay] - RADIO_DELAY_BEFORE_TX, tsch_sd_rx_before_ack, "RxBeforeAck");
                 TSCH_DEBUG_RX_EVENT();
                 NETSTACK_RADIO.transmit(ack_len);
                 tsch_radio_off(TSCH_RADIO_CMD_OFF_WITHIN_TIMESLOT);
 
                 /* Schedule a burst link iff the frame pending bit was set */
                 burst_link_scheduled = tsch_packet_get_frame_pending(current_input->payload, current_input->len);
+                burst_link_tx = 0;
               }
             }
 
+            TSCH_PROFILER_PHASE_START();
             /* If the sender is a time source, proceed to clock drift compensation */
             n = tsch_queue_get_nbr(&source_address);
             if(n != NULL && n->is_time_source) {
@@ -966,6 +1015,12 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
               tsch_stats_rx_packet(n, current_input->rssi, radio_last_lqi, tsch_current_channel);
             }
 
+#ifdef TSCH_CALLBACK_LINK_USED
+            if(frame.fcf.ack_required) {
+              TSCH_CALLBACK_LINK_USED(current_link, 0, MAC_TX_OK);
+            }
+#endif /* TSCH_CALLBACK_LINK_USED */
+
             /* Log every reception */
             TSCH_LOG_ADD(tsch_log_rx,
               linkaddr_copy(&log->rx.src, (linkaddr_t *)&frame.src_addr);
@@ -978,6 +1033,7 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
               log->rx.estimated_drift = estimated_drift;
               log->rx.seqno = frame.seq;
             );
+            TSCH_PROFILER_PHASE_END(tsch_sp_rx_post);
           }
 
           /* Poll process for processing of pending input and logs */
@@ -1023,10 +1079,13 @@ PT_THREAD(tsch_slot_operation(struct rtimer *t, void *ptr))
                             tsch_lock_requested,
                             current_link == NULL);
       );
+      /* A skipped slot ends any ongoing burst */
+      burst_link_scheduled = 0;
 
     } else {
       int is_active_slot;
       TSCH_DEBUG_SLOT_START();
+      TSCH_PROFILER_PHASE_START();
       tsch_in_slot_operation = 1;
       /* Measure on-air noise level while TSCH is idle */
       tsch_stats_sample_rssi();
@@ -1034,7 +1093,13 @@ PT_THREAD(tsch_slot_operation(struct rtimer *t, void *ptr))
       drift_correction = 0;
       is_drift_correction_used = 0;
       /* Get a packet ready to be sent */
-      current_packet = get_packet_and_neighbor_for_link(current_link, &current_neighbor);
+      if(burst_link_scheduled) {
+        /* Within a burst, the sender keeps transmitting to the same neighbor
+         * and the receiver only listens, regardless of the link options */
+        current_packet = burst_link_tx ? tsch_queue_get_packet_for_nbr(current_neighbor, current_link) : NULL;
+      } else {
+        current_packet = get_packet_and_neighbor_for_link(current_link, &current_neighbor);
+      }
       uint8_t do_skip_best_link = 0;
       if(current_packet == NULL && backup_link != NULL) {
         /* There is no packet to send, and this link does not have Rx flag. Instead of doing
@@ -1053,7 +1118,8 @@ PT_THREAD(tsch_slot_operation(struct rtimer *t, void *ptr))
         current_link = backup_link;
         current_packet = get_packet_and_neighbor_for_link(current_link, &current_neighbor);
       }
-      is_active_slot = current_packet != NULL || (current_link->link_options & LINK_OPTION_RX);
+      is_active_slot = current_packet != NULL || (current_link->link_options & LINK_OPTION_RX)
+          || (burst_link_scheduled && !burst_link_tx);
       if(is_active_slot) {
         /* If we are in a burst, we stick to current channel instead of
          * doing channel hopping, as per IEEE 802.15.4-2015 */
@@ -1068,6 +1134,7 @@ PT_THREAD(tsch_slot_operation(struct rtimer *t, void *ptr))
         NETSTACK_RADIO.set_value(RADIO_PARAM_CHANNEL, tsch_current_channel);
         /* Turn the radio on already here if configured so; necessary for radios with slow startup */
         tsch_radio_on(TSCH_RADIO_CMD_ON_START_OF_TIMESLOT);
+        TSCH_PROFILER_PHASE_END(tsch_sp_slot_start);
         /* Decide whether it is a TX/RX/IDLE or OFF slot */
         /* Actual slot operation */
         if(current_packet != NULL) {
@@ -1118,6 +1185,7 @@ PT_THREAD(tsch_slot_operation(struct rtimer *t, void *ptr))
       rtimer_clock_t time_to_next_active_slot;
       /* Schedule next wakeup skipping slots if missed deadline */
       do {
+        TSCH_PROFILER_PHASE_START();
         update_link_backoff(current_link);
 
         /* A burst link was scheduled. Replay the current link at the
@@ -1151,7 +1219,8 @@ PT_THREAD(tsch_slot_operation(struct rtimer *t, void *ptr))
         /* Update current slot start */
         prev_slot_start = current_slot_start;
         current_slot_start += time_to_next_active_slot;
-      } while(!tsch_schedule_slot_operation(t, prev_slot_start, time_to_next_active_slot, "main"));
+        TSCH_PROFILER_PHASE_END(tsch_sp_schedule);
+      } while(!tsch_schedule_slot_operation(t, prev_slot_start, time_to_next_active_slot, tsch_sd_main, "main"));
     }
 
     tsch_in_slot_operation = 0;
@@ -1188,7 +1257,7 @@ tsch_slot_operation_start(void)
     /* Update current slot start */
     prev_slot_start = current_slot_start;
     current_slot_start += time_to_next_active_slot;
-  } while(!tsch_schedule_slot_operation(&slot_operation_timer, prev_slot_start, time_to_next_active_slot, "assoc"));
+  } while(!tsch_schedule_slot_operation(&slot_operation_timer, prev_slot_start, time_to_next_active_slot, tsch_sd_assoc, "assoc"));
 }
 /*---------------------------------------------------------------------------*/
 /* Start actual slot operation */
@@ -38,6 +38,8 @@
 #include "net/mac/tsch/tsch.h"
 #include "net/netstack.h"
 #include "dev/radio.h"
+#include "sys/critical.h"
+#include <string.h>
 
 /* Log configuration */
 #include "sys/log.h"
@@ -234,3 +236,136 @@ periodic(void *ptr)
 /*---------------------------------------------------------------------------*/
 #endif /* TSCH_STATS_ON */
 /*---------------------------------------------------------------------------*/
+#if TSCH_STATS_SLOT_PROFILER
+/*---------------------------------------------------------------------------*/
+
+struct tsch_slot_profiler_stats tsch_slot_profiler;
+
+static const char *phase_names[tsch_sp_count] = {
+  "slot-start",
+  "tx-prepare",
+  "tx-ack-process",
+  "tx-post",
+  "rx-process",
+  "rx-ack-prepare",
+  "rx-post",
+  "schedule",
+};
+
+static const char *deadline_names[tsch_sd_count] = {
+  "cca",
+  "TxBeforeTx",
+  "TxBeforeAck",
+  "RxBeforeListen",
+  "RxBeforeAck",
+  "main",
+  "assoc",
+};
+
+/*---------------------------------------------------------------------------*/
+void
+tsch_stats_profiler_record(enum tsch_slot_phase phase,
+                           rtimer_clock_t start, rtimer_clock_t end)
+{
+  struct tsch_slot_phase_stats *stats;
+  uint32_t duration_us;
+  uint16_t bucket;
+
+  if(phase >= tsch_sp_count) {
+    return;
+  }
+  stats = &tsch_slot_profiler.phases[phase];
+
+  /* Assumes a single overflow at most, which holds for any phase
+   * shorter than a timeslot */
+  duration_us = RTIMERTICKS_TO_US((rtimer_clock_t)(end - start));
+  if(duration_us > 0xffff) {
+    duration_us = 0xffff;
+  }
+
+  if(stats->count == 0 || duration_us < stats->min_us) {
+    stats->min_us = duration_us;
+  }
+  if(duration_us > stats->max_us) {
+    stats->max_us = duration_us;
+  }
+  stats->count++;
+  stats->total_us += duration_us;
+
+  bucket = MIN(duration_us / TSCH_STATS_PROFILER_BUCKET_US,
+               TSCH_STATS_PROFILER_NUM_BUCKETS - 1);
+  if(stats->histogram[bucket] < 0xffff) {
+    stats->histogram[bucket]++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_stats_profiler_deadline_miss(enum tsch_slot_deadline deadline)
+{
+  if(deadline < tsch_sd_count) {
+    tsch_slot_profiler.deadline_misses[deadline]++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+tsch_stats_profiler_percentile(enum tsch_slot_phase phase, uint8_t percentile)
+{
+  const struct tsch_slot_phase_stats *stats;
+  uint32_t histogram_count;
+  uint32_t threshold;
+  uint32_t seen;
+  uint32_t upper_bound;
+  int i;
+
+  if(phase >= tsch_sp_count) {
+    return 0;
+  }
+  stats = &tsch_slot_profiler.phases[phase];
+
+  /* The histogram saturates, so do not rely on stats->count here */
+  histogram_count = 0;
+  for(i = 0; i < TSCH_STATS_PROFILER_NUM_BUCKETS; ++i) {
+    histogram_count += stats->histogram[i];
+  }
+  if(histogram_count == 0) {
+    return 0;
+  }
+
+  /* Rank of the sample at the requested percentile, rounded up */
+  threshold = (histogram_count * MIN(percentile, 100) + 99) / 100;
+  seen = 0;
+  for(i = 0; i < TSCH_STATS_PROFILER_NUM_BUCKETS - 1; ++i) {
+    seen += stats->histogram[i];
+    if(seen >= threshold) {
+      break;
+    }
+  }
+
+  upper_bound = (uint32_t)(i + 1) * TSCH_STATS_PROFILER_BUCKET_US;
+  return MIN(upper_bound, stats->max_us);
+}
+/*---------------------------------------------------------------------------*/
+const char *
+tsch_stats_profiler_phase_name(enum tsch_slot_phase phase)
+{
+  return phase < tsch_sp_count ? phase_names[phase] : "unknown";
+}
+/*---------------------------------------------------------------------------*/
+const char *
+tsch_stats_profiler_deadline_name(enum tsch_slot_deadline deadline)
+{
+  return deadline < tsch_sd_count ? deadline_names[deadline] : "unknown";
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_stats_profiler_reset(void)
+{
+  int_master_status_t status;
+
+  status = critical_enter();
+  memset(&tsch_slot_profiler, 0, sizeof(tsch_slot_profiler));
+  critical_exit(status);
+}
+/*---------------------------------------------------------------------------*/
+#endif /* TSCH_STATS_SLOT_PROFILER */
+/*---------------------------------------------------------------------------*/
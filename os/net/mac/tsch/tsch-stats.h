@@ -109,6 +109,34 @@
 #define TSCH_STATS_FIRST_CHANNEL 11
 #endif
 
+/*
+ * Enable the slot operation profiler? When enabled, the CPU time spent in
+ * each phase of Tx and Rx slots is measured with rtimer timestamps and
+ * accumulated in per-phase histograms, and missed slot deadlines are counted.
+ * Independent from TSCH_STATS_ON.
+ */
+#ifdef TSCH_STATS_CONF_SLOT_PROFILER
+#define TSCH_STATS_SLOT_PROFILER TSCH_STATS_CONF_SLOT_PROFILER
+#else
+/* The adaptive timeslot timing is derived from the slot profile */
+#define TSCH_STATS_SLOT_PROFILER TSCH_ADAPTIVE_TIMESLOT_TIMING
+#endif
+
+/* The width of a slot profiler histogram bucket, in usec */
+#ifdef TSCH_STATS_CONF_PROFILER_BUCKET_US
+#define TSCH_STATS_PROFILER_BUCKET_US TSCH_STATS_CONF_PROFILER_BUCKET_US
+#else
+#define TSCH_STATS_PROFILER_BUCKET_US 32
+#endif
+
+/* The number of histogram buckets per phase. The last bucket also
+ * counts all durations longer than the histogram range. */
+#ifdef TSCH_STATS_CONF_PROFILER_NUM_BUCKETS
+#define TSCH_STATS_PROFILER_NUM_BUCKETS TSCH_STATS_CONF_PROFILER_NUM_BUCKETS
+#else
+#define TSCH_STATS_PROFILER_NUM_BUCKETS 32
+#endif
+
 /* Internal: the scaling of the various stats */
 #define TSCH_STATS_RSSI_SCALING_FACTOR    -16
 #define TSCH_STATS_LQI_SCALING_FACTOR      16
@@ -166,6 +194,49 @@ struct tsch_neighbor_stats {
 
 struct tsch_neighbor; /* Forward declaration */
 
+/** \brief The phases of slot operation measured by the slot profiler */
+enum tsch_slot_phase {
+  tsch_sp_slot_start,      /* Link, packet and neighbor selection, channel hopping */
+  tsch_sp_tx_prepare,      /* Framing, CCM* and copying the frame to the radio */
+  tsch_sp_tx_ack_process,  /* Reading, parsing and authenticating the ACK */
+  tsch_sp_tx_post,         /* Queue update and logging after Tx */
+  tsch_sp_rx_process,      /* Reading, parsing and authenticating the frame */
+  tsch_sp_rx_ack_prepare,  /* Building, securing and copying the ACK to the radio */
+  tsch_sp_rx_post,         /* Drift compensation, input queueing and stats after Rx */
+  tsch_sp_schedule,        /* Computing the next active link */
+  tsch_sp_count,           /* Not a phase */
+};
+
+/** \brief The deadlines of slot operation, i.e. the points where a
+ * phase must have completed for the slot to run on time */
+enum tsch_slot_deadline {
+  tsch_sd_cca,
+  tsch_sd_tx_before_tx,
+  tsch_sd_tx_before_ack,
+  tsch_sd_rx_before_listen,
+  tsch_sd_rx_before_ack,
+  tsch_sd_main,
+  tsch_sd_assoc,
+  tsch_sd_count,           /* Not a deadline */
+};
+
+struct tsch_slot_phase_stats {
+  /* number of samples */
+  uint32_t count;
+  /* sum of all samples, in usec */
+  uint32_t total_us;
+  /* extreme samples, in usec */
+  uint16_t min_us;
+  uint16_t max_us;
+  /* histogram of samples, TSCH_STATS_PROFILER_BUCKET_US wide buckets */
+  uint16_t histogram[TSCH_STATS_PROFILER_NUM_BUCKETS];
+};
+
+struct tsch_slot_profiler_stats {
+  struct tsch_slot_phase_stats phases[tsch_sp_count];
+  uint32_t deadline_misses[tsch_sd_count];
+};
+
 
 /************ External variables ***********/
 
@@ -206,6 +277,59 @@ void tsch_stats_reset_neighbor_stats(void);
 
 #endif /* TSCH_STATS_ON */
 
+#if TSCH_STATS_SLOT_PROFILER
+
+/* Slot operation profile of the local node */
+extern struct tsch_slot_profiler_stats tsch_slot_profiler;
+
+/**
+ * \brief Record the duration of a slot operation phase. Called from interrupt.
+ * \param phase The phase
+ * \param start The rtimer timestamp of the start of the phase
+ * \param end The rtimer timestamp of the end of the phase
+ */
+void tsch_stats_profiler_record(enum tsch_slot_phase phase,
+                                rtimer_clock_t start, rtimer_clock_t end);
+
+/**
+ * \brief Count a missed slot operation deadline. Called from interrupt.
+ * \param deadline The missed deadline
+ */
+void tsch_stats_profiler_deadline_miss(enum tsch_slot_deadline deadline);
+
+/**
+ * \brief Estimate a percentile of the duration of a phase from its histogram
+ * \param phase The phase
+ * \param percentile The percentile, in the range [1;100]
+ * \return The upper bound of the histogram bucket containing the percentile,
+ * in usec, never larger than the maximum duration seen
+ */
+uint16_t tsch_stats_profiler_percentile(enum tsch_slot_phase phase,
+                                        uint8_t percentile);
+
+/**
+ * \brief Get the printable name of a phase
+ */
+const char *tsch_stats_profiler_phase_name(enum tsch_slot_phase phase);
+
+/**
+ * \brief Get the printable name of a deadline
+ */
+const char *tsch_stats_profiler_deadline_name(enum tsch_slot_deadline deadline);
+
+/**
+ * \brief Clear the slot operation profile
+ */
+void tsch_stats_profiler_reset(void);
+
+#else /* TSCH_STATS_SLOT_PROFILER */
+
+#define tsch_stats_profiler_record(phase, start, end)
+#define tsch_stats_profiler_deadline_miss(deadline)
+#define tsch_stats_profiler_reset()
+
+#endif /* TSCH_STATS_SLOT_PROFILER */
+
 static inline uint8_t
 tsch_stats_channel_to_index(uint8_t channel)
 {
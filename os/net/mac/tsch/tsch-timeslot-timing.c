@@ -93,4 +93,81 @@ const tsch_timeslot_timing_usec tsch_timeslot_timing_us_10000 = {
   10000, /* TimeslotLength */
 };
 
+#if TSCH_ADAPTIVE_TIMESLOT_TIMING
+/*---------------------------------------------------------------------------*/
+/* Worst-case duration of a slot operation phase (in usec), or -1 if the
+ * phase was not sampled enough to be trusted */
+static int32_t
+phase_worst_case(enum tsch_slot_phase phase)
+{
+  const struct tsch_slot_phase_stats *stats = &tsch_slot_profiler.phases[phase];
+  if(stats->count < TSCH_ADAPTIVE_TIMESLOT_TIMING_MIN_SAMPLES) {
+    return -1;
+  }
+  return stats->max_us + TSCH_ADAPTIVE_TIMESLOT_TIMING_MARGIN;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+tsch_timeslot_timing_derive(tsch_timeslot_timing_usec timing,
+                            const tsch_timeslot_timing_usec reference)
+{
+  int32_t slot_start, tx_prepare, tx_ack_process, tx_post;
+  int32_t rx_process, rx_ack_prepare, rx_post, schedule;
+  int32_t cca_to_tx, tx_offset, tx_ack_delay;
+  int32_t tx_end, rx_end;
+  int i;
+
+  slot_start = phase_worst_case(tsch_sp_slot_start);
+  tx_prepare = phase_worst_case(tsch_sp_tx_prepare);
+  tx_ack_process = phase_worst_case(tsch_sp_tx_ack_process);
+  tx_post = phase_worst_case(tsch_sp_tx_post);
+  rx_process = phase_worst_case(tsch_sp_rx_process);
+  rx_ack_prepare = phase_worst_case(tsch_sp_rx_ack_prepare);
+  rx_post = phase_worst_case(tsch_sp_rx_post);
+  schedule = phase_worst_case(tsch_sp_schedule);
+
+  if(slot_start < 0 || tx_prepare < 0 || tx_ack_process < 0 || tx_post < 0
+     || rx_process < 0 || rx_ack_prepare < 0 || rx_post < 0 || schedule < 0) {
+    return 0;
+  }
+
+  /* Keep all radio-dependent timings */
+  for(i = 0; i < tsch_ts_elements_count; i++) {
+    timing[i] = reference[i];
+  }
+
+  /* Transmitter: the frame must be in the radio before CCA (if any) and Tx.
+   * Receiver: must be listening half a guard time before the expected Tx. */
+  cca_to_tx = reference[tsch_ts_tx_offset] - reference[tsch_ts_cca_offset];
+  tx_offset = slot_start + tx_prepare + (TSCH_CCA_ENABLED ? cca_to_tx : 0);
+  tx_offset = MAX(tx_offset, slot_start + reference[tsch_ts_rx_wait] / 2);
+  tx_offset = MAX(tx_offset, cca_to_tx);
+  timing[tsch_ts_cca_offset] = tx_offset - cca_to_tx;
+  timing[tsch_ts_tx_offset] = tx_offset;
+  timing[tsch_ts_rx_offset] = tx_offset - reference[tsch_ts_rx_wait] / 2;
+
+  /* Receiver: the ACK must be in the radio at TxAckDelay after the frame.
+   * Transmitter: listens for the ACK centered on TxAckDelay. */
+  tx_ack_delay = MAX(rx_process + rx_ack_prepare, reference[tsch_ts_rx_tx]);
+  tx_ack_delay = MAX(tx_ack_delay, reference[tsch_ts_ack_wait] / 2);
+  timing[tsch_ts_tx_ack_delay] = tx_ack_delay;
+  timing[tsch_ts_rx_ack_delay] = tx_ack_delay - reference[tsch_ts_ack_wait] / 2;
+
+  /* Both sides must be done with post-processing and with computing the
+   * next active link before the end of the timeslot. The receiver must
+   * also allow for a transmitter late by up to half a guard time. */
+  tx_end = tx_offset + reference[tsch_ts_max_tx]
+    + tx_ack_delay + reference[tsch_ts_ack_wait] / 2 + reference[tsch_ts_max_ack]
+    + tx_ack_process + tx_post + schedule;
+  rx_end = tx_offset + reference[tsch_ts_rx_wait] / 2 + reference[tsch_ts_max_tx]
+    + tx_ack_delay + reference[tsch_ts_max_ack]
+    + rx_post + schedule;
+  timing[tsch_ts_timeslot_length] = MIN(MAX(tx_end, rx_end), 0xffff);
+
+  return timing[tsch_ts_timeslot_length];
+}
+/*---------------------------------------------------------------------------*/
+#endif /* TSCH_ADAPTIVE_TIMESLOT_TIMING */
+
+
 /** @} */
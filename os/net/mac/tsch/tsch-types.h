@@ -89,6 +89,8 @@ struct tsch_slotframe {
   /* Number of timeslots in the slotframe.
    * Stored as struct asn_divisor_t because we often need ASN%size */
   struct tsch_asn_divisor_t size;
+  /* ASN%size at the last schedule lookup, to avoid a full modulo at the next */
+  struct tsch_asn_mod_tracker_t asn_mod;
   /* List of links belonging to this slotframe */
   LIST_STRUCT(links_list);
 };
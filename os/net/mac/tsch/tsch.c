@@ -56,6 +56,7 @@
 #include "net/mac/tsch/tsch.h"
 #include "net/mac/mac-sequence.h"
 #include "lib/random.h"
+#include "sys/critical.h"
 #include "net/routing/routing.h"
 
 #if TSCH_WITH_SIXTOP
@@ -99,6 +100,21 @@ uint16_t tsch_timing_us[tsch_ts_elements_count];
 /* TSCH timeslot timing (in rtimer ticks) */
 rtimer_clock_t tsch_timing[tsch_ts_elements_count];
 
+#if TSCH_ADAPTIVE_TIMESLOT_TIMING
+/* Timeslot timing derived from the measured processing times (in micro-second) */
+static uint16_t adaptive_timing_us[tsch_ts_elements_count];
+/* Has adaptive_timing_us been derived yet? */
+static uint8_t adaptive_timing_ready;
+/* Set when the coordinator restarts the network with adaptive_timing_us */
+static uint8_t adaptive_timing_restart_pending;
+/* ASN at the time of the restart, and when it was taken. The network resumes
+ * past it, to never reuse an ASN (and CCM* nonce) */
+static struct tsch_asn_t adaptive_timing_restart_asn;
+static clock_time_t adaptive_timing_restart_time;
+/* Timer for the end of the calibration period */
+static struct ctimer adaptive_timing_timer;
+#endif /* TSCH_ADAPTIVE_TIMESLOT_TIMING */
+
 #if LINKADDR_SIZE == 8
 /* 802.15.4 broadcast MAC address  */
 const linkaddr_t tsch_broadcast_address = { { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff } };
@@ -218,6 +234,11 @@ tsch_reset(void)
   current_link = NULL;
   /* Reset timeslot timing to defaults */
   tsch_default_timing_us = TSCH_DEFAULT_TIMESLOT_TIMING;
+#if TSCH_ADAPTIVE_TIMESLOT_TIMING
+  if(tsch_is_coordinator && adaptive_timing_ready) {
+    tsch_default_timing_us = adaptive_timing_us;
+  }
+#endif /* TSCH_ADAPTIVE_TIMESLOT_TIMING */
   for(i = 0; i < tsch_ts_elements_count; i++) {
     tsch_timing_us[i] = tsch_default_timing_us[i];
     tsch_timing[i] = US_TO_RTIMERTICKS(tsch_timing_us[i]);
@@ -549,6 +570,46 @@ tsch_tx_process_pending(void)
     ringbufindex_get(&dequeued_ringbuf);
   }
 }
+#if TSCH_ADAPTIVE_TIMESLOT_TIMING
+/*---------------------------------------------------------------------------*/
+/* End of the calibration period: derive the adaptive timeslot timing
+ * and restart the network with it if it yields shorter timeslots */
+static void
+adaptive_timing_calibrate(void *ptr)
+{
+  uint16_t timeslot_length;
+  int_master_status_t status;
+
+  if(!tsch_is_coordinator || !tsch_is_associated || adaptive_timing_ready) {
+    return;
+  }
+
+  timeslot_length = tsch_timeslot_timing_derive(adaptive_timing_us, tsch_timing_us);
+  if(timeslot_length == 0) {
+    LOG_INFO("adaptive timing: not enough samples yet, extending calibration\n");
+    ctimer_reset(&adaptive_timing_timer);
+    return;
+  }
+
+  if(timeslot_length >= tsch_timing_us[tsch_ts_timeslot_length]) {
+    LOG_INFO("adaptive timing: no gain (%u us), keeping %u us timeslots\n",
+             timeslot_length, tsch_timing_us[tsch_ts_timeslot_length]);
+    return;
+  }
+
+  LOG_INFO("adaptive timing: timeslot length %u -> %u us, tx offset %u us, restarting\n",
+           tsch_timing_us[tsch_ts_timeslot_length], timeslot_length,
+           adaptive_timing_us[tsch_ts_tx_offset]);
+
+  status = critical_enter();
+  adaptive_timing_restart_asn = tsch_current_asn;
+  critical_exit(status);
+  adaptive_timing_restart_time = clock_time();
+  adaptive_timing_ready = 1;
+  adaptive_timing_restart_pending = 1;
+  tsch_disassociate();
+}
+#endif /* TSCH_ADAPTIVE_TIMESLOT_TIMING */
 /*---------------------------------------------------------------------------*/
 /* Setup TSCH as a coordinator */
 static void
@@ -562,6 +623,25 @@ tsch_start_coordinator(void)
   tsch_schedule_create_minimal();
 #endif
 
+#if TSCH_ADAPTIVE_TIMESLOT_TIMING
+  if(adaptive_timing_restart_pending) {
+    /* Resume past any ASN the previous network may have used: the nodes keep
+     * their slot operation going until they detect the desynchronization.
+     * Counting in the new, shorter timeslots overestimates the slots elapsed */
+    tsch_current_asn = adaptive_timing_restart_asn;
+    TSCH_ASN_INC(tsch_current_asn,
+                 ((uint64_t)(clock_time() - adaptive_timing_restart_time
+                             + TSCH_DESYNC_THRESHOLD
+                             + TSCH_ADAPTIVE_TIMESLOT_TIMING_ASN_MARGIN)
+                  * 1000000 / CLOCK_SECOND)
+                 / adaptive_timing_us[tsch_ts_timeslot_length] + 1);
+    adaptive_timing_restart_pending = 0;
+  } else if(!adaptive_timing_ready) {
+    ctimer_set(&adaptive_timing_timer, TSCH_ADAPTIVE_TIMESLOT_TIMING_CALIBRATION,
+               adaptive_timing_calibrate, NULL);
+  }
+#endif /* TSCH_ADAPTIVE_TIMESLOT_TIMING */
+
   tsch_is_associated = 1;
   tsch_join_priority = 0;
 
@@ -873,6 +953,11 @@ PROCESS_THREAD(tsch_process, ev, data)
       }
     }
 
+#if TSCH_WITH_SIXTOP
+    /* The scheduling functions start over in the new network */
+    sixtop_init_sf();
+#endif /* TSCH_WITH_SIXTOP */
+
     /* We are part of a TSCH network, start slot operation */
     tsch_slot_operation_start();
 
@@ -111,6 +111,15 @@ frequency hopping for enhanced reliability.
 
 #endif /* BUILD_WITH_ORCHESTRA */
 
+#if TSCH_WITH_SIXTOP
+#include "net/mac/tsch/sixtop/sixtop-conf.h"
+#if SIXTOP_WITH_MSF
+#ifndef TSCH_CALLBACK_LINK_USED
+#define TSCH_CALLBACK_LINK_USED msf_callback_link_used
+#endif /* TSCH_CALLBACK_LINK_USED */
+#endif /* SIXTOP_WITH_MSF */
+#endif /* TSCH_WITH_SIXTOP */
+
 /* Called by TSCH when joining a network */
 #ifdef TSCH_CALLBACK_JOINING_NETWORK
 void TSCH_CALLBACK_JOINING_NETWORK();
@@ -148,6 +157,13 @@ void TSCH_CALLBACK_NEW_TIME_SOURCE(const struct tsch_neighbor *old, const struct
 int TSCH_CALLBACK_PACKET_READY(void);
 #endif
 
+/* Called by TSCH from interrupt after every unicast transmission attempt
+ * and every unicast reception, with the link used */
+#ifdef TSCH_CALLBACK_LINK_USED
+struct tsch_link;
+void TSCH_CALLBACK_LINK_USED(const struct tsch_link *link, int is_tx, int mac_tx_status);
+#endif /* TSCH_CALLBACK_LINK_USED */
+
 /* Called when a new root node, including the local node, is detected to be added or removed */ 
 #ifdef TSCH_CALLBACK_ROOT_NODE_UPDATED
 void TSCH_CALLBACK_ROOT_NODE_UPDATED(const linkaddr_t *, uint8_t is_added);
@@ -261,6 +277,19 @@ uint64_t tsch_get_network_uptime_ticks(void);
   * Leave the TSCH network we are currently in
   */
 void tsch_disassociate(void);
+#if TSCH_ADAPTIVE_TIMESLOT_TIMING
+/**
+  * Derive the shortest safe timeslot timing template from the worst-case
+  * processing times measured by the slot profiler
+  *
+  * \param timing The derived template (output)
+  * \param reference The template providing the radio-dependent timings
+  * \return The derived timeslot length in usec, or 0 if the profile does
+  * not contain enough samples yet
+  */
+uint16_t tsch_timeslot_timing_derive(tsch_timeslot_timing_usec timing,
+                                     const tsch_timeslot_timing_usec reference);
+#endif /* TSCH_ADAPTIVE_TIMESLOT_TIMING */
 
 #endif /* __TSCH_H__ */
 /** @} */
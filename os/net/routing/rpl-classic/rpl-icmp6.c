@@ -782,6 +782,18 @@ dao_input_storing(void)
 
   if(lifetime == RPL_ZERO_LIFETIME) {
     LOG_INFO("No-Path DAO received\n");
+#if UIP_DS6_ROUTE_WITH_AGGREGATION
+    /* The prefix may be part of an aggregated route via the sender: give
+       it its own entry, to be removed while the rest of the aggregate
+       stays. */
+    if(rep != NULL &&
+       rep->length < prefixlen &&
+       !RPL_ROUTE_IS_NOPATH_RECEIVED(rep) &&
+       uip_ds6_route_nexthop(rep) != NULL &&
+       uip_ipaddr_cmp(uip_ds6_route_nexthop(rep), &dao_sender_addr)) {
+      rep = uip_ds6_route_split(rep, &prefix, prefixlen);
+    }
+#endif /* UIP_DS6_ROUTE_WITH_AGGREGATION */
     /* No-Path DAO received; invoke the route purging routine. */
     if(rep != NULL &&
        !RPL_ROUTE_IS_NOPATH_RECEIVED(rep) &&
@@ -909,6 +921,12 @@ fwd_dao:
       dao_ack_output(instance, &dao_sender_addr, sequence,
                      RPL_DAO_ACK_UNCONDITIONAL_ACCEPT);
     }
+#if UIP_DS6_ROUTE_WITH_AGGREGATION
+    /* Merged now unless it waits for a DAO-ACK from above */
+    if(rep != NULL) {
+      rpl_aggregate_route(rep);
+    }
+#endif /* UIP_DS6_ROUTE_WITH_AGGREGATION */
   }
 #endif /* RPL_WITH_STORING */
 }
@@ -1362,6 +1380,11 @@ dao_ack_input(void)
       if(status >= RPL_DAO_ACK_UNABLE_TO_ACCEPT) {
         /* this node did not get in to the routing tables above... - remove */
         uip_ds6_route_rm(re);
+#if UIP_DS6_ROUTE_WITH_AGGREGATION
+      } else {
+        /* accepted above, the route may now join its neighbors */
+        rpl_aggregate_route(re);
+#endif /* UIP_DS6_ROUTE_WITH_AGGREGATION */
       }
     } else {
       LOG_WARN("No route entry found to forward DAO ACK (seqno %u)\n", sequence);
@@ -330,6 +330,9 @@ void rpl_remove_routes(rpl_dag_t *dag);
 void rpl_remove_routes_by_nexthop(uip_ipaddr_t *nexthop, rpl_dag_t *dag);
 uip_ds6_route_t *rpl_add_route(rpl_dag_t *dag, uip_ipaddr_t *prefix,
                                int prefix_len, uip_ipaddr_t *next_hop);
+#if UIP_DS6_ROUTE_WITH_AGGREGATION
+uip_ds6_route_t *rpl_aggregate_route(uip_ds6_route_t *rep);
+#endif /* UIP_DS6_ROUTE_WITH_AGGREGATION */
 void rpl_purge_routes(void);
 
 /* Objective function. */
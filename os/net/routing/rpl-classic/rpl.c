@@ -228,6 +228,46 @@ rpl_remove_routes_by_nexthop(uip_ipaddr_t *nexthop, rpl_dag_t *dag)
   LOG_ANNOTATE("#L %u 0\n", nexthop->u8[sizeof(uip_ipaddr_t) - 1]);
 }
 /*---------------------------------------------------------------------------*/
+#if UIP_DS6_ROUTE_WITH_AGGREGATION
+/* Routes are only merged once settled: a route waiting for a DAO-ACK from
+   above, or being removed after a No-Path DAO, keeps its own entry. Without
+   DAO-ACKs, the pending flag is never cleared and does not matter. */
+static int
+route_can_aggregate(uip_ds6_route_t *r, rpl_dag_t *dag)
+{
+  return r->state.dag == dag &&
+#if RPL_WITH_DAO_ACK
+    !RPL_ROUTE_IS_DAO_PENDING(r) &&
+#endif /* RPL_WITH_DAO_ACK */
+    !RPL_ROUTE_IS_NOPATH_RECEIVED(r);
+}
+/*---------------------------------------------------------------------------*/
+/* Merge the route with the routes to the neighboring prefixes via the same
+   next hop, for as long as there are some. The aggregate lives as long as
+   the longest-lived of its parts. */
+uip_ds6_route_t *
+rpl_aggregate_route(uip_ds6_route_t *rep)
+{
+  uip_ds6_route_t *buddy;
+  uint32_t lifetime;
+
+  while(rep->length > UIP_DS6_ROUTE_AGGREGATION_MIN_LENGTH &&
+        route_can_aggregate(rep, rep->state.dag) &&
+        (buddy = uip_ds6_route_lookup_buddy(rep)) != NULL &&
+        route_can_aggregate(buddy, rep->state.dag)) {
+    lifetime = MAX(rep->state.lifetime, buddy->state.lifetime);
+    if(uip_ds6_route_merge(rep, buddy) == NULL) {
+      break;
+    }
+    rep->state.lifetime = lifetime;
+    LOG_INFO("Aggregated routes to ");
+    LOG_INFO_6ADDR(&rep->ipaddr);
+    LOG_INFO_("/%u\n", rep->length);
+  }
+  return rep;
+}
+#endif /* UIP_DS6_ROUTE_WITH_AGGREGATION */
+/*---------------------------------------------------------------------------*/
 uip_ds6_route_t *
 rpl_add_route(rpl_dag_t *dag, uip_ipaddr_t *prefix, int prefix_len,
               uip_ipaddr_t *next_hop)
@@ -239,6 +279,17 @@ rpl_add_route(rpl_dag_t *dag, uip_ipaddr_t *prefix, int prefix_len,
     return NULL;
   }
 
+#if UIP_DS6_ROUTE_WITH_AGGREGATION
+  /* The prefix is covered by an aggregate via the same next hop. It gets
+     its own entry again, so that the aggregate takes on neither its
+     lifetime nor its DAO-ACK: a negative one removes this entry only. */
+  if(rep->length < prefix_len &&
+     (rep = uip_ds6_route_split(rep, prefix, prefix_len)) == NULL) {
+    LOG_ERR("Could not split an aggregated route\n");
+    return NULL;
+  }
+#endif /* UIP_DS6_ROUTE_WITH_AGGREGATION */
+
   rep->state.dag = dag;
   rep->state.lifetime = RPL_LIFETIME(dag->instance, dag->instance->default_lifetime);
   /* always clear state flags for the no-path received when adding/refreshing */
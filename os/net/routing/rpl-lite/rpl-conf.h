@@ -147,6 +147,42 @@
 #endif
 #endif /* RPL_CONF_TRICKLE_REFRESH_DAO_ROUTES */
 
+/*
+ * Keep the RPL neighbors in a list sorted by path cost, updated whenever a
+ * DIO or a link-stats update changes the path cost of a neighbor. Parent
+ * selection then only evaluates the neighbors at the head of the list
+ * instead of the whole neighbor table, which pays off in dense networks.
+ * Costs a pointer and a path cost per neighbor.
+ */
+#ifdef RPL_CONF_WITH_SORTED_CANDIDATES
+#define RPL_WITH_SORTED_CANDIDATES RPL_CONF_WITH_SORTED_CANDIDATES
+#else
+#define RPL_WITH_SORTED_CANDIDATES 0
+#endif
+
+/*
+ * The number of destinations for which the root caches the source routing
+ * header, so that downward packets get a copy of it rather than a header
+ * computed from the source routing graph. Entries are least-recently-used
+ * and get invalid on any change of the graph. 0 disables the cache.
+ */
+#ifdef RPL_CONF_SRH_CACHE_SIZE
+#define RPL_SRH_CACHE_SIZE RPL_CONF_SRH_CACHE_SIZE
+#else
+#define RPL_SRH_CACHE_SIZE 0
+#endif
+
+/*
+ * The largest source routing header kept in the cache, in bytes. With
+ * addresses in a common /64 prefix, every hop takes 8 bytes after the
+ * first 8 bytes of headers. Longer headers are computed for every packet.
+ */
+#ifdef RPL_CONF_SRH_CACHE_MAX_HDR_LEN
+#define RPL_SRH_CACHE_MAX_HDR_LEN RPL_CONF_SRH_CACHE_MAX_HDR_LEN
+#else
+#define RPL_SRH_CACHE_MAX_HDR_LEN 64
+#endif
+
 /*
  * RPL probing. When enabled, probes will be sent periodically to keep
  * neighbor link estimates up to date. Further configurable
@@ -326,6 +362,61 @@
 #define RPL_DAO_RETRANSMISSION_TIMEOUT    (5 * CLOCK_SECOND)
 #endif /* RPL_CONF_DAO_RETRANSMISSION_TIMEOUT */
 
+/*
+ * DAO batching, to avoid DAO storms at the root after a global repair.
+ * When enabled, DAO triggers arriving while a new DAO is pending are merged
+ * into that DAO, new DAOs are delayed further the deeper the node is in the
+ * DAG so that parents register before their children, DAOs are sent at most
+ * once every RPL_DAO_MIN_INTERVAL, DAO retransmissions back off
+ * exponentially, and refreshes are spread over a wider window.
+ */
+#ifdef RPL_CONF_WITH_DAO_BATCHING
+#define RPL_WITH_DAO_BATCHING RPL_CONF_WITH_DAO_BATCHING
+#else
+#define RPL_WITH_DAO_BATCHING 0
+#endif /* RPL_CONF_WITH_DAO_BATCHING */
+
+/* With DAO batching, the extra DAO delay per DAG rank (hop) below the root */
+#ifdef RPL_CONF_DAO_RANK_DELAY
+#define RPL_DAO_RANK_DELAY RPL_CONF_DAO_RANK_DELAY
+#else
+#define RPL_DAO_RANK_DELAY (RPL_DAO_DELAY / 2)
+#endif /* RPL_CONF_DAO_RANK_DELAY */
+
+/* With DAO batching, the maximum DAG rank accounted for in the DAO delay */
+#ifdef RPL_CONF_DAO_MAX_RANK_DELAYED
+#define RPL_DAO_MAX_RANK_DELAYED RPL_CONF_DAO_MAX_RANK_DELAYED
+#else
+#define RPL_DAO_MAX_RANK_DELAYED 8
+#endif /* RPL_CONF_DAO_MAX_RANK_DELAYED */
+
+/* With DAO batching, the minimum interval between two new DAOs */
+#ifdef RPL_CONF_DAO_MIN_INTERVAL
+#define RPL_DAO_MIN_INTERVAL RPL_CONF_DAO_MIN_INTERVAL
+#else
+#define RPL_DAO_MIN_INTERVAL (CLOCK_SECOND * 10)
+#endif /* RPL_CONF_DAO_MIN_INTERVAL */
+
+/* With DAO batching, the DAO refresh is sent at a random time within the
+ * last RPL_DAO_REFRESH_JITTER percent of the refresh period */
+#ifdef RPL_CONF_DAO_REFRESH_JITTER
+#define RPL_DAO_REFRESH_JITTER RPL_CONF_DAO_REFRESH_JITTER
+#else
+#define RPL_DAO_REFRESH_JITTER 25
+#endif /* RPL_CONF_DAO_REFRESH_JITTER */
+
+/*
+ * The maximum number of Target options in a DAO. DAOs travel end-to-end to
+ * the root in non-storing mode, so a node aggregates only its own global
+ * addresses in the DAG prefix, all sharing the same Transit option. The root
+ * accepts up to this many targets per Transit option.
+ */
+#ifdef RPL_CONF_DAO_MAX_TARGETS
+#define RPL_DAO_MAX_TARGETS RPL_CONF_DAO_MAX_TARGETS
+#else
+#define RPL_DAO_MAX_TARGETS 1
+#endif /* RPL_CONF_DAO_MAX_TARGETS */
+
 /******************************************************************************/
 /************************** More parameterization *****************************/
 /******************************************************************************/
@@ -393,6 +393,7 @@ update_nbr_from_dio(uip_ipaddr_t *from, rpl_dio_t *dio)
 #if RPL_WITH_MC
   memcpy(&nbr->mc, &dio->mc, sizeof(nbr->mc));
 #endif /* RPL_WITH_MC */
+  rpl_neighbor_update_path_cost(nbr);
 
   return nbr;
 }
@@ -632,6 +633,10 @@ rpl_process_dis(uip_ipaddr_t *from, int is_multicast)
 void
 rpl_process_dao(uip_ipaddr_t *from, rpl_dao_t *dao)
 {
+#if RPL_DAO_MAX_TARGETS > 1
+  int i;
+#endif /* RPL_DAO_MAX_TARGETS > 1 */
+
   if(dao->lifetime == 0) {
     uip_sr_expire_parent(NULL, from, &dao->parent_addr);
   } else {
@@ -641,6 +646,21 @@ rpl_process_dao(uip_ipaddr_t *from, rpl_dao_t *dao)
     }
   }
 
+#if RPL_DAO_MAX_TARGETS > 1
+  /* Aggregated targets share the parent of the DAO source */
+  for(i = 0; i + 1 < dao->num_targets; i++) {
+    if(!rpl_is_addr_in_our_dag(&dao->extra_targets[i])) {
+      continue;
+    }
+    if(dao->lifetime == 0) {
+      uip_sr_expire_parent(NULL, &dao->extra_targets[i], &dao->parent_addr);
+    } else if(!uip_sr_update_node(NULL, &dao->extra_targets[i], &dao->parent_addr,
+                                  RPL_LIFETIME(dao->lifetime))) {
+      LOG_ERR("failed to add link for aggregated DAO target\n");
+    }
+  }
+#endif /* RPL_DAO_MAX_TARGETS > 1 */
+
 #if RPL_WITH_DAO_ACK
   if(dao->flags & RPL_DAO_K_FLAG) {
     rpl_timers_schedule_dao_ack(from, dao->sequence);
@@ -700,6 +720,7 @@ rpl_process_hbh(rpl_nbr_t *sender, uint16_t sender_rank, int loop_detected, int
      * the sender's rank from ext header */
     if(sender != NULL) {
       sender->rank = sender_rank;
+      rpl_neighbor_update_path_cost(sender);
       /* Select DAG and preferred parent. In case of a parent switch,
       the new parent will be used to forward the current packet. */
       rpl_dag_update_state();
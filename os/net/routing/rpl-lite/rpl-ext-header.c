@@ -47,12 +47,29 @@
 #include "net/routing/rpl-lite/rpl.h"
 #include "net/ipv6/uip-sr.h"
 #include "net/packetbuf.h"
+#include "lib/list.h"
+#include "lib/memb.h"
 
 /* Log configuration */
 #include "sys/log.h"
 #define LOG_MODULE "RPL"
 #define LOG_LEVEL LOG_LEVEL_RPL
 
+#if RPL_SRH_CACHE_SIZE
+/* A source routing header, ready to be copied into downward packets */
+struct srh_cache_entry {
+  struct srh_cache_entry *next;
+  uint32_t graph_version; /* The graph version the header was computed on */
+  uip_ipaddr_t destipaddr; /* The final destination */
+  uip_ipaddr_t nexthop; /* The first hop, which becomes the IPv6 destination */
+  uint8_t len;
+  uint8_t hdr[RPL_SRH_CACHE_MAX_HDR_LEN];
+};
+/* Cache entries, the most recently used first */
+LIST(srh_cache);
+MEMB(srh_cache_memb, struct srh_cache_entry, RPL_SRH_CACHE_SIZE);
+#endif /* RPL_SRH_CACHE_SIZE */
+
 /*---------------------------------------------------------------------------*/
 int
 rpl_ext_header_srh_get_next_hop(uip_ipaddr_t *ipaddr)
@@ -174,6 +191,80 @@ count_matching_bytes(const void *p1, const void *p2, size_t n)
   }
   return n;
 }
+#if RPL_SRH_CACHE_SIZE
+/*---------------------------------------------------------------------------*/
+static struct srh_cache_entry *
+srh_cache_lookup(const uip_ipaddr_t *destipaddr)
+{
+  struct srh_cache_entry *e;
+  for(e = list_head(srh_cache); e != NULL; e = list_item_next(e)) {
+    if(uip_ipaddr_cmp(&e->destipaddr, destipaddr)) {
+      list_remove(srh_cache, e);
+      if(e->graph_version != uip_sr_graph_version()) {
+        /* The path may have changed since */
+        memb_free(&srh_cache_memb, e);
+        return NULL;
+      }
+      list_push(srh_cache, e);
+      return e;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+srh_cache_add(const uip_ipaddr_t *destipaddr, const uip_ipaddr_t *nexthop,
+              const uint8_t *hdr, uint8_t len)
+{
+  struct srh_cache_entry *e;
+
+  if(len > RPL_SRH_CACHE_MAX_HDR_LEN) {
+    return;
+  }
+
+  e = memb_alloc(&srh_cache_memb);
+  if(e == NULL) {
+    /* Replace the least recently used entry */
+    e = list_chop(srh_cache);
+  }
+
+  e->graph_version = uip_sr_graph_version();
+  uip_ipaddr_copy(&e->destipaddr, destipaddr);
+  uip_ipaddr_copy(&e->nexthop, nexthop);
+  e->len = len;
+  memcpy(e->hdr, hdr, len);
+  list_push(srh_cache, e);
+}
+/*---------------------------------------------------------------------------*/
+/* Inserts a cached SRH as first extension header. Returns 1 on success, 0 on
+ * failure. */
+static int
+insert_cached_srh_header(const struct srh_cache_entry *e)
+{
+  struct uip_routing_hdr *rh_hdr = (struct uip_routing_hdr *)UIP_IP_PAYLOAD(0);
+
+  LOG_INFO("SRH found in cache, ext len %u\n", e->len);
+
+  if(uip_len + e->len > UIP_LINK_MTU) {
+    LOG_ERR("packet too long: impossible to add source routing header (%u bytes)\n", e->len);
+    return 0;
+  }
+
+  /* Move existing ext headers and payload, and copy the header in place */
+  memmove(uip_buf + UIP_IPH_LEN + uip_ext_len + e->len,
+      uip_buf + UIP_IPH_LEN + uip_ext_len, uip_len - UIP_IPH_LEN);
+  memcpy(uip_buf + UIP_IPH_LEN + uip_ext_len, e->hdr, e->len);
+
+  rh_hdr->next = UIP_IP_BUF->proto;
+  UIP_IP_BUF->proto = UIP_PROTO_ROUTING;
+  uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, &e->nexthop);
+
+  uipbuf_add_ext_hdr(e->len);
+  uipbuf_set_len_field(UIP_IP_BUF, uip_len - UIP_IPH_LEN);
+
+  return 1;
+}
+#endif /* RPL_SRH_CACHE_SIZE */
 /*---------------------------------------------------------------------------*/
 /* Used by rpl_ext_header_update to insert a RPL SRH extension header. This
  * is used at the root, to initiate downward routing. Returns 1 on success,
@@ -192,6 +283,10 @@ insert_srh_header(void)
   uip_sr_node_t *root_node;
   uip_sr_node_t *node;
   uip_ipaddr_t node_addr;
+#if RPL_SRH_CACHE_SIZE
+  struct srh_cache_entry *cached;
+  uip_ipaddr_t destipaddr;
+#endif /* RPL_SRH_CACHE_SIZE */
 
   /* Always insest SRH as first extension header */
   struct uip_routing_hdr *rh_hdr = (struct uip_routing_hdr *)UIP_IP_PAYLOAD(0);
@@ -211,6 +306,14 @@ insert_srh_header(void)
     return 1;
   }
 
+#if RPL_SRH_CACHE_SIZE
+  if((cached = srh_cache_lookup(&UIP_IP_BUF->destipaddr)) != NULL) {
+    return insert_cached_srh_header(cached);
+  }
+  /* Keep the destination, which gets replaced by the first hop */
+  uip_ipaddr_copy(&destipaddr, &UIP_IP_BUF->destipaddr);
+#endif /* RPL_SRH_CACHE_SIZE */
+
   dest_node = uip_sr_get_node(NULL, &UIP_IP_BUF->destipaddr);
   if(dest_node == NULL) {
     /* The destination is not found, skip SRH insertion */
@@ -312,6 +415,10 @@ insert_srh_header(void)
   uipbuf_add_ext_hdr(ext_len);
   uipbuf_set_len_field(UIP_IP_BUF, uip_len - UIP_IPH_LEN);
 
+#if RPL_SRH_CACHE_SIZE
+  srh_cache_add(&destipaddr, &node_addr, (const uint8_t *)rh_hdr, ext_len);
+#endif /* RPL_SRH_CACHE_SIZE */
+
   return 1;
 }
 /*---------------------------------------------------------------------------*/
@@ -508,9 +508,19 @@ dao_input(void)
     switch(subopt_type) {
       case RPL_OPTION_TARGET:
         /* Handle the target option. */
-        dao.prefixlen = buffer[i + 3];
-        memset(&dao.prefix, 0, sizeof(dao.prefix));
-        memcpy(&dao.prefix, buffer + i + 4, (dao.prefixlen + 7) / CHAR_BIT);
+        if(dao.num_targets == 0) {
+          dao.prefixlen = buffer[i + 3];
+          memset(&dao.prefix, 0, sizeof(dao.prefix));
+          memcpy(&dao.prefix, buffer + i + 4, (dao.prefixlen + 7) / CHAR_BIT);
+          dao.num_targets++;
+        }
+#if RPL_DAO_MAX_TARGETS > 1
+        else if(dao.num_targets < RPL_DAO_MAX_TARGETS && buffer[i + 3] == 128) {
+          /* Aggregated target, full addresses only */
+          memcpy(&dao.extra_targets[dao.num_targets - 1], buffer + i + 4, 16);
+          dao.num_targets++;
+        }
+#endif /* RPL_DAO_MAX_TARGETS > 1 */
         break;
       case RPL_OPTION_TRANSIT:
         /* The path sequence and control are ignored. */
@@ -529,7 +539,7 @@ dao_input(void)
   LOG_INFO_6ADDR(&UIP_IP_BUF->srcipaddr);
   LOG_INFO_(", seqno %u, lifetime %u, prefix ", dao.sequence, dao.lifetime);
   LOG_INFO_6ADDR(&dao.prefix);
-  LOG_INFO_(", prefix length %u, parent ", dao.prefixlen);
+  LOG_INFO_(", prefix length %u, %u target(s), parent ", dao.prefixlen, dao.num_targets);
   LOG_INFO_6ADDR(&dao.parent_addr);
   LOG_INFO_(" \n");
 
@@ -539,12 +549,30 @@ dao_input(void)
     uipbuf_clear();
 }
 /*---------------------------------------------------------------------------*/
+static int
+add_dao_target(unsigned char *buffer, int pos, const uip_ipaddr_t *target)
+{
+  uint8_t prefixlen = sizeof(*target) * CHAR_BIT;
+
+  buffer[pos++] = RPL_OPTION_TARGET;
+  buffer[pos++] = 2 + ((prefixlen + 7) / CHAR_BIT);
+  buffer[pos++] = 0; /* reserved */
+  buffer[pos++] = prefixlen;
+  memcpy(buffer + pos, target, (prefixlen + 7) / CHAR_BIT);
+  pos += ((prefixlen + 7) / CHAR_BIT);
+  return pos;
+}
+/*---------------------------------------------------------------------------*/
 void
 rpl_icmp6_dao_output(uint8_t lifetime)
 {
   unsigned char *buffer;
-  uint8_t prefixlen;
   int pos;
+#if RPL_DAO_MAX_TARGETS > 1
+  int i;
+  int num_targets;
+  const uip_ipaddr_t *target;
+#endif /* RPL_DAO_MAX_TARGETS > 1 */
   const uip_ipaddr_t *prefix = rpl_get_global_address();
   uip_ipaddr_t *parent_ipaddr = rpl_neighbor_get_ipaddr(curr_instance.dag.preferred_parent);
 
@@ -582,13 +610,23 @@ rpl_icmp6_dao_output(uint8_t lifetime)
   buffer[pos++] = curr_instance.dag.dao_last_seqno;
 
   /* create target subopt */
-  prefixlen = sizeof(*prefix) * CHAR_BIT;
-  buffer[pos++] = RPL_OPTION_TARGET;
-  buffer[pos++] = 2 + ((prefixlen + 7) / CHAR_BIT);
-  buffer[pos++] = 0; /* reserved */
-  buffer[pos++] = prefixlen;
-  memcpy(buffer + pos, prefix, (prefixlen + 7) / CHAR_BIT);
-  pos += ((prefixlen + 7) / CHAR_BIT);
+  pos = add_dao_target(buffer, pos, prefix);
+
+#if RPL_DAO_MAX_TARGETS > 1
+  /* Aggregate our other global addresses in the DAG, that is, with another
+   * interface identifier, as targets sharing the same transit information */
+  num_targets = 1;
+  for(i = 0; i < UIP_DS6_ADDR_NB && num_targets < RPL_DAO_MAX_TARGETS; i++) {
+    target = &uip_ds6_if.addr_list[i].ipaddr;
+    if(uip_ds6_if.addr_list[i].isused
+       && uip_ds6_if.addr_list[i].state == ADDR_PREFERRED
+       && memcmp(target->u8 + 8, prefix->u8 + 8, 8) != 0
+       && rpl_is_addr_in_our_dag(target)) {
+      pos = add_dao_target(buffer, pos, target);
+      num_targets++;
+    }
+  }
+#endif /* RPL_DAO_MAX_TARGETS > 1 */
 
   /* Create a transit information sub-option. */
   buffer[pos++] = RPL_OPTION_TRANSIT;
@@ -76,11 +76,16 @@ typedef struct rpl_dio rpl_dio_t;
 struct rpl_dao {
   uip_ipaddr_t parent_addr;
   uip_ipaddr_t prefix;
+#if RPL_DAO_MAX_TARGETS > 1
+  /* Further targets sharing the transit information */
+  uip_ipaddr_t extra_targets[RPL_DAO_MAX_TARGETS - 1];
+#endif /* RPL_DAO_MAX_TARGETS > 1 */
   uint16_t sequence;
   uint8_t instance_id;
   uint8_t lifetime;
   uint8_t prefixlen;
   uint8_t flags;
+  uint8_t num_targets;
 };
 typedef struct rpl_dao rpl_dao_t;
 
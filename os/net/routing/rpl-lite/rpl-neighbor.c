@@ -63,6 +63,10 @@ static rpl_nbr_t * best_parent(int fresh_only);
 /*---------------------------------------------------------------------------*/
 /* Per-neighbor RPL information */
 NBR_TABLE_GLOBAL(rpl_nbr_t, rpl_neighbors);
+#if RPL_WITH_SORTED_CANDIDATES
+/* All neighbors in the table, by increasing path cost */
+LIST(candidates);
+#endif /* RPL_WITH_SORTED_CANDIDATES */
 
 /*---------------------------------------------------------------------------*/
 static int
@@ -205,6 +209,9 @@ remove_neighbor(rpl_nbr_t *nbr)
   if(nbr == curr_instance.dag.unicast_dio_target) {
     curr_instance.dag.unicast_dio_target = NULL;
   }
+#if RPL_WITH_SORTED_CANDIDATES
+  list_remove(candidates, nbr);
+#endif /* RPL_WITH_SORTED_CANDIDATES */
   nbr_table_remove(rpl_neighbors, nbr);
   rpl_timers_schedule_state_update(); /* Updating from here is unsafe; postpone */
 }
@@ -336,40 +343,91 @@ rpl_neighbor_get_from_ipaddr(uip_ipaddr_t *addr)
   return nbr_table_get_from_lladdr(rpl_neighbors, (linkaddr_t *)lladdr);
 }
 /*---------------------------------------------------------------------------*/
+void
+rpl_neighbor_update_path_cost(rpl_nbr_t *nbr)
+{
+#if RPL_WITH_SORTED_CANDIDATES
+  rpl_nbr_t *prev = NULL;
+  rpl_nbr_t *n;
+
+  list_remove(candidates, nbr);
+  nbr->path_cost = curr_instance.of->nbr_path_cost(nbr);
+  /* Insert after the neighbors with a lower or equal path cost */
+  for(n = list_head(candidates); n != NULL && n->path_cost <= nbr->path_cost;
+      n = list_item_next(n)) {
+    prev = n;
+  }
+  list_insert(candidates, prev, nbr);
+#endif /* RPL_WITH_SORTED_CANDIDATES */
+}
+/*---------------------------------------------------------------------------*/
+static int
+is_candidate_parent(rpl_nbr_t *nbr, int fresh_only)
+{
+  if(!acceptable_rank(rpl_neighbor_rank_via_nbr(nbr))
+    || !curr_instance.of->nbr_is_acceptable_parent(nbr)) {
+    /* Exclude neighbors with a rank that is not acceptable */
+    return 0;
+  }
+
+  if(fresh_only && !rpl_neighbor_is_fresh(nbr)) {
+    /* Filter out non-fresh nerighbors if fresh_only is set */
+    return 0;
+  }
+
+#if UIP_ND6_SEND_NS
+  /* Exclude links to a neighbor that is not reachable at a NUD level */
+  if(rpl_get_ds6_nbr(nbr) == NULL) {
+    return 0;
+  }
+#endif /* UIP_ND6_SEND_NS */
+
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
 static rpl_nbr_t *
 best_parent(int fresh_only)
 {
   rpl_nbr_t *nbr;
   rpl_nbr_t *best = NULL;
+#if RPL_WITH_SORTED_CANDIDATES
+  rpl_nbr_t *preferred_parent = curr_instance.dag.preferred_parent;
+  int past_preferred_parent;
+#endif /* RPL_WITH_SORTED_CANDIDATES */
 
   if(curr_instance.used == 0) {
     return NULL;
   }
 
-  /* Search for the best parent according to the OF */
-  for(nbr = nbr_table_head(rpl_neighbors); nbr != NULL; nbr = nbr_table_next(rpl_neighbors, nbr)) {
-
-    if(!acceptable_rank(rpl_neighbor_rank_via_nbr(nbr))
-      || !curr_instance.of->nbr_is_acceptable_parent(nbr)) {
-      /* Exclude neighbors with a rank that is not acceptable */
+#if RPL_WITH_SORTED_CANDIDATES
+  /* Candidates come by increasing path cost. The OF picks the lowest path
+  cost, except that it may stick to the preferred parent. Once past the
+  preferred parent, a neighbor with a higher path cost than the best so far
+  can thus not win, nor can any neighbor after it. */
+  past_preferred_parent = preferred_parent == NULL
+    || !is_candidate_parent(preferred_parent, fresh_only);
+  for(nbr = list_head(candidates); nbr != NULL; nbr = list_item_next(nbr)) {
+    if(!is_candidate_parent(nbr, fresh_only)) {
       continue;
     }
-
-    if(fresh_only && !rpl_neighbor_is_fresh(nbr)) {
-      /* Filter out non-fresh nerighbors if fresh_only is set */
-      continue;
+    if(best != NULL && past_preferred_parent
+       && nbr->path_cost > best->path_cost) {
+      break;
     }
-
-#if UIP_ND6_SEND_NS
-    /* Exclude links to a neighbor that is not reachable at a NUD level */
-    if(rpl_get_ds6_nbr(nbr) == NULL) {
-      continue;
-    }
-#endif /* UIP_ND6_SEND_NS */
-
-    /* Now we have an acceptable parent, check if it is the new best */
     best = curr_instance.of->best_parent(best, nbr);
+    if(nbr == preferred_parent) {
+      past_preferred_parent = 1;
+    }
+  }
+#else /* RPL_WITH_SORTED_CANDIDATES */
+  /* Search for the best parent according to the OF */
+  for(nbr = nbr_table_head(rpl_neighbors); nbr != NULL; nbr = nbr_table_next(rpl_neighbors, nbr)) {
+    if(is_candidate_parent(nbr, fresh_only)) {
+      /* Now we have an acceptable parent, check if it is the new best */
+      best = curr_instance.of->best_parent(best, nbr);
+    }
   }
+#endif /* RPL_WITH_SORTED_CANDIDATES */
 
   return best;
 }
@@ -177,6 +177,15 @@ void rpl_neighbor_print_list(const char *str);
 */
 void rpl_neighbor_remove_all(void);
 
+/**
+ * Update the position of a neighbor among the candidate parents after a
+ * change of its rank, metric container or link metric. Only needed with
+ * RPL_WITH_SORTED_CANDIDATES.
+ *
+ * \param nbr The neighbor
+*/
+void rpl_neighbor_update_path_cost(rpl_nbr_t *nbr);
+
 /**
  * Returns the best candidate for preferred parent
  *
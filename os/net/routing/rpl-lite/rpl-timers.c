@@ -231,6 +231,13 @@ static void
 schedule_dao_retransmission(void)
 {
   clock_time_t expiration_time = RPL_DAO_RETRANSMISSION_TIMEOUT / 2 + (random_rand() % (RPL_DAO_RETRANSMISSION_TIMEOUT));
+#if RPL_WITH_DAO_BATCHING
+  /* Back off exponentially, so that retransmissions do not feed a congested
+   * root or the congested links around it */
+  if(curr_instance.dag.dao_transmissions > 1) {
+    expiration_time <<= MIN(curr_instance.dag.dao_transmissions - 1, 4);
+  }
+#endif /* RPL_WITH_DAO_BATCHING */
   ctimer_set(&curr_instance.dag.dao_timer, expiration_time, resend_dao, NULL);
 }
 #endif /* RPL_WITH_DAO_ACK */
@@ -247,8 +254,17 @@ schedule_dao_refresh(void)
     clock_time_t target_refresh = (CLOCK_SECOND * RPL_LIFETIME(curr_instance.default_lifetime) / 2);
 #endif /* RPL_WITH_DAO_ACK */
 
+#if RPL_WITH_DAO_BATCHING
+    /* Send between 60 seconds and RPL_DAO_REFRESH_JITTER percent of the period
+     * before target refresh, so that nodes that registered together, e.g.
+     * after a global repair, do not refresh together */
+    clock_time_t jitter = (target_refresh / CLOCK_SECOND) * RPL_DAO_REFRESH_JITTER / 100;
+    clock_time_t safety_margin = (60 * CLOCK_SECOND)
+      + (random_rand() % (jitter + 1)) * CLOCK_SECOND + (random_rand() % CLOCK_SECOND);
+#else /* RPL_WITH_DAO_BATCHING */
     /* Send between 60 and 120 seconds before target refresh */
     clock_time_t safety_margin = (60 * CLOCK_SECOND) + (random_rand() % (60 * CLOCK_SECOND));
+#endif /* RPL_WITH_DAO_BATCHING */
 
     if(target_refresh > safety_margin) {
       target_refresh -= safety_margin;
@@ -259,14 +275,54 @@ schedule_dao_refresh(void)
   }
 }
 /*---------------------------------------------------------------------------*/
+#if RPL_WITH_DAO_BATCHING
+static clock_time_t
+dao_batching_delay(clock_time_t delay)
+{
+  rpl_rank_t dag_rank = DAG_RANK(curr_instance.dag.rank);
+  clock_time_t elapsed;
+
+  /* The deeper the node, the later the DAO, so that the root tends to learn
+   * about parents before their children and can route their DAO-ACKs */
+  if(dag_rank > RPL_DAO_MAX_RANK_DELAYED) {
+    dag_rank = RPL_DAO_MAX_RANK_DELAYED;
+  }
+  if(dag_rank > 1) {
+    delay += (dag_rank - 1) * RPL_DAO_RANK_DELAY;
+  }
+
+  /* No sooner than RPL_DAO_MIN_INTERVAL after the last new DAO, if any */
+  if(curr_instance.dag.dao_last_seqno != RPL_LOLLIPOP_INIT) {
+    elapsed = clock_time() - curr_instance.dag.dao_last_sent;
+    if(elapsed + delay < RPL_DAO_MIN_INTERVAL) {
+      delay = RPL_DAO_MIN_INTERVAL - elapsed;
+    }
+  }
+
+  return delay;
+}
+#endif /* RPL_WITH_DAO_BATCHING */
+/*---------------------------------------------------------------------------*/
 void
 rpl_timers_schedule_dao(void)
 {
   if(curr_instance.used && curr_instance.mop != RPL_MOP_NO_DOWNWARD_ROUTES) {
+    clock_time_t expiration_time;
+#if RPL_WITH_DAO_BATCHING
+    if(curr_instance.dag.dao_pending) {
+      /* A new DAO is already scheduled. As it advertises our state at the
+       * time it is sent, it covers this trigger as well. */
+      return;
+    }
+#endif /* RPL_WITH_DAO_BATCHING */
     /* No need for DAO aggregation delay as per RFC 6550 section 9.5, as this
     * only serves storing mode. Use simple delay instead, with the only purpose
     * to reduce congestion. */
-    clock_time_t expiration_time = RPL_DAO_DELAY / 2 + (random_rand() % (RPL_DAO_DELAY));
+    expiration_time = RPL_DAO_DELAY / 2 + (random_rand() % (RPL_DAO_DELAY));
+#if RPL_WITH_DAO_BATCHING
+    expiration_time = dao_batching_delay(expiration_time);
+    curr_instance.dag.dao_pending = 1;
+#endif /* RPL_WITH_DAO_BATCHING */
     ctimer_set(&curr_instance.dag.dao_timer, expiration_time, send_new_dao, NULL);
   }
 }
@@ -274,6 +330,10 @@ rpl_timers_schedule_dao(void)
 static void
 send_new_dao(void *ptr)
 {
+#if RPL_WITH_DAO_BATCHING
+  curr_instance.dag.dao_pending = 0;
+  curr_instance.dag.dao_last_sent = clock_time();
+#endif /* RPL_WITH_DAO_BATCHING */
 #if RPL_WITH_DAO_ACK
   /* We are sending a new DAO here. Prepare retransmissions */
   curr_instance.dag.dao_transmissions = 1;
@@ -319,6 +379,12 @@ handle_dao_ack_timer(void *ptr)
 void
 rpl_timers_notify_dao_ack(void)
 {
+#if RPL_WITH_DAO_BATCHING
+  if(curr_instance.dag.dao_pending) {
+    /* A new DAO is scheduled, and will schedule the refresh in turn */
+    return;
+  }
+#endif /* RPL_WITH_DAO_BATCHING */
   /* The last DAO was ACKed. Schedule refresh to avoid route expiration. This
   implicitly de-schedules resend_dao, as both share curr_instance.dag.dao_timer */
   schedule_dao_refresh();
@@ -543,6 +609,9 @@ rpl_timers_stop_dag_timers(void)
   ctimer_stop(&curr_instance.dag.dio_timer);
   ctimer_stop(&curr_instance.dag.unicast_dio_timer);
   ctimer_stop(&curr_instance.dag.dao_timer);
+#if RPL_WITH_DAO_BATCHING
+  curr_instance.dag.dao_pending = 0;
+#endif /* RPL_WITH_DAO_BATCHING */
 #if RPL_WITH_PROBING
   ctimer_stop(&curr_instance.dag.probing_timer);
 #endif /* RPL_WITH_PROBING */
@@ -134,6 +134,10 @@ typedef struct rpl_prefix rpl_prefix_t;
 
 /** \brief All information related to a RPL neighbor */
 struct rpl_nbr {
+#if RPL_WITH_SORTED_CANDIDATES
+  struct rpl_nbr *next; /* Next neighbor by increasing path cost */
+  uint16_t path_cost; /* The path cost the neighbor is sorted by */
+#endif /* RPL_WITH_SORTED_CANDIDATES */
   clock_time_t better_parent_since;  /* The neighbor has been a possible
   replacement for our preferred parent consistently since 'parent_since'.
   Currently used by MRHOF only. */
@@ -210,6 +214,10 @@ struct rpl_dag {
   struct ctimer unicast_dio_timer;
   struct ctimer dao_timer;
   rpl_nbr_t *unicast_dio_target;
+#if RPL_WITH_DAO_BATCHING
+  clock_time_t dao_last_sent; /* the time at which the last new DAO was sent */
+  uint8_t dao_pending; /* is a new DAO scheduled on dao_timer? */
+#endif /* RPL_WITH_DAO_BATCHING */
 #if RPL_WITH_PROBING
   struct ctimer probing_timer;
   rpl_nbr_t *urgent_probing_target;
@@ -106,6 +106,7 @@ rpl_link_callback(const linkaddr_t *addr, int status, int numtx)
         curr_instance.dag.urgent_probing_target = NULL;
       }
 #endif
+      rpl_neighbor_update_path_cost(nbr);
       /* Link stats were updated, and we need to update our internal state.
       Updating from here is unsafe; postpone */
       LOG_INFO("packet sent to ");
@@ -39,5 +39,10 @@
 
 #define CMD_CONF_OUTPUT border_router_cmd_output
 
+/* track routing graph changes, served by the routes-snapshot shell command */
+#ifndef UIP_SR_CONF_WITH_SNAPSHOT
+#define UIP_SR_CONF_WITH_SNAPSHOT 1
+#endif
+
 /* used by wpcap (see /cpu/native/net/wpcap-drv.c) */
 #define SELECT_CALLBACK 1
@@ -52,6 +52,8 @@
 #include "net/ipv6/uiplib.h"
 #include "net/ipv6/uip-icmp6.h"
 #include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/multicast/uip-mcast6.h"
+#include "net/ipv6/multicast/uip-mcast6-stats.h"
 #if BUILD_WITH_RESOLV
 #include "resolv.h"
 #endif /* BUILD_WITH_RESOLV */
@@ -600,6 +602,7 @@ PT_THREAD(cmd_tsch_status(struct pt *pt, shell_output_func output, char *args))
     SHELL_OUTPUT(output, "-- PAN ID: 0x%x\n", frame802154_get_pan_id());
     SHELL_OUTPUT(output, "-- Is PAN secured: %u\n", tsch_is_pan_secured);
     SHELL_OUTPUT(output, "-- Join priority: %u\n", tsch_join_priority);
+    SHELL_OUTPUT(output, "-- Timeslot length: %u usec\n", tsch_timing_us[tsch_ts_timeslot_length]);
     SHELL_OUTPUT(output, "-- Time source: ");
     if(n != NULL) {
       shell_output_lladdr(output, tsch_queue_get_nbr_address(n));
@@ -617,6 +620,46 @@ PT_THREAD(cmd_tsch_status(struct pt *pt, shell_output_func output, char *args))
 
   PT_END(pt);
 }
+#if TSCH_STATS_SLOT_PROFILER
+/*---------------------------------------------------------------------------*/
+static
+PT_THREAD(cmd_tsch_profile(struct pt *pt, shell_output_func output, char *args))
+{
+  int i;
+
+  PT_BEGIN(pt);
+
+  if(args != NULL && !strcmp(args, "reset")) {
+    tsch_stats_profiler_reset();
+    SHELL_OUTPUT(output, "TSCH slot profile cleared\n");
+    PT_EXIT(pt);
+  }
+
+  SHELL_OUTPUT(output, "TSCH slot profile (usec):\n");
+  for(i = 0; i < tsch_sp_count; i++) {
+    const struct tsch_slot_phase_stats *stats = &tsch_slot_profiler.phases[i];
+    if(stats->count == 0) {
+      SHELL_OUTPUT(output, "-- %s: no samples\n", tsch_stats_profiler_phase_name(i));
+    } else {
+      SHELL_OUTPUT(output, "-- %s: count %lu, min %u, avg %lu, max %u, p99 %u\n",
+                   tsch_stats_profiler_phase_name(i),
+                   (unsigned long)stats->count,
+                   stats->min_us,
+                   (unsigned long)(stats->total_us / stats->count),
+                   stats->max_us,
+                   tsch_stats_profiler_percentile(i, 99));
+    }
+  }
+
+  SHELL_OUTPUT(output, "TSCH deadline misses:\n");
+  for(i = 0; i < tsch_sd_count; i++) {
+    SHELL_OUTPUT(output, "-- %s: %lu\n", tsch_stats_profiler_deadline_name(i),
+                 (unsigned long)tsch_slot_profiler.deadline_misses[i]);
+  }
+
+  PT_END(pt);
+}
+#endif /* TSCH_STATS_SLOT_PROFILER */
 #endif /* MAC_CONF_WITH_TSCH */
 #if NETSTACK_CONF_WITH_IPV6
 /*---------------------------------------------------------------------------*/
@@ -684,6 +727,143 @@ PT_THREAD(cmd_routes(struct pt *pt, shell_output_func output, char *args))
 
   PT_END(pt);
 }
+#if UIP_CONF_IPV6_RPL && UIP_SR_WITH_SNAPSHOT
+/*---------------------------------------------------------------------------*/
+static
+PT_THREAD(cmd_routes_snapshot(struct pt *pt, shell_output_func output, char *args))
+{
+  char *next_args;
+  char *ptr;
+  unsigned long since = 0;
+  int hex = 0;
+
+  PT_BEGIN(pt);
+
+  SHELL_ARGS_INIT(args, next_args);
+
+  /* Get and parse arguments: the version we have, then the format */
+  SHELL_ARGS_NEXT(args, next_args);
+  if(args != NULL) {
+    since = strtoul(args, &ptr, 10);
+    if(ptr == args) {
+      SHELL_OUTPUT(output, "Invalid version: %s\n", args);
+      PT_EXIT(pt);
+    }
+    SHELL_ARGS_NEXT(args, next_args);
+    if(args != NULL) {
+      if(strcmp(args, "hex")) {
+        SHELL_OUTPUT(output, "Invalid format: %s\n", args);
+        PT_EXIT(pt);
+      }
+      hex = 1;
+    }
+  }
+
+  if(hex) {
+    /* The binary snapshot, one hex-encoded chunk per line */
+    uint8_t buf[96];
+    uint16_t offset = 0;
+    int len;
+    int i;
+    do {
+      len = uip_sr_snapshot_serialize(buf, sizeof(buf), since, offset);
+      if(len == 0) {
+        /* Nothing was written, buf holds no header */
+        break;
+      }
+      for(i = 0; i < len; i++) {
+        SHELL_OUTPUT(output, "%02x", buf[i]);
+      }
+      SHELL_OUTPUT(output, "\n");
+      offset += (buf[10] << 8) | buf[11];
+    } while(buf[1] & UIP_SR_SNAPSHOT_FLAG_MORE);
+  } else {
+    /* A JSON object, one record per line */
+    uip_sr_snapshot_t snapshot;
+    uip_sr_snapshot_record_t record;
+    char buf[120];
+    int first = 1;
+    uip_sr_snapshot_start(&snapshot, since);
+    SHELL_OUTPUT(output, "{\"since\":%lu,\"version\":%lu,\"full\":%s,\"records\":[\n",
+                 (unsigned long)snapshot.since, (unsigned long)snapshot.version,
+                 (snapshot.flags & UIP_SR_SNAPSHOT_FLAG_FULL) ? "true" : "false");
+    while(uip_sr_snapshot_next(&snapshot, &record)) {
+      uip_sr_snapshot_record_snprint_json(buf, sizeof(buf), &record);
+      SHELL_OUTPUT(output, "%s%s\n", first ? "" : ",", buf);
+      first = 0;
+    }
+    SHELL_OUTPUT(output, "]}\n");
+  }
+
+  PT_END(pt);
+}
+#endif /* UIP_CONF_IPV6_RPL && UIP_SR_WITH_SNAPSHOT */
+#if UIP_MCAST6_ENGINE && UIP_MCAST6_STATS
+/*---------------------------------------------------------------------------*/
+static
+PT_THREAD(cmd_mcast_stats(struct pt *pt, shell_output_func output, char *args))
+{
+  int i;
+
+  PT_BEGIN(pt);
+
+  if(args != NULL && !strcmp(args, "reset")) {
+    UIP_MCAST6_STATS_RESET();
+    SHELL_OUTPUT(output, "Multicast stats cleared\n");
+    PT_EXIT(pt);
+  }
+
+  if(args != NULL && !strcmp(args, "hex")) {
+    uint8_t buf[UIP_MCAST6_STATS_DUMP_LEN];
+    int len = uip_mcast6_stats_dump(buf, sizeof(buf));
+    for(i = 0; i < len; i++) {
+      SHELL_OUTPUT(output, "%02x", buf[i]);
+    }
+    SHELL_OUTPUT(output, "\n");
+    PT_EXIT(pt);
+  }
+
+  SHELL_OUTPUT(output, "Multicast stats, engine %s:\n", UIP_MCAST6.name);
+  SHELL_OUTPUT(output, "-- Received: %lu, unique %lu, ours %lu, duplicates %lu (%lu%%)\n",
+               (unsigned long)UIP_MCAST6_STATS_GET(mcast_in_all),
+               (unsigned long)UIP_MCAST6_STATS_GET(mcast_in_unique),
+               (unsigned long)UIP_MCAST6_STATS_GET(mcast_in_ours),
+               (unsigned long)UIP_MCAST6_STATS_GET(mcast_in_dup),
+               UIP_MCAST6_STATS_GET(mcast_in_all) == 0 ? 0 :
+               (unsigned long)UIP_MCAST6_STATS_GET(mcast_in_dup) * 100 / UIP_MCAST6_STATS_GET(mcast_in_all));
+  SHELL_OUTPUT(output, "-- Sent: forwarded %lu, originated %lu, suppressed %lu\n",
+               (unsigned long)UIP_MCAST6_STATS_GET(mcast_fwd),
+               (unsigned long)UIP_MCAST6_STATS_GET(mcast_out),
+               (unsigned long)UIP_MCAST6_STATS_GET(mcast_suppressed));
+  SHELL_OUTPUT(output, "-- Dropped: %lu, malformed %lu\n",
+               (unsigned long)UIP_MCAST6_STATS_GET(mcast_dropped),
+               (unsigned long)UIP_MCAST6_STATS_GET(mcast_bad));
+  if(UIP_MCAST6_STATS_GET(fwd_delay_count) == 0) {
+    SHELL_OUTPUT(output, "-- Forwarding delay: no samples\n");
+  } else {
+    SHELL_OUTPUT(output, "-- Forwarding delay (msec): count %lu, avg %lu, max %lu\n",
+                 (unsigned long)UIP_MCAST6_STATS_GET(fwd_delay_count),
+                 (unsigned long)(UIP_MCAST6_STATS_GET(fwd_delay_sum) / UIP_MCAST6_STATS_GET(fwd_delay_count)),
+                 (unsigned long)UIP_MCAST6_STATS_GET(fwd_delay_max));
+  }
+  SHELL_OUTPUT(output, "-- Forwarding delay histogram (msec):");
+  for(i = 0; i < UIP_MCAST6_STATS_DELAY_BINS - 1; i++) {
+    SHELL_OUTPUT(output, " <%lu: %lu,", (unsigned long)UIP_MCAST6_STATS_DELAY_BIN_MS << i,
+                 (unsigned long)UIP_MCAST6_STATS_GET(fwd_delay_hist[i]));
+  }
+  SHELL_OUTPUT(output, " more: %lu\n",
+               (unsigned long)UIP_MCAST6_STATS_GET(fwd_delay_hist[UIP_MCAST6_STATS_DELAY_BINS - 1]));
+  SHELL_OUTPUT(output, "-- Buffer occupancy histogram (%%):");
+  for(i = 0; i < UIP_MCAST6_STATS_OCCUPANCY_BINS; i++) {
+    SHELL_OUTPUT(output, " %u-%u: %lu%s", i * 100 / UIP_MCAST6_STATS_OCCUPANCY_BINS,
+                 (i + 1) * 100 / UIP_MCAST6_STATS_OCCUPANCY_BINS,
+                 (unsigned long)UIP_MCAST6_STATS_GET(occupancy_hist[i]),
+                 i < UIP_MCAST6_STATS_OCCUPANCY_BINS - 1 ? "," : "\n");
+  }
+
+  PT_END(pt);
+}
+#endif /* UIP_MCAST6_ENGINE && UIP_MCAST6_STATS */
 /*---------------------------------------------------------------------------*/
 #if BUILD_WITH_RESOLV
 static
@@ -986,6 +1166,12 @@ const struct shell_command_t builtin_shell_commands[] = {
   { "ip-nbr",               cmd_ip_neighbors,         "'> ip-nbr': Shows all IPv6 neighbors" },
   { "ping",                 cmd_ping,                 "'> ping addr': Pings the IPv6 address 'addr'" },
   { "routes",               cmd_routes,               "'> routes': Shows the route entries" },
+#if UIP_CONF_IPV6_RPL && UIP_SR_WITH_SNAPSHOT
+  { "routes-snapshot",      cmd_routes_snapshot,      "'> routes-snapshot [version] [hex]': Shows the routing links changed since 'version' (all if 0 or none), in JSON or as hex-encoded binary chunks" },
+#endif /* UIP_CONF_IPV6_RPL && UIP_SR_WITH_SNAPSHOT */
+#if UIP_MCAST6_ENGINE && UIP_MCAST6_STATS
+  { "mcast-stats",          cmd_mcast_stats,          "'> mcast-stats [hex|reset]': Shows the multicast forwarding stats, as text or as a hex-encoded binary dump, or clears them" },
+#endif /* UIP_MCAST6_ENGINE && UIP_MCAST6_STATS */
 #if BUILD_WITH_RESOLV
   { "nslookup",             cmd_resolv,               "'> nslookup': Lookup IPv6 address of host" },
 #endif /* BUILD_WITH_RESOLV */
@@ -1007,6 +1193,9 @@ const struct shell_command_t builtin_shell_commands[] = {
   { "tsch-set-coordinator", cmd_tsch_set_coordinator, "'> tsch-set-coordinator 0/1 [0/1]': Sets node as coordinator (1) or not (0). Second, optional parameter: enable (1) or disable (0) security." },
   { "tsch-schedule",        cmd_tsch_schedule,        "'> tsch-schedule': Shows the current TSCH schedule" },
   { "tsch-status",          cmd_tsch_status,          "'> tsch-status': Shows a summary of the current TSCH state" },
+#if TSCH_STATS_SLOT_PROFILER
+  { "tsch-profile",         cmd_tsch_profile,         "'> tsch-profile [reset]': Shows (or clears) the TSCH slot operation timing profile" },
+#endif /* TSCH_STATS_SLOT_PROFILER */
 #endif /* MAC_CONF_WITH_TSCH */
 #if TSCH_WITH_SIXTOP
   { "6top",                 cmd_6top,                 "'> 6top help': Shows 6top command usage" },
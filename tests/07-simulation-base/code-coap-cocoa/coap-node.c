@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         CoAP benchmark over RPL+TSCH: the root serves a resource, and the
+ *         node with the highest id requests it a number of times, keeping
+ *         a few confirmable requests outstanding, then reports the goodput
+ *         and the number of retransmissions.
+ */
+
+#include "contiki.h"
+#include "sys/node-id.h"
+#include "net/routing/routing.h"
+#include "net/netstack.h"
+#include "coap-engine.h"
+#include "coap-callback-api.h"
+#include <stdio.h>
+#include <string.h>
+
+#define CLIENT_NODE_ID 8
+#define NUM_REQUESTS 100
+#define WINDOW 2
+#define PAYLOAD_LEN 32
+
+PROCESS(node_process, "CoAP node");
+AUTOSTART_PROCESSES(&node_process);
+
+static void
+res_get_handler(coap_message_t *request, coap_message_t *response,
+                uint8_t *buffer, uint16_t preferred_size, int32_t *offset)
+{
+  memset(buffer, 'x', PAYLOAD_LEN);
+  coap_set_header_content_format(response, TEXT_PLAIN);
+  coap_set_payload(response, buffer, PAYLOAD_LEN);
+}
+RESOURCE(res_bench, "title=\"Benchmark\"", res_get_handler, NULL, NULL, NULL);
+
+static coap_endpoint_t server;
+static coap_callback_request_state_t states[WINDOW];
+static coap_message_t requests[WINDOW];
+static uint8_t busy[WINDOW];
+static uint16_t sent;
+static uint16_t received;
+static uint16_t failed;
+/*---------------------------------------------------------------------------*/
+static void
+response_callback(coap_callback_request_state_t *state)
+{
+  int i = state - states;
+
+  if(state->state.status == COAP_REQUEST_STATUS_RESPONSE) {
+    if(state->state.response->payload_len == PAYLOAD_LEN) {
+      received++;
+    }
+  } else if(state->state.status == COAP_REQUEST_STATUS_FINISHED
+            || state->state.status == COAP_REQUEST_STATUS_TIMEOUT) {
+    if(state->state.status == COAP_REQUEST_STATUS_TIMEOUT) {
+      failed++;
+    }
+    busy[i] = 0;
+    process_poll(&node_process);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_requests(void)
+{
+  int i;
+
+  for(i = 0; i < WINDOW && sent < NUM_REQUESTS; i++) {
+    if(!busy[i]) {
+      coap_init_message(&requests[i], COAP_TYPE_CON, COAP_GET, 0);
+      coap_set_header_uri_path(&requests[i], "bench");
+      if(coap_send_request(&states[i], &server, &requests[i],
+                           response_callback)) {
+        busy[i] = 1;
+        sent++;
+      }
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(node_process, ev, data)
+{
+  static struct etimer et;
+  static clock_time_t start;
+
+  PROCESS_BEGIN();
+
+  if(node_id == 1) {
+    NETSTACK_ROUTING.root_start();
+    coap_activate_resource(&res_bench, "bench");
+  }
+  NETSTACK_MAC.on();
+
+  if(node_id != CLIENT_NODE_ID) {
+    PROCESS_EXIT();
+  }
+
+  /* Wait for the network to settle */
+  etimer_set(&et, 120 * CLOCK_SECOND);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  while(!NETSTACK_ROUTING.node_is_reachable()
+        || !NETSTACK_ROUTING.get_root_ipaddr(&server.ipaddr)) {
+    etimer_set(&et, CLOCK_SECOND);
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  }
+  server.port = UIP_HTONS(COAP_DEFAULT_PORT);
+
+  printf("CoAP benchmark: starting, %u requests, %u outstanding\n",
+         NUM_REQUESTS, WINDOW);
+  start = clock_time();
+  while(received + failed < NUM_REQUESTS) {
+    send_requests();
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL);
+  }
+
+  printf("CoAP benchmark: %u responses, %u timeouts, %lu retransmissions in %lu ms\n",
+         received, failed, (unsigned long)coap_get_retransmission_count(),
+         (unsigned long)((clock_time() - start) * 1000 / CLOCK_SECOND));
+
+  PROCESS_END();
+}
@@ -0,0 +1,36 @@
+TIMEOUT(3600000);
+
+/* This script waits for the CoAP client (see code-coap-cocoa/coap-node.c)
+ * to finish its request run and logs goodput and retransmissions, so that
+ * the default retransmission timers can be compared with CoCoA congestion
+ * control (COAP_CONF_WITH_CONGESTION_CONTROL) */
+
+var PAYLOAD_LEN = 32; /* bytes, as in coap-node.c */
+
+var result_re =
+  /^CoAP benchmark: (\d+) responses, (\d+) timeouts, (\d+) retransmissions in (\d+) ms/;
+var found = null;
+
+while(found == null) {
+  if(msg.startsWith("CoAP benchmark: starting")) {
+    log.log(msg + "\n");
+  }
+  found = msg.match(result_re);
+  YIELD();
+}
+
+var responses = parseInt(found[1]);
+var timeouts = parseInt(found[2]);
+var retransmissions = parseInt(found[3]);
+var elapsed = parseInt(found[4]);
+
+log.log("Responses " + responses + ", timeouts " + timeouts +
+        ", retransmissions " + retransmissions + "\n");
+log.log("Goodput " +
+        Math.round(responses * PAYLOAD_LEN * 1000 / Math.max(elapsed, 1)) +
+        " B/s over " + elapsed + " ms\n");
+
+if(responses == 0) {
+  log.testFailed();
+}
+log.testOK();
@@ -0,0 +1,46 @@
+TIMEOUT(300000);
+
+/* This script measures how long multicast messages take from the root to
+ * the sink, and how much host CPU time the simulation takes meanwhile */
+
+var MESSAGES = 20;
+
+var sent_re = /\(msg=0x([0-9a-f]+)\)/;
+var in_re = /^In: \[0x([0-9a-f]+)\]/;
+
+var os = java.lang.management.ManagementFactory.getOperatingSystemMXBean();
+var sent = {};
+var received = 0;
+var total_latency = 0;
+var max_latency = 0;
+var cpu_start = -1;
+
+while(received < MESSAGES) {
+  var found = msg.match(sent_re);
+  if(found) {
+    if(cpu_start < 0) {
+      cpu_start = os.getProcessCpuTime();
+    }
+    sent[found[1]] = time;
+  }
+
+  found = msg.match(in_re);
+  if(found) {
+    if(!(found[1] in sent)) {
+      log.log("Received message 0x" + found[1] + " which was not sent\n");
+      log.testFailed();
+    }
+    var latency = time - sent[found[1]];
+    total_latency += latency;
+    max_latency = latency > max_latency ? latency : max_latency;
+    received++;
+  }
+  YIELD();
+}
+
+log.log("Delivered " + received + " messages, latency mean " +
+        Math.round(total_latency / received / 1000) + " ms, max " +
+        Math.round(max_latency / 1000) + " ms\n");
+log.log("CPU time " + Math.round((os.getProcessCpuTime() - cpu_start) / 1000000) +
+        " ms\n");
+log.testOK();
@@ -0,0 +1,119 @@
+TIMEOUT(600000);
+
+/* This script waits for the sink to receive a number of multicast messages,
+ * then decodes the forwarding stats dumped by the intermediate nodes (see
+ * uip_mcast6_stats_dump()) and logs their network-wide aggregate, so that
+ * the engines can be compared by rerunning with a different
+ * UIP_MCAST6_CONF_ENGINE */
+
+var MESSAGES = 20;
+var STATS_INTERVAL = 10000; /* ms, as in intermediate.c */
+
+var COUNTERS = [ "in_unique", "in_all", "in_ours", "fwd", "out", "bad",
+                 "dropped", "in_dup", "suppressed", "fwd_delay_count",
+                 "fwd_delay_sum", "fwd_delay_max" ];
+var DELAY_BINS = 8;
+var OCCUPANCY_BINS = 8;
+
+var stats_re = /^Stats: ([0-9a-f]+)/;
+var latest = {};
+var received = 0;
+
+function u16(hex, offset) {
+  return parseInt(hex.substr(offset * 2, 4), 16);
+}
+
+function u32(hex, offset) {
+  return parseInt(hex.substr(offset * 2, 8), 16);
+}
+
+function collect() {
+  var found = msg.match(stats_re);
+  if(found) {
+    latest[id] = found[1];
+  }
+}
+
+while(received < MESSAGES) {
+  if(msg.startsWith("In: ")) {
+    received++;
+  }
+  collect();
+  YIELD();
+}
+
+/* Let every node dump its stats once more after the last delivery */
+GENERATE_MSG(STATS_INTERVAL + 1000, "stats-done");
+while(!msg.equals("stats-done")) {
+  collect();
+  YIELD();
+}
+
+var total = {};
+var delay_hist = [];
+var occupancy_hist = [];
+var engine = -1;
+var bin_ms = 0;
+var nodes = 0;
+var i;
+
+for(i = 0; i < COUNTERS.length; i++) {
+  total[COUNTERS[i]] = 0;
+}
+for(i = 0; i < DELAY_BINS; i++) {
+  delay_hist[i] = 0;
+}
+for(i = 0; i < OCCUPANCY_BINS; i++) {
+  occupancy_hist[i] = 0;
+}
+
+for(var node in latest) {
+  var hex = latest[node];
+  if(hex.substr(0, 6) != "4d3601") {
+    log.log("Node " + node + ": bad stats dump " + hex + "\n");
+    log.testFailed();
+  }
+  engine = parseInt(hex.substr(6, 2), 16);
+  bin_ms = u16(hex, 4);
+  var offset = 6;
+  for(i = 0; i < COUNTERS.length; i++, offset += 4) {
+    if(COUNTERS[i] == "fwd_delay_max") {
+      total[COUNTERS[i]] = Math.max(total[COUNTERS[i]], u32(hex, offset));
+    } else {
+      total[COUNTERS[i]] += u32(hex, offset);
+    }
+  }
+  for(i = 0; i < DELAY_BINS; i++, offset += 4) {
+    delay_hist[i] += u32(hex, offset);
+  }
+  for(i = 0; i < OCCUPANCY_BINS; i++, offset += 4) {
+    occupancy_hist[i] += u32(hex, offset);
+  }
+  nodes++;
+}
+
+if(nodes == 0) {
+  log.log("No stats received\n");
+  log.testFailed();
+}
+
+log.log("Engine " + engine + ", " + nodes + " nodes, " + received +
+        " messages delivered\n");
+log.log("Received " + total.in_all + ", duplicates " + total.in_dup + " (" +
+        Math.round(100 * total.in_dup / Math.max(total.in_all, 1)) + "%)\n");
+log.log("Forwarded " + total.fwd + ", suppressed " + total.suppressed +
+        ", dropped " + total.dropped + "\n");
+log.log("Forwarding delay mean " +
+        Math.round(total.fwd_delay_sum / Math.max(total.fwd_delay_count, 1)) +
+        " ms, max " + total.fwd_delay_max + " ms\n");
+var line = "Forwarding delay histogram:";
+for(i = 0; i < DELAY_BINS - 1; i++) {
+  line += " <" + (bin_ms << i) + ":" + delay_hist[i];
+}
+log.log(line + " more:" + delay_hist[DELAY_BINS - 1] + "\n");
+line = "Buffer occupancy histogram:";
+for(i = 0; i < OCCUPANCY_BINS; i++) {
+  line += " " + (i * 100 / OCCUPANCY_BINS) + "%:" + occupancy_hist[i];
+}
+log.log(line + "\n");
+log.testOK();
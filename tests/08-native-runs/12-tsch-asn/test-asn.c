@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "contiki.h"
+#include "lib/random.h"
+#include "unit-test.h"
+#include "net/mac/tsch/tsch-asn.h"
+#include <stdio.h>
+
+PROCESS(test_process, "test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define NUM_STEPS 100000
+#define NUM_BENCH_STEPS 10000000
+
+/* Slotframe and hopping sequence lengths in use in the tree */
+static const uint16_t divisors[] = { 1, 4, 7, 16, 17, 31, 101, 397, 65535 };
+
+#define NUM_DIVISORS (sizeof(divisors) / sizeof(divisors[0]))
+
+/*---------------------------------------------------------------------------*/
+void
+print_test_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Check the tracker against TSCH_ASN_MOD, starting from start and moving
+ * forward by random steps up to max_step */
+static int
+check_tracker(const struct tsch_asn_t *start, uint32_t max_step)
+{
+  int i, j;
+  struct tsch_asn_t asn;
+  struct tsch_asn_divisor_t div;
+  struct tsch_asn_mod_tracker_t tracker;
+
+  for(i = 0; i < NUM_DIVISORS; i++) {
+    TSCH_ASN_DIVISOR_INIT(div, divisors[i]);
+    TSCH_ASN_MOD_TRACKER_RESET(tracker);
+    asn = *start;
+    for(j = 0; j < NUM_STEPS; j++) {
+      if(tsch_asn_mod_tracked(&tracker, &asn, &div) != TSCH_ASN_MOD(asn, div)) {
+        printf("mismatch at ASN 0x%x.%lx, divisor %u\n",
+               asn.ms1b, (unsigned long)asn.ls4b, div.val);
+        return 0;
+      }
+      TSCH_ASN_INC(asn, 1 + random_rand() % max_step);
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(asn_mod_tracker_steps, "ASN modulo tracker, forward steps");
+UNIT_TEST(asn_mod_tracker_steps)
+{
+  struct tsch_asn_t asn;
+
+  UNIT_TEST_BEGIN();
+
+  TSCH_ASN_INIT(asn, 0, 0);
+  UNIT_TEST_ASSERT(check_tracker(&asn, 1));
+  UNIT_TEST_ASSERT(check_tracker(&asn, 20));
+  UNIT_TEST_ASSERT(check_tracker(&asn, 1000));
+  /* Carry over to the ms1b */
+  TSCH_ASN_INIT(asn, 0x12, 0xffff0000);
+  UNIT_TEST_ASSERT(check_tracker(&asn, 20));
+  UNIT_TEST_ASSERT(check_tracker(&asn, 1000));
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(asn_mod_tracker_jumps, "ASN modulo tracker, jumps");
+UNIT_TEST(asn_mod_tracker_jumps)
+{
+  struct tsch_asn_t asn;
+  struct tsch_asn_divisor_t div;
+  struct tsch_asn_divisor_t other_div;
+  struct tsch_asn_mod_tracker_t tracker;
+
+  UNIT_TEST_BEGIN();
+
+  TSCH_ASN_DIVISOR_INIT(div, 17);
+  TSCH_ASN_DIVISOR_INIT(other_div, 16);
+  TSCH_ASN_MOD_TRACKER_RESET(tracker);
+
+  TSCH_ASN_INIT(asn, 0x01, 1000);
+  UNIT_TEST_ASSERT(tsch_asn_mod_tracked(&tracker, &asn, &div) == TSCH_ASN_MOD(asn, div));
+  /* Backwards, as when joining another network */
+  TSCH_ASN_INIT(asn, 0x01, 990);
+  UNIT_TEST_ASSERT(tsch_asn_mod_tracked(&tracker, &asn, &div) == TSCH_ASN_MOD(asn, div));
+  /* Same ls4b, other ms1b */
+  TSCH_ASN_INIT(asn, 0x02, 995);
+  UNIT_TEST_ASSERT(tsch_asn_mod_tracked(&tracker, &asn, &div) == TSCH_ASN_MOD(asn, div));
+  TSCH_ASN_INIT(asn, 0x00, 997);
+  UNIT_TEST_ASSERT(tsch_asn_mod_tracked(&tracker, &asn, &div) == TSCH_ASN_MOD(asn, div));
+  /* New divisor, as when changing the hopping sequence */
+  TSCH_ASN_INC(asn, 3);
+  UNIT_TEST_ASSERT(tsch_asn_mod_tracked(&tracker, &asn, &other_div) == TSCH_ASN_MOD(asn, other_div));
+  TSCH_ASN_INC(asn, 3);
+  UNIT_TEST_ASSERT(tsch_asn_mod_tracked(&tracker, &asn, &div) == TSCH_ASN_MOD(asn, div));
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+/* Time NUM_BENCH_STEPS modulo operations on an ASN moving forward by step.
+ * The results are summed up so that the compiler keeps the operations. */
+static void
+benchmark(uint16_t divisor, uint32_t step)
+{
+  uint32_t i;
+  uint32_t sum_full = 0;
+  uint32_t sum_tracked = 0;
+  clock_time_t start, time_full, time_tracked;
+  struct tsch_asn_t asn;
+  struct tsch_asn_divisor_t div;
+  struct tsch_asn_mod_tracker_t tracker;
+
+  TSCH_ASN_DIVISOR_INIT(div, divisor);
+  TSCH_ASN_MOD_TRACKER_RESET(tracker);
+
+  TSCH_ASN_INIT(asn, 0x01, 0);
+  start = clock_time();
+  for(i = 0; i < NUM_BENCH_STEPS; i++) {
+    sum_full += TSCH_ASN_MOD(asn, div);
+    TSCH_ASN_INC(asn, step);
+  }
+  time_full = clock_time() - start;
+
+  TSCH_ASN_INIT(asn, 0x01, 0);
+  start = clock_time();
+  for(i = 0; i < NUM_BENCH_STEPS; i++) {
+    sum_tracked += tsch_asn_mod_tracked(&tracker, &asn, &div);
+    TSCH_ASN_INC(asn, step);
+  }
+  time_tracked = clock_time() - start;
+
+  printf("divisor %5u step %3lu: full %5lu ms, tracked %5lu ms%s\n",
+         divisor, (unsigned long)step,
+         (unsigned long)(time_full * 1000 / CLOCK_SECOND),
+         (unsigned long)(time_tracked * 1000 / CLOCK_SECOND),
+         sum_full == sum_tracked ? "" : " =check-me= FAILED");
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(asn_mod_tracker_steps);
+  UNIT_TEST_RUN(asn_mod_tracker_jumps);
+
+  printf("Benchmark: %u ASN modulo operations\n", NUM_BENCH_STEPS);
+  /* Hopping sequence, channel computed in every slot */
+  benchmark(4, 1);
+  benchmark(16, 1);
+  /* Slotframes, looked up at every active slot */
+  benchmark(7, 1);
+  benchmark(101, 3);
+  benchmark(397, 20);
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
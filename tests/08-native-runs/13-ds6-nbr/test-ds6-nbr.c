@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "lib/random.h"
+#include "unit-test.h"
+#include "net/ipv6/uip-ds6-nbr.h"
+#include <stdio.h>
+#include <string.h>
+
+PROCESS(test_process, "test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define NUM_NBRS 300
+#define NUM_BENCH_LOOKUPS 200000
+
+/*---------------------------------------------------------------------------*/
+void
+print_test_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+nbr_lladdr(uip_lladdr_t *lladdr, uint16_t i)
+{
+  memset(lladdr, 0, sizeof(*lladdr));
+  lladdr->addr[0] = 0x02;
+  lladdr->addr[sizeof(*lladdr) - 2] = i >> 8;
+  lladdr->addr[sizeof(*lladdr) - 1] = i & 0xff;
+}
+/*---------------------------------------------------------------------------*/
+static void
+nbr_ipaddr(uip_ipaddr_t *ipaddr, uint16_t i, int is_global)
+{
+  uip_lladdr_t lladdr;
+  nbr_lladdr(&lladdr, i);
+  if(is_global) {
+    uip_ip6addr(ipaddr, 0xfd00, 0, 0, 0, 0, 0, 0, 0);
+  } else {
+    uip_ip6addr(ipaddr, 0xfe80, 0, 0, 0, 0, 0, 0, 0);
+  }
+  uip_ds6_set_addr_iid(ipaddr, &lladdr);
+}
+/*---------------------------------------------------------------------------*/
+/* The lookup as done without an index */
+static uip_ds6_nbr_t *
+linear_lookup(const uip_ipaddr_t *ipaddr)
+{
+  uip_ds6_nbr_t *nbr;
+  for(nbr = uip_ds6_nbr_head(); nbr != NULL; nbr = uip_ds6_nbr_next(nbr)) {
+    if(uip_ipaddr_cmp(&nbr->ipaddr, ipaddr)) {
+      return nbr;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static int
+nbr_is_found(uint16_t i, int is_global)
+{
+  uip_ipaddr_t ipaddr;
+  uip_lladdr_t lladdr;
+  uip_ds6_nbr_t *nbr;
+
+  nbr_ipaddr(&ipaddr, i, is_global);
+  nbr_lladdr(&lladdr, i);
+  nbr = uip_ds6_nbr_lookup(&ipaddr);
+  return nbr != NULL
+    && nbr == linear_lookup(&ipaddr)
+    && memcmp(uip_ds6_nbr_get_ll(nbr), &lladdr, sizeof(lladdr)) == 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+remove_all_nbrs(void)
+{
+  uip_ds6_nbr_t *nbr;
+  while((nbr = uip_ds6_nbr_head()) != NULL) {
+    uip_ds6_nbr_rm(nbr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+add_nbrs(void)
+{
+  uip_ipaddr_t ipaddr;
+  uip_lladdr_t lladdr;
+  uint16_t i;
+
+  for(i = 0; i < NUM_NBRS; i++) {
+    nbr_ipaddr(&ipaddr, i, 0);
+    nbr_lladdr(&lladdr, i);
+    if(uip_ds6_nbr_add(&ipaddr, &lladdr, 0, NBR_REACHABLE,
+                       NBR_TABLE_REASON_IPV6_ND, NULL) == NULL) {
+      return 0;
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(nbr_lookup, "Neighbor cache lookup");
+UNIT_TEST(nbr_lookup)
+{
+  uint16_t i;
+
+  UNIT_TEST_BEGIN();
+
+  remove_all_nbrs();
+  UNIT_TEST_ASSERT(add_nbrs());
+  UNIT_TEST_ASSERT(uip_ds6_nbr_num() == NUM_NBRS);
+  for(i = 0; i < NUM_NBRS; i++) {
+    UNIT_TEST_ASSERT(nbr_is_found(i, 0));
+    /* Same IID, but not a neighbor address */
+    UNIT_TEST_ASSERT(!nbr_is_found(i, 1));
+  }
+  UNIT_TEST_ASSERT(!nbr_is_found(NUM_NBRS, 0));
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(nbr_remove, "Neighbor cache removal");
+UNIT_TEST(nbr_remove)
+{
+  uip_ipaddr_t ipaddr;
+  uint16_t i;
+
+  UNIT_TEST_BEGIN();
+
+  remove_all_nbrs();
+  UNIT_TEST_ASSERT(add_nbrs());
+  for(i = 0; i < NUM_NBRS; i += 2) {
+    nbr_ipaddr(&ipaddr, i, 0);
+    UNIT_TEST_ASSERT(uip_ds6_nbr_rm(uip_ds6_nbr_lookup(&ipaddr)) == 1);
+  }
+  UNIT_TEST_ASSERT(uip_ds6_nbr_num() == NUM_NBRS / 2);
+  for(i = 0; i < NUM_NBRS; i++) {
+    UNIT_TEST_ASSERT(nbr_is_found(i, 0) == (i % 2));
+  }
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(nbr_update, "Neighbor cache update");
+UNIT_TEST(nbr_update)
+{
+  uip_ipaddr_t ipaddr;
+  uip_lladdr_t lladdr;
+  uip_ds6_nbr_t *nbr;
+
+  UNIT_TEST_BEGIN();
+
+  remove_all_nbrs();
+  UNIT_TEST_ASSERT(add_nbrs());
+
+  /* New link-layer address for a known IPv6 address */
+  nbr_ipaddr(&ipaddr, 1, 0);
+  nbr_lladdr(&lladdr, NUM_NBRS);
+  nbr = uip_ds6_nbr_lookup(&ipaddr);
+  UNIT_TEST_ASSERT(uip_ds6_nbr_update_ll(&nbr, &lladdr) == 0);
+  UNIT_TEST_ASSERT(uip_ds6_nbr_lookup(&ipaddr) == nbr);
+  UNIT_TEST_ASSERT(nbr_is_found(0, 0));
+  UNIT_TEST_ASSERT(nbr_is_found(2, 0));
+
+  /* New IPv6 address for a known link-layer address */
+  nbr_ipaddr(&ipaddr, 2, 1);
+  nbr_lladdr(&lladdr, 2);
+  UNIT_TEST_ASSERT((nbr = uip_ds6_nbr_add(&ipaddr, &lladdr, 0, NBR_REACHABLE,
+                                          NBR_TABLE_REASON_IPV6_ND, NULL)) != NULL);
+  UNIT_TEST_ASSERT(uip_ds6_nbr_lookup(&ipaddr) == nbr);
+#if UIP_DS6_NBR_MULTI_IPV6_ADDRS
+  /* The address was added to the entry */
+  UNIT_TEST_ASSERT(nbr_is_found(2, 0));
+  UNIT_TEST_ASSERT(uip_ds6_nbr_num() == NUM_NBRS + 1);
+#else /* UIP_DS6_NBR_MULTI_IPV6_ADDRS */
+  /* The entry was reused */
+  UNIT_TEST_ASSERT(!nbr_is_found(2, 0));
+  UNIT_TEST_ASSERT(uip_ds6_nbr_num() == NUM_NBRS);
+#endif /* UIP_DS6_NBR_MULTI_IPV6_ADDRS */
+  UNIT_TEST_ASSERT(nbr_is_found(3, 0));
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+static void
+benchmark(void)
+{
+  static uip_ipaddr_t addrs[NUM_NBRS];
+  uint32_t i;
+  uint32_t found_indexed = 0;
+  uint32_t found_linear = 0;
+  clock_time_t start, time_indexed, time_linear;
+
+  remove_all_nbrs();
+  add_nbrs();
+  for(i = 0; i < NUM_NBRS; i++) {
+    nbr_ipaddr(&addrs[i], i, 0);
+  }
+
+  start = clock_time();
+  for(i = 0; i < NUM_BENCH_LOOKUPS; i++) {
+    found_indexed += uip_ds6_nbr_lookup(&addrs[i % NUM_NBRS]) != NULL;
+  }
+  time_indexed = clock_time() - start;
+
+  start = clock_time();
+  for(i = 0; i < NUM_BENCH_LOOKUPS; i++) {
+    found_linear += linear_lookup(&addrs[i % NUM_NBRS]) != NULL;
+  }
+  time_linear = clock_time() - start;
+
+  printf("Benchmark: %u lookups among %u neighbors, %u buckets\n",
+         NUM_BENCH_LOOKUPS, NUM_NBRS, UIP_DS6_NBR_HASH_BUCKETS);
+  printf("indexed %lu ms, linear %lu ms%s\n",
+         (unsigned long)(time_indexed * 1000 / CLOCK_SECOND),
+         (unsigned long)(time_linear * 1000 / CLOCK_SECOND),
+         found_indexed == found_linear ? "" : " =check-me= FAILED");
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(nbr_lookup);
+  UNIT_TEST_RUN(nbr_remove);
+  UNIT_TEST_RUN(nbr_update);
+
+  benchmark();
+  remove_all_nbrs();
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
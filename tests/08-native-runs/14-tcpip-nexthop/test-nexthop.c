@@ -0,0 +1,345 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "unit-test.h"
+#include "net/ipv6/uip-ds6-route.h"
+#include <stdio.h>
+#include <string.h>
+
+PROCESS(test_process, "test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define NUM_NBRS 8
+#define NUM_ROUTES 200
+#define NUM_BENCH_PACKETS 200000
+
+/* The link-layer destination of the last packet sent */
+static linkaddr_t last_dest;
+static int num_sent;
+
+/*---------------------------------------------------------------------------*/
+void
+print_test_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Record the next hop and drop the packet instead of sending it */
+static enum netstack_ip_action
+capture_output(const linkaddr_t *localdest)
+{
+  if(localdest != NULL) {
+    linkaddr_copy(&last_dest, localdest);
+  } else {
+    linkaddr_copy(&last_dest, &linkaddr_null);
+  }
+  num_sent++;
+  return NETSTACK_IP_DROP;
+}
+static struct netstack_ip_packet_processor capture = {
+  .process_output = capture_output
+};
+/*---------------------------------------------------------------------------*/
+static void
+nbr_lladdr(uip_lladdr_t *lladdr, uint16_t i)
+{
+  memset(lladdr, 0, sizeof(*lladdr));
+  lladdr->addr[0] = 0x02;
+  lladdr->addr[sizeof(*lladdr) - 1] = i + 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+nbr_ipaddr(uip_ipaddr_t *ipaddr, uint16_t i)
+{
+  uip_lladdr_t lladdr;
+  nbr_lladdr(&lladdr, i);
+  uip_ip6addr(ipaddr, 0xfe80, 0, 0, 0, 0, 0, 0, 0);
+  uip_ds6_set_addr_iid(ipaddr, &lladdr);
+}
+/*---------------------------------------------------------------------------*/
+static void
+dest_ipaddr(uip_ipaddr_t *ipaddr, uint16_t i)
+{
+  uip_ip6addr(ipaddr, 0xfd01, 0, 0, 0, 0, 0, 0, i + 1);
+}
+/*---------------------------------------------------------------------------*/
+static int
+add_route(uint16_t dest, uint16_t nbr)
+{
+  uip_ipaddr_t ipaddr;
+  uip_ipaddr_t nexthop;
+  dest_ipaddr(&ipaddr, dest);
+  nbr_ipaddr(&nexthop, nbr);
+  return uip_ds6_route_add(&ipaddr, 128, &nexthop) != NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+rm_route(uint16_t dest)
+{
+  uip_ipaddr_t ipaddr;
+  dest_ipaddr(&ipaddr, dest);
+  uip_ds6_route_rm(uip_ds6_route_lookup(&ipaddr));
+}
+/*---------------------------------------------------------------------------*/
+static void
+setup(void)
+{
+  uip_ipaddr_t ipaddr;
+  uip_lladdr_t lladdr;
+  uip_ds6_nbr_t *nbr;
+  uint16_t i;
+
+  while(uip_ds6_route_head() != NULL) {
+    uip_ds6_route_rm(uip_ds6_route_head());
+  }
+  while((nbr = uip_ds6_nbr_head()) != NULL) {
+    uip_ds6_nbr_rm(nbr);
+  }
+  for(i = 0; i < NUM_NBRS; i++) {
+    nbr_ipaddr(&ipaddr, i);
+    nbr_lladdr(&lladdr, i);
+    uip_ds6_nbr_add(&ipaddr, &lladdr, 0, NBR_REACHABLE,
+                    NBR_TABLE_REASON_IPV6_ND, NULL);
+  }
+  for(i = 0; i < NUM_ROUTES; i++) {
+    add_route(i, i % NUM_NBRS);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Send a UDP packet to dest. Returns the index of the neighbor it was
+ * sent to, -1 if it was not sent. */
+static int
+send_to(const uip_ipaddr_t *dest)
+{
+  uip_lladdr_t lladdr;
+  uint16_t i;
+  int sent;
+
+  uipbuf_clear();
+  memset(uip_buf, 0, UIP_IPUDPH_LEN);
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->proto = UIP_PROTO_UDP;
+  UIP_IP_BUF->ttl = 64;
+  uip_ds6_select_src(&UIP_IP_BUF->srcipaddr, (uip_ipaddr_t *)dest);
+  uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, dest);
+  uipbuf_set_len(UIP_IPUDPH_LEN);
+  uipbuf_set_len_field(UIP_IP_BUF, UIP_UDPH_LEN);
+
+  sent = num_sent;
+  tcpip_ipv6_output();
+  if(num_sent == sent) {
+    return -1;
+  }
+  for(i = 0; i < NUM_NBRS; i++) {
+    nbr_lladdr(&lladdr, i);
+    if(linkaddr_cmp(&last_dest, (linkaddr_t *)&lladdr)) {
+      return i;
+    }
+  }
+  return -1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+send_to_dest(uint16_t i)
+{
+  uip_ipaddr_t ipaddr;
+  dest_ipaddr(&ipaddr, i);
+  return send_to(&ipaddr);
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(nexthop_routes, "Next-hop cache, routed destinations");
+UNIT_TEST(nexthop_routes)
+{
+  struct tcpip_nexthop_cache_stats before;
+  uint16_t i;
+
+  UNIT_TEST_BEGIN();
+
+  setup();
+  before = tcpip_nexthop_cache_stats;
+  /* A miss, then hits */
+  for(i = 0; i < 3; i++) {
+    UNIT_TEST_ASSERT(send_to_dest(5) == 5 % NUM_NBRS);
+  }
+  UNIT_TEST_ASSERT(tcpip_nexthop_cache_stats.misses == before.misses + 1);
+  UNIT_TEST_ASSERT(tcpip_nexthop_cache_stats.hits == before.hits + 2);
+
+  /* More destinations than cache entries */
+  for(i = 0; i < NUM_ROUTES; i++) {
+    UNIT_TEST_ASSERT(send_to_dest(i) == i % NUM_NBRS);
+    UNIT_TEST_ASSERT(send_to_dest(i) == i % NUM_NBRS);
+  }
+  UNIT_TEST_ASSERT(tcpip_nexthop_cache_stats.hits >= before.hits + 2 + NUM_ROUTES);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(nexthop_route_change, "Next-hop cache, route changes");
+UNIT_TEST(nexthop_route_change)
+{
+  UNIT_TEST_BEGIN();
+
+  setup();
+  UNIT_TEST_ASSERT(send_to_dest(1) == 1);
+  UNIT_TEST_ASSERT(send_to_dest(1) == 1);
+  /* Re-route through another neighbor */
+  rm_route(1);
+  UNIT_TEST_ASSERT(add_route(1, 3));
+  UNIT_TEST_ASSERT(send_to_dest(1) == 3);
+  /* Route removal */
+  rm_route(1);
+  UNIT_TEST_ASSERT(send_to_dest(1) == -1);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(nexthop_nbr_change, "Next-hop cache, neighbor changes");
+UNIT_TEST(nexthop_nbr_change)
+{
+  uip_ipaddr_t ipaddr;
+  uip_lladdr_t lladdr;
+
+  UNIT_TEST_BEGIN();
+
+  setup();
+  UNIT_TEST_ASSERT(send_to_dest(2) == 2);
+  UNIT_TEST_ASSERT(send_to_dest(2) == 2);
+  /* The next hop leaves the neighbor cache: the route is dead */
+  nbr_ipaddr(&ipaddr, 2);
+  UNIT_TEST_ASSERT(uip_ds6_nbr_rm(uip_ds6_nbr_lookup(&ipaddr)) == 1);
+  UNIT_TEST_ASSERT(send_to_dest(2) == -1);
+
+  /* A link-local destination, on link */
+  UNIT_TEST_ASSERT(send_to(&ipaddr) == -1);
+  nbr_lladdr(&lladdr, 2);
+  UNIT_TEST_ASSERT(uip_ds6_nbr_add(&ipaddr, &lladdr, 0, NBR_REACHABLE,
+                                   NBR_TABLE_REASON_IPV6_ND, NULL) != NULL);
+  UNIT_TEST_ASSERT(send_to(&ipaddr) == 2);
+  UNIT_TEST_ASSERT(send_to(&ipaddr) == 2);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(nexthop_defrt, "Next-hop cache, default route");
+UNIT_TEST(nexthop_defrt)
+{
+  uip_ipaddr_t ipaddr;
+  uip_ipaddr_t dest;
+
+  UNIT_TEST_BEGIN();
+
+  setup();
+  uip_ip6addr(&dest, 0xfd02, 0, 0, 0, 0, 0, 0, 1);
+  UNIT_TEST_ASSERT(send_to(&dest) == -1);
+  nbr_ipaddr(&ipaddr, 4);
+  UNIT_TEST_ASSERT(uip_ds6_defrt_add(&ipaddr, 0) != NULL);
+  UNIT_TEST_ASSERT(send_to(&dest) == 4);
+  UNIT_TEST_ASSERT(send_to(&dest) == 4);
+  uip_ds6_defrt_rm(uip_ds6_defrt_lookup(&ipaddr));
+  UNIT_TEST_ASSERT(send_to(&dest) == -1);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+/* Forward packets to a few destinations, with the cache in use or flushed
+ * before every packet, as without the cache */
+static void
+benchmark(void)
+{
+  uint32_t i;
+  uint32_t sent_cached = 0;
+  uint32_t sent_uncached = 0;
+  clock_time_t start, time_cached, time_uncached;
+  struct tcpip_nexthop_cache_stats before;
+  uip_ipaddr_t dests[TCPIP_NEXTHOP_CACHE_SIZE];
+
+  setup();
+  for(i = 0; i < TCPIP_NEXTHOP_CACHE_SIZE; i++) {
+    /* The first routes added, at the far end of the routing table */
+    dest_ipaddr(&dests[i], i);
+  }
+
+  before = tcpip_nexthop_cache_stats;
+  start = clock_time();
+  for(i = 0; i < NUM_BENCH_PACKETS; i++) {
+    sent_cached += send_to(&dests[i % TCPIP_NEXTHOP_CACHE_SIZE]) >= 0;
+  }
+  time_cached = clock_time() - start;
+  printf("Benchmark: %u packets, %u routes, %u hits, %u misses\n",
+         NUM_BENCH_PACKETS, NUM_ROUTES,
+         (unsigned)(tcpip_nexthop_cache_stats.hits - before.hits),
+         (unsigned)(tcpip_nexthop_cache_stats.misses - before.misses));
+
+  start = clock_time();
+  for(i = 0; i < NUM_BENCH_PACKETS; i++) {
+    tcpip_nexthop_cache_flush();
+    sent_uncached += send_to(&dests[i % TCPIP_NEXTHOP_CACHE_SIZE]) >= 0;
+  }
+  time_uncached = clock_time() - start;
+
+  printf("cached %lu ms, uncached %lu ms%s\n",
+         (unsigned long)(time_cached * 1000 / CLOCK_SECOND),
+         (unsigned long)(time_uncached * 1000 / CLOCK_SECOND),
+         sent_cached == NUM_BENCH_PACKETS && sent_cached == sent_uncached ?
+         "" : " =check-me= FAILED");
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  /* Let tcpip_process initialize */
+  PROCESS_PAUSE();
+  netstack_ip_packet_processor_add(&capture);
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(nexthop_routes);
+  UNIT_TEST_RUN(nexthop_route_change);
+  UNIT_TEST_RUN(nexthop_nbr_change);
+  UNIT_TEST_RUN(nexthop_defrt);
+
+  benchmark();
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "unit-test.h"
+#include "net/routing/routing.h"
+#include "net/routing/rpl-lite/rpl.h"
+#include "net/ipv6/uip-sr.h"
+#include <stdio.h>
+#include <string.h>
+
+PROCESS(test_process, "test");
+AUTOSTART_PROCESSES(&test_process);
+
+/* A tree below the root, where node i has node i / FANOUT as parent,
+ * node 0 being the root */
+#define NUM_NODES 120
+#define FANOUT 3
+#define NUM_BENCH_PACKETS 200000
+#define PAYLOAD_LEN 32
+
+static uint8_t packet[UIP_BUFSIZE];
+static uint16_t packet_len;
+
+/*---------------------------------------------------------------------------*/
+void
+print_test_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+node_ipaddr(uip_ipaddr_t *ipaddr, uint16_t i)
+{
+  if(i == 0) {
+    uip_ipaddr_copy(ipaddr, &curr_instance.dag.dag_id);
+  } else {
+    uip_ip6addr(ipaddr, 0xfd00, 0, 0, 0, 0x0200, 0, 0, i);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+set_parent(uint16_t i, uint16_t parent)
+{
+  uip_ipaddr_t child_addr;
+  uip_ipaddr_t parent_addr;
+  node_ipaddr(&child_addr, i);
+  node_ipaddr(&parent_addr, parent);
+  return uip_sr_update_node(NULL, &child_addr, &parent_addr,
+                            UIP_SR_INFINITE_LIFETIME) != NULL;
+}
+/*---------------------------------------------------------------------------*/
+static int
+build_tree(void)
+{
+  uint16_t i;
+  for(i = 1; i <= NUM_NODES; i++) {
+    if(!set_parent(i, i / FANOUT)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Build a UDP packet from the root to node i, insert the routing header,
+ * and keep a copy of the result */
+static int
+send_to(uint16_t i)
+{
+  uipbuf_clear();
+  memset(uip_buf, 0, UIP_IPUDPH_LEN + PAYLOAD_LEN);
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->proto = UIP_PROTO_UDP;
+  UIP_IP_BUF->ttl = 64;
+  node_ipaddr(&UIP_IP_BUF->srcipaddr, 0);
+  node_ipaddr(&UIP_IP_BUF->destipaddr, i);
+  uipbuf_set_len(UIP_IPUDPH_LEN + PAYLOAD_LEN);
+  uipbuf_set_len_field(UIP_IP_BUF, UIP_UDPH_LEN + PAYLOAD_LEN);
+  memset(uip_buf + UIP_IPUDPH_LEN, i, PAYLOAD_LEN);
+
+  if(!NETSTACK_ROUTING.ext_header_update()) {
+    return 0;
+  }
+  packet_len = uip_len;
+  memcpy(packet, uip_buf, packet_len);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Check that the packet goes down the path to node i, and that the
+ * payload survived the header insertion */
+static int
+check_route(uint16_t i, uint16_t hops)
+{
+  struct uip_ip_hdr *ip_hdr = (struct uip_ip_hdr *)packet;
+  struct uip_routing_hdr *rh_hdr = (struct uip_routing_hdr *)(packet + UIP_IPH_LEN);
+  uip_ipaddr_t first_hop;
+  uint16_t ext_len;
+  uint16_t first;
+  int j;
+
+  /* The first hop is the child of the root on the path */
+  for(first = i; first / FANOUT != 0; first /= FANOUT);
+  node_ipaddr(&first_hop, first);
+
+  ext_len = (rh_hdr->len + 1) * 8;
+  if(ip_hdr->proto != UIP_PROTO_ROUTING
+     || rh_hdr->next != UIP_PROTO_UDP
+     || rh_hdr->seg_left != hops
+     || !uip_ipaddr_cmp(&ip_hdr->destipaddr, &first_hop)
+     || packet_len != UIP_IPUDPH_LEN + PAYLOAD_LEN + ext_len) {
+    return 0;
+  }
+  for(j = 0; j < PAYLOAD_LEN; j++) {
+    if(packet[UIP_IPUDPH_LEN + ext_len + j] != (i & 0xff)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+depth(uint16_t i)
+{
+  uint16_t d = 0;
+  for(; i != 0; i /= FANOUT) {
+    d++;
+  }
+  return d;
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(srh_cache, "SRH cache, cached headers");
+UNIT_TEST(srh_cache)
+{
+  static uint8_t computed[UIP_BUFSIZE];
+  uint16_t computed_len;
+  uint16_t i;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(build_tree());
+  for(i = 1; i <= NUM_NODES; i += 7) {
+    /* Computed, then cached */
+    UNIT_TEST_ASSERT(send_to(i));
+    UNIT_TEST_ASSERT(check_route(i, depth(i) - 1));
+    memcpy(computed, packet, packet_len);
+    computed_len = packet_len;
+    UNIT_TEST_ASSERT(send_to(i));
+    UNIT_TEST_ASSERT(packet_len == computed_len);
+    UNIT_TEST_ASSERT(memcmp(packet, computed, computed_len) == 0);
+  }
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(srh_cache_update, "SRH cache, topology changes");
+UNIT_TEST(srh_cache_update)
+{
+  uint16_t dest = NUM_NODES;
+  uip_ipaddr_t first_hop;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(build_tree());
+  UNIT_TEST_ASSERT(send_to(dest));
+  UNIT_TEST_ASSERT(check_route(dest, depth(dest) - 1));
+  UNIT_TEST_ASSERT(send_to(dest));
+  UNIT_TEST_ASSERT(check_route(dest, depth(dest) - 1));
+
+  /* The parent of the destination moves right below the root */
+  UNIT_TEST_ASSERT(set_parent(dest / FANOUT, 0));
+  UNIT_TEST_ASSERT(send_to(dest));
+  node_ipaddr(&first_hop, dest / FANOUT);
+  UNIT_TEST_ASSERT(uip_ipaddr_cmp(&((struct uip_ip_hdr *)packet)->destipaddr,
+                                  &first_hop));
+  UNIT_TEST_ASSERT(((struct uip_routing_hdr *)(packet + UIP_IPH_LEN))->seg_left == 1);
+
+  /* Back to the original tree */
+  UNIT_TEST_ASSERT(build_tree());
+  UNIT_TEST_ASSERT(send_to(dest));
+  UNIT_TEST_ASSERT(check_route(dest, depth(dest) - 1));
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+/* Insert headers for packets to the deepest nodes, cycling through as many
+ * destinations as the cache holds, then through one more, which makes the
+ * least recently used entry miss every time */
+static void
+benchmark(void)
+{
+  uint32_t i;
+  uint32_t sent_cached = 0;
+  uint32_t sent_uncached = 0;
+  clock_time_t start, time_cached, time_uncached;
+
+  build_tree();
+
+  start = clock_time();
+  for(i = 0; i < NUM_BENCH_PACKETS; i++) {
+    sent_cached += send_to(NUM_NODES - i % RPL_SRH_CACHE_SIZE);
+  }
+  time_cached = clock_time() - start;
+
+  start = clock_time();
+  for(i = 0; i < NUM_BENCH_PACKETS; i++) {
+    sent_uncached += send_to(NUM_NODES - i % (RPL_SRH_CACHE_SIZE + 1));
+  }
+  time_uncached = clock_time() - start;
+
+  printf("Benchmark: %u packets, %u nodes, depth %u\n",
+         NUM_BENCH_PACKETS, NUM_NODES, depth(NUM_NODES));
+  printf("cached %lu ms, uncached %lu ms%s\n",
+         (unsigned long)(time_cached * 1000 / CLOCK_SECOND),
+         (unsigned long)(time_uncached * 1000 / CLOCK_SECOND),
+         sent_cached == NUM_BENCH_PACKETS && sent_cached == sent_uncached ?
+         "" : " =check-me= FAILED");
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  NETSTACK_ROUTING.root_start();
+  PROCESS_PAUSE();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(srh_cache);
+  UNIT_TEST_RUN(srh_cache_update);
+
+  benchmark();
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,373 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "unit-test.h"
+#include "net/routing/routing.h"
+#include "net/ipv6/uip-sr.h"
+#include <stdio.h>
+#include <string.h>
+
+PROCESS(test_process, "test");
+AUTOSTART_PROCESSES(&test_process);
+
+/* A tree below the root, where node i has node i / FANOUT as parent,
+ * node 0 being the root */
+#define NUM_NODES 200
+#define FANOUT 3
+#define LIFETIME 100000
+
+/*---------------------------------------------------------------------------*/
+void
+print_test_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+node_ipaddr(uip_ipaddr_t *ipaddr, uint16_t i)
+{
+  if(i == 0) {
+    NETSTACK_ROUTING.get_root_ipaddr(ipaddr);
+  } else {
+    uip_ip6addr(ipaddr, 0xfd00, 0, 0, 0, 0x0200, 0, 0, i);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+set_parent(uint16_t i, uint16_t parent)
+{
+  uip_ipaddr_t child_addr;
+  uip_ipaddr_t parent_addr;
+  node_ipaddr(&child_addr, i);
+  node_ipaddr(&parent_addr, parent);
+  return uip_sr_update_node(NULL, &child_addr, &parent_addr, LIFETIME) != NULL;
+}
+/*---------------------------------------------------------------------------*/
+static int
+build_tree(void)
+{
+  uint16_t i;
+  uip_sr_free_all();
+  for(i = 1; i <= NUM_NODES; i++) {
+    if(!set_parent(i, i / FANOUT)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Expire a leaf and age the graph until it is removed */
+static void
+remove_leaf(uint16_t i)
+{
+  uip_ipaddr_t child_addr;
+  uip_ipaddr_t parent_addr;
+  node_ipaddr(&child_addr, i);
+  node_ipaddr(&parent_addr, i / FANOUT);
+  uip_sr_expire_parent(NULL, &child_addr, &parent_addr);
+  uip_sr_periodic(UIP_SR_REMOVAL_DELAY);
+  uip_sr_periodic(1);
+}
+/*---------------------------------------------------------------------------*/
+/* Count the records of a snapshot */
+static int
+count_records(uint32_t since, int *num_removed, int *is_full)
+{
+  uip_sr_snapshot_t snapshot;
+  uip_sr_snapshot_record_t record;
+  int count = 0;
+
+  *num_removed = 0;
+  uip_sr_snapshot_start(&snapshot, since);
+  *is_full = (snapshot.flags & UIP_SR_SNAPSHOT_FLAG_FULL) != 0;
+  while(uip_sr_snapshot_next(&snapshot, &record)) {
+    if(record.node == NULL) {
+      (*num_removed)++;
+    }
+    count++;
+  }
+  return count;
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(snapshot_full, "Snapshot, full dump");
+UNIT_TEST(snapshot_full)
+{
+  int num_removed;
+  int is_full;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(build_tree());
+  /* All nodes, plus the root */
+  UNIT_TEST_ASSERT(uip_sr_num_nodes() == NUM_NODES + 1);
+  UNIT_TEST_ASSERT(count_records(0, &num_removed, &is_full) == NUM_NODES + 1);
+  UNIT_TEST_ASSERT(is_full && num_removed == 0);
+  /* A version from the future, e.g. before a reboot */
+  UNIT_TEST_ASSERT(count_records(uip_sr_snapshot_version() + 1,
+                                 &num_removed, &is_full) == NUM_NODES + 1);
+  UNIT_TEST_ASSERT(is_full);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(snapshot_delta, "Snapshot, deltas");
+UNIT_TEST(snapshot_delta)
+{
+  uint32_t version;
+  int num_removed;
+  int is_full;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(build_tree());
+  version = uip_sr_snapshot_version();
+  UNIT_TEST_ASSERT(count_records(version, &num_removed, &is_full) == 0);
+  UNIT_TEST_ASSERT(!is_full);
+
+  /* A new parent, and a refresh */
+  UNIT_TEST_ASSERT(set_parent(NUM_NODES - 1, 1));
+  UNIT_TEST_ASSERT(set_parent(NUM_NODES - 2, (NUM_NODES - 2) / FANOUT));
+  UNIT_TEST_ASSERT(count_records(version, &num_removed, &is_full) == 2);
+  UNIT_TEST_ASSERT(!is_full && num_removed == 0);
+
+  /* Removals, then an addition of a removed node */
+  version = uip_sr_snapshot_version();
+  remove_leaf(NUM_NODES);
+  remove_leaf(NUM_NODES - 3);
+  UNIT_TEST_ASSERT(uip_sr_num_nodes() == NUM_NODES - 1);
+  UNIT_TEST_ASSERT(count_records(version, &num_removed, &is_full) == 2);
+  UNIT_TEST_ASSERT(!is_full && num_removed == 2);
+  UNIT_TEST_ASSERT(set_parent(NUM_NODES, NUM_NODES / FANOUT));
+  UNIT_TEST_ASSERT(count_records(version, &num_removed, &is_full) == 3);
+  UNIT_TEST_ASSERT(!is_full && num_removed == 2);
+
+  /* More removals than remembered: clients that are too late get it all */
+  version = uip_sr_snapshot_version();
+  for(i = 0; i < UIP_SR_SNAPSHOT_REMOVED_NUM; i++) {
+    remove_leaf(NUM_NODES - 4 - i);
+  }
+  UNIT_TEST_ASSERT(count_records(version, &num_removed, &is_full)
+                   == UIP_SR_SNAPSHOT_REMOVED_NUM);
+  UNIT_TEST_ASSERT(!is_full);
+  remove_leaf(NUM_NODES - 4 - i);
+  UNIT_TEST_ASSERT(count_records(version, &num_removed, &is_full)
+                   == uip_sr_num_nodes());
+  UNIT_TEST_ASSERT(is_full && num_removed == 0);
+
+  /* The graph is flushed */
+  version = uip_sr_snapshot_version();
+  uip_sr_free_all();
+  UNIT_TEST_ASSERT(count_records(version, &num_removed, &is_full) == 0);
+  UNIT_TEST_ASSERT(is_full);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(snapshot_serialize, "Snapshot, binary chunks");
+UNIT_TEST(snapshot_serialize)
+{
+  static uint8_t buf[100];
+  static uint16_t parents[NUM_NODES + 1];
+  uint32_t version;
+  uint32_t lifetime;
+  uint16_t offset;
+  uint16_t count;
+  int num_nodes;
+  int num_chunks;
+  int len;
+  int pos;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(build_tree());
+  remove_leaf(NUM_NODES);
+  version = uip_sr_snapshot_version();
+
+  /* Fetch the full dump in chunks, and rebuild the tree from it */
+  memset(parents, 0xff, sizeof(parents));
+  num_nodes = 0;
+  num_chunks = 0;
+  offset = 0;
+  do {
+    len = uip_sr_snapshot_serialize(buf, sizeof(buf), 0, offset);
+    UNIT_TEST_ASSERT(len >= UIP_SR_SNAPSHOT_HDR_LEN && len <= sizeof(buf));
+    UNIT_TEST_ASSERT(buf[0] == UIP_SR_SNAPSHOT_FORMAT);
+    UNIT_TEST_ASSERT(buf[1] & UIP_SR_SNAPSHOT_FLAG_FULL);
+    UNIT_TEST_ASSERT(buf[6] == (version >> 24 & 0xff) && buf[9] == (version & 0xff));
+    UNIT_TEST_ASSERT(buf[12] == 0xfd && buf[13] == 0x00);
+    count = (buf[10] << 8) | buf[11];
+    UNIT_TEST_ASSERT(count > 0);
+    pos = UIP_SR_SNAPSHOT_HDR_LEN;
+    for(i = 0; i < count; i++) {
+      UNIT_TEST_ASSERT(buf[pos] == UIP_SR_SNAPSHOT_TYPE_NODE);
+      if(buf[pos + 1] == 0x02 && buf[pos + 2] == 0x00) {
+        /* One of our nodes, otherwise the root */
+        uint16_t node = (buf[pos + 7] << 8) | buf[pos + 8];
+        uint16_t parent = (buf[pos + 15] << 8) | buf[pos + 16];
+        if(buf[pos + 9] != 0x02 || buf[pos + 10] != 0x00) {
+          parent = 0;
+        }
+        UNIT_TEST_ASSERT(node <= NUM_NODES && parents[node] == 0xffff);
+        parents[node] = parent;
+        /* Aged by the removal of the leaf */
+        lifetime = ((uint32_t)buf[pos + 17] << 24) | ((uint32_t)buf[pos + 18] << 16)
+          | ((uint32_t)buf[pos + 19] << 8) | buf[pos + 20];
+        UNIT_TEST_ASSERT(lifetime == LIFETIME - UIP_SR_REMOVAL_DELAY - 1);
+      }
+      pos += UIP_SR_SNAPSHOT_NODE_LEN;
+      num_nodes++;
+    }
+    UNIT_TEST_ASSERT(pos == len);
+    offset += count;
+    num_chunks++;
+  } while(buf[1] & UIP_SR_SNAPSHOT_FLAG_MORE);
+
+  UNIT_TEST_ASSERT(num_nodes == NUM_NODES);
+  /* As many node records per chunk as fit */
+  count = (sizeof(buf) - UIP_SR_SNAPSHOT_HDR_LEN) / UIP_SR_SNAPSHOT_NODE_LEN;
+  UNIT_TEST_ASSERT(num_chunks == (NUM_NODES + count - 1) / count);
+  UNIT_TEST_ASSERT(parents[NUM_NODES] == 0xffff);
+  for(i = 1; i < NUM_NODES; i++) {
+    UNIT_TEST_ASSERT(parents[i] == i / FANOUT);
+  }
+
+  /* A delta with a removal and an update */
+  remove_leaf(NUM_NODES - 1);
+  UNIT_TEST_ASSERT(set_parent(NUM_NODES - 2, 1));
+  len = uip_sr_snapshot_serialize(buf, sizeof(buf), version, 0);
+  UNIT_TEST_ASSERT(len == UIP_SR_SNAPSHOT_HDR_LEN + UIP_SR_SNAPSHOT_REMOVED_LEN
+                   + UIP_SR_SNAPSHOT_NODE_LEN);
+  UNIT_TEST_ASSERT(buf[1] == 0 && buf[11] == 2);
+  pos = UIP_SR_SNAPSHOT_HDR_LEN;
+  UNIT_TEST_ASSERT(buf[pos] == UIP_SR_SNAPSHOT_TYPE_REMOVED && buf[pos + 8] == NUM_NODES - 1);
+  pos += UIP_SR_SNAPSHOT_REMOVED_LEN;
+  UNIT_TEST_ASSERT(buf[pos] == UIP_SR_SNAPSHOT_TYPE_NODE && buf[pos + 8] == NUM_NODES - 2
+                   && buf[pos + 16] == 1);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(snapshot_json, "Snapshot, JSON records");
+UNIT_TEST(snapshot_json)
+{
+  uip_sr_snapshot_t snapshot;
+  uip_sr_snapshot_record_t record;
+  uint32_t version;
+  char buf[120];
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(build_tree());
+  version = uip_sr_snapshot_version();
+  remove_leaf(NUM_NODES);
+  UNIT_TEST_ASSERT(set_parent(NUM_NODES - 1, 1));
+
+  uip_sr_snapshot_start(&snapshot, version);
+  UNIT_TEST_ASSERT(uip_sr_snapshot_next(&snapshot, &record));
+  uip_sr_snapshot_record_snprint_json(buf, sizeof(buf), &record);
+  printf("%s\n", buf);
+  UNIT_TEST_ASSERT(!strcmp(buf, "{\"removed\":\"fd00::200:0:0:c8\"}"));
+  UNIT_TEST_ASSERT(uip_sr_snapshot_next(&snapshot, &record));
+  uip_sr_snapshot_record_snprint_json(buf, sizeof(buf), &record);
+  printf("%s\n", buf);
+  UNIT_TEST_ASSERT(!strcmp(buf, "{\"node\":\"fd00::200:0:0:c7\",\"parent\":\"fd00::200:0:0:1\",\"lifetime\":100000}"));
+  UNIT_TEST_ASSERT(!uip_sr_snapshot_next(&snapshot, &record));
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+/* Compare the size of a full dump with the links printed by the shell, and
+ * with a delta after a few changes */
+static void
+benchmark(void)
+{
+  static uint8_t buf[1024];
+  uip_sr_node_t *link;
+  uint32_t version;
+  uint16_t offset = 0;
+  unsigned long text_len = 0;
+  unsigned long full_len = 0;
+  int delta_len;
+  int len;
+
+  build_tree();
+  for(link = uip_sr_node_head(); link != NULL; link = uip_sr_node_next(link)) {
+    text_len += uip_sr_link_snprint((char *)buf, sizeof(buf), link) + 4;
+  }
+  do {
+    len = uip_sr_snapshot_serialize(buf, sizeof(buf), 0, offset);
+    offset += (buf[10] << 8) | buf[11];
+    full_len += len;
+  } while(buf[1] & UIP_SR_SNAPSHOT_FLAG_MORE);
+
+  version = uip_sr_snapshot_version();
+  remove_leaf(NUM_NODES);
+  set_parent(NUM_NODES - 1, 1);
+  set_parent(NUM_NODES - 2, 1);
+  delta_len = uip_sr_snapshot_serialize(buf, sizeof(buf), version, 0);
+
+  printf("Benchmark: %u nodes: printed links %lu bytes, full dump %lu bytes, delta of 3 changes %u bytes\n",
+         NUM_NODES + 1, text_len, full_len, delta_len);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  NETSTACK_ROUTING.root_start();
+  PROCESS_PAUSE();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(snapshot_full);
+  UNIT_TEST_RUN(snapshot_delta);
+  UNIT_TEST_RUN(snapshot_serialize);
+  UNIT_TEST_RUN(snapshot_json);
+
+  benchmark();
+  uip_sr_free_all();
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,446 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "lib/random.h"
+#include "unit-test.h"
+#include "net/routing/routing.h"
+#include "net/routing/rpl-classic/rpl-private.h"
+#include <stdio.h>
+#include <string.h>
+
+PROCESS(test_process, "test");
+AUTOSTART_PROCESSES(&test_process);
+
+/* Descendants numbered from 0, reached through NUM_NEXTHOPS children,
+ * each of them with a block of contiguous descendants below it */
+#define NUM_DESCENDANTS 256
+#define NUM_NEXTHOPS 4
+#define BLOCK_SIZE (NUM_DESCENDANTS / NUM_NEXTHOPS)
+#define FIRST_IID 0x1000
+#define NUM_BENCH_LOOKUPS 200000
+
+/*---------------------------------------------------------------------------*/
+void
+print_test_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+nexthop_lladdr(uip_lladdr_t *lladdr, uint16_t k)
+{
+  memset(lladdr, 0, sizeof(*lladdr));
+  lladdr->addr[0] = 0x02;
+  lladdr->addr[sizeof(*lladdr) - 1] = k + 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+nexthop_ipaddr(uip_ipaddr_t *ipaddr, uint16_t k)
+{
+  uip_lladdr_t lladdr;
+  nexthop_lladdr(&lladdr, k);
+  uip_ip6addr(ipaddr, 0xfe80, 0, 0, 0, 0, 0, 0, 0);
+  uip_ds6_set_addr_iid(ipaddr, &lladdr);
+}
+/*---------------------------------------------------------------------------*/
+static void
+descendant_ipaddr(uip_ipaddr_t *ipaddr, uint16_t i)
+{
+  uip_ip6addr(ipaddr, 0xfd00, 0, 0, 0, 0x0200, 0, 0, FIRST_IID + i);
+}
+/*---------------------------------------------------------------------------*/
+static int
+add_nexthops(void)
+{
+  uip_ipaddr_t ipaddr;
+  uip_lladdr_t lladdr;
+  uint16_t k;
+
+  for(k = 0; k < NUM_NEXTHOPS; k++) {
+    nexthop_ipaddr(&ipaddr, k);
+    nexthop_lladdr(&lladdr, k);
+    if(uip_ds6_nbr_lookup(&ipaddr) == NULL &&
+       uip_ds6_nbr_add(&ipaddr, &lladdr, 0, NBR_REACHABLE,
+                       NBR_TABLE_REASON_RPL_DAO, NULL) == NULL) {
+      return 0;
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+remove_all_routes(void)
+{
+  uip_ds6_route_t *r;
+  while((r = uip_ds6_route_head()) != NULL) {
+    uip_ds6_route_rm(r);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Route to descendant i via next hop k, as when receiving its DAO, before
+ * it is forwarded */
+static uip_ds6_route_t *
+refresh_descendant(uint16_t i, uint16_t k)
+{
+  uip_ipaddr_t ipaddr;
+  uip_ipaddr_t nexthop;
+  uip_ds6_route_t *rep;
+
+  descendant_ipaddr(&ipaddr, i);
+  nexthop_ipaddr(&nexthop, k);
+  rep = rpl_add_route(rpl_get_any_dag(), &ipaddr, 128, &nexthop);
+  if(rep != NULL) {
+    rep->state.lifetime = RPL_LIFETIME(rpl_get_default_instance(),
+                                       rpl_get_default_instance()->default_lifetime);
+  }
+  return rep;
+}
+/*---------------------------------------------------------------------------*/
+/* Route to descendant i via next hop k, as when receiving its DAO at the
+ * root, where it needs no DAO-ACK */
+static int
+add_descendant(uint16_t i, uint16_t k)
+{
+  uip_ds6_route_t *rep;
+
+  rep = refresh_descendant(i, k);
+  if(rep != NULL) {
+    rpl_aggregate_route(rep);
+  }
+  return rep != NULL;
+}
+/*---------------------------------------------------------------------------*/
+/* Add all descendants, in random order */
+static int
+add_all_descendants(void)
+{
+  static uint16_t order[NUM_DESCENDANTS];
+  uint16_t i, j, tmp;
+
+  for(i = 0; i < NUM_DESCENDANTS; i++) {
+    order[i] = i;
+  }
+  for(i = NUM_DESCENDANTS - 1; i > 0; i--) {
+    j = random_rand() % (i + 1);
+    tmp = order[i];
+    order[i] = order[j];
+    order[j] = tmp;
+  }
+  for(i = 0; i < NUM_DESCENDANTS; i++) {
+    if(!add_descendant(order[i], order[i] / BLOCK_SIZE)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+is_routed_via(uint16_t i, uint16_t k)
+{
+  uip_ipaddr_t ipaddr;
+  uip_ipaddr_t nexthop;
+  uip_ds6_route_t *r;
+
+  descendant_ipaddr(&ipaddr, i);
+  nexthop_ipaddr(&nexthop, k);
+  r = uip_ds6_route_lookup(&ipaddr);
+  return r != NULL && uip_ipaddr_cmp(uip_ds6_route_nexthop(r), &nexthop);
+}
+/*---------------------------------------------------------------------------*/
+static int
+all_routed(void)
+{
+  uint16_t i;
+  for(i = 0; i < NUM_DESCENDANTS; i++) {
+    if(!is_routed_via(i, i / BLOCK_SIZE)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(route_aggregation, "Route aggregation");
+UNIT_TEST(route_aggregation)
+{
+  uip_ipaddr_t ipaddr;
+
+  UNIT_TEST_BEGIN();
+
+  remove_all_routes();
+  UNIT_TEST_ASSERT(add_all_descendants());
+  /* One route per block */
+  UNIT_TEST_ASSERT(uip_ds6_route_num_routes() == NUM_NEXTHOPS);
+  UNIT_TEST_ASSERT(all_routed());
+  /* Outside of the blocks */
+  descendant_ipaddr(&ipaddr, NUM_DESCENDANTS);
+  UNIT_TEST_ASSERT(uip_ds6_route_lookup(&ipaddr) == NULL);
+  descendant_ipaddr(&ipaddr, -1);
+  UNIT_TEST_ASSERT(uip_ds6_route_lookup(&ipaddr) == NULL);
+
+  /* Refreshing a descendant does not add any route */
+  UNIT_TEST_ASSERT(add_descendant(BLOCK_SIZE + 1, 1));
+  UNIT_TEST_ASSERT(uip_ds6_route_num_routes() == NUM_NEXTHOPS);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(route_aggregation_partial, "Route aggregation, gaps");
+UNIT_TEST(route_aggregation_partial)
+{
+  uint16_t i;
+
+  UNIT_TEST_BEGIN();
+
+  /* Every other descendant: nothing to aggregate */
+  remove_all_routes();
+  for(i = 0; i < BLOCK_SIZE; i += 2) {
+    UNIT_TEST_ASSERT(add_descendant(i, 0));
+  }
+  UNIT_TEST_ASSERT(uip_ds6_route_num_routes() == BLOCK_SIZE / 2);
+  for(i = 0; i < BLOCK_SIZE; i++) {
+    UNIT_TEST_ASSERT(is_routed_via(i, 0) == !(i % 2));
+  }
+
+  /* Filling the gaps aggregates the block */
+  for(i = 1; i < BLOCK_SIZE; i += 2) {
+    UNIT_TEST_ASSERT(add_descendant(i, 0));
+  }
+  UNIT_TEST_ASSERT(uip_ds6_route_num_routes() == 1);
+  for(i = 0; i < BLOCK_SIZE; i++) {
+    UNIT_TEST_ASSERT(is_routed_via(i, 0));
+  }
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(route_aggregation_move, "Route aggregation, moves");
+UNIT_TEST(route_aggregation_move)
+{
+  uint16_t moved = 5;
+
+  UNIT_TEST_BEGIN();
+
+  remove_all_routes();
+  UNIT_TEST_ASSERT(add_all_descendants());
+
+  /* A descendant moves below another child: the aggregate stays */
+  UNIT_TEST_ASSERT(add_descendant(moved, 1));
+  UNIT_TEST_ASSERT(uip_ds6_route_num_routes() == NUM_NEXTHOPS + 1);
+  UNIT_TEST_ASSERT(is_routed_via(moved, 1));
+  UNIT_TEST_ASSERT(is_routed_via(moved - 1, 0));
+  UNIT_TEST_ASSERT(is_routed_via(moved + 1, 0));
+
+  /* And back */
+  UNIT_TEST_ASSERT(add_descendant(moved, 0));
+  UNIT_TEST_ASSERT(uip_ds6_route_num_routes() == NUM_NEXTHOPS);
+  UNIT_TEST_ASSERT(all_routed());
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(route_aggregation_split, "Route aggregation, split");
+UNIT_TEST(route_aggregation_split)
+{
+  uip_ipaddr_t ipaddr;
+  uip_ds6_route_t *r;
+  uint16_t removed = 2 * BLOCK_SIZE + 9;
+  uint16_t i;
+
+  UNIT_TEST_BEGIN();
+
+  remove_all_routes();
+  UNIT_TEST_ASSERT(add_all_descendants());
+
+  /* As when receiving a No-Path DAO for one descendant */
+  descendant_ipaddr(&ipaddr, removed);
+  r = uip_ds6_route_lookup(&ipaddr);
+  UNIT_TEST_ASSERT(r != NULL && r->length < 128);
+  r->state.lifetime = 1234;
+  r = uip_ds6_route_split(r, &ipaddr, 128);
+  UNIT_TEST_ASSERT(r != NULL && r->length == 128);
+  UNIT_TEST_ASSERT(uip_ipaddr_cmp(&r->ipaddr, &ipaddr));
+  /* One route per bit of the block */
+  UNIT_TEST_ASSERT(uip_ds6_route_num_routes() == NUM_NEXTHOPS + 6);
+  UNIT_TEST_ASSERT(all_routed());
+  for(r = uip_ds6_route_head(); r != NULL; r = uip_ds6_route_next(r)) {
+    UNIT_TEST_ASSERT(r->length != 128 || r->state.lifetime == 1234);
+  }
+
+  /* The descendant is gone, the rest of its block is still reachable */
+  uip_ds6_route_rm(uip_ds6_route_lookup(&ipaddr));
+  for(i = 0; i < NUM_DESCENDANTS; i++) {
+    UNIT_TEST_ASSERT(is_routed_via(i, i / BLOCK_SIZE) == (i != removed));
+  }
+
+  /* It comes back: the block is aggregated again */
+  UNIT_TEST_ASSERT(add_descendant(removed, removed / BLOCK_SIZE));
+  UNIT_TEST_ASSERT(uip_ds6_route_num_routes() == NUM_NEXTHOPS);
+  UNIT_TEST_ASSERT(all_routed());
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(route_aggregation_dao_ack, "Route aggregation, DAO-ACKs");
+UNIT_TEST(route_aggregation_dao_ack)
+{
+  uip_ds6_route_t *r;
+  uip_ds6_route_t *rep;
+  uint16_t refreshed = 3 * BLOCK_SIZE + 17;
+  uint16_t i;
+
+  UNIT_TEST_BEGIN();
+
+  remove_all_routes();
+  UNIT_TEST_ASSERT(add_all_descendants());
+  for(r = uip_ds6_route_head(); r != NULL; r = uip_ds6_route_next(r)) {
+    r->state.lifetime = 1234;
+  }
+
+  /* A DAO forwarded up: its target leaves the aggregate while it waits
+     for the DAO-ACK, and only it takes the lifetime of the DAO */
+  rep = refresh_descendant(refreshed, refreshed / BLOCK_SIZE);
+  UNIT_TEST_ASSERT(rep != NULL && rep->length == 128);
+  RPL_ROUTE_SET_DAO_PENDING(rep);
+  UNIT_TEST_ASSERT(rpl_aggregate_route(rep) == rep && rep->length == 128);
+  UNIT_TEST_ASSERT(uip_ds6_route_num_routes() == NUM_NEXTHOPS + 6);
+  UNIT_TEST_ASSERT(all_routed());
+  for(r = uip_ds6_route_head(); r != NULL; r = uip_ds6_route_next(r)) {
+    UNIT_TEST_ASSERT(r == rep || r->state.lifetime == 1234);
+  }
+  UNIT_TEST_ASSERT(rep->state.lifetime != 1234);
+
+  /* A negative DAO-ACK removes the target, not the rest of its block */
+  uip_ds6_route_rm(rep);
+  for(i = 0; i < NUM_DESCENDANTS; i++) {
+    UNIT_TEST_ASSERT(is_routed_via(i, i / BLOCK_SIZE) == (i != refreshed));
+  }
+
+  /* A positive one aggregates it again */
+  rep = refresh_descendant(refreshed, refreshed / BLOCK_SIZE);
+  UNIT_TEST_ASSERT(rep != NULL);
+  RPL_ROUTE_SET_DAO_PENDING(rep);
+  rpl_aggregate_route(rep);
+  UNIT_TEST_ASSERT(uip_ds6_route_num_routes() == NUM_NEXTHOPS + 6);
+  RPL_ROUTE_CLEAR_DAO_PENDING(rep);
+  rpl_aggregate_route(rep);
+  UNIT_TEST_ASSERT(uip_ds6_route_num_routes() == NUM_NEXTHOPS);
+  UNIT_TEST_ASSERT(all_routed());
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+/* Look up routes to all descendants, from a table with one route per
+ * descendant and from the aggregated table */
+static void
+benchmark(void)
+{
+  static uip_ipaddr_t addrs[NUM_DESCENDANTS];
+  uip_ipaddr_t nexthop;
+  uint32_t i;
+  uint32_t found_plain = 0;
+  uint32_t found_aggregated = 0;
+  int num_plain, num_aggregated;
+  clock_time_t start, time_plain, time_aggregated;
+
+  for(i = 0; i < NUM_DESCENDANTS; i++) {
+    descendant_ipaddr(&addrs[i], i);
+  }
+
+  /* Routes added right to the routing table, not aggregated */
+  remove_all_routes();
+  for(i = 0; i < NUM_DESCENDANTS; i++) {
+    nexthop_ipaddr(&nexthop, i / BLOCK_SIZE);
+    uip_ds6_route_add(&addrs[i], 128, &nexthop);
+  }
+  num_plain = uip_ds6_route_num_routes();
+  start = clock_time();
+  for(i = 0; i < NUM_BENCH_LOOKUPS; i++) {
+    found_plain += uip_ds6_route_lookup(&addrs[(i * 7) % NUM_DESCENDANTS]) != NULL;
+  }
+  time_plain = clock_time() - start;
+
+  remove_all_routes();
+  add_all_descendants();
+  num_aggregated = uip_ds6_route_num_routes();
+  start = clock_time();
+  for(i = 0; i < NUM_BENCH_LOOKUPS; i++) {
+    found_aggregated += uip_ds6_route_lookup(&addrs[(i * 7) % NUM_DESCENDANTS]) != NULL;
+  }
+  time_aggregated = clock_time() - start;
+
+  printf("Benchmark: %u lookups, %u descendants via %u next hops\n",
+         NUM_BENCH_LOOKUPS, NUM_DESCENDANTS, NUM_NEXTHOPS);
+  printf("plain %d routes (%u B) %lu ms, aggregated %d routes (%u B) %lu ms%s\n",
+         num_plain,
+         (unsigned)(num_plain * (sizeof(uip_ds6_route_t) +
+                                 sizeof(struct uip_ds6_route_neighbor_route))),
+         (unsigned long)(time_plain * 1000 / CLOCK_SECOND),
+         num_aggregated,
+         (unsigned)(num_aggregated * (sizeof(uip_ds6_route_t) +
+                                      sizeof(struct uip_ds6_route_neighbor_route))),
+         (unsigned long)(time_aggregated * 1000 / CLOCK_SECOND),
+         found_plain == NUM_BENCH_LOOKUPS && found_plain == found_aggregated ?
+         "" : " =check-me= FAILED");
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  NETSTACK_ROUTING.root_start();
+  PROCESS_PAUSE();
+  add_nexthops();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(route_aggregation);
+  UNIT_TEST_RUN(route_aggregation_partial);
+  UNIT_TEST_RUN(route_aggregation_move);
+  UNIT_TEST_RUN(route_aggregation_split);
+  UNIT_TEST_RUN(route_aggregation_dao_ack);
+
+  benchmark();
+  remove_all_routes();
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
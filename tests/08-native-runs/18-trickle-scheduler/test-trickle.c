@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "contiki.h"
+#include "unit-test.h"
+#include "lib/trickle-timer.h"
+#include <stdio.h>
+#include <string.h>
+
+PROCESS(test_process, "test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define NUM_TIMERS 64
+#define IMIN 16 /* ticks */
+#define IMAX 4  /* doublings */
+#define RUN_TIME (2 * CLOCK_SECOND)
+
+struct test_timer {
+  struct trickle_timer tt;
+  uint32_t callbacks;
+  uint32_t suppressed;
+  clock_time_t suppressed_due;
+  clock_time_t interval_end;
+  /* The random first interval, inconsistencies do not reset an Imin one */
+  clock_time_t first_i;
+  /* The interval of the last callback */
+  clock_time_t last_start;
+  clock_time_t last_end;
+  /* Set if an interval went by without a callback when stopped */
+  uint8_t missed;
+};
+
+static struct test_timer timers[NUM_TIMERS];
+static uint32_t violations;
+static clock_time_t max_lateness;
+
+/*---------------------------------------------------------------------------*/
+void
+print_test_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Whether a is before b */
+static int
+is_before(clock_time_t a, clock_time_t b)
+{
+  return (clock_time_t)(a - b) > (TRICKLE_TIMER_CLOCK_MAX >> 1);
+}
+/*---------------------------------------------------------------------------*/
+/* Check where the scheduler put the callback rather than when the native
+ * clock delivered it, which depends on the load of the host: a transmission
+ * is due no earlier than I/2 in its interval, a suppressed one is due at the
+ * end of its interval, no callback runs before it is due, and every interval
+ * gets exactly one callback */
+static void
+tx(void *ptr, uint8_t suppress)
+{
+  struct test_timer *t = ptr;
+  clock_time_t now = clock_time();
+  clock_time_t due = TRICKLE_TIMER_NEXT_EVENT(&t->tt);
+
+  if(suppress == TRICKLE_TIMER_TX_SUPPRESS) {
+    t->suppressed++;
+    t->suppressed_due = due;
+  } else if(is_before(due, t->tt.i_start + (t->tt.i_cur >> 1))) {
+    violations++;
+  }
+  if(is_before(now + TRICKLE_TIMER_SCHEDULER_WINDOW, due)) {
+    violations++;
+  }
+  if(t->callbacks > 0 && t->tt.i_start != t->last_end) {
+    violations++;
+  }
+  t->callbacks++;
+  t->last_start = t->tt.i_start;
+  t->last_end = TRICKLE_TIMER_INTERVAL_END(&t->tt);
+
+  if(now - due > max_lateness) {
+    max_lateness = now - due;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+start_timers(uint8_t k)
+{
+  int i;
+
+  violations = 0;
+  max_lateness = 0;
+  for(i = 0; i < NUM_TIMERS; i++) {
+    memset(&timers[i], 0, sizeof(timers[i]));
+    trickle_timer_config(&timers[i].tt, IMIN, IMAX, k);
+    trickle_timer_set(&timers[i].tt, tx, &timers[i]);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+stop_timers(void)
+{
+  int i;
+  for(i = 0; i < NUM_TIMERS; i++) {
+    if(trickle_timer_is_running(&timers[i].tt)) {
+      /* The current interval may still be waiting for its callback */
+      timers[i].missed = timers[i].tt.i_start != timers[i].last_start &&
+        timers[i].tt.i_start != timers[i].last_end;
+      trickle_timer_stop(&timers[i].tt);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(trickle_timing, "Trickle scheduler, timing");
+UNIT_TEST(trickle_timing)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(violations == 0);
+  for(i = 0; i < NUM_TIMERS; i++) {
+    /* One transmission per interval, up to the current one */
+    UNIT_TEST_ASSERT(timers[i].callbacks > IMAX);
+    UNIT_TEST_ASSERT(!timers[i].missed);
+    UNIT_TEST_ASSERT(timers[i].suppressed == 0);
+    UNIT_TEST_ASSERT(timers[i].tt.stats.transmissions == timers[i].callbacks);
+    UNIT_TEST_ASSERT(timers[i].tt.stats.suppressions == 0);
+  }
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(trickle_suppression, "Trickle scheduler, suppression");
+UNIT_TEST(trickle_suppression)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(violations == 0);
+  for(i = 0; i < NUM_TIMERS; i += 2) {
+    /* Suppressed in the first interval, delivered at its end */
+    UNIT_TEST_ASSERT(timers[i].suppressed == 1);
+    UNIT_TEST_ASSERT(timers[i].tt.stats.suppressions == 1);
+    UNIT_TEST_ASSERT(timers[i].tt.stats.resets == (timers[i].first_i != IMIN));
+    UNIT_TEST_ASSERT(timers[i].callbacks == timers[i].tt.stats.transmissions + 1);
+    UNIT_TEST_ASSERT(timers[i].suppressed_due == timers[i].interval_end);
+    UNIT_TEST_ASSERT(!timers[i].missed);
+  }
+  for(i = 1; i < NUM_TIMERS; i += 2) {
+    UNIT_TEST_ASSERT(timers[i].suppressed == 0);
+    UNIT_TEST_ASSERT(timers[i].tt.stats.transmissions == timers[i].callbacks);
+  }
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(trickle_stop, "Trickle scheduler, stop");
+UNIT_TEST(trickle_stop)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  for(i = 0; i < NUM_TIMERS; i++) {
+    if(i % 3 == 0) {
+      /* Stopped right after being started */
+      UNIT_TEST_ASSERT(timers[i].callbacks == 0);
+      UNIT_TEST_ASSERT(!trickle_timer_is_running(&timers[i].tt));
+    } else {
+      UNIT_TEST_ASSERT(timers[i].callbacks > 0);
+    }
+  }
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  static struct etimer et;
+  static int i;
+  static uint32_t total;
+
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  /* No suppression: every callback is a transmission */
+  start_timers(1);
+  etimer_set(&et, RUN_TIME);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  stop_timers();
+  UNIT_TEST_RUN(trickle_timing);
+
+  total = 0;
+  for(i = 0; i < NUM_TIMERS; i++) {
+    total += timers[i].callbacks;
+  }
+  printf("Benchmark: %u timers, Imin %u ticks, Imax %u: %lu callbacks in %lu ms"
+         " from one ctimer\n", NUM_TIMERS, IMIN, IMAX, (unsigned long)total,
+         (unsigned long)(RUN_TIME * 1000 / CLOCK_SECOND));
+  printf("struct trickle_timer: %u B with statistics, without its own %u B ctimer\n",
+         (unsigned)sizeof(struct trickle_timer),
+         (unsigned)sizeof(struct ctimer));
+
+  /* Every other timer hears k consistent messages in its first interval */
+  start_timers(2);
+  for(i = 0; i < NUM_TIMERS; i += 2) {
+    timers[i].first_i = timers[i].tt.i_cur;
+    trickle_timer_inconsistency(&timers[i].tt);
+    trickle_timer_consistency(&timers[i].tt);
+    trickle_timer_consistency(&timers[i].tt);
+    timers[i].interval_end = TRICKLE_TIMER_INTERVAL_END(&timers[i].tt);
+  }
+  etimer_set(&et, RUN_TIME);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  stop_timers();
+  UNIT_TEST_RUN(trickle_suppression);
+  printf("callbacks delivered at most %lu ticks after they were due\n",
+         (unsigned long)max_lateness);
+
+  /* Some timers stopped */
+  start_timers(1);
+  for(i = 0; i < NUM_TIMERS; i += 3) {
+    trickle_timer_stop(&timers[i].tt);
+  }
+  etimer_set(&et, RUN_TIME);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  stop_timers();
+  UNIT_TEST_RUN(trickle_stop);
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
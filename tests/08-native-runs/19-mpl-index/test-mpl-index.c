@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "unit-test.h"
+#include "net/ipv6/multicast/uip-mcast6.h"
+#include <stdio.h>
+#include <string.h>
+
+PROCESS(test_process, "test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define MPL_HBHO_LEN 8
+#define PAYLOAD_LEN 32
+/* Seeds 1 to 9 are used by the tests, the benchmark uses the next ones */
+#define FIRST_BENCH_SEED 10
+#define NUM_BENCH_SEEDS 64
+#define NUM_BENCH_ROUNDS 250
+
+static uip_ipaddr_t all_forwarders;
+static uip_ipaddr_t other_group;
+
+/*---------------------------------------------------------------------------*/
+void
+print_test_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Hand an MPL data message from a seed, with an S=0 seed id, to the engine */
+static uint8_t
+deliver(const uip_ipaddr_t *group, uint16_t seed, uint8_t seq)
+{
+  uint8_t *hbho = uip_buf + UIP_IPH_LEN;
+  uint16_t len = UIP_IPH_LEN + MPL_HBHO_LEN + UIP_UDPH_LEN + PAYLOAD_LEN;
+
+  uipbuf_clear();
+  memset(uip_buf, 0, len);
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->proto = UIP_PROTO_HBHO;
+  UIP_IP_BUF->ttl = 64;
+  uip_ip6addr(&UIP_IP_BUF->srcipaddr, 0xfd00, 0, 0, 0, 0x0200, 0, 0, seed);
+  uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, group);
+
+  hbho[0] = UIP_PROTO_UDP;
+  hbho[1] = 0;
+  hbho[2] = HBHO_OPT_TYPE_MPL;
+  hbho[3] = 2;
+  hbho[4] = 0;
+  hbho[5] = seq;
+  hbho[6] = UIP_EXT_HDR_OPT_PADN;
+  hbho[7] = 0;
+  memset(uip_buf + len - PAYLOAD_LEN, seq, PAYLOAD_LEN);
+
+  uipbuf_set_len(len);
+  uipbuf_set_len_field(UIP_IP_BUF, len - UIP_IPH_LEN);
+  uip_ext_len = MPL_HBHO_LEN;
+  return UIP_MCAST6.in();
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+deliver_all(uint16_t seed, uint8_t seq)
+{
+  return deliver(&all_forwarders, seed, seq);
+}
+/*---------------------------------------------------------------------------*/
+/* Seeds 1 to 8 send sequence numbers far apart, fill all buffers, and
+ * receive everything twice */
+UNIT_TEST_REGISTER(mpl_duplicates, "MPL duplicate detection");
+UNIT_TEST(mpl_duplicates)
+{
+  static const uint8_t seqs[] = { 1, 120, 50, 250 };
+  uint16_t seed;
+  uint8_t i;
+
+  UNIT_TEST_BEGIN();
+
+  for(i = 0; i < sizeof(seqs); i++) {
+    for(seed = 1; seed <= 8; seed++) {
+      UNIT_TEST_ASSERT(deliver_all(seed, seqs[i]) == UIP_MCAST6_ACCEPT);
+    }
+  }
+  for(i = 0; i < sizeof(seqs); i++) {
+    for(seed = 1; seed <= 8; seed++) {
+      UNIT_TEST_ASSERT(deliver_all(seed, seqs[i]) == UIP_MCAST6_DROP);
+    }
+  }
+  /* Older than the oldest one */
+  UNIT_TEST_ASSERT(deliver_all(1, 0) == UIP_MCAST6_DROP);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+/* Buffers are reclaimed from the seed of the oldest message, which moves
+ * the sequence number window of that seed */
+UNIT_TEST_REGISTER(mpl_reclaim, "MPL buffer reclaim");
+UNIT_TEST(mpl_reclaim)
+{
+  uint16_t seed;
+
+  UNIT_TEST_BEGIN();
+
+  /* Seeds 1 to 3 lose sequence number 1, and now start at 50 */
+  for(seed = 1; seed <= 3; seed++) {
+    UNIT_TEST_ASSERT(deliver_all(9, seed) == UIP_MCAST6_ACCEPT);
+  }
+  for(seed = 1; seed <= 3; seed++) {
+    UNIT_TEST_ASSERT(deliver_all(seed, 1) == UIP_MCAST6_DROP);
+    UNIT_TEST_ASSERT(deliver_all(seed, 50) == UIP_MCAST6_DROP);
+    UNIT_TEST_ASSERT(deliver_all(seed, 120) == UIP_MCAST6_DROP);
+    UNIT_TEST_ASSERT(deliver_all(seed, 250) == UIP_MCAST6_DROP);
+  }
+  /* Seeds 4 to 6 go next */
+  for(seed = 1; seed <= 3; seed++) {
+    UNIT_TEST_ASSERT(deliver_all(seed, 121) == UIP_MCAST6_ACCEPT);
+    UNIT_TEST_ASSERT(deliver_all(seed, 121) == UIP_MCAST6_DROP);
+  }
+  for(seed = 4; seed <= 6; seed++) {
+    UNIT_TEST_ASSERT(deliver_all(seed, 2) == UIP_MCAST6_DROP);
+  }
+  /* Seed 7 owns the oldest message, so its own message is too old once
+   * that is reclaimed, which leaves a free buffer for seed 8 */
+  UNIT_TEST_ASSERT(deliver_all(7, 2) == UIP_MCAST6_DROP);
+  UNIT_TEST_ASSERT(deliver_all(7, 50) == UIP_MCAST6_DROP);
+  UNIT_TEST_ASSERT(deliver_all(8, 2) == UIP_MCAST6_ACCEPT);
+  UNIT_TEST_ASSERT(deliver_all(8, 2) == UIP_MCAST6_DROP);
+  UNIT_TEST_ASSERT(deliver_all(8, 1) == UIP_MCAST6_DROP);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(mpl_domains, "MPL seeds in several domains");
+UNIT_TEST(mpl_domains)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(uip_ds6_maddr_add(&other_group) != NULL);
+  UNIT_TEST_ASSERT(deliver(&other_group, 1, 121) == UIP_MCAST6_ACCEPT);
+  UNIT_TEST_ASSERT(deliver(&other_group, 1, 121) == UIP_MCAST6_DROP);
+  UNIT_TEST_ASSERT(deliver(&other_group, 1, 122) == UIP_MCAST6_ACCEPT);
+  UNIT_TEST_ASSERT(deliver_all(1, 121) == UIP_MCAST6_DROP);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+/* Every seed sends a new message in turn, and each message is received
+ * twice, as from two neighbors */
+static void
+benchmark(void)
+{
+  uint16_t round;
+  uint16_t seed;
+  uint32_t accepted = 0;
+  uint32_t dropped = 0;
+  clock_time_t start, time_taken;
+
+  start = clock_time();
+  for(round = 1; round <= NUM_BENCH_ROUNDS; round++) {
+    for(seed = FIRST_BENCH_SEED; seed < FIRST_BENCH_SEED + NUM_BENCH_SEEDS; seed++) {
+      accepted += deliver_all(seed, round) == UIP_MCAST6_ACCEPT;
+      dropped += deliver_all(seed, round) == UIP_MCAST6_DROP;
+    }
+  }
+  time_taken = clock_time() - start;
+
+  printf("Benchmark: %u seeds, %u buffers, %s\n",
+         NUM_BENCH_SEEDS, MPL_BUFFERED_MESSAGE_SET_SIZE,
+         MPL_WITH_INDEX ? "indexed" : "linear");
+  printf("%lu messages in %lu ms%s\n",
+         (unsigned long)(accepted + dropped),
+         (unsigned long)(time_taken * 1000 / CLOCK_SECOND),
+         accepted == NUM_BENCH_SEEDS * NUM_BENCH_ROUNDS && dropped == accepted ?
+         "" : " =check-me= FAILED");
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  ALL_MPL_FORWARDERS(&all_forwarders, UIP_MCAST6_SCOPE_REALM_LOCAL);
+  uip_ip6addr(&other_group, 0xff05, 0, 0, 0, 0, 0, 0x0001, 0x0003);
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(mpl_duplicates);
+  UNIT_TEST_RUN(mpl_reclaim);
+  UNIT_TEST_RUN(mpl_domains);
+
+  benchmark();
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "contiki.h"
+#include "unit-test.h"
+#include "coap-engine.h"
+#include <stdio.h>
+#include <string.h>
+
+PROCESS(test_process, "test");
+AUTOSTART_PROCESSES(&test_process);
+
+/* The benchmark serves LwM2M-like object/instance/resource paths */
+#define NUM_BENCH_OBJECTS 6
+#define NUM_BENCH_RESOURCES 8
+#define NUM_BENCH_ROUNDS 2000
+#define BENCH_URL_LEN 16
+
+static void
+res_get_handler(coap_message_t *request, coap_message_t *response,
+                uint8_t *buffer, uint16_t preferred_size, int32_t *offset)
+{
+}
+
+RESOURCE(res_sensors_temp, "", res_get_handler, NULL, NULL, NULL);
+RESOURCE(res_sensors_hum, "", res_get_handler, NULL, NULL, NULL);
+RESOURCE(res_actuators, "", res_get_handler, NULL, NULL, NULL);
+PARENT_RESOURCE(res_fw, "", res_get_handler, NULL, NULL, NULL);
+RESOURCE(res_fw_state, "", res_get_handler, NULL, NULL, NULL);
+RESOURCE(res_cfg_net, "", res_get_handler, NULL, NULL, NULL);
+PARENT_RESOURCE(res_cfg, "", res_get_handler, NULL, NULL, NULL);
+
+static coap_resource_t bench_resources[NUM_BENCH_OBJECTS * NUM_BENCH_RESOURCES];
+static char bench_urls[NUM_BENCH_OBJECTS * NUM_BENCH_RESOURCES][BENCH_URL_LEN];
+
+/*---------------------------------------------------------------------------*/
+void
+print_test_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static coap_resource_t *
+lookup(const char *url)
+{
+  return coap_get_resource_by_uri(url, strlen(url));
+}
+/*---------------------------------------------------------------------------*/
+/* The resource lookup the engine used to do, as a reference */
+static coap_resource_t *
+lookup_linear(const char *url, int url_len)
+{
+  coap_resource_t *resource;
+  int res_url_len;
+
+  for(resource = coap_get_first_resource(); resource != NULL;
+      resource = coap_get_next_resource(resource)) {
+    res_url_len = strlen(resource->url);
+    if((url_len == res_url_len
+        || (url_len > res_url_len
+            && (resource->flags & HAS_SUB_RESOURCES)
+            && url[res_url_len] == '/'))
+       && strncmp(resource->url, url, res_url_len) == 0) {
+      return resource;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(coap_dispatch_exact, "CoAP dispatch of exact paths");
+UNIT_TEST(coap_dispatch_exact)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(lookup("sensors/temp") == &res_sensors_temp);
+  UNIT_TEST_ASSERT(lookup("sensors/hum") == &res_sensors_hum);
+  UNIT_TEST_ASSERT(lookup("actuators") == &res_actuators);
+  UNIT_TEST_ASSERT(lookup(".well-known/core") != NULL);
+  UNIT_TEST_ASSERT(lookup("sensors") == NULL);
+  UNIT_TEST_ASSERT(lookup("sensors/") == NULL);
+  UNIT_TEST_ASSERT(lookup("sensors/temp/1") == NULL);
+  UNIT_TEST_ASSERT(lookup("sensors/tem") == NULL);
+  UNIT_TEST_ASSERT(lookup("actuator") == NULL);
+  UNIT_TEST_ASSERT(lookup("") == NULL);
+  UNIT_TEST_ASSERT(coap_get_resource_by_uri(NULL, 0) == NULL);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(coap_dispatch_sub, "CoAP dispatch to parent resources");
+UNIT_TEST(coap_dispatch_sub)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(lookup("fw") == &res_fw);
+  UNIT_TEST_ASSERT(lookup("fw/image/1") == &res_fw);
+  UNIT_TEST_ASSERT(lookup("fw/") == &res_fw);
+  UNIT_TEST_ASSERT(lookup("fwx") == NULL);
+  /* A parent activated first shadows its sub-resources, and the other
+   * way around, as with the linear lookup */
+  UNIT_TEST_ASSERT(lookup("fw/state") == &res_fw);
+  UNIT_TEST_ASSERT(lookup("cfg/net") == &res_cfg_net);
+  UNIT_TEST_ASSERT(lookup("cfg/net/1") == &res_cfg);
+  UNIT_TEST_ASSERT(lookup("cfg/radio") == &res_cfg);
+  UNIT_TEST_ASSERT(lookup("cfg") == &res_cfg);
+  UNIT_TEST_ASSERT(lookup("sensors/temp/1") == NULL);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(coap_dispatch_activate, "CoAP dispatch after activation");
+UNIT_TEST(coap_dispatch_activate)
+{
+  static const char *urls[] = { "sensors/temp", "sensors/hum", "fw/x",
+                                "cfg/net", "cfg/x", "3303/0/5700",
+                                "3303/0", "3304/1/5700", "nothing", "" };
+  static coap_resource_t res_late = { NULL, NULL, NO_FLAGS, "",
+                                      res_get_handler, NULL, NULL, NULL,
+                                      { NULL } };
+  int i;
+  int j;
+
+  UNIT_TEST_BEGIN();
+
+  /* Resources activated after the first lookup are found as well */
+  UNIT_TEST_ASSERT(lookup("late/one") == NULL);
+  coap_activate_resource(&res_late, "late/one");
+  UNIT_TEST_ASSERT(lookup("late/one") == &res_late);
+
+  for(i = 0; i < sizeof(urls) / sizeof(urls[0]); i++) {
+    UNIT_TEST_ASSERT(lookup(urls[i]) == lookup_linear(urls[i], strlen(urls[i])));
+  }
+  for(i = 0; i < NUM_BENCH_OBJECTS * NUM_BENCH_RESOURCES; i++) {
+    UNIT_TEST_ASSERT(lookup(bench_urls[i]) == &bench_resources[i]);
+    for(j = 0; bench_urls[i][j] != '\0'; j++) {
+      UNIT_TEST_ASSERT(coap_get_resource_by_uri(bench_urls[i], j) ==
+                       lookup_linear(bench_urls[i], j));
+    }
+  }
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+static void
+benchmark(void)
+{
+  coap_resource_t *resource;
+  uint16_t round;
+  uint16_t i;
+  uint16_t count = 0;
+  uint32_t found = 0;
+  uint32_t found_linear = 0;
+  clock_time_t start, time_taken, time_taken_linear;
+
+  start = clock_time();
+  for(round = 0; round < NUM_BENCH_ROUNDS; round++) {
+    for(i = 0; i < NUM_BENCH_OBJECTS * NUM_BENCH_RESOURCES; i++) {
+      found += lookup(bench_urls[i]) == &bench_resources[i];
+    }
+  }
+  time_taken = clock_time() - start;
+
+  start = clock_time();
+  for(round = 0; round < NUM_BENCH_ROUNDS; round++) {
+    for(i = 0; i < NUM_BENCH_OBJECTS * NUM_BENCH_RESOURCES; i++) {
+      found_linear += lookup_linear(bench_urls[i], strlen(bench_urls[i])) ==
+        &bench_resources[i];
+    }
+  }
+  time_taken_linear = clock_time() - start;
+
+  for(resource = coap_get_first_resource(); resource != NULL;
+      resource = coap_get_next_resource(resource)) {
+    count++;
+  }
+  printf("Benchmark: %u resources, %u trie nodes\n",
+         count, COAP_URI_TRIE_NODES);
+  printf("%lu lookups in %lu ms, linear %lu ms%s\n",
+         (unsigned long)found,
+         (unsigned long)(time_taken * 1000 / CLOCK_SECOND),
+         (unsigned long)(time_taken_linear * 1000 / CLOCK_SECOND),
+         found == NUM_BENCH_OBJECTS * NUM_BENCH_RESOURCES * NUM_BENCH_ROUNDS
+         && found_linear == found ? "" : " =check-me= FAILED");
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  int i;
+
+  PROCESS_BEGIN();
+
+  coap_engine_init();
+  coap_activate_resource(&res_sensors_temp, "sensors/temp");
+  coap_activate_resource(&res_sensors_hum, "sensors/hum");
+  coap_activate_resource(&res_actuators, "actuators");
+  coap_activate_resource(&res_fw, "fw");
+  coap_activate_resource(&res_fw_state, "fw/state");
+  coap_activate_resource(&res_cfg_net, "cfg/net");
+  coap_activate_resource(&res_cfg, "cfg");
+  for(i = 0; i < NUM_BENCH_OBJECTS * NUM_BENCH_RESOURCES; i++) {
+    snprintf(bench_urls[i], BENCH_URL_LEN, "%u/0/%u",
+             3300 + i / NUM_BENCH_RESOURCES, 5700 + i % NUM_BENCH_RESOURCES);
+    bench_resources[i].flags = NO_FLAGS;
+    bench_resources[i].get_handler = res_get_handler;
+    coap_activate_resource(&bench_resources[i], bench_urls[i]);
+  }
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(coap_dispatch_exact);
+  UNIT_TEST_RUN(coap_dispatch_sub);
+  UNIT_TEST_RUN(coap_dispatch_activate);
+
+  benchmark();
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
@@ -0,0 +1,349 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "contiki.h"
+#include "unit-test.h"
+#include "coap-engine.h"
+#include <stdio.h>
+#include <string.h>
+
+PROCESS(test_process, "test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define NUM_OBSERVERS 60
+#define NUM_BENCH_ROUNDS 500
+
+static uint32_t handler_calls;
+static uint16_t reading;
+
+static void
+res_get_handler(coap_message_t *request, coap_message_t *response,
+                uint8_t *buffer, uint16_t preferred_size, int32_t *offset)
+{
+  handler_calls++;
+  coap_set_header_content_format(response, APPLICATION_JSON);
+  coap_set_payload(response, buffer,
+                   snprintf((char *)buffer, preferred_size,
+                            "{\"t\":%u.%u,\"u\":\"Cel\"}",
+                            reading / 10, reading % 10));
+}
+
+EVENT_RESOURCE(res_temp, "obs", res_get_handler, NULL, NULL, NULL, NULL);
+EVENT_RESOURCE(res_other, "obs", res_get_handler, NULL, NULL, NULL, NULL);
+PARENT_RESOURCE(res_tree, "obs", res_get_handler, NULL, NULL, NULL);
+
+/*---------------------------------------------------------------------------*/
+void
+print_test_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Registers an observer the way the engine does for a GET with Observe: 0.
+ * Clients sit at the unspecified address, told apart by their port, so that
+ * the IP layer drops their notifications instead of writing them to tun.
+ */
+static coap_observer_t *
+observe(coap_resource_t *resource, const char *url, uint16_t client,
+        uint8_t token_len)
+{
+  static coap_message_t request[1];
+  static coap_message_t response[1];
+  static coap_endpoint_t endpoint;
+  uint8_t token[COAP_TOKEN_LEN];
+  uint8_t i;
+  coap_observer_t *obs;
+
+  memset(&endpoint, 0, sizeof(endpoint));
+  endpoint.port = UIP_HTONS(COAP_DEFAULT_PORT + client);
+  for(i = 0; i < token_len; i++) {
+    token[i] = client + i;
+  }
+
+  coap_init_message(request, COAP_TYPE_CON, COAP_GET, client);
+  coap_set_header_uri_path(request, url);
+  coap_set_header_observe(request, 0);
+  coap_set_token(request, token, token_len);
+  coap_set_src_endpoint(request, &endpoint);
+  coap_init_message(response, COAP_TYPE_ACK, CONTENT_2_05, client);
+  coap_observe_handler(resource, request, response);
+
+  for(obs = coap_get_first_observer(); obs != NULL; obs = obs->next) {
+    if(coap_endpoint_cmp(&obs->endpoint, &endpoint)
+       && obs->token_len == token_len
+       && memcmp(obs->token, token, token_len) == 0) {
+      return obs;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+/* Drops the notifications kept for retransmission */
+static void
+clear_notifications(void)
+{
+  coap_observer_t *obs;
+  coap_transaction_t *t;
+
+  for(obs = coap_get_first_observer(); obs != NULL; obs = obs->next) {
+    if((t = coap_get_transaction_by_mid(obs->last_mid)) != NULL) {
+      coap_clear_transaction(t);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Checks the confirmable notification last sent to an observer */
+static int
+check_notification(coap_observer_t *obs, uint32_t observe)
+{
+  static coap_message_t message[1];
+  static uint8_t buf[COAP_MAX_PACKET_SIZE];
+  char expected[32];
+  coap_transaction_t *t;
+  uint32_t value;
+  const uint8_t *payload;
+  int payload_len;
+
+  t = coap_get_transaction_by_mid(obs->last_mid);
+  if(t == NULL) {
+    return 0;
+  }
+  memcpy(buf, t->message, t->message_len);
+  snprintf(expected, sizeof(expected), "{\"t\":%u.%u,\"u\":\"Cel\"}",
+           reading / 10, reading % 10);
+  payload_len = 0;
+  return coap_parse_message(message, buf, t->message_len) == NO_ERROR
+    && message->type == COAP_TYPE_CON
+    && message->code == CONTENT_2_05
+    && message->mid == obs->last_mid
+    && message->token_len == obs->token_len
+    && memcmp(message->token, obs->token, obs->token_len) == 0
+    && coap_get_header_observe(message, &value) && value == observe
+    && (payload_len = coap_get_payload(message, &payload)) == strlen(expected)
+    && memcmp(payload, expected, payload_len) == 0;
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(coap_observe_fanout, "CoAP notification fan-out");
+UNIT_TEST(coap_observe_fanout)
+{
+  static coap_observer_t *obs[NUM_OBSERVERS];
+  /* Observe sequence numbers taking 1, 2 and 3 bytes, all due for a
+   * confirmable notification */
+  static const uint32_t counters[] = { 20, 300, 65540 };
+  static const uint8_t token_lens[] = { 2, 4, 8, 0 };
+  coap_observer_t *other;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  for(i = 0; i < NUM_OBSERVERS; i++) {
+    obs[i] = observe(&res_temp, "sensors/temp", i + 1,
+                     token_lens[(i / 3) % sizeof(token_lens)]);
+    UNIT_TEST_ASSERT(obs[i] != NULL);
+    UNIT_TEST_ASSERT(obs[i]->obs_counter == 1);
+    obs[i]->obs_counter = counters[i % 3];
+  }
+  other = observe(&res_other, "sensors/hum", NUM_OBSERVERS + 1, 2);
+  UNIT_TEST_ASSERT(other != NULL);
+
+  reading = 215;
+  handler_calls = 0;
+  coap_notify_observers(&res_temp);
+
+  UNIT_TEST_ASSERT(handler_calls == 1);
+  for(i = 0; i < NUM_OBSERVERS; i++) {
+    UNIT_TEST_ASSERT(check_notification(obs[i], counters[i % 3]));
+    UNIT_TEST_ASSERT(obs[i]->obs_counter == counters[i % 3] + 1);
+  }
+  UNIT_TEST_ASSERT(other->last_mid == 0);
+  UNIT_TEST_ASSERT(other->obs_counter == 1);
+
+  clear_notifications();
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(coap_observe_sub, "CoAP notification of sub-resources");
+UNIT_TEST(coap_observe_sub)
+{
+  coap_observer_t *obs1;
+  coap_observer_t *obs2;
+  coap_observer_t *obs3;
+
+  UNIT_TEST_BEGIN();
+
+  obs1 = observe(&res_tree, "tree/1", 101, 2);
+  obs2 = observe(&res_tree, "tree/2", 102, 2);
+  obs3 = observe(&res_tree, "tree", 103, 2);
+  UNIT_TEST_ASSERT(obs1 != NULL && obs2 != NULL && obs3 != NULL);
+  obs1->obs_counter = obs2->obs_counter = obs3->obs_counter = 40;
+
+  reading = 7;
+  handler_calls = 0;
+  coap_notify_observers_sub(&res_tree, "/1");
+  UNIT_TEST_ASSERT(handler_calls == 1);
+  UNIT_TEST_ASSERT(check_notification(obs1, 40));
+  UNIT_TEST_ASSERT(obs2->obs_counter == 40);
+  UNIT_TEST_ASSERT(obs3->obs_counter == 40);
+  clear_notifications();
+
+  obs1->obs_counter = 60;
+  handler_calls = 0;
+  coap_notify_observers(&res_tree);
+  UNIT_TEST_ASSERT(handler_calls == 1);
+  UNIT_TEST_ASSERT(check_notification(obs1, 60));
+  UNIT_TEST_ASSERT(check_notification(obs2, 40));
+  UNIT_TEST_ASSERT(check_notification(obs3, 40));
+  clear_notifications();
+
+  coap_remove_observer(obs1);
+  coap_remove_observer(obs2);
+  coap_remove_observer(obs3);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+/* What notifying cost before notifications were serialized once: a
+ * handler call and a serialization per observer */
+static void
+notify_per_observer(coap_resource_t *resource)
+{
+  coap_message_t notification[1];
+  coap_message_t request[1];
+  coap_observer_t *obs;
+  coap_transaction_t *transaction;
+  int32_t new_offset;
+
+  coap_init_message(request, COAP_TYPE_CON, COAP_GET, 0);
+  coap_set_header_uri_path(request, resource->url);
+
+  for(obs = coap_get_first_observer(); obs != NULL; obs = obs->next) {
+    if(strcmp(obs->url, resource->url) != 0) {
+      continue;
+    }
+    if((transaction = coap_new_transaction(coap_get_mid(), &obs->endpoint))) {
+      coap_init_message(notification, COAP_TYPE_NON, CONTENT_2_05,
+                        transaction->mid);
+      obs->last_mid = transaction->mid;
+      new_offset = 0;
+      resource->get_handler(request, notification,
+                            transaction->message + COAP_MAX_HEADER_SIZE,
+                            COAP_MAX_CHUNK_SIZE, &new_offset);
+      coap_set_header_observe(notification, (obs->obs_counter)++);
+      obs->obs_counter &= 0xffffff;
+      coap_set_token(notification, obs->token, obs->token_len);
+      transaction->message_len =
+        coap_serialize_message(notification, transaction->message);
+      coap_send_transaction(transaction);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static clock_time_t
+benchmark_round(void (*notify)(coap_resource_t *resource))
+{
+  coap_observer_t *obs;
+  clock_time_t start;
+  uint16_t round;
+
+  /* Observe sequence numbers close to each other, as for observers
+   * registered around the same time, and the same token length */
+  for(obs = coap_get_first_observer(); obs != NULL; obs = obs->next) {
+    obs->obs_counter = 1000 + obs->token[0] % 16;
+  }
+
+  handler_calls = 0;
+  start = clock_time();
+  for(round = 0; round < NUM_BENCH_ROUNDS; round++) {
+    reading++;
+    notify(&res_temp);
+    clear_notifications();
+  }
+  return clock_time() - start;
+}
+/*---------------------------------------------------------------------------*/
+static void
+benchmark(void)
+{
+  coap_observer_t *obs;
+  clock_time_t time_taken, time_taken_per_observer;
+  uint32_t calls;
+  int observers = 0;
+
+  while((obs = coap_get_first_observer()) != NULL) {
+    coap_remove_observer(obs);
+  }
+  for(observers = 0; observers < NUM_OBSERVERS; observers++) {
+    observe(&res_temp, "sensors/temp", observers + 1, 4);
+  }
+
+  time_taken = benchmark_round(coap_notify_observers);
+  calls = handler_calls;
+  time_taken_per_observer = benchmark_round(notify_per_observer);
+
+  printf("Benchmark: %u observers, %u notifications\n",
+         observers, NUM_BENCH_ROUNDS);
+  printf("%lu us per notification, %lu handler calls; per observer %lu us, %lu handler calls%s\n",
+         (unsigned long)(time_taken * 1000000 / CLOCK_SECOND / NUM_BENCH_ROUNDS),
+         (unsigned long)calls,
+         (unsigned long)(time_taken_per_observer * 1000000 / CLOCK_SECOND / NUM_BENCH_ROUNDS),
+         (unsigned long)handler_calls,
+         calls == NUM_BENCH_ROUNDS ? "" : " =check-me= FAILED");
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  coap_engine_init();
+  coap_activate_resource(&res_temp, "sensors/temp");
+  coap_activate_resource(&res_other, "sensors/hum");
+  coap_activate_resource(&res_tree, "tree");
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(coap_observe_fanout);
+  UNIT_TEST_RUN(coap_observe_sub);
+
+  benchmark();
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "contiki.h"
+#include "unit-test.h"
+#include "coap-engine.h"
+#include "coap-cocoa.h"
+#include <stdio.h>
+#include <string.h>
+
+PROCESS(test_process, "test");
+AUTOSTART_PROCESSES(&test_process);
+
+/*---------------------------------------------------------------------------*/
+void
+print_test_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Endpoints at the unspecified address, told apart by their port, so that
+ * the IP layer drops the messages sent to them */
+static void
+endpoint(coap_endpoint_t *ep, uint16_t port)
+{
+  memset(ep, 0, sizeof(*ep));
+  ep->port = UIP_HTONS(port);
+}
+/*---------------------------------------------------------------------------*/
+static coap_transaction_t *
+send_request(const coap_endpoint_t *ep)
+{
+  static coap_message_t request[1];
+  coap_transaction_t *t;
+
+  coap_init_message(request, COAP_TYPE_CON, COAP_GET, coap_get_mid());
+  coap_set_header_uri_path(request, "test");
+  t = coap_new_transaction(request->mid, ep);
+  if(t != NULL) {
+    t->message_len = coap_serialize_message(request, t->message);
+    coap_send_transaction(t);
+  }
+  return t;
+}
+/*---------------------------------------------------------------------------*/
+/* Answers a transaction as if its response took rtt msec */
+static void
+answer(coap_transaction_t *t, uint32_t rtt, uint8_t retransmissions)
+{
+  t->first_sent = (uint32_t)coap_timer_uptime() - rtt;
+  t->retrans_counter = retransmissions;
+  coap_cocoa_response(t);
+  coap_clear_transaction(t);
+}
+/*---------------------------------------------------------------------------*/
+/* Checks that the initial timeouts are dithered between RTO and 1.5 RTO */
+static int
+check_timeouts(const coap_endpoint_t *ep, uint8_t *backoff)
+{
+  uint32_t rto = coap_cocoa_get_rto(ep);
+  uint32_t timeout;
+  int i;
+
+  for(i = 0; i < 100; i++) {
+    timeout = coap_cocoa_initial_timeout(ep, backoff);
+    if(timeout < rto || timeout > rto + rto / 2) {
+      return 0;
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(coap_cocoa_nstart, "CoAP NSTART");
+UNIT_TEST(coap_cocoa_nstart)
+{
+  coap_endpoint_t ep1;
+  coap_endpoint_t ep2;
+  coap_transaction_t *t1, *t2, *t3, *t4, *other;
+
+  UNIT_TEST_BEGIN();
+
+  endpoint(&ep1, 1001);
+  endpoint(&ep2, 1002);
+
+  t1 = send_request(&ep1);
+  t2 = send_request(&ep1);
+  t3 = send_request(&ep1);
+  t4 = send_request(&ep1);
+  other = send_request(&ep2);
+  UNIT_TEST_ASSERT(t1 && t2 && t3 && t4 && other);
+  UNIT_TEST_ASSERT(t1->in_flight && t2->in_flight && other->in_flight);
+  UNIT_TEST_ASSERT(t3->deferred && !t3->in_flight);
+  UNIT_TEST_ASSERT(t4->deferred && !t4->in_flight);
+
+  /* Answers release the queued messages in order */
+  answer(t2, 100, 0);
+  UNIT_TEST_ASSERT(t3->in_flight && !t3->deferred);
+  UNIT_TEST_ASSERT(t4->deferred);
+  answer(other, 100, 0);
+  UNIT_TEST_ASSERT(t4->deferred);
+  coap_clear_transaction(t1);
+  UNIT_TEST_ASSERT(t4->in_flight && !t4->deferred);
+
+  /* Dropping a queued message does not release another one */
+  t1 = send_request(&ep1);
+  UNIT_TEST_ASSERT(t1->deferred);
+  coap_clear_transaction(t1);
+  coap_clear_transaction(t3);
+  coap_clear_transaction(t4);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(coap_cocoa_rto, "CoAP CoCoA RTO estimation");
+UNIT_TEST(coap_cocoa_rto)
+{
+  coap_endpoint_t ep;
+  uint8_t backoff;
+  uint32_t previous;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  endpoint(&ep, 2001);
+
+  /* A new endpoint starts from the default RTO */
+  UNIT_TEST_ASSERT(coap_cocoa_get_rto(&ep) == COAP_RESPONSE_TIMEOUT_TICKS);
+  UNIT_TEST_ASSERT(check_timeouts(&ep, &backoff));
+  UNIT_TEST_ASSERT(backoff == 4);
+
+  /* Strong RTT samples: RTO = (SRTT + 4 RTTVAR + RTO) / 2 */
+  answer(send_request(&ep), 200, 0);
+  UNIT_TEST_ASSERT(coap_cocoa_get_rto(&ep) ==
+                   (200 + 4 * 100 + COAP_RESPONSE_TIMEOUT_TICKS) / 2);
+
+  /* The RTO converges towards the RTT, and backs off faster when short */
+  for(i = 0; i < 20; i++) {
+    answer(send_request(&ep), 200, 0);
+  }
+  previous = coap_cocoa_get_rto(&ep);
+  UNIT_TEST_ASSERT(previous >= 200 && previous < 300);
+  UNIT_TEST_ASSERT(check_timeouts(&ep, &backoff));
+  UNIT_TEST_ASSERT(backoff == 6);
+
+  /* Exchanges with more than two retransmissions are not sampled */
+  answer(send_request(&ep), 10000, 3);
+  UNIT_TEST_ASSERT(coap_cocoa_get_rto(&ep) == previous);
+
+  /* A weak sample, timed from the first transmission, weighs less:
+   * RTO = (SRTT + RTTVAR + 3 RTO) / 4 */
+  answer(send_request(&ep), 5000, 1);
+  UNIT_TEST_ASSERT(coap_cocoa_get_rto(&ep) == (5000 + 2500 + 3 * previous) / 4);
+  UNIT_TEST_ASSERT(check_timeouts(&ep, &backoff));
+  UNIT_TEST_ASSERT(backoff == 4);
+
+  for(i = 0; i < 10; i++) {
+    answer(send_request(&ep), 6000, 2);
+  }
+  UNIT_TEST_ASSERT(coap_cocoa_get_rto(&ep) > 3000);
+  UNIT_TEST_ASSERT(check_timeouts(&ep, &backoff));
+  UNIT_TEST_ASSERT(backoff == 3);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(coap_cocoa_endpoints, "CoAP CoCoA endpoint table");
+UNIT_TEST(coap_cocoa_endpoints)
+{
+  coap_endpoint_t ep1;
+  coap_endpoint_t ep2;
+  coap_endpoint_t ep3;
+  uint8_t backoff;
+
+  UNIT_TEST_BEGIN();
+
+  endpoint(&ep1, 3001);
+  endpoint(&ep2, 3002);
+  endpoint(&ep3, 3003);
+
+  answer(send_request(&ep1), 100, 0);
+  answer(send_request(&ep2), 100, 0);
+  UNIT_TEST_ASSERT(coap_cocoa_get_rto(&ep1) != COAP_RESPONSE_TIMEOUT_TICKS);
+  UNIT_TEST_ASSERT(coap_cocoa_get_rto(&ep2) != COAP_RESPONSE_TIMEOUT_TICKS);
+
+  /* With room for two endpoints, a third one takes over the least
+   * recently used entry */
+  coap_cocoa_initial_timeout(&ep1, &backoff);
+  coap_cocoa_initial_timeout(&ep3, &backoff);
+  UNIT_TEST_ASSERT(coap_cocoa_get_rto(&ep1) != COAP_RESPONSE_TIMEOUT_TICKS);
+  UNIT_TEST_ASSERT(coap_cocoa_get_rto(&ep2) == COAP_RESPONSE_TIMEOUT_TICKS);
+  UNIT_TEST_ASSERT(coap_cocoa_get_rto(&ep3) == COAP_RESPONSE_TIMEOUT_TICKS);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  coap_engine_init();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(coap_cocoa_nstart);
+  UNIT_TEST_RUN(coap_cocoa_rto);
+  UNIT_TEST_RUN(coap_cocoa_endpoints);
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
@@ -0,0 +1,351 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "contiki.h"
+#include "unit-test.h"
+#include "coap.h"
+#include <stdio.h>
+#include <string.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+PROCESS(test_process, "test");
+AUTOSTART_PROCESSES(&test_process);
+
+/* The benchmark is fed by the CoAP corpus of the packet injector */
+#define CORPUS_DIR "../../20-packet-parsing/packet-injector/coap-data"
+#define MAX_PACKETS 64
+#define MAX_PACKET_LEN 1024
+#define NUM_BENCH_ROUNDS 20000
+#define PATH_LEN 512
+
+static uint8_t corpus[MAX_PACKETS][MAX_PACKET_LEN];
+static uint16_t corpus_len[MAX_PACKETS];
+static unsigned corpus_count;
+
+/* coap_parse_message() writes to its input, so it parses a copy */
+static uint8_t buffer[MAX_PACKET_LEN + 1];
+
+/*---------------------------------------------------------------------------*/
+void
+print_test_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+load_corpus(void)
+{
+  DIR *dir;
+  struct dirent *entry;
+  char filename[sizeof(CORPUS_DIR) + sizeof(entry->d_name) + 1];
+  int fd;
+  int len;
+
+  dir = opendir(CORPUS_DIR);
+  if(dir == NULL) {
+    return;
+  }
+  while((entry = readdir(dir)) != NULL && corpus_count < MAX_PACKETS) {
+    if(entry->d_name[0] == '.') {
+      continue;
+    }
+    snprintf(filename, sizeof(filename), "%s/%s", CORPUS_DIR, entry->d_name);
+    fd = open(filename, O_RDONLY);
+    if(fd < 0) {
+      continue;
+    }
+    len = read(fd, corpus[corpus_count], MAX_PACKET_LEN);
+    close(fd);
+    if(len > 0) {
+      corpus_len[corpus_count++] = len;
+    }
+  }
+  closedir(dir);
+}
+/*---------------------------------------------------------------------------*/
+/* joins the instances of a repeated option, as coap_parse_message() does */
+static size_t
+join_option(const coap_message_view_t *view, unsigned int number,
+            char separator, char *out)
+{
+  coap_option_iterator_t iterator;
+  size_t len = 0;
+
+  coap_option_iterator_init(&iterator, view);
+  while(coap_option_iterator_next(&iterator)) {
+    if(iterator.number == number) {
+      if(len > 0) {
+        out[len++] = separator;
+      }
+      memcpy(out + len, iterator.value, iterator.length);
+      len += iterator.length;
+    }
+  }
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+build_message(uint8_t *out)
+{
+  coap_message_t message;
+  static char long_path[301];
+
+  memset(long_path, 'x', sizeof(long_path) - 1);
+  long_path[0] = 'a';
+  long_path[1] = '/';
+  coap_init_message(&message, COAP_TYPE_CON, COAP_GET, 0x1234);
+  coap_set_token(&message, (const uint8_t *)"\x01\x02\x03", 3);
+  coap_set_header_uri_path(&message, long_path);
+  coap_set_header_block2(&message, 3, 0, 64);
+  coap_set_header_size1(&message, 70000);
+  return coap_serialize_message(&message, out);
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(coap_parse_iterator, "Option iterator");
+UNIT_TEST(coap_parse_iterator)
+{
+  static uint8_t packet[512];
+  coap_message_view_t view;
+  coap_option_iterator_t iterator;
+  const uint8_t *value;
+  uint32_t block;
+  uint16_t len;
+
+  UNIT_TEST_BEGIN();
+
+  len = build_message(packet);
+  UNIT_TEST_ASSERT(coap_validate_message(&view, packet, len) == NO_ERROR);
+  UNIT_TEST_ASSERT(coap_view_get_type(&view) == COAP_TYPE_CON);
+  UNIT_TEST_ASSERT(coap_view_get_code(&view) == COAP_GET);
+  UNIT_TEST_ASSERT(coap_view_get_mid(&view) == 0x1234);
+  UNIT_TEST_ASSERT(coap_view_get_token(&view, &value) == 3);
+  UNIT_TEST_ASSERT(memcmp(value, "\x01\x02\x03", 3) == 0);
+
+  coap_option_iterator_init(&iterator, &view);
+  UNIT_TEST_ASSERT(coap_option_iterator_next(&iterator));
+  UNIT_TEST_ASSERT(iterator.number == COAP_OPTION_URI_PATH);
+  UNIT_TEST_ASSERT(iterator.length == 1 && iterator.value[0] == 'a');
+  UNIT_TEST_ASSERT(coap_option_iterator_next(&iterator));
+  UNIT_TEST_ASSERT(iterator.number == COAP_OPTION_URI_PATH);
+  UNIT_TEST_ASSERT(iterator.length == 298);
+  UNIT_TEST_ASSERT(coap_option_iterator_next(&iterator));
+  UNIT_TEST_ASSERT(iterator.number == COAP_OPTION_BLOCK2);
+  UNIT_TEST_ASSERT(coap_option_get_int(&iterator) == (3 << 4 | 2));
+  UNIT_TEST_ASSERT(coap_option_iterator_next(&iterator));
+  UNIT_TEST_ASSERT(iterator.number == COAP_OPTION_SIZE1);
+  UNIT_TEST_ASSERT(coap_option_get_int(&iterator) == 70000);
+  UNIT_TEST_ASSERT(!coap_option_iterator_next(&iterator));
+
+  UNIT_TEST_ASSERT(coap_view_get_int_option(&view, COAP_OPTION_BLOCK2,
+                                            &block));
+  UNIT_TEST_ASSERT(block >> 4 == 3);
+  UNIT_TEST_ASSERT(!coap_view_get_int_option(&view, COAP_OPTION_BLOCK1,
+                                             &block));
+  UNIT_TEST_ASSERT(coap_view_get_option(&view, COAP_OPTION_OBSERVE,
+                                        &value) < 0);
+
+  /* truncated messages fail validation */
+  UNIT_TEST_ASSERT(coap_validate_message(&view, packet, len - 1)
+                   == BAD_REQUEST_4_00);
+  UNIT_TEST_ASSERT(coap_validate_message(&view, packet, 6)
+                   == BAD_REQUEST_4_00);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(coap_parse_empty_last, "Empty last option");
+UNIT_TEST(coap_parse_empty_last)
+{
+  /* GET /a with Accept: text/plain, which encodes as an empty option */
+  static const uint8_t packet[] = { 0x40, 0x01, 0x00, 0x01,
+                                    0xb1, 'a', 0x60 };
+  coap_message_view_t view;
+  coap_message_t message;
+  unsigned int accept = 1;
+
+  UNIT_TEST_BEGIN();
+
+  memcpy(buffer, packet, sizeof(packet));
+  UNIT_TEST_ASSERT(coap_validate_message(&view, buffer, sizeof(packet))
+                   == NO_ERROR);
+  UNIT_TEST_ASSERT(coap_parse_message(&message, buffer, sizeof(packet))
+                   == NO_ERROR);
+  UNIT_TEST_ASSERT(coap_get_header_accept(&message, &accept));
+  UNIT_TEST_ASSERT(accept == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(coap_parse_corpus, "Corpus parse");
+UNIT_TEST(coap_parse_corpus)
+{
+  coap_message_view_t view;
+  coap_message_t message;
+  coap_status_t status;
+  const uint8_t *token;
+  static char joined[PATH_LEN];
+  size_t len;
+  uint32_t value;
+  unsigned i;
+  unsigned valid = 0;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(corpus_count > 0);
+
+  for(i = 0; i < corpus_count; i++) {
+    status = coap_validate_message(&view, corpus[i], corpus_len[i]);
+    memcpy(buffer, corpus[i], corpus_len[i]);
+    UNIT_TEST_ASSERT(coap_parse_message(&message, buffer, corpus_len[i])
+                     == status);
+    if(status != NO_ERROR) {
+      continue;
+    }
+    valid++;
+
+    UNIT_TEST_ASSERT(coap_view_get_type(&view) == message.type);
+    UNIT_TEST_ASSERT(coap_view_get_code(&view) == message.code);
+    UNIT_TEST_ASSERT(coap_view_get_mid(&view) == message.mid);
+    UNIT_TEST_ASSERT(coap_view_get_token(&view, &token) == message.token_len);
+    UNIT_TEST_ASSERT(memcmp(token, message.token, message.token_len) == 0);
+
+    len = join_option(&view, COAP_OPTION_URI_PATH, '/', joined);
+    UNIT_TEST_ASSERT(len == message.uri_path_len);
+    UNIT_TEST_ASSERT(memcmp(joined, message.uri_path, len) == 0);
+    len = join_option(&view, COAP_OPTION_URI_QUERY, '&', joined);
+    UNIT_TEST_ASSERT(len == message.uri_query_len);
+    UNIT_TEST_ASSERT(memcmp(joined, message.uri_query, len) == 0);
+
+    if(coap_view_get_int_option(&view, COAP_OPTION_BLOCK2, &value)) {
+      UNIT_TEST_ASSERT(coap_is_option(&message, COAP_OPTION_BLOCK2));
+      UNIT_TEST_ASSERT(value >> 4 == message.block2_num);
+    }
+    if(coap_view_get_int_option(&view, COAP_OPTION_CONTENT_FORMAT, &value)) {
+      UNIT_TEST_ASSERT(value == message.content_format);
+    }
+    UNIT_TEST_ASSERT(MIN(view.payload_len, COAP_MAX_CHUNK_SIZE)
+                     == message.payload_len);
+  }
+
+  /* the corpus has both valid and malformed messages */
+  UNIT_TEST_ASSERT(valid > 0 && valid < corpus_count);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+static void
+benchmark(void)
+{
+  coap_message_view_t view;
+  coap_option_iterator_t iterator;
+  coap_message_t message;
+  uint16_t round;
+  unsigned i;
+  uint32_t parsed = 0;
+  uint32_t validated = 0;
+  uint32_t bytes = 0;
+  uint32_t segments = 0;
+  clock_time_t start, time_taken, time_taken_view;
+
+  for(i = 0; i < corpus_count; i++) {
+    bytes += corpus_len[i];
+  }
+
+  start = clock_time();
+  for(round = 0; round < NUM_BENCH_ROUNDS; round++) {
+    for(i = 0; i < corpus_count; i++) {
+      memcpy(buffer, corpus[i], corpus_len[i]);
+      parsed += coap_parse_message(&message, buffer, corpus_len[i])
+        == NO_ERROR;
+    }
+  }
+  time_taken = clock_time() - start;
+
+  /* validate, then read what request dispatch needs: the path segments */
+  start = clock_time();
+  for(round = 0; round < NUM_BENCH_ROUNDS; round++) {
+    for(i = 0; i < corpus_count; i++) {
+      memcpy(buffer, corpus[i], corpus_len[i]);
+      if(coap_validate_message(&view, buffer, corpus_len[i]) != NO_ERROR) {
+        continue;
+      }
+      validated++;
+      coap_option_iterator_init(&iterator, &view);
+      while(coap_option_iterator_next(&iterator)) {
+        if(iterator.number == COAP_OPTION_URI_PATH) {
+          segments++;
+        } else if(iterator.number > COAP_OPTION_URI_PATH) {
+          break;
+        }
+      }
+    }
+  }
+  time_taken_view = clock_time() - start;
+
+  printf("Benchmark: %u messages, %lu bytes, %u B message struct, "
+         "%u B view and iterator\n",
+         corpus_count, (unsigned long)bytes, (unsigned)sizeof(message),
+         (unsigned)(sizeof(view) + sizeof(iterator)));
+  printf("%lu parsed in %lu ms, %lu validated and iterated in %lu ms%s\n",
+         (unsigned long)parsed,
+         (unsigned long)(time_taken * 1000 / CLOCK_SECOND),
+         (unsigned long)validated,
+         (unsigned long)(time_taken_view * 1000 / CLOCK_SECOND),
+         parsed == validated && segments > 0 ? "" : " =check-me= FAILED");
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  load_corpus();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(coap_parse_iterator);
+  UNIT_TEST_RUN(coap_parse_empty_last);
+  UNIT_TEST_RUN(coap_parse_corpus);
+
+  benchmark();
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
@@ -0,0 +1,581 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "unit-test.h"
+#include "coap-engine.h"
+#include "coap-block1.h"
+#include "coap-blockwise.h"
+#include "coap-callback-api.h"
+#include "cfs/cfs.h"
+#include "lib/list.h"
+#include "lib/memb.h"
+#include <stdio.h>
+#include <string.h>
+
+PROCESS(test_process, "test");
+AUTOSTART_PROCESSES(&test_process);
+
+/*
+ * The engine is both client and server. Messages to the peer address go
+ * through a simulated path and come back as if sent by the peer.
+ */
+#define PATH_LATENCY 20    /* one-way, in msec */
+#define PATH_RATE    250   /* kbit/s, shared by both directions */
+#define MAX_FRAMES   16
+
+#define BIG_SIZE     65536
+#define SMALL_SIZE   250
+#define UPLOAD_SIZE  8192
+#define FILENAME     "blockwise.bin"
+
+struct frame {
+  struct frame *next;
+  clock_time_t arrival;
+  uint16_t len;
+  uint8_t data[COAP_MAX_PACKET_SIZE];
+};
+MEMB(frame_memb, struct frame, MAX_FRAMES);
+LIST(frame_list);
+
+static struct ctimer delivery_timer;
+static clock_time_t channel_free;
+static coap_endpoint_t peer;
+static uint32_t frames_sent;
+static uint32_t frames_dropped;
+/* frames to drop, counted from 1 */
+static uint32_t drop_frames[2];
+/* how to break the Block2 option of responses to blocks after the first */
+#define MANGLE_NONE      0
+#define MANGLE_NO_BLOCK2 1
+#define MANGLE_LARGER    2
+static uint8_t mangle;
+
+static uint8_t small_data[SMALL_SIZE];
+static uint8_t upload_data[UPLOAD_SIZE];
+static size_t upload_len;
+
+static coap_blockwise_state_t transfer;
+static coap_callback_request_state_t callback_state;
+static coap_message_t request[1];
+static uint8_t buffer[BIG_SIZE + COAP_MAX_BLOCK_SIZE];
+static size_t received;
+static uint8_t transfer_done;
+
+/*---------------------------------------------------------------------------*/
+void
+print_test_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+content_byte(uint32_t i)
+{
+  return (uint8_t)(i * 7 + (i >> 8));
+}
+/*---------------------------------------------------------------------------*/
+static int
+check_content(const uint8_t *data, size_t len)
+{
+  size_t i;
+
+  for(i = 0; i < len; i++) {
+    if(data[i] != content_byte(i)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+static void deliver(void *ptr);
+/*---------------------------------------------------------------------------*/
+static void
+schedule_delivery(void)
+{
+  struct frame *f = list_head(frame_list);
+  clock_time_t now = clock_time();
+
+  if(f != NULL) {
+    ctimer_set(&delivery_timer, f->arrival > now ? f->arrival - now : 0,
+               deliver, NULL);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+deliver(void *ptr)
+{
+  static uint8_t data[COAP_MAX_PACKET_SIZE];
+  struct frame *f = list_head(frame_list);
+  uint16_t len;
+
+  if(f == NULL || f->arrival > clock_time()) {
+    schedule_delivery();
+    return;
+  }
+  list_remove(frame_list, f);
+  len = f->len;
+  memcpy(data, f->data, len);
+  memb_free(&frame_memb, f);
+
+  coap_receive(&peer, data, len);
+  schedule_delivery();
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+mangle_response(uint8_t *data, uint16_t len)
+{
+  static coap_message_t message[1];
+  static uint8_t copy[COAP_MAX_PACKET_SIZE];
+  uint32_t num;
+  uint16_t size;
+  uint8_t more;
+
+  /* parsing works in place, keep the original intact */
+  memcpy(copy, data, len);
+  if(coap_parse_message(message, copy, len) != NO_ERROR ||
+     message->code < CREATED_2_01 || message->code >= BAD_REQUEST_4_00 ||
+     !coap_get_header_block2(message, &num, &more, &size, NULL) ||
+     num == 0) {
+    return len;
+  }
+
+  if(mangle == MANGLE_NO_BLOCK2) {
+    message->options[COAP_OPTION_BLOCK2 / COAP_OPTION_MAP_SIZE] &=
+      ~(1 << (COAP_OPTION_BLOCK2 % COAP_OPTION_MAP_SIZE));
+  } else {
+    coap_set_header_block2(message, num, more, size * 2);
+  }
+  return coap_serialize_message(message, data);
+}
+/*---------------------------------------------------------------------------*/
+/* Queue the UDP payload of packets to the peer, drop all packets */
+static enum netstack_ip_action
+path_output(const linkaddr_t *localdest)
+{
+  struct frame *f;
+  clock_time_t now = clock_time();
+
+  if(UIP_IP_BUF->proto != UIP_PROTO_UDP ||
+     !uip_ipaddr_cmp(&UIP_IP_BUF->destipaddr, &peer.ipaddr)) {
+    return NETSTACK_IP_DROP;
+  }
+
+  frames_sent++;
+  if(frames_sent == drop_frames[0] || frames_sent == drop_frames[1] ||
+     (f = memb_alloc(&frame_memb)) == NULL) {
+    frames_dropped++;
+    return NETSTACK_IP_DROP;
+  }
+
+  f->len = uip_len - UIP_IPUDPH_LEN;
+  memcpy(f->data, uip_buf + UIP_IPUDPH_LEN, f->len);
+  if(mangle != MANGLE_NONE) {
+    f->len = mangle_response(f->data, f->len);
+  }
+  channel_free = MAX(channel_free, now) + uip_len * 8 / PATH_RATE;
+  f->arrival = channel_free + PATH_LATENCY;
+  list_add(frame_list, f);
+  if(list_head(frame_list) == f) {
+    schedule_delivery();
+  }
+  return NETSTACK_IP_DROP;
+}
+static struct netstack_ip_packet_processor path = {
+  .process_output = path_output
+};
+/*---------------------------------------------------------------------------*/
+static void
+setup_path(void)
+{
+  uip_lladdr_t lladdr;
+
+  memset(&lladdr, 0, sizeof(lladdr));
+  lladdr.addr[0] = 0x02;
+  lladdr.addr[sizeof(lladdr) - 1] = 0x02;
+  memset(&peer, 0, sizeof(peer));
+  uip_ip6addr(&peer.ipaddr, 0xfe80, 0, 0, 0, 0, 0, 0, 0);
+  uip_ds6_set_addr_iid(&peer.ipaddr, &lladdr);
+  peer.port = UIP_HTONS(COAP_DEFAULT_PORT);
+  uip_ds6_nbr_add(&peer.ipaddr, &lladdr, 0, NBR_REACHABLE,
+                  NBR_TABLE_REASON_IPV6_ND, NULL);
+  netstack_ip_packet_processor_add(&path);
+}
+/*---------------------------------------------------------------------------*/
+/* A chunk-wise resource, too large for the message buffers */
+static void
+big_get_handler(coap_message_t *request, coap_message_t *response,
+                uint8_t *buffer, uint16_t preferred_size, int32_t *offset)
+{
+  uint16_t len;
+  uint16_t i;
+
+  if(*offset >= BIG_SIZE) {
+    coap_set_status_code(response, BAD_OPTION_4_02);
+    coap_set_payload(response, "BlockOutOfScope", 15);
+    return;
+  }
+  len = MIN(preferred_size, BIG_SIZE - *offset);
+  for(i = 0; i < len; i++) {
+    buffer[i] = content_byte(*offset + i);
+  }
+  coap_set_payload(response, buffer, len);
+  *offset += len;
+  if(*offset >= BIG_SIZE) {
+    *offset = -1;
+  }
+}
+RESOURCE(res_big, "", big_get_handler, NULL, NULL, NULL);
+/*---------------------------------------------------------------------------*/
+/* A resource unaware of blocks: the engine cuts them */
+static void
+small_get_handler(coap_message_t *request, coap_message_t *response,
+                  uint8_t *buffer, uint16_t preferred_size, int32_t *offset)
+{
+  coap_set_payload(response, small_data, SMALL_SIZE);
+}
+RESOURCE(res_small, "", small_get_handler, NULL, NULL, NULL);
+/*---------------------------------------------------------------------------*/
+static void
+upload_put_handler(coap_message_t *request, coap_message_t *response,
+                   uint8_t *buffer, uint16_t preferred_size, int32_t *offset)
+{
+  if(coap_block1_handler(request, response, upload_data, &upload_len,
+                         UPLOAD_SIZE) == 0) {
+    coap_set_status_code(response, CHANGED_2_04);
+  }
+}
+RESOURCE(res_upload, "", NULL, NULL, upload_put_handler, NULL);
+/*---------------------------------------------------------------------------*/
+static void
+transfer_callback(coap_blockwise_state_t *state)
+{
+  transfer_done = 1;
+  process_poll(&test_process);
+}
+/*---------------------------------------------------------------------------*/
+static int
+start_get(const char *uri, uint8_t window, uint16_t block_size)
+{
+  transfer_done = 0;
+  memset(buffer, 0, sizeof(buffer));
+  coap_blockwise_init(&transfer, window, block_size);
+  coap_init_message(request, COAP_TYPE_CON, COAP_GET, 0);
+  coap_set_header_uri_path(request, uri);
+  return coap_blockwise_get(&transfer, &peer, request, buffer, BIG_SIZE,
+                            transfer_callback);
+}
+/*---------------------------------------------------------------------------*/
+static int
+start_put(const uint8_t *data, size_t length, uint8_t window,
+          uint16_t block_size)
+{
+  transfer_done = 0;
+  upload_len = 0;
+  memset(upload_data, 0, sizeof(upload_data));
+  coap_blockwise_init(&transfer, window, block_size);
+  coap_init_message(request, COAP_TYPE_CON, COAP_PUT, 0);
+  coap_set_header_uri_path(request, "upload");
+  return coap_blockwise_put(&transfer, &peer, request, data, length,
+                            transfer_callback);
+}
+/*---------------------------------------------------------------------------*/
+static void
+callback_api_callback(coap_callback_request_state_t *callback_state)
+{
+  coap_request_state_t *state = &callback_state->state;
+  uint32_t offset = 0;
+
+  if(state->status == COAP_REQUEST_STATUS_MORE ||
+     state->status == COAP_REQUEST_STATUS_RESPONSE) {
+    coap_get_header_block2(state->response, NULL, NULL, NULL, &offset);
+    if(offset + state->response->payload_len <= BIG_SIZE) {
+      memcpy(buffer + offset, state->response->payload,
+             state->response->payload_len);
+      received = MAX(received, offset + state->response->payload_len);
+    }
+  }
+  if(state->status != COAP_REQUEST_STATUS_MORE &&
+     state->status != COAP_REQUEST_STATUS_RESPONSE) {
+    transfer_done = 1;
+    process_poll(&test_process);
+  }
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(blockwise_get,
+                   "Pipelined Block2 transfer of a block-unaware resource");
+UNIT_TEST(blockwise_get)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(transfer.status == COAP_REQUEST_STATUS_FINISHED);
+  UNIT_TEST_ASSERT(transfer.response_code == CONTENT_2_05);
+  UNIT_TEST_ASSERT(transfer.length == SMALL_SIZE);
+  UNIT_TEST_ASSERT(check_content(buffer, SMALL_SIZE));
+  UNIT_TEST_ASSERT(transfer.outstanding == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(blockwise_get_lossy,
+                   "Block2 transfer with a lost request and response");
+UNIT_TEST(blockwise_get_lossy)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(frames_dropped == 2);
+  UNIT_TEST_ASSERT(transfer.status == COAP_REQUEST_STATUS_FINISHED);
+  UNIT_TEST_ASSERT(transfer.length == SMALL_SIZE);
+  UNIT_TEST_ASSERT(check_content(buffer, SMALL_SIZE));
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(blockwise_not_found, "Block2 transfer of a missing resource");
+UNIT_TEST(blockwise_not_found)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(transfer.status == COAP_REQUEST_STATUS_RESPONSE);
+  UNIT_TEST_ASSERT(transfer.response_code == NOT_FOUND_4_04);
+  UNIT_TEST_ASSERT(transfer.length == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(blockwise_no_block2,
+                   "Block2 transfer with a later block missing its option");
+UNIT_TEST(blockwise_no_block2)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(transfer.status == COAP_REQUEST_STATUS_BLOCK_ERROR);
+  UNIT_TEST_ASSERT(transfer.response_code == CONTENT_2_05);
+  UNIT_TEST_ASSERT(transfer.outstanding == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(blockwise_larger_block,
+                   "Block2 transfer with a block larger than requested");
+UNIT_TEST(blockwise_larger_block)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(transfer.status == COAP_REQUEST_STATUS_BLOCK_ERROR);
+  UNIT_TEST_ASSERT(transfer.response_code == CONTENT_2_05);
+  UNIT_TEST_ASSERT(transfer.outstanding == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(blockwise_put, "Pipelined Block1 transfer");
+UNIT_TEST(blockwise_put)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(transfer.status == COAP_REQUEST_STATUS_FINISHED);
+  UNIT_TEST_ASSERT(transfer.response_code == CHANGED_2_04);
+  UNIT_TEST_ASSERT(upload_len == UPLOAD_SIZE);
+  UNIT_TEST_ASSERT(check_content(upload_data, UPLOAD_SIZE));
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(blockwise_put_too_large, "Block1 transfer refused by 4.13");
+UNIT_TEST(blockwise_put_too_large)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(transfer.status == COAP_REQUEST_STATUS_RESPONSE);
+  UNIT_TEST_ASSERT(transfer.response_code == REQUEST_ENTITY_TOO_LARGE_4_13);
+  UNIT_TEST_ASSERT(transfer.outstanding == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(blockwise_file, "Block2 into and Block1 from a CFS file");
+UNIT_TEST(blockwise_file)
+{
+  int fd;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(transfer.status == COAP_REQUEST_STATUS_FINISHED);
+  UNIT_TEST_ASSERT(upload_len == SMALL_SIZE);
+  UNIT_TEST_ASSERT(check_content(upload_data, SMALL_SIZE));
+
+  fd = cfs_open(FILENAME, CFS_READ);
+  UNIT_TEST_ASSERT(fd >= 0);
+  UNIT_TEST_ASSERT(cfs_read(fd, buffer, sizeof(buffer)) == SMALL_SIZE);
+  cfs_close(fd);
+  UNIT_TEST_ASSERT(check_content(buffer, SMALL_SIZE));
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  static const uint8_t windows[] = { 1, 4, 8 };
+  static clock_time_t times[sizeof(windows)];
+  static clock_time_t time_callback_api;
+  static clock_time_t start;
+  static uint8_t ok;
+  static uint8_t i;
+  static int fd;
+  uint16_t j;
+
+  PROCESS_BEGIN();
+
+  coap_engine_init();
+  coap_activate_resource(&res_big, "big");
+  coap_activate_resource(&res_small, "small");
+  coap_activate_resource(&res_upload, "upload");
+  setup_path();
+  for(j = 0; j < SMALL_SIZE; j++) {
+    small_data[j] = content_byte(j);
+  }
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  start_get("small", 4, 32);
+  PROCESS_WAIT_EVENT_UNTIL(transfer_done);
+  UNIT_TEST_RUN(blockwise_get);
+
+  frames_sent = 0;
+  frames_dropped = 0;
+  drop_frames[0] = 2;
+  drop_frames[1] = 7;
+  start_get("small", 4, 32);
+  PROCESS_WAIT_EVENT_UNTIL(transfer_done);
+  drop_frames[0] = drop_frames[1] = 0;
+  UNIT_TEST_RUN(blockwise_get_lossy);
+
+  start_get("missing", 4, 64);
+  PROCESS_WAIT_EVENT_UNTIL(transfer_done);
+  UNIT_TEST_RUN(blockwise_not_found);
+
+  mangle = MANGLE_NO_BLOCK2;
+  start_get("small", 4, 32);
+  PROCESS_WAIT_EVENT_UNTIL(transfer_done);
+  mangle = MANGLE_NONE;
+  UNIT_TEST_RUN(blockwise_no_block2);
+
+  mangle = MANGLE_LARGER;
+  start_get("small", 4, 32);
+  PROCESS_WAIT_EVENT_UNTIL(transfer_done);
+  mangle = MANGLE_NONE;
+  UNIT_TEST_RUN(blockwise_larger_block);
+
+  for(j = 0; j < UPLOAD_SIZE + 256; j++) {
+    buffer[j] = content_byte(j);
+  }
+  start_put(buffer, UPLOAD_SIZE, 4, 256);
+  PROCESS_WAIT_EVENT_UNTIL(transfer_done);
+  UNIT_TEST_RUN(blockwise_put);
+
+  start_put(buffer, UPLOAD_SIZE + 256, 4, 256);
+  PROCESS_WAIT_EVENT_UNTIL(transfer_done);
+  UNIT_TEST_RUN(blockwise_put_too_large);
+
+  /* fetch into a file, then send the file back */
+  fd = cfs_open(FILENAME, CFS_WRITE);
+  transfer_done = 0;
+  coap_blockwise_init(&transfer, 4, 32);
+  coap_init_message(request, COAP_TYPE_CON, COAP_GET, 0);
+  coap_set_header_uri_path(request, "small");
+  coap_blockwise_get_file(&transfer, &peer, request, fd, transfer_callback);
+  PROCESS_WAIT_EVENT_UNTIL(transfer_done);
+  cfs_close(fd);
+  if(transfer.status == COAP_REQUEST_STATUS_FINISHED) {
+    fd = cfs_open(FILENAME, CFS_READ);
+    transfer_done = 0;
+    upload_len = 0;
+    coap_blockwise_init(&transfer, 4, 32);
+    coap_init_message(request, COAP_TYPE_CON, COAP_PUT, 0);
+    coap_set_header_uri_path(request, "upload");
+    coap_blockwise_put_file(&transfer, &peer, request, fd, SMALL_SIZE,
+                            transfer_callback);
+    PROCESS_WAIT_EVENT_UNTIL(transfer_done);
+    cfs_close(fd);
+  }
+  UNIT_TEST_RUN(blockwise_file);
+  cfs_remove(FILENAME);
+
+  /* 64 KiB, one block per round trip with the callback API */
+  ok = 1;
+  transfer_done = 0;
+  received = 0;
+  memset(buffer, 0, sizeof(buffer));
+  coap_init_message(request, COAP_TYPE_CON, COAP_GET, 0);
+  coap_set_header_uri_path(request, "big");
+  start = clock_time();
+  coap_send_request(&callback_state, &peer, request, callback_api_callback);
+  PROCESS_WAIT_EVENT_UNTIL(transfer_done);
+  time_callback_api = clock_time() - start;
+  if(callback_state.state.status != COAP_REQUEST_STATUS_FINISHED ||
+     received != BIG_SIZE || !check_content(buffer, BIG_SIZE)) {
+    ok = 0;
+  }
+
+  for(i = 0; i < sizeof(windows); i++) {
+    start = clock_time();
+    start_get("big", windows[i], COAP_MAX_BLOCK_SIZE);
+    PROCESS_WAIT_EVENT_UNTIL(transfer_done);
+    times[i] = clock_time() - start;
+    if(transfer.status != COAP_REQUEST_STATUS_FINISHED ||
+       transfer.length != BIG_SIZE || !check_content(buffer, BIG_SIZE)) {
+      ok = 0;
+    }
+  }
+
+  printf("Benchmark: %u bytes in %u B blocks, %u ms one-way latency, "
+         "%u kbit/s\n", BIG_SIZE, COAP_MAX_BLOCK_SIZE, PATH_LATENCY,
+         PATH_RATE);
+  printf("callback API %lu ms, window %u %lu ms, window %u %lu ms, "
+         "window %u %lu ms%s\n",
+         (unsigned long)(time_callback_api * 1000 / CLOCK_SECOND),
+         windows[0], (unsigned long)(times[0] * 1000 / CLOCK_SECOND),
+         windows[1], (unsigned long)(times[1] * 1000 / CLOCK_SECOND),
+         windows[2], (unsigned long)(times[2] * 1000 / CLOCK_SECOND),
+         ok && times[1] < times[0] ? "" : " =check-me= FAILED");
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
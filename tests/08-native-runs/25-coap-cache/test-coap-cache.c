@@ -0,0 +1,486 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "unit-test.h"
+#include "coap-engine.h"
+#include "coap-cache.h"
+#include <stdio.h>
+#include <string.h>
+
+PROCESS(test_process, "test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define NUM_BENCH_REQUESTS 20000
+
+static const uint8_t etag[] = { 0xde, 0xad, 0xbe, 0xef };
+
+static coap_endpoint_t client;
+static uint8_t response[COAP_MAX_PACKET_SIZE];
+static uint16_t response_len;
+static uint16_t next_mid = 1;
+static unsigned info_calls;
+static unsigned counter_calls;
+static unsigned short_calls;
+
+/*---------------------------------------------------------------------------*/
+void
+print_test_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Record the CoAP payload of packets sent to the client and drop them */
+static enum netstack_ip_action
+capture_output(const linkaddr_t *localdest)
+{
+  if(UIP_IP_BUF->proto == UIP_PROTO_UDP &&
+     uip_ipaddr_cmp(&UIP_IP_BUF->destipaddr, &client.ipaddr)) {
+    response_len = uip_len - UIP_IPUDPH_LEN;
+    memcpy(response, uip_buf + UIP_IPUDPH_LEN, response_len);
+  }
+  return NETSTACK_IP_DROP;
+}
+static struct netstack_ip_packet_processor capture = {
+  .process_output = capture_output
+};
+/*---------------------------------------------------------------------------*/
+static void
+setup_client(void)
+{
+  uip_lladdr_t lladdr;
+
+  memset(&lladdr, 0, sizeof(lladdr));
+  lladdr.addr[0] = 0x02;
+  lladdr.addr[sizeof(lladdr) - 1] = 0x02;
+  memset(&client, 0, sizeof(client));
+  uip_ip6addr(&client.ipaddr, 0xfe80, 0, 0, 0, 0, 0, 0, 0);
+  uip_ds6_set_addr_iid(&client.ipaddr, &lladdr);
+  client.port = UIP_HTONS(COAP_DEFAULT_PORT);
+  uip_ds6_nbr_add(&client.ipaddr, &lladdr, 0, NBR_REACHABLE,
+                  NBR_TABLE_REASON_IPV6_ND, NULL);
+  netstack_ip_packet_processor_add(&capture);
+}
+/*---------------------------------------------------------------------------*/
+/* Renders a device description, the kind of response worth caching */
+static int
+render_info(uint8_t *buffer, uint16_t size)
+{
+  int len;
+  int i;
+
+  len = snprintf((char *)buffer, size, "{\"model\":\"native\",\"sensors\":[");
+  for(i = 0; i < 8 && len < size; i++) {
+    len += snprintf((char *)buffer + len, size - len, "%s{\"id\":%d,\"t\":%d}",
+                    i > 0 ? "," : "", i, 20 + i);
+  }
+  if(len < size) {
+    len += snprintf((char *)buffer + len, size - len, "]}");
+  }
+  return MIN(len, size);
+}
+/*---------------------------------------------------------------------------*/
+static void
+info_get_handler(coap_message_t *request, coap_message_t *response,
+                 uint8_t *buffer, uint16_t preferred_size, int32_t *offset)
+{
+  info_calls++;
+  coap_set_header_content_format(response, APPLICATION_JSON);
+  coap_set_header_max_age(response, 30);
+  coap_set_header_etag(response, etag, sizeof(etag));
+  coap_set_payload(response, buffer, render_info(buffer, preferred_size));
+}
+static void
+info_put_handler(coap_message_t *request, coap_message_t *response,
+                 uint8_t *buffer, uint16_t preferred_size, int32_t *offset)
+{
+  coap_set_status_code(response, CHANGED_2_04);
+}
+RESOURCE(res_info, "", info_get_handler, NULL, info_put_handler, NULL);
+/*---------------------------------------------------------------------------*/
+/* The same representation, without freshness lifetime */
+static void
+sensor_get_handler(coap_message_t *request, coap_message_t *response,
+                   uint8_t *buffer, uint16_t preferred_size, int32_t *offset)
+{
+  coap_set_header_content_format(response, APPLICATION_JSON);
+  coap_set_payload(response, buffer, render_info(buffer, preferred_size));
+}
+RESOURCE(res_sensor, "", sensor_get_handler, NULL, NULL, NULL);
+/*---------------------------------------------------------------------------*/
+static void
+short_get_handler(coap_message_t *request, coap_message_t *response,
+                  uint8_t *buffer, uint16_t preferred_size, int32_t *offset)
+{
+  short_calls++;
+  coap_set_header_max_age(response, 1);
+  coap_set_payload(response, "short", 5);
+}
+RESOURCE(res_short, "", short_get_handler, NULL, NULL, NULL);
+/*---------------------------------------------------------------------------*/
+static void
+counter_post_handler(coap_message_t *request, coap_message_t *response,
+                     uint8_t *buffer, uint16_t preferred_size, int32_t *offset)
+{
+  counter_calls++;
+  coap_set_status_code(response, CHANGED_2_04);
+  coap_set_payload(response, buffer,
+                   snprintf((char *)buffer, preferred_size, "%u",
+                            counter_calls));
+}
+RESOURCE(res_counter, "", NULL, counter_post_handler, NULL, NULL);
+RESOURCE(res_extra, "", short_get_handler, NULL, NULL, NULL);
+/*---------------------------------------------------------------------------*/
+/* Sends a request to the engine, returns the parsed response */
+static int
+request(coap_message_type_t type, coap_method_t method, uint16_t mid,
+        const char *uri, const uint8_t *request_etag,
+        coap_message_view_t *view)
+{
+  static uint8_t buffer[COAP_MAX_PACKET_SIZE];
+  coap_message_t message[1];
+  char path[32];
+  const char *query;
+  uint8_t token[2];
+  uint16_t len;
+
+  token[0] = mid >> 8;
+  token[1] = mid;
+  coap_init_message(message, type, method, mid);
+  coap_set_token(message, token, sizeof(token));
+  query = strchr(uri, '?');
+  len = query != NULL ? query - uri : strlen(uri);
+  memcpy(path, uri, len);
+  path[len] = '\0';
+  coap_set_header_uri_path(message, path);
+  if(query != NULL) {
+    coap_set_header_uri_query(message, query + 1);
+  }
+  if(request_etag != NULL) {
+    coap_set_header_etag(message, request_etag, sizeof(etag));
+  }
+  len = coap_serialize_message(message, buffer);
+
+  response_len = 0;
+  coap_receive(&client, buffer, len);
+  return response_len > 0 &&
+    coap_validate_message(view, response, response_len) == NO_ERROR;
+}
+/*---------------------------------------------------------------------------*/
+static int
+get(const char *uri, coap_message_view_t *view)
+{
+  return request(COAP_TYPE_CON, COAP_GET, next_mid++, uri, NULL, view);
+}
+/*---------------------------------------------------------------------------*/
+/* GET with a Uri-Path and Uri-Query that may contain any '?' */
+static int
+get_path(const char *path, const char *query, coap_message_view_t *view)
+{
+  static uint8_t buffer[COAP_MAX_PACKET_SIZE];
+  coap_message_t message[1];
+  uint16_t len;
+
+  coap_init_message(message, COAP_TYPE_CON, COAP_GET, next_mid++);
+  coap_set_header_uri_path(message, path);
+  coap_set_header_uri_query(message, query);
+  len = coap_serialize_message(message, buffer);
+
+  response_len = 0;
+  coap_receive(&client, buffer, len);
+  return response_len > 0 &&
+    coap_validate_message(view, response, response_len) == NO_ERROR;
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(cache_hit, "Repeated GET answered from the cache");
+UNIT_TEST(cache_hit)
+{
+  coap_message_view_t view;
+  const coap_cache_stats_t *stats = coap_cache_get_stats();
+  const uint8_t *token;
+  const uint8_t *value;
+  uint8_t payload[COAP_MAX_CHUNK_SIZE];
+  uint16_t payload_len;
+  uint32_t max_age;
+  uint16_t mid;
+
+  UNIT_TEST_BEGIN();
+
+  coap_cache_reset_stats();
+  info_calls = 0;
+  UNIT_TEST_ASSERT(get("info", &view));
+  UNIT_TEST_ASSERT(coap_view_get_code(&view) == CONTENT_2_05);
+  payload_len = view.payload_len;
+  memcpy(payload, view.payload, payload_len);
+
+  mid = next_mid;
+  UNIT_TEST_ASSERT(get("info", &view));
+  UNIT_TEST_ASSERT(info_calls == 1);
+  UNIT_TEST_ASSERT(stats->stores == 1 && stats->hits == 1);
+  UNIT_TEST_ASSERT(stats->misses == 1);
+
+  /* headers of the new request, options and payload of the cached one */
+  UNIT_TEST_ASSERT(coap_view_get_type(&view) == COAP_TYPE_ACK);
+  UNIT_TEST_ASSERT(coap_view_get_mid(&view) == mid);
+  UNIT_TEST_ASSERT(coap_view_get_token(&view, &token) == 2);
+  UNIT_TEST_ASSERT(token[0] == mid >> 8 && token[1] == (mid & 0xff));
+  UNIT_TEST_ASSERT(coap_view_get_code(&view) == CONTENT_2_05);
+  UNIT_TEST_ASSERT(view.payload_len == payload_len);
+  UNIT_TEST_ASSERT(memcmp(view.payload, payload, payload_len) == 0);
+  UNIT_TEST_ASSERT(coap_view_get_option(&view, COAP_OPTION_ETAG, &value)
+                   == sizeof(etag));
+  UNIT_TEST_ASSERT(memcmp(value, etag, sizeof(etag)) == 0);
+  UNIT_TEST_ASSERT(coap_view_get_int_option(&view, COAP_OPTION_MAX_AGE,
+                                            &max_age));
+  UNIT_TEST_ASSERT(max_age > 0 && max_age <= 30);
+  UNIT_TEST_ASSERT(coap_view_get_int_option(&view,
+                                            COAP_OPTION_CONTENT_FORMAT,
+                                            &max_age));
+  UNIT_TEST_ASSERT(max_age == APPLICATION_JSON);
+
+  /* a NON request gets a NON response */
+  UNIT_TEST_ASSERT(request(COAP_TYPE_NON, COAP_GET, next_mid++, "info", NULL,
+                           &view));
+  UNIT_TEST_ASSERT(coap_view_get_type(&view) == COAP_TYPE_NON);
+  UNIT_TEST_ASSERT(info_calls == 1);
+
+  /* another query is another representation */
+  UNIT_TEST_ASSERT(get("info?x=1", &view));
+  UNIT_TEST_ASSERT(info_calls == 2);
+
+  /* a '?' in the path does not move the query boundary */
+  UNIT_TEST_ASSERT(get_path("info", "x?y", &view));
+  UNIT_TEST_ASSERT(info_calls == 3);
+  UNIT_TEST_ASSERT(get_path("info?x", "y", &view));
+  UNIT_TEST_ASSERT(coap_view_get_code(&view) == NOT_FOUND_4_04);
+  UNIT_TEST_ASSERT(info_calls == 3);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(cache_validate, "GET with a current ETag gets 2.03 Valid");
+UNIT_TEST(cache_validate)
+{
+  static const uint8_t other_etag[] = { 1, 2, 3, 4 };
+  coap_message_view_t view;
+  const uint8_t *value;
+  uint32_t max_age;
+
+  UNIT_TEST_BEGIN();
+
+  info_calls = 0;
+  UNIT_TEST_ASSERT(request(COAP_TYPE_CON, COAP_GET, next_mid++, "info", etag,
+                           &view));
+  UNIT_TEST_ASSERT(info_calls == 0);
+  UNIT_TEST_ASSERT(coap_view_get_code(&view) == VALID_2_03);
+  UNIT_TEST_ASSERT(view.payload_len == 0);
+  UNIT_TEST_ASSERT(coap_view_get_option(&view, COAP_OPTION_ETAG, &value)
+                   == sizeof(etag));
+  UNIT_TEST_ASSERT(coap_view_get_int_option(&view, COAP_OPTION_MAX_AGE,
+                                            &max_age));
+  UNIT_TEST_ASSERT(max_age > 0 && max_age <= 30);
+  UNIT_TEST_ASSERT(coap_cache_get_stats()->validations == 1);
+
+  UNIT_TEST_ASSERT(request(COAP_TYPE_CON, COAP_GET, next_mid++, "info",
+                           other_etag, &view));
+  UNIT_TEST_ASSERT(coap_view_get_code(&view) == CONTENT_2_05);
+  UNIT_TEST_ASSERT(view.payload_len > 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(cache_invalidate, "Explicit and PUT invalidation");
+UNIT_TEST(cache_invalidate)
+{
+  coap_message_view_t view;
+  uint16_t len;
+
+  UNIT_TEST_BEGIN();
+
+  coap_cache_reset_stats();
+  info_calls = 0;
+  UNIT_TEST_ASSERT(get("info", &view));
+  UNIT_TEST_ASSERT(info_calls == 0);
+
+  coap_cache_invalidate(&res_info);
+  UNIT_TEST_ASSERT(get("info", &view));
+  UNIT_TEST_ASSERT(info_calls == 1);
+  UNIT_TEST_ASSERT(get("info", &view));
+  UNIT_TEST_ASSERT(info_calls == 1);
+
+  UNIT_TEST_ASSERT(request(COAP_TYPE_CON, COAP_PUT, next_mid++, "info", NULL,
+                           &view));
+  UNIT_TEST_ASSERT(coap_view_get_code(&view) == CHANGED_2_04);
+  UNIT_TEST_ASSERT(get("info", &view));
+  UNIT_TEST_ASSERT(info_calls == 2);
+
+  /* responses without Max-Age are not kept */
+  UNIT_TEST_ASSERT(get("sensor", &view));
+  UNIT_TEST_ASSERT(get("sensor", &view));
+  UNIT_TEST_ASSERT(coap_view_get_code(&view) == CONTENT_2_05);
+  UNIT_TEST_ASSERT(coap_cache_get_stats()->stores == 2);
+
+  /* .well-known/core is kept until a resource is activated */
+  coap_cache_reset_stats();
+  UNIT_TEST_ASSERT(get(".well-known/core", &view));
+  UNIT_TEST_ASSERT(view.payload_len > 0);
+  UNIT_TEST_ASSERT(get(".well-known/core", &view));
+  UNIT_TEST_ASSERT(coap_cache_get_stats()->hits == 1);
+  len = view.payload_len;
+  coap_activate_resource(&res_extra, "extra");
+  UNIT_TEST_ASSERT(get(".well-known/core", &view));
+  UNIT_TEST_ASSERT(coap_cache_get_stats()->hits == 1);
+  UNIT_TEST_ASSERT(view.payload_len == len + strlen(",</extra>"));
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(cache_duplicate, "Duplicate CON request answered again");
+UNIT_TEST(cache_duplicate)
+{
+  static uint8_t first[COAP_MAX_PACKET_SIZE];
+  coap_message_view_t view;
+  uint16_t first_len;
+  uint16_t mid = next_mid++;
+
+  UNIT_TEST_BEGIN();
+
+  coap_cache_reset_stats();
+  counter_calls = 0;
+  UNIT_TEST_ASSERT(request(COAP_TYPE_CON, COAP_POST, mid, "counter", NULL,
+                           &view));
+  first_len = response_len;
+  memcpy(first, response, response_len);
+
+  UNIT_TEST_ASSERT(request(COAP_TYPE_CON, COAP_POST, mid, "counter", NULL,
+                           &view));
+  UNIT_TEST_ASSERT(counter_calls == 1);
+  UNIT_TEST_ASSERT(response_len == first_len);
+  UNIT_TEST_ASSERT(memcmp(response, first, first_len) == 0);
+  UNIT_TEST_ASSERT(coap_cache_get_stats()->duplicates == 1);
+
+  /* a new exchange runs the handler */
+  UNIT_TEST_ASSERT(request(COAP_TYPE_CON, COAP_POST, next_mid++, "counter",
+                           NULL, &view));
+  UNIT_TEST_ASSERT(counter_calls == 2);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(cache_expiry, "Cached response expires after Max-Age");
+UNIT_TEST(cache_expiry)
+{
+  coap_message_view_t view;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(get("short", &view));
+  UNIT_TEST_ASSERT(short_calls == 2);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+static void
+benchmark(void)
+{
+  const coap_cache_stats_t *stats = coap_cache_get_stats();
+  coap_message_view_t view;
+  clock_time_t start;
+  clock_time_t time_cached;
+  clock_time_t time_uncached;
+  unsigned ok = 0;
+  unsigned i;
+
+  coap_cache_reset_stats();
+  start = clock_time();
+  for(i = 0; i < NUM_BENCH_REQUESTS; i++) {
+    ok += get("info", &view) && view.payload_len > 0;
+  }
+  time_cached = clock_time() - start;
+
+  start = clock_time();
+  for(i = 0; i < NUM_BENCH_REQUESTS; i++) {
+    ok += get("sensor", &view) && view.payload_len > 0;
+  }
+  time_uncached = clock_time() - start;
+
+  printf("Benchmark: %u GETs per resource, hits %lu, misses %lu, "
+         "hit rate %lu%%\n", NUM_BENCH_REQUESTS, (unsigned long)stats->hits,
+         (unsigned long)stats->misses,
+         (unsigned long)(stats->hits * 100 / (stats->hits + stats->misses)));
+  printf("cached %lu ms, handler %lu ms%s\n",
+         (unsigned long)(time_cached * 1000 / CLOCK_SECOND),
+         (unsigned long)(time_uncached * 1000 / CLOCK_SECOND),
+         ok == 2 * NUM_BENCH_REQUESTS && time_cached < time_uncached ?
+         "" : " =check-me= FAILED");
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  static struct etimer et;
+  static coap_message_view_t view;
+
+  PROCESS_BEGIN();
+
+  coap_engine_init();
+  coap_activate_resource(&res_info, "info");
+  coap_activate_resource(&res_sensor, "sensor");
+  coap_activate_resource(&res_short, "short");
+  coap_activate_resource(&res_counter, "counter");
+  setup_client();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(cache_hit);
+  UNIT_TEST_RUN(cache_validate);
+  UNIT_TEST_RUN(cache_invalidate);
+  UNIT_TEST_RUN(cache_duplicate);
+
+  get("short", &view);
+  get("short", &view);
+  etimer_set(&et, CLOCK_SECOND + CLOCK_SECOND / 10);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  UNIT_TEST_RUN(cache_expiry);
+
+  benchmark();
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
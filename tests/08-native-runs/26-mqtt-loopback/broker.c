@@ -0,0 +1,425 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "tcp-socket.h"
+#include "mqtt.h"
+#include "broker.h"
+#include <string.h>
+
+#define BODY_MAX 160
+#define LINK_SLOTS 8
+#define HELD_ACKS_MAX 8
+
+broker_stats_t broker_stats;
+uip_ipaddr_t broker_addr;
+uint8_t broker_ack_batch = 1;
+const uint8_t *broker_props;
+uint8_t broker_props_len;
+
+/* Packets on their way over the simulated link, delivered in order */
+static struct {
+  clock_time_t due;
+  uint16_t len;
+  uint8_t data[UIP_BUFSIZE];
+} link[LINK_SLOTS];
+static uint8_t link_head;
+static uint8_t link_count;
+static struct ctimer link_timer;
+
+static struct tcp_socket socket;
+static uint8_t in_buf[1024];
+static uint8_t out_buf[1024];
+
+/* Packet being parsed, packets may be split over several segments */
+static struct {
+  enum { PARSE_FHDR, PARSE_LENGTH, PARSE_BODY } state;
+  uint8_t fhdr;
+  uint32_t length;
+  uint8_t shift;
+  uint32_t pos;
+  uint8_t body[BODY_MAX];
+} pkt;
+static uint8_t protocol_level;
+
+/* Acks held back until broker_ack_batch of them have been collected */
+static uint8_t held_acks[HELD_ACKS_MAX][4];
+static uint8_t num_held_acks;
+
+/* PUBLISH to the client, written to the socket as its buffer drains */
+static struct {
+  uint8_t hdr[8 + BROKER_MAX_TOPIC_LEN + BROKER_MAX_PROPS_LEN];
+  uint16_t hdr_len;
+  uint32_t len;
+  uint32_t pos;
+} out_pub;
+static uint16_t out_pub_mid;
+/*---------------------------------------------------------------------------*/
+static void
+deliver(void *ptr)
+{
+  uip_ipaddr_t addr;
+
+  while(link_count > 0 && clock_time() >= link[link_head].due) {
+    memcpy(uip_buf, link[link_head].data, link[link_head].len);
+    uip_len = link[link_head].len;
+    link_head = (link_head + 1) % LINK_SLOTS;
+    link_count--;
+    uip_ipaddr_copy(&addr, &UIP_IP_BUF->srcipaddr);
+    uip_ipaddr_copy(&UIP_IP_BUF->srcipaddr, &UIP_IP_BUF->destipaddr);
+    uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, &addr);
+    tcpip_input();
+  }
+  if(link_count > 0) {
+    ctimer_set(&link_timer, link[link_head].due - clock_time(), deliver, NULL);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static enum netstack_ip_action
+link_output(const linkaddr_t *localdest)
+{
+  uint8_t i;
+
+  if(uip_ipaddr_cmp(&UIP_IP_BUF->destipaddr, &broker_addr) &&
+     link_count < LINK_SLOTS) {
+    i = (link_head + link_count) % LINK_SLOTS;
+    memcpy(link[i].data, uip_buf, uip_len);
+    link[i].len = uip_len;
+    link[i].due = clock_time() + BROKER_LINK_DELAY;
+    if(link_count++ == 0) {
+      ctimer_set(&link_timer, BROKER_LINK_DELAY, deliver, NULL);
+    }
+  }
+  return NETSTACK_IP_DROP;
+}
+static struct netstack_ip_packet_processor link_processor = {
+  .process_output = link_output
+};
+/*---------------------------------------------------------------------------*/
+void
+broker_send(const uint8_t *data, int len)
+{
+  tcp_socket_send(&socket, data, len);
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_ack(const uint8_t *ack)
+{
+  int i;
+
+  if(broker_ack_batch == 0) {
+    return;
+  }
+  memcpy(held_acks[num_held_acks++], ack, 4);
+  if(num_held_acks >= MIN(broker_ack_batch, HELD_ACKS_MAX)) {
+    /* Latest first, all in one segment */
+    for(i = num_held_acks - 1; i >= 0; i--) {
+      broker_send(held_acks[i], 4);
+    }
+    num_held_acks = 0;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+handle_connect(void)
+{
+  static const uint8_t connack[] = { 0x20, 0x02, 0x00, 0x00 };
+  static const uint8_t connack_v5[] = {
+    0x20, 0x08, 0x00, 0x00,
+    /* Receive Maximum 10, Wildcard Subscription Available 0 */
+    0x05, MQTT_VHDR_PROP_RECEIVE_MAX, 0x00, 0x0a,
+    MQTT_VHDR_PROP_WILD_SUB_AVAIL, 0x00
+  };
+  uint16_t name_len = (pkt.body[0] << 8) | pkt.body[1];
+
+  protocol_level = pkt.body[2 + name_len];
+  broker_stats.connects++;
+  if(protocol_level == MQTT_PROTOCOL_VERSION_5) {
+    broker_send(connack_v5, sizeof(connack_v5));
+  } else {
+    broker_send(connack, sizeof(connack));
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+handle_publish(void)
+{
+  uint8_t ack[4];
+  uint16_t topic_len;
+  uint32_t pos;
+  uint32_t end;
+  uint8_t qos;
+
+  qos = (pkt.fhdr >> 1) & 0x03;
+  topic_len = (pkt.body[0] << 8) | pkt.body[1];
+  pos = 2 + topic_len;
+  broker_stats.last_mid = 0;
+  if(qos > 0) {
+    broker_stats.last_mid = (pkt.body[pos] << 8) | pkt.body[pos + 1];
+    pos += 2;
+  }
+  broker_stats.last_props_len = 0;
+  if(protocol_level == MQTT_PROTOCOL_VERSION_5) {
+    /* Only property lengths below 128 are expected here */
+    broker_stats.last_props_len = MIN(pkt.body[pos], BROKER_MAX_PROPS_LEN);
+    memcpy(broker_stats.last_props, &pkt.body[pos + 1],
+           broker_stats.last_props_len);
+    pos += 1 + pkt.body[pos];
+  }
+
+  broker_stats.publishes++;
+  /* DUP flag */
+  if(pkt.fhdr & 0x08) {
+    broker_stats.dups++;
+  }
+  broker_stats.last_fhdr = pkt.fhdr;
+  memset(broker_stats.last_topic, 0, sizeof(broker_stats.last_topic));
+  memcpy(broker_stats.last_topic, &pkt.body[2],
+         MIN(topic_len, BROKER_MAX_TOPIC_LEN));
+  end = MIN(pkt.length, BODY_MAX);
+  broker_stats.last_payload_len = pkt.length - pos;
+  if(end > pos) {
+    memcpy(broker_stats.last_payload, &pkt.body[pos],
+           MIN(end - pos, BROKER_MAX_PAYLOAD_LEN));
+  }
+
+  if(qos > 0) {
+    ack[0] = qos == 1 ? MQTT_FHDR_MSG_TYPE_PUBACK : MQTT_FHDR_MSG_TYPE_PUBREC;
+    ack[1] = 2;
+    ack[2] = broker_stats.last_mid >> 8;
+    ack[3] = broker_stats.last_mid & 0xff;
+    send_ack(ack);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+handle_packet(void)
+{
+  uint8_t ack[5];
+
+  switch(pkt.fhdr & 0xf0) {
+  case MQTT_FHDR_MSG_TYPE_CONNECT:
+    handle_connect();
+    break;
+  case MQTT_FHDR_MSG_TYPE_PUBLISH:
+    handle_publish();
+    break;
+  case MQTT_FHDR_MSG_TYPE_PUBREL:
+    broker_stats.pubrels++;
+    ack[0] = MQTT_FHDR_MSG_TYPE_PUBCOMP;
+    ack[1] = 2;
+    ack[2] = pkt.body[0];
+    ack[3] = pkt.body[1];
+    send_ack(ack);
+    break;
+  case MQTT_FHDR_MSG_TYPE_SUBSCRIBE:
+    ack[0] = MQTT_FHDR_MSG_TYPE_SUBACK;
+    ack[1] = 3;
+    ack[2] = pkt.body[0];
+    ack[3] = pkt.body[1];
+    ack[4] = pkt.body[pkt.length - 1] & 0x03;
+    broker_send(ack, 5);
+    break;
+  case MQTT_FHDR_MSG_TYPE_PINGREQ:
+    ack[0] = MQTT_FHDR_MSG_TYPE_PINGRESP;
+    ack[1] = 0;
+    broker_send(ack, 2);
+    break;
+  default:
+    break;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+input(struct tcp_socket *s, void *ptr, const uint8_t *data, int len)
+{
+  int i;
+
+  broker_stats.segments++;
+  broker_stats.bytes += len;
+
+  for(i = 0; i < len; i++) {
+    switch(pkt.state) {
+    case PARSE_FHDR:
+      pkt.fhdr = data[i];
+      pkt.length = 0;
+      pkt.shift = 0;
+      pkt.pos = 0;
+      pkt.state = PARSE_LENGTH;
+      break;
+    case PARSE_LENGTH:
+      pkt.length |= (uint32_t)(data[i] & 0x7f) << pkt.shift;
+      pkt.shift += 7;
+      if((data[i] & 0x80) == 0) {
+        if(pkt.length == 0) {
+          handle_packet();
+          pkt.state = PARSE_FHDR;
+        } else {
+          pkt.state = PARSE_BODY;
+        }
+      }
+      break;
+    case PARSE_BODY:
+      if(pkt.pos < BODY_MAX) {
+        pkt.body[pkt.pos] = data[i];
+      }
+      if(++pkt.pos == pkt.length) {
+        handle_packet();
+        pkt.state = PARSE_FHDR;
+      }
+      break;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_publish(void)
+{
+  uint8_t chunk[64];
+  uint32_t i;
+  int len;
+  int sent;
+
+  while(out_pub.pos < out_pub.len) {
+    len = MIN(sizeof(chunk), out_pub.len - out_pub.pos);
+    for(i = 0; i < len; i++) {
+      if(out_pub.pos + i < out_pub.hdr_len) {
+        chunk[i] = out_pub.hdr[out_pub.pos + i];
+      } else {
+        chunk[i] = BROKER_PAYLOAD_BYTE(out_pub.pos + i - out_pub.hdr_len);
+      }
+    }
+    sent = tcp_socket_send(&socket, chunk, len);
+    if(sent <= 0) {
+      return;
+    }
+    out_pub.pos += sent;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+event(struct tcp_socket *s, void *ptr, tcp_socket_event_t ev)
+{
+  if(ev == TCP_SOCKET_CONNECTED) {
+    pkt.state = PARSE_FHDR;
+    num_held_acks = 0;
+    out_pub.pos = out_pub.len = 0;
+  } else if(ev == TCP_SOCKET_DATA_SENT) {
+    send_publish();
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+broker_publish(const char *topic, uint16_t payload_len, uint8_t qos)
+{
+  uint16_t topic_len = strlen(topic);
+  uint32_t length;
+  uint8_t *p;
+
+  if(out_pub.pos < out_pub.len || topic_len > BROKER_MAX_TOPIC_LEN ||
+     broker_props_len > BROKER_MAX_PROPS_LEN) {
+    return 0;
+  }
+
+  length = 2 + topic_len + payload_len;
+  if(qos > 0) {
+    length += 2;
+  }
+  if(protocol_level == MQTT_PROTOCOL_VERSION_5) {
+    length += 1 + broker_props_len;
+  }
+
+  p = out_pub.hdr;
+  *p++ = MQTT_FHDR_MSG_TYPE_PUBLISH | (qos << 1);
+  do {
+    *p = length & 0x7f;
+    length >>= 7;
+    if(length > 0) {
+      *p |= 0x80;
+    }
+    p++;
+  } while(length > 0);
+  *p++ = topic_len >> 8;
+  *p++ = topic_len & 0xff;
+  memcpy(p, topic, topic_len);
+  p += topic_len;
+  if(qos > 0) {
+    out_pub_mid++;
+    *p++ = out_pub_mid >> 8;
+    *p++ = out_pub_mid & 0xff;
+  }
+  if(protocol_level == MQTT_PROTOCOL_VERSION_5) {
+    /* Only property lengths below 128 are supported */
+    *p++ = broker_props_len;
+    memcpy(p, broker_props, broker_props_len);
+    p += broker_props_len;
+  }
+
+  out_pub.hdr_len = p - out_pub.hdr;
+  out_pub.len = out_pub.hdr_len + payload_len;
+  out_pub.pos = 0;
+  send_publish();
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+void
+broker_disconnect(void)
+{
+  tcp_socket_close(&socket);
+}
+/*---------------------------------------------------------------------------*/
+void
+broker_reset_stats(void)
+{
+  memset(&broker_stats, 0, sizeof(broker_stats));
+}
+/*---------------------------------------------------------------------------*/
+void
+broker_init(void)
+{
+  uip_lladdr_t lladdr;
+
+  memset(&lladdr, 0, sizeof(lladdr));
+  lladdr.addr[0] = 0x02;
+  lladdr.addr[sizeof(lladdr) - 1] = 0x02;
+  uip_ip6addr(&broker_addr, 0xfe80, 0, 0, 0, 0, 0, 0, 0);
+  uip_ds6_set_addr_iid(&broker_addr, &lladdr);
+  uip_ds6_nbr_add(&broker_addr, &lladdr, 0, NBR_REACHABLE,
+                  NBR_TABLE_REASON_IPV6_ND, NULL);
+  netstack_ip_packet_processor_add(&link_processor);
+
+  broker_reset_stats();
+  tcp_socket_register(&socket, NULL, in_buf, sizeof(in_buf),
+                      out_buf, sizeof(out_buf), input, event);
+  tcp_socket_listen(&socket, BROKER_PORT);
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BROKER_H_
+#define BROKER_H_
+
+#include "contiki.h"
+#include "net/ipv6/uip.h"
+
+/*
+ * A minimal MQTT broker running on the node itself, so that the client can be
+ * exercised without an external broker. It accepts any CONNECT, acknowledges
+ * PUBLISH and SUBSCRIBE and answers PINGREQ. Publishes are only counted, the
+ * last one is kept for inspection. broker_publish() sends a PUBLISH to the
+ * client, its payload byte i is BROKER_PAYLOAD_BYTE(i).
+ *
+ * An MQTTv5 CONNACK carries a Receive Maximum and reports wildcard
+ * subscriptions as unavailable.
+ *
+ * The client connects to broker_addr, a link-local neighbor. Packets sent to
+ * it are held for BROKER_LINK_DELAY and then delivered back to the node with
+ * source and destination swapped, which leaves the TCP checksum intact. The
+ * client thus talks to the broker over a link with a real round-trip time.
+ */
+
+#define BROKER_PORT 1883
+#define BROKER_LINK_DELAY (CLOCK_SECOND / 50)
+#define BROKER_MAX_TOPIC_LEN 32
+#define BROKER_MAX_PAYLOAD_LEN 64
+#define BROKER_PAYLOAD_BYTE(i) ((uint8_t)((i) * 7 + 3))
+#define BROKER_MAX_PROPS_LEN 64
+
+typedef struct {
+  unsigned long connects;
+  unsigned long publishes;
+  unsigned long segments;
+  unsigned long bytes;
+  unsigned long dups;
+  unsigned long pubrels;
+  uint8_t last_fhdr;
+  uint16_t last_mid;
+  char last_topic[BROKER_MAX_TOPIC_LEN + 1];
+  uint8_t last_payload[BROKER_MAX_PAYLOAD_LEN];
+  uint16_t last_payload_len;
+  /* MQTTv5 properties of the last publish, without their length field */
+  uint8_t last_props[BROKER_MAX_PROPS_LEN];
+  uint8_t last_props_len;
+} broker_stats_t;
+
+extern broker_stats_t broker_stats;
+extern uip_ipaddr_t broker_addr;
+
+/*
+ * PUBACK, PUBREC and PUBCOMP are held back until this many have been
+ * collected and then sent latest first. 1 acks right away, 0 never acks.
+ */
+extern uint8_t broker_ack_batch;
+
+void broker_init(void);
+void broker_reset_stats(void);
+
+/* Closes the connection to the client */
+void broker_disconnect(void);
+
+/* Sends a packet, already encoded, to the client */
+void broker_send(const uint8_t *data, int len);
+
+/* MQTTv5 properties of the packets sent by broker_publish(), encoded */
+extern const uint8_t *broker_props;
+extern uint8_t broker_props_len;
+
+/*
+ * Sends a PUBLISH of payload_len bytes to the client. Payloads larger than
+ * the socket buffer are written as the client acknowledges the data. Returns
+ * 0 while a previous PUBLISH is still being written.
+ */
+int broker_publish(const char *topic, uint16_t payload_len, uint8_t qos);
+
+#endif /* BROKER_H_ */
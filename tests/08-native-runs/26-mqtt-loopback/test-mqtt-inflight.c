@@ -0,0 +1,299 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "unit-test.h"
+#include "mqtt.h"
+#include "broker.h"
+#include <stdio.h>
+#include <string.h>
+
+PROCESS(test_process, "test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define NUM_BENCH_PUBLISHES 100
+#define BENCH_PAYLOAD_LEN 16
+
+/* Polls cond every clock tick, for at most five seconds */
+#define WAIT_FOR(cond)                                          \
+  do {                                                          \
+    deadline = clock_time() + 5 * CLOCK_SECOND;                 \
+    while(!(cond) && clock_time() < deadline) {                 \
+      etimer_set(&et, 1);                                       \
+      PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));            \
+    }                                                           \
+  } while(0)
+
+static struct mqtt_connection conn;
+static char client_id[] = "inflight";
+static char topic[] = "test/inflight";
+static char host[UIPLIB_IPV6_MAX_STR_LEN];
+static uint8_t payload[BENCH_PAYLOAD_LEN];
+static uint8_t connected;
+static unsigned long pubacks;
+static unsigned long pubcomps;
+static uint16_t mids[MQTT_MAX_INFLIGHT];
+static uint16_t acked_mids[MQTT_MAX_INFLIGHT];
+static mqtt_status_t window_full_status;
+/*---------------------------------------------------------------------------*/
+void
+print_test_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+mqtt_event(struct mqtt_connection *m, mqtt_event_t event, void *data)
+{
+  switch(event) {
+  case MQTT_EVENT_CONNECTED:
+    connected = 1;
+    break;
+  case MQTT_EVENT_DISCONNECTED:
+    connected = 0;
+    break;
+  case MQTT_EVENT_PUBACK:
+    if(pubacks < MQTT_MAX_INFLIGHT) {
+      acked_mids[pubacks] = *(uint16_t *)data;
+    }
+    pubacks++;
+    break;
+  case MQTT_EVENT_PUBCOMP:
+    pubcomps++;
+    break;
+  default:
+    break;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static mqtt_status_t
+publish(uint8_t *data, uint32_t len, mqtt_qos_level_t qos, uint16_t *mid)
+{
+#if MQTT_5
+  return mqtt_publish(&conn, mid, topic, data, len, qos, MQTT_RETAIN_OFF, 0,
+                      MQTT_TOPIC_ALIAS_OFF, NULL);
+#else
+  return mqtt_publish(&conn, mid, topic, data, len, qos, MQTT_RETAIN_OFF);
+#endif
+}
+/*---------------------------------------------------------------------------*/
+static void
+connect_broker(void)
+{
+  /* The test reconnects by itself, as examples/mqtt-client does */
+  conn.auto_reconnect = 0;
+#if MQTT_5
+  mqtt_connect(&conn, host, BROKER_PORT, 60, 0, NULL);
+#else
+  mqtt_connect(&conn, host, BROKER_PORT, 60, 0);
+#endif
+}
+/*---------------------------------------------------------------------------*/
+static void
+reset_acks(void)
+{
+  pubacks = 0;
+  pubcomps = 0;
+  memset(acked_mids, 0, sizeof(acked_mids));
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(out_of_order, "Out-of-order PUBACKs in one segment");
+UNIT_TEST(out_of_order)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(broker_stats.publishes == MQTT_MAX_INFLIGHT);
+  UNIT_TEST_ASSERT(pubacks == MQTT_MAX_INFLIGHT);
+  for(i = 0; i < MQTT_MAX_INFLIGHT; i++) {
+    UNIT_TEST_ASSERT(acked_mids[i] == mids[MQTT_MAX_INFLIGHT - 1 - i]);
+  }
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(qos2_flow, "QoS 2 PUBREC, PUBREL and PUBCOMP");
+UNIT_TEST(qos2_flow)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(broker_stats.publishes == 2);
+  UNIT_TEST_ASSERT(broker_stats.pubrels == 2);
+  UNIT_TEST_ASSERT(pubcomps == 2);
+  UNIT_TEST_ASSERT(pubacks == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+#if MQTT_WITH_SESSION_STORE
+UNIT_TEST_REGISTER(session_resend, "Session store resends after a restart");
+UNIT_TEST(session_resend)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(window_full_status == MQTT_STATUS_OUT_QUEUE_FULL);
+  UNIT_TEST_ASSERT(connected);
+  UNIT_TEST_ASSERT(broker_stats.dups == MQTT_MAX_INFLIGHT);
+  UNIT_TEST_ASSERT(pubacks == MQTT_MAX_INFLIGHT - 1);
+  UNIT_TEST_ASSERT(pubcomps == 1);
+  /* Acknowledged messages are removed from the store */
+  for(i = 0; i < MQTT_MAX_INFLIGHT; i++) {
+    UNIT_TEST_ASSERT(conn.inflight[i].state == MQTT_INFLIGHT_FREE);
+    UNIT_TEST_ASSERT(conn.inflight[i].stored_len == 0);
+  }
+
+  UNIT_TEST_END();
+}
+#endif /* MQTT_WITH_SESSION_STORE */
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  static struct etimer et;
+  static clock_time_t deadline;
+  static clock_time_t start;
+  static clock_time_t serial_time;
+  static clock_time_t window_time;
+  static unsigned sent;
+  static int i;
+
+  PROCESS_BEGIN();
+
+  broker_init();
+  uiplib_ipaddr_snprint(host, sizeof(host), &broker_addr);
+  mqtt_register(&conn, &test_process, client_id, mqtt_event,
+                MQTT_TCP_OUTPUT_BUFF_SIZE);
+  connect_broker();
+  WAIT_FOR(connected);
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  /* The broker acks the whole window at once, latest first */
+  broker_reset_stats();
+  reset_acks();
+  broker_ack_batch = MQTT_MAX_INFLIGHT;
+  for(i = 0; i < MQTT_MAX_INFLIGHT; i++) {
+    payload[0] = i;
+    WAIT_FOR(publish(payload, 1, MQTT_QOS_LEVEL_1, &mids[i]) ==
+             MQTT_STATUS_OK);
+  }
+  WAIT_FOR(pubacks == MQTT_MAX_INFLIGHT);
+  UNIT_TEST_RUN(out_of_order);
+
+  broker_ack_batch = 1;
+  broker_reset_stats();
+  reset_acks();
+  WAIT_FOR(publish(payload, 1, MQTT_QOS_LEVEL_2, NULL) == MQTT_STATUS_OK);
+  WAIT_FOR(publish(payload, 1, MQTT_QOS_LEVEL_2, NULL) == MQTT_STATUS_OK);
+  WAIT_FOR(pubcomps == 2);
+  UNIT_TEST_RUN(qos2_flow);
+
+#if MQTT_WITH_SESSION_STORE
+  /* Fill the window with messages the broker never acknowledges */
+  broker_ack_batch = 0;
+  broker_reset_stats();
+  reset_acks();
+  for(i = 0; i < MQTT_MAX_INFLIGHT; i++) {
+    WAIT_FOR(publish(payload, 1, i == 0 ? MQTT_QOS_LEVEL_2 : MQTT_QOS_LEVEL_1,
+                     &mids[i]) == MQTT_STATUS_OK);
+  }
+  WAIT_FOR(publish(payload, 1, MQTT_QOS_LEVEL_1, NULL) ==
+           MQTT_STATUS_OUT_QUEUE_FULL);
+  window_full_status = publish(payload, 1, MQTT_QOS_LEVEL_1, NULL);
+  WAIT_FOR(broker_stats.publishes == MQTT_MAX_INFLIGHT);
+
+  /* Lose the connection and restart, the in-flight table is read from CFS */
+  broker_disconnect();
+  WAIT_FOR(!connected);
+  mqtt_register(&conn, &test_process, client_id, mqtt_event,
+                MQTT_TCP_OUTPUT_BUFF_SIZE);
+  broker_ack_batch = 1;
+  broker_reset_stats();
+  connect_broker();
+  WAIT_FOR(connected);
+  WAIT_FOR(pubacks == MQTT_MAX_INFLIGHT - 1 && pubcomps == 1);
+  UNIT_TEST_RUN(session_resend);
+#endif /* MQTT_WITH_SESSION_STORE */
+
+  /* QoS 1, waiting for each PUBACK as the client used to */
+  broker_reset_stats();
+  reset_acks();
+  memset(payload, 0xa5, sizeof(payload));
+  start = clock_time();
+  for(sent = 0; sent < NUM_BENCH_PUBLISHES; sent++) {
+    WAIT_FOR(publish(payload, BENCH_PAYLOAD_LEN, MQTT_QOS_LEVEL_1, NULL) ==
+             MQTT_STATUS_OK);
+    WAIT_FOR(pubacks == sent + 1);
+  }
+  serial_time = clock_time() - start;
+
+  /* QoS 1, as fast as the in-flight window accepts messages */
+  reset_acks();
+  start = clock_time();
+  deadline = start + 30 * CLOCK_SECOND;
+  sent = 0;
+  while(sent < NUM_BENCH_PUBLISHES && clock_time() < deadline) {
+    if(publish(payload, BENCH_PAYLOAD_LEN, MQTT_QOS_LEVEL_1, NULL) ==
+       MQTT_STATUS_OK) {
+      sent++;
+    } else {
+      etimer_set(&et, CLOCK_SECOND / 10);
+      PROCESS_WAIT_EVENT();
+    }
+  }
+  WAIT_FOR(pubacks == NUM_BENCH_PUBLISHES);
+  window_time = clock_time() - start;
+
+  printf("Benchmark: %u QoS 1 publishes of %u bytes, one at a time %lu msg/s, "
+         "window of %u %lu msg/s%s\n",
+         NUM_BENCH_PUBLISHES, BENCH_PAYLOAD_LEN,
+         (unsigned long)(NUM_BENCH_PUBLISHES * CLOCK_SECOND /
+                         MAX(serial_time, 1)),
+         MQTT_MAX_INFLIGHT,
+         (unsigned long)(NUM_BENCH_PUBLISHES * CLOCK_SECOND /
+                         MAX(window_time, 1)),
+         broker_stats.publishes == 2 * NUM_BENCH_PUBLISHES &&
+         pubacks == NUM_BENCH_PUBLISHES && window_time < serial_time ?
+         "" : " =check-me= FAILED");
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
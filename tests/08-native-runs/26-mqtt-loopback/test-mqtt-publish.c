@@ -0,0 +1,249 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "unit-test.h"
+#include "mqtt.h"
+#include "broker.h"
+#include <stdio.h>
+#include <string.h>
+
+PROCESS(test_process, "test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define NUM_BENCH_PUBLISHES 500
+#define BENCH_PAYLOAD_LEN 16
+#define NUM_BURST 8
+
+/* Polls cond every clock tick, for at most five seconds */
+#define WAIT_FOR(cond)                                          \
+  do {                                                          \
+    deadline = clock_time() + 5 * CLOCK_SECOND;                 \
+    while(!(cond) && clock_time() < deadline) {                 \
+      etimer_set(&et, 1);                                       \
+      PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));            \
+    }                                                           \
+  } while(0)
+
+static struct mqtt_connection conn;
+static char client_id[] = "native";
+static char frame_topic[] = "test/frame";
+static char burst_topic[] = "test/burst";
+static char bench_topic[] = "bench/rate";
+static uint8_t payload[BENCH_PAYLOAD_LEN];
+static uint8_t connected;
+static unsigned long pubacks;
+static uint16_t last_puback_mid;
+static uint16_t qos1_mid;
+static int burst_accepted;
+/*---------------------------------------------------------------------------*/
+void
+print_test_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+mqtt_event(struct mqtt_connection *m, mqtt_event_t event, void *data)
+{
+  switch(event) {
+  case MQTT_EVENT_CONNECTED:
+    connected = 1;
+    break;
+  case MQTT_EVENT_DISCONNECTED:
+    connected = 0;
+    break;
+  case MQTT_EVENT_PUBACK:
+    pubacks++;
+    last_puback_mid = *(uint16_t *)data;
+    break;
+  default:
+    break;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static mqtt_status_t
+publish(char *topic, uint8_t *data, uint32_t len, mqtt_qos_level_t qos,
+        mqtt_retain_t retain, uint16_t *mid)
+{
+#if MQTT_5
+  return mqtt_publish(&conn, mid, topic, data, len, qos, retain, 0,
+                      MQTT_TOPIC_ALIAS_OFF, NULL);
+#else
+  return mqtt_publish(&conn, mid, topic, data, len, qos, retain);
+#endif
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(publish_framing, "QoS 0 PUBLISH framing");
+UNIT_TEST(publish_framing)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(broker_stats.publishes == 1);
+  UNIT_TEST_ASSERT(broker_stats.last_fhdr ==
+                   (MQTT_FHDR_MSG_TYPE_PUBLISH | MQTT_RETAIN_ON));
+  UNIT_TEST_ASSERT(strcmp(broker_stats.last_topic, frame_topic) == 0);
+  UNIT_TEST_ASSERT(broker_stats.last_payload_len == 5);
+  UNIT_TEST_ASSERT(memcmp(broker_stats.last_payload, "hello", 5) == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(publish_burst, "QoS 0 burst shares segments");
+UNIT_TEST(publish_burst)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(broker_stats.publishes == NUM_BURST);
+  UNIT_TEST_ASSERT(strcmp(broker_stats.last_topic, burst_topic) == 0);
+  UNIT_TEST_ASSERT(broker_stats.last_payload[0] == NUM_BURST - 1);
+#if MQTT_DIRECT_PUBLISH
+  UNIT_TEST_ASSERT(burst_accepted == NUM_BURST);
+  UNIT_TEST_ASSERT(broker_stats.segments < NUM_BURST);
+#endif
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(publish_qos1, "QoS 1 behind queued QoS 0");
+UNIT_TEST(publish_qos1)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(broker_stats.publishes == 3);
+  UNIT_TEST_ASSERT(broker_stats.last_fhdr ==
+                   (MQTT_FHDR_MSG_TYPE_PUBLISH | (MQTT_QOS_LEVEL_1 << 1)));
+  UNIT_TEST_ASSERT(broker_stats.last_mid == qos1_mid);
+  UNIT_TEST_ASSERT(pubacks == 1);
+  UNIT_TEST_ASSERT(last_puback_mid == qos1_mid);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  static struct etimer et;
+  static clock_time_t deadline;
+  static clock_time_t start;
+  static clock_time_t elapsed;
+  static char host[UIPLIB_IPV6_MAX_STR_LEN];
+  static unsigned sent;
+  static int i;
+
+  PROCESS_BEGIN();
+
+  broker_init();
+  uiplib_ipaddr_snprint(host, sizeof(host), &broker_addr);
+  mqtt_register(&conn, &test_process, client_id, mqtt_event,
+                MQTT_TCP_OUTPUT_BUFF_SIZE);
+#if MQTT_5
+  mqtt_connect(&conn, host, BROKER_PORT, 60, 1, NULL);
+#else
+  mqtt_connect(&conn, host, BROKER_PORT, 60, 1);
+#endif
+  WAIT_FOR(connected);
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  broker_reset_stats();
+  memcpy(payload, "hello", 5);
+  publish(frame_topic, payload, 5, MQTT_QOS_LEVEL_0, MQTT_RETAIN_ON, NULL);
+  WAIT_FOR(broker_stats.publishes == 1);
+  UNIT_TEST_RUN(publish_framing);
+
+  /* Publish a burst from one event, without giving the stack a chance to run */
+  broker_reset_stats();
+  for(i = 0; i < NUM_BURST; i++) {
+    payload[0] = i;
+    if(publish(burst_topic, payload, 1, MQTT_QOS_LEVEL_0, MQTT_RETAIN_OFF,
+               NULL) == MQTT_STATUS_OK) {
+      burst_accepted++;
+    } else {
+      WAIT_FOR(publish(burst_topic, payload, 1, MQTT_QOS_LEVEL_0,
+                       MQTT_RETAIN_OFF, NULL) == MQTT_STATUS_OK);
+    }
+  }
+  WAIT_FOR(broker_stats.publishes == NUM_BURST);
+  UNIT_TEST_RUN(publish_burst);
+
+  broker_reset_stats();
+  publish(burst_topic, payload, 1, MQTT_QOS_LEVEL_0, MQTT_RETAIN_OFF, NULL);
+  WAIT_FOR(publish(burst_topic, payload, 1, MQTT_QOS_LEVEL_0,
+                   MQTT_RETAIN_OFF, NULL) == MQTT_STATUS_OK);
+  WAIT_FOR(publish(burst_topic, payload, 1, MQTT_QOS_LEVEL_1,
+                   MQTT_RETAIN_OFF, &qos1_mid) == MQTT_STATUS_OK);
+  WAIT_FOR(pubacks == 1);
+  UNIT_TEST_RUN(publish_qos1);
+
+  /* Publish as fast as the client accepts messages */
+  broker_reset_stats();
+  WAIT_FOR(publish(bench_topic, payload, BENCH_PAYLOAD_LEN, MQTT_QOS_LEVEL_0,
+                   MQTT_RETAIN_OFF, NULL) == MQTT_STATUS_OK);
+  WAIT_FOR(broker_stats.publishes == 1);
+  broker_reset_stats();
+  memset(payload, 0xa5, sizeof(payload));
+  sent = 0;
+  start = clock_time();
+  deadline = start + 30 * CLOCK_SECOND;
+  while(sent < NUM_BENCH_PUBLISHES && clock_time() < deadline) {
+    if(publish(bench_topic, payload, BENCH_PAYLOAD_LEN, MQTT_QOS_LEVEL_0,
+               MQTT_RETAIN_OFF, NULL) == MQTT_STATUS_OK) {
+      sent++;
+    } else {
+      etimer_set(&et, CLOCK_SECOND / 10);
+      PROCESS_WAIT_EVENT();
+    }
+  }
+  WAIT_FOR(broker_stats.publishes == NUM_BENCH_PUBLISHES);
+  elapsed = clock_time() - start;
+
+  printf("Benchmark: %u QoS 0 publishes of %u bytes in %lu ms, %lu msg/s, "
+         "%lu.%02lu publishes per segment%s\n",
+         NUM_BENCH_PUBLISHES, BENCH_PAYLOAD_LEN,
+         (unsigned long)(elapsed * 1000 / CLOCK_SECOND),
+         (unsigned long)(NUM_BENCH_PUBLISHES * CLOCK_SECOND / MAX(elapsed, 1)),
+         broker_stats.publishes / MAX(broker_stats.segments, 1),
+         broker_stats.publishes * 100 / MAX(broker_stats.segments, 1) % 100,
+         broker_stats.publishes == NUM_BENCH_PUBLISHES &&
+         broker_stats.segments < NUM_BENCH_PUBLISHES ?
+         "" : " =check-me= FAILED");
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
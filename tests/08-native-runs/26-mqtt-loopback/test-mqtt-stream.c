@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "unit-test.h"
+#include "mqtt.h"
+#include "broker.h"
+#include <stdio.h>
+#include <string.h>
+
+PROCESS(test_process, "test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define SMALL_PAYLOAD_LEN 10
+#define LARGE_PAYLOAD_LEN 3000
+
+/* Polls cond every clock tick, for at most five seconds */
+#define WAIT_FOR(cond)                                          \
+  do {                                                          \
+    deadline = clock_time() + 5 * CLOCK_SECOND;                 \
+    while(!(cond) && clock_time() < deadline) {                 \
+      etimer_set(&et, 1);                                       \
+      PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));            \
+    }                                                           \
+  } while(0)
+
+static struct mqtt_connection conn;
+static char client_id[] = "stream";
+static char host[UIPLIB_IPV6_MAX_STR_LEN];
+static uint8_t connected;
+
+/* What the application has seen of incoming publishes */
+static struct {
+  unsigned long chunks;
+  unsigned long first_chunks;
+  unsigned long messages;
+  unsigned long empty_messages;
+  unsigned long bad_bytes;
+  unsigned long bad_lengths;
+  unsigned long copied_chunks;
+  uint16_t offset;
+  uint16_t max_chunk;
+  uint16_t last_length;
+  uint16_t last_mid;
+  char last_topic[MQTT_MAX_TOPIC_LENGTH + 1];
+} rx;
+/*---------------------------------------------------------------------------*/
+void
+print_test_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+receive_chunk(struct mqtt_message *msg)
+{
+  uint16_t i;
+
+  rx.chunks++;
+  if(msg->first_chunk) {
+    rx.first_chunks++;
+    rx.offset = 0;
+  }
+  for(i = 0; i < msg->payload_chunk_length; i++) {
+    if(msg->payload_chunk[i] != BROKER_PAYLOAD_BYTE(rx.offset + i)) {
+      rx.bad_bytes++;
+    }
+  }
+  /* Streamed chunks point into the TCP input buffer */
+  if(msg->payload_chunk < conn.in_buffer ||
+     msg->payload_chunk + msg->payload_chunk_length >
+     conn.in_buffer + MQTT_TCP_INPUT_BUFF_SIZE) {
+    rx.copied_chunks++;
+  }
+  rx.offset += msg->payload_chunk_length;
+  rx.max_chunk = MAX(rx.max_chunk, msg->payload_chunk_length);
+  if(rx.offset + msg->payload_left != msg->payload_length) {
+    rx.bad_lengths++;
+  }
+
+  if(msg->payload_left == 0) {
+    rx.messages++;
+    if(rx.offset == 0) {
+      rx.empty_messages++;
+    }
+    rx.last_length = rx.offset;
+    rx.last_mid = msg->mid;
+    strcpy(rx.last_topic, msg->topic);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+mqtt_event(struct mqtt_connection *m, mqtt_event_t event, void *data)
+{
+  switch(event) {
+  case MQTT_EVENT_CONNECTED:
+    connected = 1;
+    break;
+  case MQTT_EVENT_DISCONNECTED:
+    connected = 0;
+    break;
+  case MQTT_EVENT_PUBLISH:
+    receive_chunk(data);
+    break;
+  default:
+    break;
+  }
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(small_payload, "Small PUBLISH in one chunk");
+UNIT_TEST(small_payload)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(rx.messages == 1);
+  UNIT_TEST_ASSERT(rx.chunks == 1);
+  UNIT_TEST_ASSERT(rx.first_chunks == 1);
+  UNIT_TEST_ASSERT(rx.last_length == SMALL_PAYLOAD_LEN);
+  UNIT_TEST_ASSERT(strcmp(rx.last_topic, "test/stream/small") == 0);
+  UNIT_TEST_ASSERT(rx.bad_bytes == 0);
+  UNIT_TEST_ASSERT(rx.bad_lengths == 0);
+  UNIT_TEST_ASSERT(rx.copied_chunks == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(large_payload, "PUBLISH larger than the input buffers");
+UNIT_TEST(large_payload)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(LARGE_PAYLOAD_LEN > MQTT_INPUT_BUFF_SIZE);
+  UNIT_TEST_ASSERT(LARGE_PAYLOAD_LEN > MQTT_TCP_INPUT_BUFF_SIZE);
+  UNIT_TEST_ASSERT(rx.messages == 1);
+  UNIT_TEST_ASSERT(rx.chunks > 1);
+  UNIT_TEST_ASSERT(rx.first_chunks == 1);
+  UNIT_TEST_ASSERT(rx.last_length == LARGE_PAYLOAD_LEN);
+  UNIT_TEST_ASSERT(rx.max_chunk <= MQTT_TCP_INPUT_BUFF_SIZE);
+  UNIT_TEST_ASSERT(strcmp(rx.last_topic, "test/stream/large") == 0);
+  UNIT_TEST_ASSERT(rx.bad_bytes == 0);
+  UNIT_TEST_ASSERT(rx.bad_lengths == 0);
+  UNIT_TEST_ASSERT(rx.copied_chunks == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(back_to_back, "Consecutive PUBLISH packets");
+UNIT_TEST(back_to_back)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(rx.messages == 3);
+  UNIT_TEST_ASSERT(rx.first_chunks == 3);
+  /* An empty payload is reported with a single empty chunk */
+  UNIT_TEST_ASSERT(rx.empty_messages == 1);
+  /* The QoS 1 packet identifier is not part of the payload */
+  UNIT_TEST_ASSERT(rx.last_mid != 0);
+  UNIT_TEST_ASSERT(rx.last_length == SMALL_PAYLOAD_LEN);
+  UNIT_TEST_ASSERT(strcmp(rx.last_topic, "test/stream/qos1") == 0);
+  UNIT_TEST_ASSERT(rx.bad_bytes == 0);
+  UNIT_TEST_ASSERT(rx.bad_lengths == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  static struct etimer et;
+  static clock_time_t deadline;
+
+  PROCESS_BEGIN();
+
+  broker_init();
+  uiplib_ipaddr_snprint(host, sizeof(host), &broker_addr);
+  mqtt_register(&conn, &test_process, client_id, mqtt_event,
+                MQTT_TCP_OUTPUT_BUFF_SIZE);
+#if MQTT_5
+  mqtt_connect(&conn, host, BROKER_PORT, 60, 1, NULL);
+#else
+  mqtt_connect(&conn, host, BROKER_PORT, 60, 1);
+#endif
+  WAIT_FOR(connected);
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  memset(&rx, 0, sizeof(rx));
+  WAIT_FOR(broker_publish("test/stream/small", SMALL_PAYLOAD_LEN, 0));
+  WAIT_FOR(rx.messages == 1);
+  UNIT_TEST_RUN(small_payload);
+
+  memset(&rx, 0, sizeof(rx));
+  WAIT_FOR(broker_publish("test/stream/large", LARGE_PAYLOAD_LEN, 0));
+  WAIT_FOR(rx.messages == 1);
+  UNIT_TEST_RUN(large_payload);
+
+  memset(&rx, 0, sizeof(rx));
+  /* Packets may share segments and be split over them */
+  WAIT_FOR(broker_publish("test/stream/empty", 0, 0));
+  WAIT_FOR(broker_publish("test/stream/small", SMALL_PAYLOAD_LEN, 0));
+  WAIT_FOR(broker_publish("test/stream/qos1", SMALL_PAYLOAD_LEN, 1));
+  WAIT_FOR(rx.messages == 3);
+  UNIT_TEST_RUN(back_to_back);
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
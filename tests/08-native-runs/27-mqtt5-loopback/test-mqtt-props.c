@@ -0,0 +1,417 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "unit-test.h"
+#include "mqtt.h"
+#include "mqtt-prop.h"
+#include "broker.h"
+#include <stdio.h>
+#include <string.h>
+
+PROCESS(test_process, "test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define NUM_BENCH_PUBLISHES 200
+#define BENCH_PAYLOAD_LEN 16
+
+/* Polls cond every clock tick, for at most five seconds */
+#define WAIT_FOR(cond)                                          \
+  do {                                                          \
+    deadline = clock_time() + 5 * CLOCK_SECOND;                 \
+    while(!(cond) && clock_time() < deadline) {                 \
+      etimer_set(&et, 1);                                       \
+      PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));            \
+    }                                                           \
+  } while(0)
+
+static struct mqtt_connection conn;
+static char client_id[] = "props";
+static char topic[] = "test/props";
+static uint8_t payload[BENCH_PAYLOAD_LEN];
+static uint8_t connected;
+
+/* Properties of the PUBLISH sent by the broker, in wire format */
+static const uint8_t in_props[] = {
+  MQTT_VHDR_PROP_CONTENT_TYPE, 0x00, 0x04, 't', 'e', 'x', 't',
+  MQTT_VHDR_PROP_USER_PROP, 0x00, 0x01, 'k', 0x00, 0x02, 'v', '1',
+  MQTT_VHDR_PROP_MSG_EXP_INT, 0x00, 0x00, 0x00, 0x3c,
+  MQTT_VHDR_PROP_USER_PROP, 0x00, 0x01, 'k', 0x00, 0x02, 'v', '2',
+  /* Subscription Identifier 300, as a Variable Byte Integer */
+  MQTT_VHDR_PROP_SUB_ID, 0xac, 0x02
+};
+
+/* AUTH from the broker, Continue Authentication (0x18), method then data */
+static const uint8_t auth_packet[] = {
+  MQTT_FHDR_MSG_TYPE_AUTH, 0x11, 0x18, 0x0f,
+  MQTT_VHDR_PROP_AUTH_METHOD, 0x00, 0x05, 'S', 'C', 'R', 'A', 'M',
+  MQTT_VHDR_PROP_AUTH_DATA, 0x00, 0x04, 'd', 'a', 't', 'a'
+};
+
+/* Results of the lookups made on an incoming PUBLISH */
+static struct {
+  unsigned long messages;
+  uint32_t content_type_len;
+  uint32_t user_prop_len[3];
+  uint8_t user_prop[3][7];
+  uint32_t msg_exp_int;
+  uint32_t sub_id;
+  uint8_t has_msg_exp_int;
+  uint8_t has_sub_id;
+  uint8_t has_topic_alias;
+  uint8_t in_packet;
+} rx;
+
+/* What an AUTH event carries */
+static struct {
+  unsigned long auths;
+  uint16_t method_len;
+  size_t method_strlen;
+  char method[MQTT_PROP_MAX_PROP_LENGTH + 1];
+  uint16_t data_len;
+  uint8_t data[MQTT_PROP_MAX_PROP_LENGTH];
+} auth_rx;
+/*---------------------------------------------------------------------------*/
+void
+print_test_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+lookup_props(void)
+{
+  const uint8_t *value = NULL;
+  uint32_t val;
+  int i;
+
+  rx.messages++;
+  rx.content_type_len = mqtt_prop_find(&conn, MQTT_VHDR_PROP_CONTENT_TYPE,
+                                       &value);
+  /* Values are not copied, they point into the received packet */
+  rx.in_packet = value >= conn.in_packet.payload &&
+    value < conn.in_packet.payload + MQTT_INPUT_BUFF_SIZE;
+
+  value = NULL;
+  for(i = 0; i < 3; i++) {
+    rx.user_prop_len[i] = mqtt_prop_find(&conn, MQTT_VHDR_PROP_USER_PROP,
+                                         &value);
+    /* The packet is gone once the event returns */
+    if(value != NULL && rx.user_prop_len[i] == sizeof(rx.user_prop[i])) {
+      memcpy(rx.user_prop[i], value, sizeof(rx.user_prop[i]));
+    }
+  }
+
+  rx.has_msg_exp_int = mqtt_prop_get_int(&conn, MQTT_VHDR_PROP_MSG_EXP_INT,
+                                         &rx.msg_exp_int);
+  rx.has_sub_id = mqtt_prop_get_int(&conn, MQTT_VHDR_PROP_SUB_ID,
+                                    &rx.sub_id);
+  rx.has_topic_alias = mqtt_prop_get_int(&conn, MQTT_VHDR_PROP_TOPIC_ALIAS,
+                                         &val);
+}
+/*---------------------------------------------------------------------------*/
+static void
+copy_auth(const struct mqtt_prop_auth_event *auth)
+{
+  auth_rx.auths++;
+  auth_rx.method_len = auth->auth_method.length;
+  /* This is what registering the method again does */
+  auth_rx.method_strlen = strlen(auth->auth_method.string);
+  if(auth_rx.method_strlen < sizeof(auth_rx.method)) {
+    strcpy(auth_rx.method, auth->auth_method.string);
+  }
+  auth_rx.data_len = auth->auth_data.len;
+  memcpy(auth_rx.data, auth->auth_data.data, auth->auth_data.len);
+}
+/*---------------------------------------------------------------------------*/
+static void
+mqtt_event(struct mqtt_connection *m, mqtt_event_t event, void *data)
+{
+  switch(event) {
+  case MQTT_EVENT_CONNECTED:
+    connected = 1;
+    break;
+  case MQTT_EVENT_DISCONNECTED:
+    connected = 0;
+    break;
+  case MQTT_EVENT_PUBLISH:
+    if(((struct mqtt_message *)data)->first_chunk) {
+      lookup_props();
+    }
+    break;
+  case MQTT_EVENT_AUTH:
+    copy_auth(data);
+    break;
+  default:
+    break;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static mqtt_status_t
+publish(struct mqtt_prop_list *prop_list)
+{
+  return mqtt_publish(&conn, NULL, topic, payload, BENCH_PAYLOAD_LEN,
+                      MQTT_QOS_LEVEL_0, MQTT_RETAIN_OFF, 0,
+                      MQTT_TOPIC_ALIAS_OFF, prop_list);
+}
+/*---------------------------------------------------------------------------*/
+static void
+register_props(struct mqtt_prop_list **prop_list)
+{
+  mqtt_prop_register(prop_list, NULL, MQTT_FHDR_MSG_TYPE_PUBLISH,
+                     MQTT_VHDR_PROP_CONTENT_TYPE, "text");
+  mqtt_prop_register(prop_list, NULL, MQTT_FHDR_MSG_TYPE_PUBLISH,
+                     MQTT_VHDR_PROP_USER_PROP, "Contiki", "NG");
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(connack_props, "CONNACK properties looked up in place");
+UNIT_TEST(connack_props)
+{
+  UNIT_TEST_BEGIN();
+
+  /* The Receive Maximum in front does not stop the lookup */
+  UNIT_TEST_ASSERT(!(conn.srv_feature_en & MQTT_CAP_WILD_SUB_AVAIL));
+  UNIT_TEST_ASSERT(conn.srv_feature_en & MQTT_CAP_SUB_ID_AVAIL);
+  UNIT_TEST_ASSERT(conn.srv_feature_en & MQTT_CAP_SHARED_SUB_AVAIL);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(buf_list, "Buffer property list encoding");
+UNIT_TEST(buf_list)
+{
+  static struct mqtt_prop_list buf_list;
+  static uint8_t buf[16];
+  struct mqtt_prop_list *list = &buf_list;
+
+  UNIT_TEST_BEGIN();
+
+  mqtt_prop_create_buf_list(list, buf, sizeof(buf));
+  UNIT_TEST_ASSERT(mqtt_prop_add(list, MQTT_VHDR_PROP_CONTENT_TYPE,
+                                 "text") == 0);
+  UNIT_TEST_ASSERT(list->properties_len == 7);
+  /* Neither a property that does not fit nor an unknown one are added */
+  UNIT_TEST_ASSERT(mqtt_prop_add(list, MQTT_VHDR_PROP_USER_PROP,
+                                 "Contiki", "NG") != 0);
+  UNIT_TEST_ASSERT(mqtt_prop_add(list, MQTT_VHDR_PROP_ANY) != 0);
+  UNIT_TEST_ASSERT(list->properties_len == 7);
+  UNIT_TEST_ASSERT(mqtt_prop_add(list, MQTT_VHDR_PROP_MSG_EXP_INT, 60) == 0);
+  UNIT_TEST_ASSERT(list->properties_len == 12);
+  UNIT_TEST_ASSERT(list->properties_len_enc_bytes == 1);
+  UNIT_TEST_ASSERT(list->properties_len_enc[0] == 12);
+  UNIT_TEST_ASSERT(memcmp(buf, in_props, 7) == 0);
+  UNIT_TEST_ASSERT(memcmp(&buf[7], &in_props[15], 5) == 0);
+
+  mqtt_prop_clear_list(&list);
+  UNIT_TEST_ASSERT(list->properties_len == 0);
+  UNIT_TEST_ASSERT(list->buf == buf);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+/* Properties of the PUBLISH sent with the memb list, as the broker got them */
+static uint8_t list_props[BROKER_MAX_PROPS_LEN];
+static uint8_t list_props_len;
+
+UNIT_TEST_REGISTER(list_wire_format, "Memb list PUBLISH properties");
+UNIT_TEST(list_wire_format)
+{
+  UNIT_TEST_BEGIN();
+
+  memcpy(list_props, broker_stats.last_props, broker_stats.last_props_len);
+  list_props_len = broker_stats.last_props_len;
+  UNIT_TEST_ASSERT(list_props_len > 0);
+  UNIT_TEST_ASSERT(broker_stats.last_payload_len == BENCH_PAYLOAD_LEN);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(buf_wire_format, "Buffer list publishes like the memb list");
+UNIT_TEST(buf_wire_format)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(list_props_len > 0);
+  UNIT_TEST_ASSERT(broker_stats.last_props_len == list_props_len);
+  UNIT_TEST_ASSERT(memcmp(broker_stats.last_props, list_props,
+                          list_props_len) == 0);
+  UNIT_TEST_ASSERT(broker_stats.last_payload_len == BENCH_PAYLOAD_LEN);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(lazy_lookup, "Incoming properties looked up in place");
+UNIT_TEST(lazy_lookup)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(rx.messages == 1);
+  UNIT_TEST_ASSERT(rx.in_packet);
+  /* Strings come with their length field */
+  UNIT_TEST_ASSERT(rx.content_type_len == 6);
+
+  /* Repeated properties are found one after the other */
+  UNIT_TEST_ASSERT(rx.user_prop_len[0] == 7);
+  UNIT_TEST_ASSERT(rx.user_prop_len[1] == 7);
+  UNIT_TEST_ASSERT(rx.user_prop_len[2] == 0);
+  UNIT_TEST_ASSERT(memcmp(rx.user_prop[0], &in_props[8], 7) == 0);
+  UNIT_TEST_ASSERT(memcmp(rx.user_prop[1], &in_props[21], 7) == 0);
+
+  UNIT_TEST_ASSERT(rx.has_msg_exp_int && rx.msg_exp_int == 60);
+  UNIT_TEST_ASSERT(rx.has_sub_id && rx.sub_id == 300);
+  UNIT_TEST_ASSERT(!rx.has_topic_alias);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(auth_props, "AUTH method copied and NULL-terminated");
+UNIT_TEST(auth_props)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(auth_rx.auths == 1);
+  UNIT_TEST_ASSERT(auth_rx.method_len == 5);
+  /* In the packet, the method runs straight into the data property */
+  UNIT_TEST_ASSERT(auth_rx.method_strlen == 5);
+  UNIT_TEST_ASSERT(strcmp(auth_rx.method, "SCRAM") == 0);
+  UNIT_TEST_ASSERT(auth_rx.data_len == 4);
+  UNIT_TEST_ASSERT(memcmp(auth_rx.data, "data", 4) == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  static struct etimer et;
+  static clock_time_t deadline;
+  static clock_time_t start;
+  static clock_time_t elapsed[2];
+  static unsigned long segments[2];
+  static unsigned long received;
+  static char host[UIPLIB_IPV6_MAX_STR_LEN];
+  static struct mqtt_prop_list *mem_list;
+  static struct mqtt_prop_list buf_list;
+  static uint8_t buf[32];
+  static struct mqtt_prop_list *list;
+  static unsigned sent;
+  static int run;
+
+  PROCESS_BEGIN();
+
+  mqtt_props_init();
+  broker_init();
+  uiplib_ipaddr_snprint(host, sizeof(host), &broker_addr);
+  mqtt_register(&conn, &test_process, client_id, mqtt_event,
+                MQTT_TCP_OUTPUT_BUFF_SIZE);
+  mqtt_connect(&conn, host, BROKER_PORT, 60, 1, NULL);
+  WAIT_FOR(connected);
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(connack_props);
+  UNIT_TEST_RUN(buf_list);
+
+  mqtt_prop_create_list(&mem_list);
+  register_props(&mem_list);
+  list = &buf_list;
+  mqtt_prop_create_buf_list(list, buf, sizeof(buf));
+  register_props(&list);
+  memset(payload, 0xa5, sizeof(payload));
+
+  /* The same properties, first from pool entries and then from a buffer */
+  for(run = 0; run < 2; run++) {
+    list = run ? &buf_list : mem_list;
+    broker_reset_stats();
+    WAIT_FOR(publish(list) == MQTT_STATUS_OK);
+    WAIT_FOR(broker_stats.publishes == 1);
+    if(run) {
+      UNIT_TEST_RUN(buf_wire_format);
+    } else {
+      UNIT_TEST_RUN(list_wire_format);
+    }
+
+    broker_reset_stats();
+    sent = 0;
+    start = clock_time();
+    deadline = start + 30 * CLOCK_SECOND;
+    while(sent < NUM_BENCH_PUBLISHES && clock_time() < deadline) {
+      if(publish(list) == MQTT_STATUS_OK) {
+        sent++;
+      } else {
+        etimer_set(&et, CLOCK_SECOND / 10);
+        PROCESS_WAIT_EVENT();
+      }
+    }
+    WAIT_FOR(broker_stats.publishes == NUM_BENCH_PUBLISHES);
+    elapsed[run] = MAX(clock_time() - start, 1);
+    segments[run] = MAX(broker_stats.segments, 1);
+    received += broker_stats.publishes;
+  }
+
+  printf("Benchmark: %u QoS 0 publishes with %lu property bytes, "
+         "list %lu msg/s and %lu.%02lu publishes per segment, "
+         "buffer %lu msg/s and %lu.%02lu publishes per segment%s\n",
+         NUM_BENCH_PUBLISHES, (unsigned long)buf_list.properties_len,
+         (unsigned long)(NUM_BENCH_PUBLISHES * CLOCK_SECOND / elapsed[0]),
+         NUM_BENCH_PUBLISHES / segments[0],
+         NUM_BENCH_PUBLISHES * 100 / segments[0] % 100,
+         (unsigned long)(NUM_BENCH_PUBLISHES * CLOCK_SECOND / elapsed[1]),
+         NUM_BENCH_PUBLISHES / segments[1],
+         NUM_BENCH_PUBLISHES * 100 / segments[1] % 100,
+         received == 2 * NUM_BENCH_PUBLISHES ? "" : " =check-me= FAILED");
+  printf("Benchmark: property RAM, list %u bytes, buffer %u bytes\n",
+         (unsigned)(sizeof(struct mqtt_prop_list) +
+                    MQTT_PROP_MAX_OUT_PROPS *
+                    sizeof(struct mqtt_prop_out_property)),
+         (unsigned)(sizeof(struct mqtt_prop_list) + sizeof(buf)));
+
+  memset(&rx, 0, sizeof(rx));
+  broker_props = in_props;
+  broker_props_len = sizeof(in_props);
+  WAIT_FOR(broker_publish("test/props/in", BENCH_PAYLOAD_LEN, 0));
+  WAIT_FOR(rx.messages == 1);
+  UNIT_TEST_RUN(lazy_lookup);
+
+  broker_send(auth_packet, sizeof(auth_packet));
+  WAIT_FOR(auth_rx.auths == 1);
+  UNIT_TEST_RUN(auth_props);
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
@@ -0,0 +1,245 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Compares parent selection from the candidates sorted by path cost with a
+ * scan of the whole neighbor table, under random rank and link updates and
+ * preferred parent switches.
+ */
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "lib/random.h"
+#include "unit-test.h"
+#include "net/link-stats.h"
+#include "net/routing/rpl-lite/rpl.h"
+#include <stdio.h>
+#include <string.h>
+
+PROCESS(test_process, "test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define NUM_NEIGHBORS 100
+#define NUM_UPDATES 20000
+/* Every this many updates, the selected parent becomes the preferred one */
+#define SWITCH_INTERVAL 7
+#define NUM_BENCH_SELECTIONS 20000
+
+extern rpl_of_t rpl_mrhof;
+extern rpl_of_t rpl_of0;
+
+static linkaddr_t lladdrs[NUM_NEIGHBORS];
+static rpl_nbr_t *nbrs[NUM_NEIGHBORS];
+
+/*---------------------------------------------------------------------------*/
+void
+print_test_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* The best parent from all neighbors, as selected without sorted
+ * candidates. There is no maximum rank increase in these tests. */
+static rpl_nbr_t *
+scan_best_parent(void)
+{
+  rpl_nbr_t *nbr;
+  rpl_nbr_t *best = NULL;
+  rpl_rank_t rank;
+
+  for(nbr = nbr_table_head(rpl_neighbors); nbr != NULL;
+      nbr = nbr_table_next(rpl_neighbors, nbr)) {
+    rank = rpl_neighbor_rank_via_nbr(nbr);
+    if(rank != RPL_INFINITE_RANK && rank >= ROOT_RANK &&
+       curr_instance.of->nbr_is_acceptable_parent(nbr)) {
+      best = curr_instance.of->best_parent(best, nbr);
+    }
+  }
+  return best;
+}
+/*---------------------------------------------------------------------------*/
+static rpl_rank_t
+random_rank(void)
+{
+  return ROOT_RANK * (1 + random_rand() % 5);
+}
+/*---------------------------------------------------------------------------*/
+static int
+setup(rpl_of_t *of)
+{
+  int i;
+
+  memset(&curr_instance, 0, sizeof(curr_instance));
+  curr_instance.used = 1;
+  curr_instance.of = of;
+  curr_instance.min_hoprankinc = 128;
+  curr_instance.dag.rank = RPL_INFINITE_RANK;
+
+  for(i = 0; i < NUM_NEIGHBORS; i++) {
+    memset(&lladdrs[i], 0, sizeof(lladdrs[i]));
+    lladdrs[i].u8[0] = 0x02;
+    lladdrs[i].u8[LINKADDR_SIZE - 1] = i + 1;
+    nbrs[i] = nbr_table_add_lladdr(rpl_neighbors, &lladdrs[i],
+                                   NBR_TABLE_REASON_RPL_DIO, NULL);
+    if(nbrs[i] == NULL) {
+      return 0;
+    }
+    nbrs[i]->rank = random_rank();
+    link_stats_packet_sent(&lladdrs[i], MAC_TX_OK, 1 + random_rand() % 3);
+    rpl_neighbor_update_path_cost(nbrs[i]);
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+teardown(void)
+{
+  rpl_neighbor_set_preferred_parent(NULL);
+  /* The instance is not fully set up, so no DAG state update on removal */
+  curr_instance.used = 0;
+  rpl_neighbor_remove_all();
+}
+/*---------------------------------------------------------------------------*/
+/* Apply random updates, and count the selections that differ */
+static unsigned long
+random_updates(void)
+{
+  unsigned long mismatches = 0;
+  rpl_nbr_t *best;
+  uint32_t i;
+  int k;
+
+  for(i = 0; i < NUM_UPDATES; i++) {
+    k = random_rand() % NUM_NEIGHBORS;
+    if(random_rand() % 2) {
+      /* A DIO with a new rank */
+      nbrs[k]->rank = random_rank();
+    } else {
+      /* A transmission, possibly failed */
+      link_stats_packet_sent(&lladdrs[k],
+                             random_rand() % 4 ? MAC_TX_OK : MAC_TX_NOACK,
+                             1 + random_rand() % 4);
+    }
+    rpl_neighbor_update_path_cost(nbrs[k]);
+
+    best = rpl_neighbor_select_best();
+    if(best != scan_best_parent()) {
+      mismatches++;
+    }
+    if(i % SWITCH_INTERVAL == 0) {
+      rpl_neighbor_set_preferred_parent(best);
+      curr_instance.dag.rank = rpl_neighbor_rank_via_nbr(best);
+    }
+  }
+  return mismatches;
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(sorted_mrhof, "Sorted candidates select like a scan, MRHOF");
+UNIT_TEST(sorted_mrhof)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(setup(&rpl_mrhof));
+  UNIT_TEST_ASSERT(random_updates() == 0);
+  teardown();
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(sorted_of0, "Sorted candidates select like a scan, OF0");
+UNIT_TEST(sorted_of0)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(setup(&rpl_of0));
+  UNIT_TEST_ASSERT(random_updates() == 0);
+  teardown();
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+static void
+benchmark(void)
+{
+  clock_time_t start, time_sorted, time_scan;
+  rpl_nbr_t *best = NULL;
+  uint32_t i;
+  int ok;
+
+  ok = setup(&rpl_mrhof);
+  random_updates();
+
+  start = clock_time();
+  for(i = 0; i < NUM_BENCH_SELECTIONS; i++) {
+    best = rpl_neighbor_select_best();
+  }
+  time_sorted = clock_time() - start;
+  ok = ok && best == scan_best_parent();
+
+  start = clock_time();
+  for(i = 0; i < NUM_BENCH_SELECTIONS; i++) {
+    best = scan_best_parent();
+  }
+  time_scan = clock_time() - start;
+  teardown();
+
+  printf("Benchmark: %u selections among %u neighbors with MRHOF, "
+         "sorted %lu ms, scan %lu ms%s\n",
+         NUM_BENCH_SELECTIONS, NUM_NEIGHBORS,
+         (unsigned long)(time_sorted * 1000 / CLOCK_SECOND),
+         (unsigned long)(time_scan * 1000 / CLOCK_SECOND),
+         ok ? "" : " =check-me= FAILED");
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  PROCESS_PAUSE();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(sorted_mrhof);
+  UNIT_TEST_RUN(sorted_of0);
+
+  benchmark();
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,309 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "contiki-lib.h"
+
+#include "net/packetbuf.h"
+#include "net/mac/tsch/tsch.h"
+#include "net/mac/tsch/sixtop/sixtop.h"
+#include "net/mac/tsch/sixtop/sixp.h"
+#include "net/mac/tsch/sixtop/sixp-pkt.h"
+#include "net/mac/tsch/sixtop/sixp-trans.h"
+#include "net/mac/tsch/sixtop/msf.h"
+
+#include "unit-test/unit-test.h"
+#include "common.h"
+
+#define TEST_NUM_CHANNEL_OFFSETS 4
+/* Offset of the 6P header in a frame sent by sixtop_output() */
+#define TEST_6P_HEADER_OFFSET 5
+#define TEST_6P_HEADER_LEN 4
+
+static const linkaddr_t child_addr = {
+  {0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02}
+};
+static const linkaddr_t other_addr = {
+  {0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03}
+};
+
+static uint8_t body[4 + 2 * 3 * sizeof(sixp_pkt_cell_t)];
+
+PROCESS(test_process, "MSF test");
+AUTOSTART_PROCESSES(&test_process);
+
+static void
+test_setup(void)
+{
+  test_mac_driver.init();
+  tsch_schedule_init();
+  TSCH_ASN_DIVISOR_INIT(tsch_hopping_sequence_length, TEST_NUM_CHANNEL_OFFSETS);
+  sixtop_init();
+  packetbuf_clear();
+  sixtop_add_sf(&msf_driver);
+}
+
+static void
+write_cell(uint8_t *buf, uint16_t timeslot, uint16_t channel_offset)
+{
+  buf[0] = timeslot & 0xff;
+  buf[1] = timeslot >> 8;
+  buf[2] = channel_offset & 0xff;
+  buf[3] = channel_offset >> 8;
+}
+
+/* Input a request from the child, with a Tx CellOptions */
+static void
+input_request(sixp_pkt_cmd_t cmd, uint8_t seqno, uint8_t num_cells,
+              const uint16_t *cells, uint8_t cells_len,
+              const uint16_t *rel_cells, uint8_t rel_cells_len)
+{
+  uint16_t body_len = 4;
+  uint8_t i;
+
+  memset(body, 0, sizeof(body));
+  if(cmd != SIXP_PKT_CMD_CLEAR) {
+    body[2] = SIXP_PKT_CELL_OPTION_TX;
+    body[3] = num_cells;
+    for(i = 0; i < rel_cells_len; i++) {
+      write_cell(&body[body_len], rel_cells[2 * i], rel_cells[2 * i + 1]);
+      body_len += sizeof(sixp_pkt_cell_t);
+    }
+    for(i = 0; i < cells_len; i++) {
+      write_cell(&body[body_len], cells[2 * i], cells[2 * i + 1]);
+      body_len += sizeof(sixp_pkt_cell_t);
+    }
+  } else {
+    body_len = 2;
+  }
+
+  packetbuf_clear();
+  sixp_pkt_create(SIXP_PKT_TYPE_REQUEST, (sixp_pkt_code_t)(uint8_t)cmd,
+                  MSF_SFID, seqno, body, body_len, NULL);
+  sixp_input(packetbuf_hdrptr(), packetbuf_totlen(), &child_addr);
+}
+
+/* Check that the last response has the given return code and CellList */
+static int
+check_response(sixp_pkt_rc_t rc, const uint16_t *cells, uint8_t cells_len)
+{
+  const uint8_t *p = (const uint8_t *)packetbuf_hdrptr() + TEST_6P_HEADER_OFFSET;
+  uint8_t expected[sizeof(sixp_pkt_cell_t)];
+  uint8_t i;
+
+  if(!test_mac_send_function_is_called() || p[1] != rc) {
+    return 0;
+  }
+  p += TEST_6P_HEADER_LEN;
+  for(i = 0; i < cells_len; i++) {
+    write_cell(expected, cells[2 * i], cells[2 * i + 1]);
+    if(memcmp(p, expected, sizeof(expected)) != 0) {
+      return 0;
+    }
+    p += sizeof(sixp_pkt_cell_t);
+  }
+  /* Payload Termination IE */
+  return p[0] == 0x00 && p[1] == 0xf8;
+}
+
+/*
+ * Free the completed transaction right away; sixp would do it from a
+ * timer, which doesn't run within a unit test.
+ */
+static void
+end_transaction(void)
+{
+  sixp_trans_t *trans;
+  if((trans = sixp_trans_find(&child_addr)) != NULL) {
+    sixp_trans_free(trans);
+  }
+}
+
+static int
+has_rx_link(uint16_t timeslot, uint16_t channel_offset)
+{
+  struct tsch_link *l;
+  l = tsch_schedule_get_link_by_timeslot(
+        tsch_schedule_get_slotframe_by_handle(MSF_SLOTFRAME_HANDLE),
+        timeslot, channel_offset);
+  return l != NULL && l->link_options == LINK_OPTION_RX
+         && linkaddr_cmp(&l->addr, &child_addr);
+}
+
+UNIT_TEST_REGISTER(test_add_as_responder,
+                   "MSF grants free cells to an ADD request");
+UNIT_TEST(test_add_as_responder)
+{
+  struct tsch_slotframe *sf;
+  const uint16_t cand[] = { 1, 0, 2, 0, 3, 1 };
+  const uint16_t granted[] = { 1, 0, 3, 1 };
+
+  UNIT_TEST_BEGIN();
+  test_setup();
+
+  /* Timeslot 2 is taken by a cell with another neighbor */
+  sf = tsch_schedule_add_slotframe(MSF_SLOTFRAME_HANDLE, MSF_SLOTFRAME_LENGTH);
+  UNIT_TEST_ASSERT(sf != NULL);
+  UNIT_TEST_ASSERT(tsch_schedule_add_link(sf, LINK_OPTION_RX, LINK_TYPE_NORMAL,
+                                          &other_addr, 2, 3, 1) != NULL);
+
+  input_request(SIXP_PKT_CMD_ADD, 0, 2, cand, 3, NULL, 0);
+  UNIT_TEST_ASSERT(check_response(SIXP_PKT_RC_SUCCESS, granted, 2));
+
+  /* The cells are installed once the response is acknowledged */
+  UNIT_TEST_ASSERT(!has_rx_link(1, 0));
+  test_mac_invoke_sent_callback(MAC_TX_OK, 1);
+  end_transaction();
+  UNIT_TEST_ASSERT(has_rx_link(1, 0));
+  UNIT_TEST_ASSERT(has_rx_link(3, 1));
+  UNIT_TEST_ASSERT(!has_rx_link(2, 0));
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_delete_as_responder,
+                   "MSF removes the cells of a DELETE request");
+UNIT_TEST(test_delete_as_responder)
+{
+  const uint16_t cand[] = { 1, 0, 3, 1 };
+  const uint16_t deleted[] = { 3, 1 };
+  const uint16_t unknown[] = { 5, 0 };
+
+  UNIT_TEST_BEGIN();
+  test_setup();
+
+  input_request(SIXP_PKT_CMD_ADD, 0, 2, cand, 2, NULL, 0);
+  test_mac_invoke_sent_callback(MAC_TX_OK, 1);
+  end_transaction();
+  UNIT_TEST_ASSERT(has_rx_link(1, 0));
+  UNIT_TEST_ASSERT(has_rx_link(3, 1));
+
+  input_request(SIXP_PKT_CMD_DELETE, 1, 1, deleted, 1, NULL, 0);
+  UNIT_TEST_ASSERT(check_response(SIXP_PKT_RC_SUCCESS, deleted, 1));
+  test_mac_invoke_sent_callback(MAC_TX_OK, 1);
+  end_transaction();
+  UNIT_TEST_ASSERT(has_rx_link(1, 0));
+  UNIT_TEST_ASSERT(!has_rx_link(3, 1));
+
+  /* None of the cells is scheduled with the child */
+  input_request(SIXP_PKT_CMD_DELETE, 2, 1, unknown, 1, NULL, 0);
+  UNIT_TEST_ASSERT(check_response(SIXP_PKT_RC_ERR_CELLLIST, NULL, 0));
+  test_mac_invoke_sent_callback(MAC_TX_OK, 1);
+  end_transaction();
+  UNIT_TEST_ASSERT(has_rx_link(1, 0));
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_relocate_as_responder,
+                   "MSF moves a cell on a RELOCATE request");
+UNIT_TEST(test_relocate_as_responder)
+{
+  const uint16_t cand[] = { 1, 0, 3, 1 };
+  const uint16_t rel[] = { 3, 1 };
+  const uint16_t new_cand[] = { 1, 2, 4, 2 };
+  const uint16_t relocated[] = { 4, 2 };
+
+  UNIT_TEST_BEGIN();
+  test_setup();
+
+  input_request(SIXP_PKT_CMD_ADD, 0, 2, cand, 2, NULL, 0);
+  test_mac_invoke_sent_callback(MAC_TX_OK, 1);
+  end_transaction();
+
+  /* Timeslot 1 is already in use: the second candidate is picked */
+  input_request(SIXP_PKT_CMD_RELOCATE, 1, 1, new_cand, 2, rel, 1);
+  UNIT_TEST_ASSERT(check_response(SIXP_PKT_RC_SUCCESS, relocated, 1));
+  test_mac_invoke_sent_callback(MAC_TX_OK, 1);
+  end_transaction();
+  UNIT_TEST_ASSERT(has_rx_link(1, 0));
+  UNIT_TEST_ASSERT(!has_rx_link(3, 1));
+  UNIT_TEST_ASSERT(has_rx_link(4, 2));
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_clear_as_responder,
+                   "MSF removes all cells with a neighbor on a CLEAR request");
+UNIT_TEST(test_clear_as_responder)
+{
+  const uint16_t cand[] = { 1, 0, 3, 1 };
+
+  UNIT_TEST_BEGIN();
+  test_setup();
+
+  input_request(SIXP_PKT_CMD_ADD, 0, 2, cand, 2, NULL, 0);
+  test_mac_invoke_sent_callback(MAC_TX_OK, 1);
+  end_transaction();
+  UNIT_TEST_ASSERT(has_rx_link(1, 0));
+
+  input_request(SIXP_PKT_CMD_CLEAR, 1, 0, NULL, 0, NULL, 0);
+  UNIT_TEST_ASSERT(check_response(SIXP_PKT_RC_SUCCESS, NULL, 0));
+  UNIT_TEST_ASSERT(!has_rx_link(1, 0));
+  UNIT_TEST_ASSERT(!has_rx_link(3, 1));
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_add_not_acknowledged,
+                   "MSF does not install cells if the response is lost");
+UNIT_TEST(test_add_not_acknowledged)
+{
+  const uint16_t cand[] = { 1, 0 };
+
+  UNIT_TEST_BEGIN();
+  test_setup();
+
+  input_request(SIXP_PKT_CMD_ADD, 0, 1, cand, 1, NULL, 0);
+  UNIT_TEST_ASSERT(check_response(SIXP_PKT_RC_SUCCESS, cand, 1));
+  test_mac_invoke_sent_callback(MAC_TX_NOACK, 1);
+  UNIT_TEST_ASSERT(!has_rx_link(1, 0));
+
+  UNIT_TEST_END();
+}
+
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(test_add_as_responder);
+  UNIT_TEST_RUN(test_delete_as_responder);
+  UNIT_TEST_RUN(test_relocate_as_responder);
+  UNIT_TEST_RUN(test_clear_as_responder);
+  UNIT_TEST_RUN(test_add_not_acknowledged);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
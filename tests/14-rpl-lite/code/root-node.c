@@ -51,6 +51,11 @@
 
 static struct simple_udp_connection unicast_connection;
 
+#ifdef GLOBAL_REPAIR_DELAY_SECONDS
+/* Trigger a global repair once the network has formed */
+static struct etimer global_repair_timer;
+#endif /* GLOBAL_REPAIR_DELAY_SECONDS */
+
 /*---------------------------------------------------------------------------*/
 PROCESS(unicast_receiver_process, "Unicast receiver example process");
 AUTOSTART_PROCESSES(&unicast_receiver_process);
@@ -79,6 +84,13 @@ PROCESS_THREAD(unicast_receiver_process, ev, data)
   simple_udp_register(&unicast_connection, UDP_PORT,
                       NULL, UDP_PORT, receiver);
 
+#ifdef GLOBAL_REPAIR_DELAY_SECONDS
+  /* A single repair */
+  etimer_set(&global_repair_timer, GLOBAL_REPAIR_DELAY_SECONDS * CLOCK_SECOND);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&global_repair_timer));
+  NETSTACK_ROUTING.global_repair("Test");
+#endif /* GLOBAL_REPAIR_DELAY_SECONDS */
+
   while(1) {
     PROCESS_WAIT_EVENT();
   }
@@ -0,0 +1,5 @@
+#!/bin/bash
+
+export TEST_PROTOCOL=coap
+
+source packet-injector.sh